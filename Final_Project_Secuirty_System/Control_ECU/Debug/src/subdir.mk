@@ -11,8 +11,15 @@ C_SRCS += \
 ../src/eeprom.c \
 ../src/gpio.c \
 ../src/i2c.c \
+../src/kernel.c \
+../src/profile.c \
 ../src/pwm.c \
+../src/scheduler.c \
+../src/soft_timer.c \
+../src/soft_uart.c \
+../src/stack.c \
 ../src/timer1.c \
+../src/trace.c \
 ../src/uart.c 
 
 OBJS += \
@@ -23,8 +30,15 @@ OBJS += \
 ./src/eeprom.o \
 ./src/gpio.o \
 ./src/i2c.o \
+./src/kernel.o \
+./src/profile.o \
 ./src/pwm.o \
+./src/scheduler.o \
+./src/soft_timer.o \
+./src/soft_uart.o \
+./src/stack.o \
 ./src/timer1.o \
+./src/trace.o \
 ./src/uart.o 
 
 C_DEPS += \
@@ -35,8 +49,15 @@ C_DEPS += \
 ./src/eeprom.d \
 ./src/gpio.d \
 ./src/i2c.d \
+./src/kernel.d \
+./src/profile.d \
 ./src/pwm.d \
+./src/scheduler.d \
+./src/soft_timer.d \
+./src/soft_uart.d \
+./src/stack.d \
 ./src/timer1.d \
+./src/trace.d \
 ./src/uart.d 
 
 
@@ -5,72 +5,131 @@
  *      Author: abdalla
  *
  * Description: Main file for the Control Electronic Control Unit (ECU). It initializes the system,
- *              checks for existing passwords, and continuously processes incoming commands related
- *              to password management and door operations.
+ *              checks for existing passwords, and continuously processes the events of the
+ *              link with the HMI, the EEPROM, the door and the alarm.
  */
 
 #include "control_functions.h" /* Include the header file for control-related functions */
+#include "scheduler.h"         /* Event queue */
+#include "kernel.h"            /* Optional preemptive kernel */
+#include "timer1.h"            /* Timer1 timestamp */
+#include "profile.h"           /* Execution time profiler */
+#include "soft_timer.h"        /* Deferred timers */
 
-int main(void)
-{
-	/* Local Variable declarations */
-	uint8 response, resulte, password_indicator;
+#if (KERNEL_ENABLE == 1)
 
-	/* Initialize system functions */
-	Init_Function();
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
 
-	/* Check if a password is already set in the system */
-	password_indicator = Find_Password();
+/* Task priorities, 0 is the highest */
+#define EVENTS_TASK_PRIORITY    0
+#define LINK_TASK_PRIORITY      1
+#define EEPROM_TASK_PRIORITY    2
 
-	/* Inform the HMI whether a password is found or Not */
-	if (password_indicator == PASSWORD_FOUND)
+/*
+ * Task stacks: the interrupt chain of KERNEL_ISR_STACK_SIZE on top of the deepest calls of each task,
+ * estimated for the -O0 build. KERNEL_dump after each READY gives the bytes they never used.
+ */
+#define EVENTS_STACK_SIZE       (KERNEL_ISR_STACK_SIZE + 96)
+#define LINK_STACK_SIZE         (KERNEL_ISR_STACK_SIZE + 160)
+#define EEPROM_STACK_SIZE       (KERNEL_ISR_STACK_SIZE + 128)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static KERNEL_TaskType g_eventsTask;
+static KERNEL_TaskType g_linkTask;
+static KERNEL_TaskType g_eepromTask;
+static uint8 g_eventsStack[EVENTS_STACK_SIZE];
+static uint8 g_linkStack[LINK_STACK_SIZE];
+static uint8 g_eepromStack[EEPROM_STACK_SIZE];
+
+/* Given by the system tick when deferred timers expired, the events task waits on it */
+static KERNEL_SemaphoreType g_deferredSemaphore;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Ready callback of the deferred timers, called last in the tick ISR */
+static void Deferred_readyCallBack(void)
+{
+	KERNEL_semaphoreGive(&g_deferredSemaphore);
+}
+
+/*
+ * Highest priority task: the door and the alarm. Their timers are deferred, their callbacks post the
+ * events from here. It preempts the other tasks even in the middle of an EEPROM or UART transfer.
+ */
+static void Events_task(void)
+{
+	while (1)
 	{
-		send_command(PASSWORD_FOUND);
+		KERNEL_semaphoreTake(&g_deferredSemaphore, KERNEL_WAIT_FOREVER);
+
+#if (PROFILE_ENABLE == 1)
+		/* Time from the system tick until this task runs: tick ISR, scheduler and context switch */
+		PROFILE_record(PROFILE_KERNEL_WAKE, TIMER1_getTimestamp() - SOFT_TIMER_getTickTimestamp());
+#endif
+
+		SOFT_TIMER_runDeferred();
+		while (SCHEDULER_dispatch());
 	}
-	else
+}
+
+/* Task running the link with the HMI, woken by its bytes and by the results of the EEPROM task */
+static void Link_task(void)
+{
+	while (1)
 	{
-		send_command(NO_PASSWORD_FOUND);
+		Link_run();
 	}
+}
 
-	/* Main loop to handle commands from HMI */
+/* Lowest priority task, the EEPROM writes and reads of the commands */
+static void Eeprom_task(void)
+{
 	while (1)
 	{
-		/* Receive command from HMI */
-		response = receive_command();
+		Eeprom_run();
+	}
+}
 
-		/* Process the received command and get the result */
-		switch (response)
-		{
-			/* Handle new password setup */
-			case SENDING_PASSWORDS:
-				resulte = Receiving_Passwords();
-				break;
-
-			/* Handle password check for opening the door */
-			case CHECKING_PASSWORD_OPEN:
-				resulte = Checking_Password(OPEN_DOOR);
-				break;
-
-			/* Handle password change request */
-			case CHECKING_PASSWORD_CHANGE:
-				resulte = Checking_Password(CHANGING_PASSWORD);
-				break;
-		}
+#endif
 
-		/* Send the result back to the HMI */
-		send_command(resulte);
+int main(void)
+{
+	/* Initialize system functions */
+	Init_Function();
 
-		/* Take action based on the result */
-		if (resulte == PASSWORD_MATCH_OPEN)
-		{
-			Open_Door(); /* Open the door if the password matches */
-		}
+	/* Each subsystem handles its own events */
+	SCHEDULER_setHandler(EVENT_UART_RX, Link_Handler);
+	SCHEDULER_setHandler(EVENT_EEPROM_READY, Eeprom_Handler);
+	SCHEDULER_setHandler(EVENT_DOOR_TIMER, Door_Handler);
+	SCHEDULER_setHandler(EVENT_ALARM_TIMER, Alarm_Handler);
 
-		/* Activate the alarm after 4 unsuccessful attempts */
-		if ((resulte == PASSWORD_UNMATCH_OPEN && g_attempt == MAX_ATTEMPTS) || (resulte == PASSWORD_UNMATCH_CHANGE && g_attempt == MAX_ATTEMPTS))
+	/* Inform the HMI whether a password is found or Not */
+	Link_start();
+
+#if (KERNEL_ENABLE == 1)
+	/* The door and alarm events, the link and the EEPROM in their own tasks, KERNEL_start never returns */
+	KERNEL_init();
+	KERNEL_semaphoreInit(&g_deferredSemaphore, 0);
+	SOFT_TIMER_setReadyCallBack(Deferred_readyCallBack);
+	KERNEL_createTask(&g_eventsTask, Events_task, g_eventsStack, EVENTS_STACK_SIZE, EVENTS_TASK_PRIORITY);
+	KERNEL_createTask(&g_linkTask, Link_task, g_linkStack, LINK_STACK_SIZE, LINK_TASK_PRIORITY);
+	KERNEL_createTask(&g_eepromTask, Eeprom_task, g_eepromStack, EEPROM_STACK_SIZE, EEPROM_TASK_PRIORITY);
+	KERNEL_start();
+#endif
+
+	/* Main loop to run the events one after the other, no handler ever waits */
+	while (1)
+	{
+		if (!SCHEDULER_dispatch())
 		{
-			g_attempt = ZERO_ATTEMPTS; 	/* Reset attempt counter */
-			Alarm();
+			(void)Link_idle();
 		}
 	}
 }
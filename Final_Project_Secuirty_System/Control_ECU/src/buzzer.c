@@ -10,6 +10,10 @@
 #include "gpio.h" 	/* Include header file for GPIO functions */
 #include "pwm.h" 	/* Include header file for PWM functions */
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -21,10 +25,10 @@
 void BUZZER_init(void)
 {
 	/*  Setup the direction for the buzzer pin */
-    GPIO_setupPinDirection(BUZZER_PORT, BUZZER_PIN, PIN_OUTPUT); 	/* Set buzzer pin as output */
+    GPIO_SETUP_PIN_DIRECTION(BUZZER_PORT, BUZZER_PIN, PIN_OUTPUT); 	/* Set buzzer pin as output */
 
     /* Turn off the buzzer at the beginning */
-    GPIO_writePin(BUZZER_PORT, BUZZER_PIN, LOGIC_LOW); 				/* Set initial state of buzzer pin to low */
+    GPIO_WRITE_PIN(BUZZER_PORT, BUZZER_PIN, LOGIC_LOW); 			/* Set initial state of buzzer pin to low */
 }
 
 /*
@@ -34,7 +38,7 @@ void BUZZER_init(void)
 void BUZZER_on (void)
 {
 	/* Turn on the buzzer*/
-	GPIO_writePin(BUZZER_PORT, BUZZER_PIN, LOGIC_HIGH);
+	GPIO_WRITE_PIN(BUZZER_PORT, BUZZER_PIN, LOGIC_HIGH);
 }
 
 /*
@@ -44,7 +48,7 @@ void BUZZER_on (void)
 void BUZZER_off(void)
 {
 	/* Turn off the buzzer*/
-	GPIO_writePin(BUZZER_PORT, BUZZER_PIN, LOGIC_LOW);
+	GPIO_WRITE_PIN(BUZZER_PORT, BUZZER_PIN, LOGIC_LOW);
 }
 
 
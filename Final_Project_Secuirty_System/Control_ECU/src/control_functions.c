@@ -6,18 +6,91 @@
  *
  * Description: This file contains the implementation of control functions for the Control ECU.
  *              It includes initialization of system components, password handling, and door operation logic.
+ *              Every function runs to completion: the link with the HMI, the door and the alarm are
+ *              state machines moved forward by the events of the scheduler.
+ *              With KERNEL_ENABLE the link and the EEPROM run in their own tasks: the bytes of the HMI
+ *              and the results of the EEPROM reach the link task through a kernel queue, and the
+ *              EEPROM jobs the EEPROM task through another one.
  */
 
 #include "control_functions.h" /* Include header for control function prototypes */
 #include "uart.h"              /* UART communication functions */
 #include "std_types.h"         /* Standard data types */
-#include "timer1.h"            /* Timer1 control functions */
+#include "timer1.h"            /* Timer1 channels */
+#include "soft_timer.h"        /* System tick and software timers */
+#include "scheduler.h"         /* Event queue */
 #include "dc_motor.h"          /* DC motor control functions */
 #include "buzzer.h"            /* Buzzer control functions */
 #include "i2c.h"               /* I2C communication functions */
 #include "eeprom.h"            /* EEPROM interaction functions */
+#include "profile.h"           /* Execution time profiler */
+#include "stack.h"             /* RAM high-water mark */
+#include "trace.h"             /* Binary trace logger */
+#include "soft_uart.h"         /* Software UART debug channel */
+#include "kernel.h"            /* Optional preemptive kernel */
 #include <avr/io.h>            /* AVR IO definitions (SREG) */
-#include <util/delay.h>        /* Delay functions */
+#include <avr/interrupt.h>     /* For cli() */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Output of the debug text: the software UART, else the link at the times the HMI drops it */
+#if (SOFT_UART_ENABLE == 1)
+#define DEBUG_SEND_BYTE             SOFT_UART_sendByte
+#else
+#define DEBUG_SEND_BYTE             UART_sendByte
+#endif
+
+/* With KERNEL_ENABLE the callbacks of the door and alarm timers post their events from the events task */
+#if (KERNEL_ENABLE == 1)
+#define CONTROL_TIMER_START         SOFT_TIMER_startDeferred
+#else
+#define CONTROL_TIMER_START         SOFT_TIMER_start
+#endif
+
+/* Number of messages the link queue can hold */
+#define LINK_QUEUE_SIZE             16
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum defining the states of the link with the HMI */
+typedef enum
+{
+	LINK_SEND_RESULT,       /* Waiting for READY from the HMI to send the result */
+	LINK_WAIT_COMMAND,      /* READY is sent, the next byte is a command */
+	LINK_FIRST_PASSWORD,    /* Receiving the first new password */
+	LINK_SECOND_PASSWORD,   /* Receiving the second new password */
+	LINK_CHECK_PASSWORD,    /* Receiving the password to check */
+	LINK_WORKING            /* The result is not ready yet */
+} Link_State;
+
+#if (KERNEL_ENABLE == 1)
+/* Enum defining the kinds of messages of the link queue */
+typedef enum
+{
+	LINK_MESSAGE_BYTE,      /* A byte from the HMI, sent by the UART receive interrupt */
+	LINK_MESSAGE_RESULT     /* The result of an EEPROM job, sent by the EEPROM task */
+} Link_MessageKind;
+
+/* Structure of a message of the link queue */
+typedef struct
+{
+	uint8 kind;             /* Link_MessageKind */
+	uint8 data;             /* The byte received, or the result */
+} Link_MessageType;
+#endif
+
+/* Enum defining the states of the door */
+typedef enum
+{
+	DOOR_CLOSED,            /* Motor off, waiting for an open request */
+	DOOR_OPENING,           /* Motor rotates clockwise */
+	DOOR_HOLDING,           /* Motor off, the door stays open */
+	DOOR_CLOSING            /* Motor rotates counter-clockwise */
+} Door_State;
 
 /*******************************************************************************
  *                          Global Variables                                   *
@@ -26,7 +99,73 @@
 /* Global variables for password storage and attempt tracking */
 uint8 g_firstPass[PASSWORD_SIZE] = {0};
 uint8 g_secondPass[PASSWORD_SIZE] = {0};
-uint8 g_attempt = 0, g_seconds = 0;
+uint8 g_attempt = 0;
+
+/* Link state, the command being served, the received password bytes and the result to send */
+static Link_State g_linkState = LINK_SEND_RESULT;
+static uint8 g_command = 0;
+static uint8 g_index = 0;
+static uint8 g_result = 0;
+
+/* TRUE if the HMI sent READY while the result was not ready yet */
+static boolean g_hmiReady = FALSE;
+
+/* Timestamp of the last byte received from the HMI, taken in the receive interrupt */
+static volatile uint32 g_rxTimestamp = 0;
+
+/* Door state and the software timers of the door and the alarm */
+static Door_State g_doorState = DOOR_CLOSED;
+static SOFT_TIMER_Type g_doorTimer;
+static SOFT_TIMER_Type g_alarmTimer;
+
+#if (KERNEL_ENABLE == 1)
+/* Bytes of the HMI and results of the EEPROM for the link task, and one EEPROM job for the EEPROM task */
+static KERNEL_QueueType g_linkQueue;
+static Link_MessageType g_linkMessages[LINK_QUEUE_SIZE];
+static KERNEL_QueueType g_eepromQueue;
+static uint8 g_eepromJob;
+#else
+/* Software timer of the EEPROM write cycle */
+static SOFT_TIMER_Type g_eepromTimer;
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* UART receive call back, posts every received byte as an event or with KERNEL_ENABLE sends it to the link task */
+static void Link_rxCallBack(uint8 data);
+
+/* Software timer call backs, post the timer events */
+static void Door_timerCallBack(void);
+static void Alarm_timerCallBack(void);
+#if (KERNEL_ENABLE == 0)
+static void Eeprom_timerCallBack(void);
+#endif
+
+/* Move the link forward with a byte received from the HMI */
+static void Link_receive(uint8 data);
+
+/* Give a job to the EEPROM: store the new password (SENDING_PASSWORDS) or check the password of a command */
+static void Eeprom_start(uint8 command);
+
+/* Run a job of the EEPROM */
+static void Eeprom_job(uint8 command);
+
+/* Give the result of an EEPROM job to the link */
+static void Link_postResult(uint8 result);
+
+/* Send READY and wait for the next command */
+static void Link_waitCommand(void);
+
+/* Send the result now if the HMI is ready or when its READY arrives */
+static void Link_sendResult(uint8 result);
+
+/* Send the result and start the actions that follow it */
+static void Link_resultSent(void);
+
+/* Answer the clock synchronization of the HMI with the receive and send timestamps */
+static void Link_sendClock(void);
 
 /*******************************************************************************
  *                      Functions  Definitions                                 *
@@ -35,108 +174,269 @@ uint8 g_attempt = 0, g_seconds = 0;
 /* Function to initialize system components */
 void Init_Function (void)
 {
-	/* Configuration structures for UART and TWI */
-	UART_ConfigType uart_struct = {EVEN_PARITY, ONE_STOP_BIT, EIGHT_BIT, 9600};
-	TWI_ConfigType twi_struct = {FAST_MODE, CONTROL_ECU_ADDRESS};
-
-	/* Initialize UART, TWI, DC motor, buzzer, and Timer1 with callback */
-	TWI_init(&twi_struct);
-	UART_init(&uart_struct);
+	/*
+	 * Initialize UART, TWI, DC motor, buzzer, Timer1 (1 MHz free-running counter), the system tick
+	 * and the event queue. The configurations of UART, TWI and Timer1 are in their headers.
+	 */
+	TWI_init(CONTROL_ECU_ADDRESS);
+	UART_init();
 	DcMotor_init();
 	BUZZER_init();
-	TIMER1_setCallBack(Count_Seconds);
+	TIMER1_init();
+	SOFT_TIMER_init();
+#if (SOFT_UART_ENABLE == 1)
+	SOFT_UART_init();
+#endif
+	SCHEDULER_init();
+#if (KERNEL_ENABLE == 1)
+	KERNEL_queueInit(&g_linkQueue, (uint8 *)g_linkMessages, sizeof(Link_MessageType), LINK_QUEUE_SIZE);
+	KERNEL_queueInit(&g_eepromQueue, &g_eepromJob, sizeof(uint8), 1);
+#endif
+
+	/* Every byte from the HMI becomes an event */
+	UART_setRxCallBack(Link_rxCallBack);
 
 	/* Enable global interrupts */
 	SREG |= (1<<7);
 }
 
-/* Function to send a command via UART */
-void send_command(uint8 command)
-{
-	/* Wait for readiness and send command */
-	while(UART_recieveByte() != READY_TO_RECEVIE);
-	UART_sendByte(command);
-}
-
-/* Function to receive a command via UART */
-uint8 receive_command(void)
-{
-	/* Send readiness signal and receive response */
-	uint8 response;
-	UART_sendByte(READY_TO_RECEVIE);
-	response = UART_recieveByte();
-	return response;
-}
-
 /* Function to check if a password is stored in EEPROM */
 uint8 Find_Password(void)
 {
 	/* Read the password indicator from EEPROM */
 	uint8 resulte;
+	PROFILE_BEGIN(EEPROM_READ_BYTE);
 	EEPROM_readByte(PASSWORD_INDICATOR, &resulte);
+	PROFILE_END(EEPROM_READ_BYTE);
 	return resulte;
 }
 
-/* Function to handle receiving and validating passwords */
-uint8 Receiving_Passwords (void)
+/* Function to inform the HMI whether a password is found or not, once the HMI is ready */
+void Link_start(void)
 {
-	/* Local variable for loop control */
-	uint8 i;
+	if (Find_Password() == PASSWORD_FOUND)
+	{
+		Link_sendResult(PASSWORD_FOUND);
+	}
+	else
+	{
+		Link_sendResult(NO_PASSWORD_FOUND);
+	}
+}
 
-	/* Increment attempt counter and check for max attempts */
-	g_attempt++;
+/* Function called by the main loop when no event is waiting, returns TRUE if a trace record was sent */
+boolean Link_idle(void)
+{
+#if (TRACE_ENABLE == 1)
+	/*
+	 * While the link waits for a command the HMI drops every byte except READY, one trace record
+	 * is sent at a time so a command received meanwhile waits one line at most.
+	 * The software UART can send at any time.
+	 */
+	if ((SOFT_UART_ENABLE == 1) || (g_linkState == LINK_WAIT_COMMAND))
+	{
+		return TRACE_drain(DEBUG_SEND_BYTE);
+	}
+#endif
+	return FALSE;
+}
+
+#if (KERNEL_ENABLE == 1)
+/* Function running one message of the link task, it sends the trace records while it waits for it */
+void Link_run(void)
+{
+	Link_MessageType message;
+
+	while (!KERNEL_queueReceive(&g_linkQueue, &message, 0))
+	{
+		if (!Link_idle())
+		{
+			(void)KERNEL_queueReceive(&g_linkQueue, &message, KERNEL_WAIT_FOREVER);
+			break;
+		}
+	}
 
-	if (g_attempt == MAX_ATTEMPTS)
+	if (message.kind == LINK_MESSAGE_BYTE)
 	{
-		return PASSWORDS_UNMATCH;
+		Link_receive(message.data);
 	}
 	else
 	{
-		/* Receive and compare two passwords */
-		UART_sendByte(READY_TO_RECEVIE);
-		UART_receiveData(g_firstPass, PASSWORD_SIZE);
-		UART_sendByte(READY_TO_RECEVIE);
-		UART_receiveData(g_secondPass, PASSWORD_SIZE);
+		Link_sendResult(message.data);
+	}
+}
 
-		/* Validate passwords and write to EEPROM if they match */
-		for(i = 0; i < PASSWORD_SIZE; i++)
-		{
-			if (g_firstPass[i] != g_secondPass[i])
+/* Function running one job of the EEPROM task */
+void Eeprom_run(void)
+{
+	uint8 command;
+
+	(void)KERNEL_queueReceive(&g_eepromQueue, &command, KERNEL_WAIT_FOREVER);
+	Eeprom_job(command);
+}
+#endif
+
+/* Function to handle every byte received from the HMI */
+void Link_Handler(const SCHEDULER_EventType * event_ptr)
+{
+	Link_receive(event_ptr->data);
+}
+
+/* Move the link forward with a byte received from the HMI */
+static void Link_receive(uint8 data)
+{
+	switch (g_linkState)
+	{
+		case LINK_SEND_RESULT:
+			/* Ignore everything until the HMI is ready */
+			if (data == READY_TO_RECEVIE)
 			{
-				/* Write in the PASSWORD_INDICATOR location in the eeprom that is no password is saved */
-				EEPROM_writeByte(PASSWORD_INDICATOR, NO_PASSWORD_FOUND);
-				return PASSWORDS_UNMATCH;
+				Link_resultSent();
 			}
-		}
+			break;
+
+		case LINK_WORKING:
+			/* Remember the HMI is ready, the result is sent as soon as it is known */
+			if (data == READY_TO_RECEVIE)
+			{
+				g_hmiReady = TRUE;
+			}
+			break;
+
+		case LINK_WAIT_COMMAND:
+			TRACE1(COMMAND, data);
+			switch (data)
+			{
+				/* Handle new password setup */
+				case SENDING_PASSWORDS:
+					/* Increment attempt counter and check for max attempts */
+					g_attempt++;
+					if (g_attempt == MAX_ATTEMPTS)
+					{
+						Link_sendResult(PASSWORDS_UNMATCH);
+					}
+					else
+					{
+						g_index = 0;
+						g_linkState = LINK_FIRST_PASSWORD;
+						UART_sendByte(READY_TO_RECEVIE);
+					}
+					break;
+
+				/* Handle password check for opening the door */
+				case CHECKING_PASSWORD_OPEN:
+					g_command = OPEN_DOOR;
+					g_index = 0;
+					g_linkState = LINK_CHECK_PASSWORD;
+					UART_sendByte(READY_TO_RECEVIE);
+					break;
+
+				/* Handle password change request */
+				case CHECKING_PASSWORD_CHANGE:
+					g_command = CHANGING_PASSWORD;
+					g_index = 0;
+					g_linkState = LINK_CHECK_PASSWORD;
+					UART_sendByte(READY_TO_RECEVIE);
+					break;
+
+				/* Handle the timestamp exchange of the clock synchronization */
+				case SYNCING_CLOCK:
+					Link_sendClock();
+					break;
+			}
+			break;
+
+		case LINK_FIRST_PASSWORD:
+			g_firstPass[g_index++] = data;
+			if (g_index == PASSWORD_SIZE)
+			{
+				g_index = 0;
+				g_linkState = LINK_SECOND_PASSWORD;
+				UART_sendByte(READY_TO_RECEVIE);
+			}
+			break;
 
-		/* Store the password in the eeprom */
-		EEPROM_writeData(PASSWORD_LOCATION, g_firstPass, PASSWORD_SIZE);
+		case LINK_SECOND_PASSWORD:
+			g_secondPass[g_index++] = data;
+			if (g_index == PASSWORD_SIZE)
+			{
+				g_linkState = LINK_WORKING;
+				Eeprom_start(SENDING_PASSWORDS);
+			}
+			break;
 
-		/* Wait 10 millesec to be able to write to the eeprom again*/
-		_delay_ms(10);
+		case LINK_CHECK_PASSWORD:
+			g_firstPass[g_index++] = data;
+			if (g_index == PASSWORD_SIZE)
+			{
+				g_linkState = LINK_WORKING;
+				Eeprom_start(g_command);
+			}
+			break;
+	}
+}
+
+/* Function to validate the two received passwords and start storing them */
+void Receiving_Passwords (void)
+{
+	/* Local variable for loop control */
+	uint8 i;
 
-		/* Write in the PASSWORD_INDICATOR location in the eeprom that there is a password saved */
-		EEPROM_writeByte(PASSWORD_INDICATOR, PASSWORD_FOUND);
-		g_attempt = ZERO_ATTEMPTS; /* Reset attempt counter */
-		return PASSWORDS_MATCH;
+	/* Validate passwords and write to EEPROM if they match */
+	for(i = 0; i < PASSWORD_SIZE; i++)
+	{
+		if (g_firstPass[i] != g_secondPass[i])
+		{
+			/* Write in the PASSWORD_INDICATOR location in the eeprom that is no password is saved */
+			PROFILE_BEGIN(EEPROM_WRITE_BYTE);
+			EEPROM_writeByte(PASSWORD_INDICATOR, NO_PASSWORD_FOUND);
+			PROFILE_END(EEPROM_WRITE_BYTE);
+			TRACE0(PASSWORDS_UNMATCH);
+			Link_postResult(PASSWORDS_UNMATCH);
+			return;
+		}
 	}
+
+	/* Store the password in the eeprom */
+	PROFILE_BEGIN(EEPROM_WRITE_DATA);
+	EEPROM_writeData(PASSWORD_LOCATION, g_firstPass, PASSWORD_SIZE);
+	PROFILE_END(EEPROM_WRITE_DATA);
+
+	/* Wait 10 millesec to be able to write to the eeprom again, the indicator is written after */
+#if (KERNEL_ENABLE == 1)
+	KERNEL_delay(EEPROM_WRITE_CYCLE);
+	Eeprom_Handler(NULL_PTR);
+#else
+	SOFT_TIMER_start(&g_eepromTimer, EEPROM_WRITE_CYCLE, 0, Eeprom_timerCallBack);
+#endif
 }
 
-/* Function to check if the entered password matches the stored password */
+/* Function to finish storing the password after the EEPROM write cycle */
+void Eeprom_Handler(const SCHEDULER_EventType * event_ptr)
+{
+	/* Write in the PASSWORD_INDICATOR location in the eeprom that there is a password saved */
+	PROFILE_BEGIN(EEPROM_WRITE_BYTE);
+	EEPROM_writeByte(PASSWORD_INDICATOR, PASSWORD_FOUND);
+	PROFILE_END(EEPROM_WRITE_BYTE);
+
+	g_attempt = ZERO_ATTEMPTS; /* Reset attempt counter */
+	TRACE0(PASSWORD_SAVED);
+	Link_postResult(PASSWORDS_MATCH);
+}
+
+/* Function to check if the received password matches the stored password */
 uint8 Checking_Password(uint8 command)
 {
 	/* Variable to iterate through the password array */
 	uint8 i;
 	/* Increment the global attempt counter */
 	g_attempt++;
-
-	/* Send a byte to indicate readiness to receive data */
-	UART_sendByte(READY_TO_RECEVIE);
-	/* Receive the first password attempt from the user */
-	UART_receiveData(g_firstPass, PASSWORD_SIZE);
+	TRACE1(PASSWORD_ATTEMPT, g_attempt);
 
 	/* Read the stored password from EEPROM */
+	PROFILE_BEGIN(EEPROM_READ_DATA);
 	EEPROM_readData(PASSWORD_LOCATION, g_secondPass, PASSWORD_SIZE);
+	PROFILE_END(EEPROM_READ_DATA);
 
 	/* Loop through each digit of the password */
 	for(i = 0; i < PASSWORD_SIZE; i++)
@@ -180,47 +480,234 @@ uint8 Checking_Password(uint8 command)
 	/* Return 0 if none of the cases are met (should not happen in normal operation) */
 	return 0;
 }
-/* Function to simulate the door opening and closing process */
+
+/* Function to start the door opening and closing process */
 void Open_Door (void)
 {
-	/* Rotate motor to open, hold, and close the door */
+	/* A request while the door is moving is ignored */
+	if (g_doorState != DOOR_CLOSED)
+	{
+		return;
+	}
+
+	/* Rotate motor to open */
 	DcMotor_rotate(MOTOR_CW, FULL_SPEED);
-	Timer1_countSeconds(FIFTEEN_SECONDS);
+	g_doorState = DOOR_OPENING;
+	TRACE1(DOOR_STATE, g_doorState);
+	CONTROL_TIMER_START(&g_doorTimer, FIFTEEN_SECONDS, 0, Door_timerCallBack);
+}
+
+/* Function to move the door to its next step when the current one is over */
+void Door_Handler(const SCHEDULER_EventType * event_ptr)
+{
+	switch (g_doorState)
+	{
+		case DOOR_OPENING:
+			/* Hold the door */
+			DcMotor_rotate(MOTOR_OFF, ZERO_SPEED);
+			g_doorState = DOOR_HOLDING;
+			CONTROL_TIMER_START(&g_doorTimer, THREE_SECONDS, 0, Door_timerCallBack);
+			break;
 
-	DcMotor_rotate(MOTOR_OFF, ZERO_SPEED);
-	Timer1_countSeconds(THREE_SECONDS);
+		case DOOR_HOLDING:
+			/* Rotate motor to close */
+			DcMotor_rotate(MOTOR_CCW, FULL_SPEED);
+			g_doorState = DOOR_CLOSING;
+			CONTROL_TIMER_START(&g_doorTimer, FIFTEEN_SECONDS, 0, Door_timerCallBack);
+			break;
 
-	DcMotor_rotate(MOTOR_CCW, FULL_SPEED);
-	Timer1_countSeconds(FIFTEEN_SECONDS);
+		case DOOR_CLOSING:
+			DcMotor_rotate(MOTOR_OFF, ZERO_SPEED);
+			g_doorState = DOOR_CLOSED;
+			break;
 
-	DcMotor_rotate(MOTOR_OFF, ZERO_SPEED);
+		case DOOR_CLOSED:
+			break;
+	}
+	TRACE1(DOOR_STATE, g_doorState);
 }
 
 /* Function to activate the alarm for one minute */
 void Alarm (void)
 {
 	BUZZER_on();
-	Timer1_countSeconds(ONE_MINUTE);
+	TRACE0(ALARM_ON);
+	CONTROL_TIMER_START(&g_alarmTimer, ONE_MINUTE, 0, Alarm_timerCallBack);
+}
+
+/* Function to stop the alarm when its time is over */
+void Alarm_Handler(const SCHEDULER_EventType * event_ptr)
+{
 	BUZZER_off();
+	TRACE0(ALARM_OFF);
+}
+
+/* UART receive call back, posts every received byte as an event or with KERNEL_ENABLE sends it to the link task */
+static void Link_rxCallBack(uint8 data)
+{
+#if (KERNEL_ENABLE == 1)
+	Link_MessageType message;
+#endif
+
+	/* First, so the receive time of a command has the same latency as the one of the HMI */
+	g_rxTimestamp = TIMER1_getTimestamp();
+	TRACE1(UART_RX, data);
+
+#if (KERNEL_ENABLE == 1)
+	/* Last, the link task may run at once from here. A byte beyond the queue is lost */
+	message.kind = LINK_MESSAGE_BYTE;
+	message.data = data;
+	(void)KERNEL_queueSend(&g_linkQueue, &message, 0);
+#else
+	SCHEDULER_post(EVENT_UART_RX, data);
+#endif
 }
 
-/* Callback function to count seconds using Timer1 */
-void Count_Seconds(void)
+/* Software timer call backs, post the timer events */
+static void Door_timerCallBack(void)
 {
-	g_seconds++;
+	SCHEDULER_post(EVENT_DOOR_TIMER, 0);
 }
 
-/* Function to count a specified number of seconds using Timer1 */
-void Timer1_countSeconds(uint8 seconds)
+static void Alarm_timerCallBack(void)
 {
-	/* Configure and start Timer1 */
-	TIMER1_ConfigType count_sec = {COMPARE_MODE, F_CPU_256, 0, ONE_SECOND};
-	TIMER1_init(&count_sec);
+	SCHEDULER_post(EVENT_ALARM_TIMER, 0);
+}
 
-	/* Wait for the specified number of seconds */
-	while(g_seconds != seconds);
+#if (KERNEL_ENABLE == 0)
+static void Eeprom_timerCallBack(void)
+{
+	SCHEDULER_post(EVENT_EEPROM_READY, 0);
+}
+#endif
+
+/* Give a job to the EEPROM: store the new password (SENDING_PASSWORDS) or check the password of a command */
+static void Eeprom_start(uint8 command)
+{
+#if (KERNEL_ENABLE == 1)
+	/* The link waits for the result, the EEPROM task never holds more than one job */
+	(void)KERNEL_queueSend(&g_eepromQueue, &command, KERNEL_WAIT_FOREVER);
+#else
+	Eeprom_job(command);
+#endif
+}
+
+/* Run a job of the EEPROM */
+static void Eeprom_job(uint8 command)
+{
+	uint8 result;
+
+	if (command == SENDING_PASSWORDS)
+	{
+		Receiving_Passwords();
+		return;
+	}
+
+	PROFILE_BEGIN(CHECKING_PASSWORD);
+	result = Checking_Password(command);
+	PROFILE_END(CHECKING_PASSWORD);
+	TRACE2(PASSWORD_CHECKED, command, result);
+	Link_postResult(result);
+}
+
+/* Give the result of an EEPROM job to the link */
+static void Link_postResult(uint8 result)
+{
+#if (KERNEL_ENABLE == 1)
+	Link_MessageType message;
+
+	message.kind = LINK_MESSAGE_RESULT;
+	message.data = result;
+	(void)KERNEL_queueSend(&g_linkQueue, &message, KERNEL_WAIT_FOREVER);
+#else
+	Link_sendResult(result);
+#endif
+}
+
+/* Send READY and wait for the next command */
+static void Link_waitCommand(void)
+{
+	/* Send readiness signal, the command arrives as the next event */
+	UART_sendByte(READY_TO_RECEVIE);
+	g_linkState = LINK_WAIT_COMMAND;
+
+#if (PROFILE_ENABLE == 1)
+	/*
+	 * The HMI reads the READY byte first and then drops everything up to the next READY
+	 * byte, so the profiling results and the RAM use can be sent here without breaking the protocol.
+	 */
+	PROFILE_dump(DEBUG_SEND_BYTE);
+	STACK_dump(DEBUG_SEND_BYTE);
+#if (KERNEL_ENABLE == 1)
+	KERNEL_dump(DEBUG_SEND_BYTE);
+#endif
+#endif
+}
+
+/* Answer the clock synchronization of the HMI with the receive and send timestamps */
+static void Link_sendClock(void)
+{
+	uint32 received;
+	uint32 sent;
+	uint8 i;
+	uint8 sreg = SREG;
+
+	/* The HMI sends nothing until the answer, the command is the last byte received */
+	cli();
+	received = g_rxTimestamp;
+	SREG = sreg;
+
+	/* The HMI takes its timestamp when this byte arrives, the time it is sent follows it */
+	UART_sendByte(SYNCING_CLOCK);
+	sent = TIMER1_getTimestamp();
+
+	/* Both timestamps with their low byte first */
+	for (i = 0; i < 4; i++)
+	{
+		UART_sendByte((uint8)(received >> (8 * i)));
+	}
+	for (i = 0; i < 4; i++)
+	{
+		UART_sendByte((uint8)(sent >> (8 * i)));
+	}
+
+	Link_waitCommand();
+}
+
+/* Send the result now if the HMI is ready or when its READY arrives */
+static void Link_sendResult(uint8 result)
+{
+	g_result = result;
+
+	if (g_hmiReady)
+	{
+		Link_resultSent();
+	}
+	else
+	{
+		g_linkState = LINK_SEND_RESULT;
+	}
+}
+
+/* Send the result and start the actions that follow it */
+static void Link_resultSent(void)
+{
+	UART_sendByte(g_result);
+	g_hmiReady = FALSE;
+
+	/* Take action based on the result */
+	if (g_result == PASSWORD_MATCH_OPEN)
+	{
+		Open_Door(); /* Open the door if the password matches */
+	}
+
+	/* Activate the alarm after 4 unsuccessful attempts */
+	if ((g_result == PASSWORD_UNMATCH_OPEN && g_attempt == MAX_ATTEMPTS) || (g_result == PASSWORD_UNMATCH_CHANGE && g_attempt == MAX_ATTEMPTS))
+	{
+		g_attempt = ZERO_ATTEMPTS; 	/* Reset attempt counter */
+		Alarm();
+	}
 
-	/* Reset seconds counter and stop Timer1 */
-	g_seconds = ZERO_SECONDS;
-	TIMER1_deinit();
+	/* The door and the alarm run on their own, the next command can be served now */
+	Link_waitCommand();
 }
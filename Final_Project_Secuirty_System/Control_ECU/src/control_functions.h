@@ -12,6 +12,8 @@
 #define CONTROL_FUNCTIONS_H_
 
 #include "std_types.h" /* Include standard data types */
+#include "scheduler.h" /* Event type of the handlers */
+#include "kernel.h"    /* KERNEL_ENABLE */
 
 
 /*******************************************************************************
@@ -39,30 +41,22 @@
 #define CHANGING_PASSWORD           0x23 /* Command to change the password */
 #define PASSWORD_UNMATCH_OPEN       0x24 /* Password does not match for 'Open Door' command */
 #define PASSWORD_UNMATCH_CHANGE     0x25 /* Password does not match for 'Change Password' command */
+#define SYNCING_CLOCK               0x26 /* Command to exchange the timestamps of the clock synchronization */
 
 /* Macros for attempt limits */
 #define MAX_ATTEMPTS        	4 	/* Maximum number of password attempts */
 #define ZERO_ATTEMPTS       	0 	/* Reset the number of attempts to zero */
 
-/*
- * Timer tick calculation for one second
- * 31250 timer tick
- * each tick = 32 micro sec
- * 32 * 31250 = 1000000 micro sec
- * 1000000 micro sec = 1 sec
- */
-#define ONE_SECOND          31250 /* Number of timer ticks for one second */
-
-/* Macros for time durations in seconds */
-#define ZERO_SECONDS        0  		/* Zero seconds */
-#define TWO_SECONDS         2  		/* Two seconds */
-#define THREE_SECONDS       3  		/* Three seconds */
-#define FIFTEEN_SECONDS     15 		/* Fifteen seconds */
-#define ONE_MINUTE          60 		/* Sixty seconds or one minute */
+/* Macros for time durations in milliseconds */
+#define TWO_SECONDS         2000UL	/* Two seconds */
+#define THREE_SECONDS       3000UL	/* Three seconds */
+#define FIFTEEN_SECONDS     15000UL	/* Fifteen seconds */
+#define ONE_MINUTE          60000UL	/* Sixty seconds or one minute */
+#define EEPROM_WRITE_CYCLE  10UL	/* Time the EEPROM needs to finish a write */
 
 /* Speed definitions for the DC motor */
-#define FULL_SPEED          100 	/* Full speed setting for the motor */
-#define ZERO_SPEED          0   	/* Zero speed setting, effectively turning off the motor */
+#define FULL_SPEED          PWM_DUTY_CYCLE(100) 	/* Full speed setting for the motor */
+#define ZERO_SPEED          PWM_DUTY_CYCLE(0)   	/* Zero speed setting, effectively turning off the motor */
 
 /* EEPROM locations for storing password and its status indicator */
 #define PASSWORD_INDICATOR  0x0309 	/* EEPROM location for the password existence indicator */
@@ -78,32 +72,46 @@ extern uint8 g_attempt;
 /* Initialize control ECU components */
 void Init_Function (void);
 
-/* Send a command to the HMI ECU */
-void send_command(uint8 command);
-
-/* Receive a command from the HMI ECU */
-uint8 receive_command(void);
-
 /* Check if a password is stored in EEPROM */
 uint8 Find_Password(void);
 
-/* Handle receiving and validating new passwords */
-uint8 Receiving_Passwords (void);
+/* Inform the HMI whether a password is stored, once the HMI is ready */
+void Link_start(void);
+
+/* Called by the main loop when no event is waiting, sends a trace record, returns TRUE if it did */
+boolean Link_idle(void);
+
+#if (KERNEL_ENABLE == 1)
+/* Run the next message of the link task: a byte of the HMI or the result of an EEPROM job */
+void Link_run(void);
 
-/* Check the entered password against the stored one */
+/* Run the next job of the EEPROM task */
+void Eeprom_run(void);
+#endif
+
+/* Handle a byte received from the HMI (EVENT_UART_RX) */
+void Link_Handler(const SCHEDULER_EventType * event_ptr);
+
+/* Validate the two received passwords and store them */
+void Receiving_Passwords (void);
+
+/* Finish storing the password after the EEPROM write cycle (EVENT_EEPROM_READY) */
+void Eeprom_Handler(const SCHEDULER_EventType * event_ptr);
+
+/* Check the received password against the stored one */
 uint8 Checking_Password(uint8 command);
 
-/* Operate the door mechanism */
+/* Start the door mechanism */
 void Open_Door (void);
 
+/* Move the door to its next step (EVENT_DOOR_TIMER) */
+void Door_Handler(const SCHEDULER_EventType * event_ptr);
+
 /* Activate the alarm system */
 void Alarm (void);
 
-/* Timer callback function to count seconds */
-void Count_Seconds(void);
-
-/* Count a specified number of seconds using Timer1 */
-void Timer1_countSeconds(uint8 seconds);
+/* Stop the alarm when its time is over (EVENT_ALARM_TIMER) */
+void Alarm_Handler(const SCHEDULER_EventType * event_ptr);
 
 
 #endif /* SRC_CONTROL_FUNCTIONS_H_ */
@@ -9,6 +9,20 @@
 #include "gpio.h"
 #include "pwm.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * The two direction pins of the motor and their levels for each direction: both pins change in
+ * one atomic update of the port, so the bridge never sees a mixed state and ISRs can drive the
+ * other pins of the port
+ */
+#define MOTOR_MASK      (3 << MOTOR_PIN)
+#define MOTOR_OFF_BITS  0x00
+#define MOTOR_CW_BITS   (1 << (MOTOR_PIN + 1))
+#define MOTOR_CCW_BITS  (1 << MOTOR_PIN)
+
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
@@ -17,12 +31,10 @@
 void DcMotor_init(void)
 {
     /* Setup motor pins as output */
-    GPIO_setupPinDirection(MOTOR_PORT, MOTOR_PIN, PIN_OUTPUT);
-    GPIO_setupPinDirection(MOTOR_PORT, MOTOR_PIN + 1, PIN_OUTPUT);
+    GPIO_SETUP_PORT_DIRECTION_MASKED(MOTOR_PORT, MOTOR_MASK, 0xFF);
 
     /* Set initial state of motor pins to LOW motor off*/
-    GPIO_writePin(MOTOR_PORT, MOTOR_PIN, LOGIC_LOW);
-    GPIO_writePin(MOTOR_PORT, MOTOR_PIN + 1, LOGIC_LOW);
+    GPIO_WRITE_PORT_MASKED(MOTOR_PORT, MOTOR_MASK, MOTOR_OFF_BITS);
 }
 
 /* Function to rotate the DC motor based on the specified state and speed */
@@ -36,23 +48,20 @@ void DcMotor_rotate(DcMotor_State state, uint8 speed)
 			PWM_Timer0_Stop ();
 
 			/* Turn off the motor */
-			GPIO_writePin(MOTOR_PORT, MOTOR_PIN, LOGIC_LOW);
-			GPIO_writePin(MOTOR_PORT, MOTOR_PIN + 1, LOGIC_LOW);
+			GPIO_WRITE_PORT_MASKED(MOTOR_PORT, MOTOR_MASK, MOTOR_OFF_BITS);
 			break;
 		case MOTOR_CW:
 		    /* Start PWM signal generation with specified speed */
 		    PWM_Timer0_Start(speed);
 
 			/* Rotate the motor clockwise */
-			GPIO_writePin(MOTOR_PORT, MOTOR_PIN, LOGIC_LOW);
-			GPIO_writePin(MOTOR_PORT, MOTOR_PIN + 1, LOGIC_HIGH);
+			GPIO_WRITE_PORT_MASKED(MOTOR_PORT, MOTOR_MASK, MOTOR_CW_BITS);
 			break;
 		case MOTOR_CCW:
 		    /* Start PWM signal generation with specified speed */
 		    PWM_Timer0_Start(speed);
 
 			/* Rotate the motor counter-clockwise */
-			GPIO_writePin(MOTOR_PORT, MOTOR_PIN, LOGIC_HIGH);
-			GPIO_writePin(MOTOR_PORT, MOTOR_PIN + 1, LOGIC_LOW);
+			GPIO_WRITE_PORT_MASKED(MOTOR_PORT, MOTOR_MASK, MOTOR_CCW_BITS);
     }
 }
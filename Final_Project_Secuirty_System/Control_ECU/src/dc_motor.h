@@ -9,6 +9,7 @@
 #define DC_MOTOR_H_
 
 #include "std_types.h" /* Include standard types header file */
+#include "pwm.h"       /* The speed is a compare value from PWM_DUTY_CYCLE */
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -40,6 +41,7 @@ void DcMotor_init(void);
 /*
  * Description :
  * Function responsible for Rotating the DC motor.
+ * The speed is the compare value of the PWM, from PWM_DUTY_CYCLE.
  */
 void DcMotor_rotate(DcMotor_State state, uint8 speed); /* Rotate the DC motor */
 
@@ -5,10 +5,12 @@
  *      Author: abdalla
  */
 
-#ifndef GPIO_H_
-#define GPIO_H_
+#ifndef SRC_GPIO_H_
+#define SRC_GPIO_H_
 
 #include "std_types.h"
+#include <avr/io.h> 	/* To use the IO Ports Registers */
+#include <avr/interrupt.h> 	/* For cli */
 
 /*******************************************************************************
  *                                Definitions                                  *
@@ -30,6 +32,70 @@
 #define PIN6_ID                6
 #define PIN7_ID                7
 
+/*
+ * Registers of a port from its id. The PIN, DDR and PORT registers of the ports are three I/O
+ * addresses apart, from port A down to port D, so a constant id gives a constant address.
+ */
+#define GPIO_PORT_DISTANCE     3
+
+#define GPIO_PIN_REGISTER(port_num)     (*(&PINA - (GPIO_PORT_DISTANCE * (port_num))))
+#define GPIO_DDR_REGISTER(port_num)     (*(&DDRA - (GPIO_PORT_DISTANCE * (port_num))))
+#define GPIO_PORT_REGISTER(port_num)    (*(&PORTA - (GPIO_PORT_DISTANCE * (port_num))))
+
+/*
+ * Pin access for constant port and pin ids, the compile-time form of the pin functions below,
+ * with no call, port switch or range check. The ids are not checked: they come from the
+ * configuration of the drivers. Runtime ids need the functions.
+ * Optimized (the Release build, -Os) the register address and the bit mask fold to constants and
+ * each access is a single sbi, cbi or sbis/sbic instruction, which an interrupt cannot split.
+ * The Debug build (-O0) folds nothing: there a write is a read-modify-write of the register, so
+ * it is done with the interrupts masked like GPIO_UPDATE_REGISTER. In both builds a port also
+ * written by an ISR can use the pin macros.
+ */
+#ifdef __OPTIMIZE__
+#define GPIO_SETUP_PIN_DIRECTION(port_num, pin_num, direction) \
+	(((direction) == PIN_OUTPUT) ? \
+		(GPIO_DDR_REGISTER(port_num) |= (uint8)(1 << (pin_num))) : \
+		(GPIO_DDR_REGISTER(port_num) &= (uint8)~(1 << (pin_num))))
+
+#define GPIO_WRITE_PIN(port_num, pin_num, value) \
+	(((value) == LOGIC_HIGH) ? \
+		(GPIO_PORT_REGISTER(port_num) |= (uint8)(1 << (pin_num))) : \
+		(GPIO_PORT_REGISTER(port_num) &= (uint8)~(1 << (pin_num))))
+#else
+#define GPIO_SETUP_PIN_DIRECTION(port_num, pin_num, direction) \
+	GPIO_UPDATE_REGISTER(GPIO_DDR_REGISTER(port_num), (uint8)(1 << (pin_num)), \
+			(((direction) == PIN_OUTPUT) ? 0xFF : 0x00))
+
+#define GPIO_WRITE_PIN(port_num, pin_num, value) \
+	GPIO_UPDATE_REGISTER(GPIO_PORT_REGISTER(port_num), (uint8)(1 << (pin_num)), \
+			(((value) == LOGIC_HIGH) ? 0xFF : 0x00))
+#endif
+
+#define GPIO_READ_PIN(port_num, pin_num) \
+	((GPIO_PIN_REGISTER(port_num) & (1 << (pin_num))) ? LOGIC_HIGH : LOGIC_LOW)
+
+/*
+ * Masked update of a register, the pins of the mask take their bits from the value and the other
+ * pins keep theirs. The read-modify-write is atomic: the interrupts are masked for the load, the
+ * merge and the store only, so an ISR writing other pins of the same port never loses its update.
+ */
+#define GPIO_UPDATE_REGISTER(reg, mask, value) \
+	do \
+	{ \
+		uint8 gpio_sreg = SREG; \
+		cli(); \
+		(reg) = (uint8)(((reg) & (uint8)~(mask)) | ((value) & (mask))); \
+		SREG = gpio_sreg; \
+	} while (0)
+
+/* Atomic masked update of the outputs (or pull-ups) and of the directions, for constant port ids */
+#define GPIO_WRITE_PORT_MASKED(port_num, mask, value) \
+	GPIO_UPDATE_REGISTER(GPIO_PORT_REGISTER(port_num), mask, value)
+
+#define GPIO_SETUP_PORT_DIRECTION_MASKED(port_num, mask, direction) \
+	GPIO_UPDATE_REGISTER(GPIO_DDR_REGISTER(port_num), mask, direction)
+
 /*******************************************************************************
  *                               Types Declaration                             *
  *******************************************************************************/
@@ -51,6 +117,7 @@ typedef enum
  * Description :
  * Setup the direction of the required pin input/output.
  * If the input port number or pin number are not correct, The function will not handle the request.
+ * The direction register is updated atomically.
  */
 void GPIO_setupPinDirection(uint8 port_num, uint8 pin_num, GPIO_PinDirectionType direction);
 
@@ -59,6 +126,7 @@ void GPIO_setupPinDirection(uint8 port_num, uint8 pin_num, GPIO_PinDirectionType
  * Write the value Logic High or Logic Low on the required pin.
  * If the input port number or pin number are not correct, The function will not handle the request.
  * If the pin is input, this function will enable/disable the internal pull-up resistor.
+ * The port register is updated atomically.
  */
 void GPIO_writePin(uint8 port_num, uint8 pin_num, uint8 value);
 
@@ -94,4 +162,20 @@ void GPIO_writePort(uint8 port_num, uint8 value);
  */
 uint8 GPIO_readPort(uint8 port_num);
 
+/*
+ * Description :
+ * Setup the direction of the pins of the mask in one atomic update of the direction register:
+ * each pin of the mask is an output if its bit in direction is 1, the other pins are unchanged.
+ * If the input port number is not correct, The function will not handle the request.
+ */
+void GPIO_setupPortDirectionMasked(uint8 port_num, uint8 mask, uint8 direction);
+
+/*
+ * Description :
+ * Write the pins of the mask in one atomic update of the port register: each pin of the mask takes
+ * its bit of the value, the other pins are unchanged, even if an ISR writes them at the same time.
+ * If the input port number is not correct, The function will not handle the request.
+ */
+void GPIO_writePortMasked(uint8 port_num, uint8 mask, uint8 value);
+
 #endif /* SRC_GPIO_H_ */
@@ -13,20 +13,20 @@
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
-/* Initialize TWI (I2C) communication */
-void TWI_init(const TWI_ConfigType * Config_Ptr)
+/* Initialize TWI (I2C) communication at TWI_BIT_RATE, with the given address of this device */
+void TWI_init(TWI_Address address)
 {
-	/* Configure the Bit rate of this device in the bus by the user*/
-	TWBR = ((F_CPU/Config_Ptr->bit_rate * 2) - 8); /* This Equation for zero prescaler only */
+	/* Configure the Bit rate of this device in the bus, both values are computed at compile time */
+	TWBR = TWI_TWBR;
 
 	/* enable TWI */
 	TWCR |= (1<<TWEN);
 
-	/* Zero pre-scaler TWPS=00 */
-	TWSR = 0x00;
+	/* Pre-scaler TWPS of the bit rate */
+	TWSR = TWI_TWPS;
 
 	/* Configure the address of this device in the bus by the user*/
-	TWAR = (TWAR & 0x01)|((Config_Ptr->address & 0x7F) << 1);
+	TWAR = (TWAR & 0x01)|((address & 0x7F) << 1);
 }
 
 /* Transmit start condition */
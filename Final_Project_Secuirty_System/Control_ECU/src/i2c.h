@@ -18,31 +18,67 @@
 #define TWI_START         0x08 		/* Start condition transmitted */
 #define TWI_REP_START     0x10 		/* Repeated start condition transmitted */
 #define TWI_MT_SLA_W_ACK  0x18 		/* Master transmit (slave address + Write request) to slave, ACK received from slave */
+#define TWI_MT_SLA_W_NACK 0x20 		/* Master transmit (slave address + Write request) to slave, NACK received from slave */
 #define TWI_MT_SLA_R_ACK  0x40 		/* Master transmit (slave address + Read request) to slave, ACK received from slave */
+#define TWI_MT_SLA_R_NACK 0x48 		/* Master transmit (slave address + Read request) to slave, NACK received from slave */
 #define TWI_MT_DATA_ACK   0x28 		/* Master transmit data, ACK received from slave */
+#define TWI_MT_DATA_NACK  0x30 		/* Master transmit data, NACK received from slave */
 #define TWI_MR_DATA_ACK   0x50 		/* Master received data, ACK sent to slave */
 #define TWI_MR_DATA_NACK  0x58 		/* Master received data, NACK sent to slave */
 
+/* TWI bit rates in Hz, defines so that the preprocessor can check them */
+#define NORMAL_MODE       100000UL 	/* 100 kHz */
+#define FAST_MODE         400000UL 	/* 400 kHz */
+#define FAST_MODE_PLUS    1000000UL 	/* 1 MHz */
+#define HIGH_SPEED_MODE   3400000UL 	/* 3.4 MHz */
+
+/* Bit rate of the bus, fixed at compile time */
+#define TWI_BIT_RATE      NORMAL_MODE
+
+/*
+ * SCL frequency = F_CPU / (16 + 2 * TWBR * 4^TWPS). The preprocessor takes the smallest prescaler
+ * with TWBR in 8 bits, and rounds TWBR up so the bus never runs faster than TWI_BIT_RATE.
+ */
+#define TWI_CYCLES_PER_BIT            (((F_CPU) + (TWI_BIT_RATE) - 1UL) / (TWI_BIT_RATE))
+#define TWI_TWBR_FOR(prescaler)       ((TWI_CYCLES_PER_BIT - 16UL + (2UL * (prescaler)) - 1UL) / (2UL * (prescaler)))
+
+#if (TWI_CYCLES_PER_BIT <= 16)
+
+#error "TWI_BIT_RATE is too high for F_CPU"
+
+#elif (TWI_TWBR_FOR(1UL) <= 255)
+#define TWI_TWPS          0
+#define TWI_PRESCALER     1UL
+#elif (TWI_TWBR_FOR(4UL) <= 255)
+#define TWI_TWPS          1
+#define TWI_PRESCALER     4UL
+#elif (TWI_TWBR_FOR(16UL) <= 255)
+#define TWI_TWPS          2
+#define TWI_PRESCALER     16UL
+#elif (TWI_TWBR_FOR(64UL) <= 255)
+#define TWI_TWPS          3
+#define TWI_PRESCALER     64UL
+#else
+
+#error "TWI_BIT_RATE is too low for F_CPU"
+
+#endif
+
+#define TWI_TWBR          TWI_TWBR_FOR(TWI_PRESCALER)
+
+/* In master mode TWBR should be 10 or more, below that SCL and SDA may be wrong (datasheet) */
+#if (defined(TWI_PRESCALER) && (TWI_TWBR < 10))
+
+#error "TWI_BIT_RATE is too high for F_CPU, TWBR would be below 10"
+
+#endif
+
 /*******************************************************************************
  *                       Types Declaration                                     *
  *******************************************************************************/
 
 typedef uint8 TWI_Address;
 
-/* Enum defining TWI BIT Rates Modes */
-typedef enum {
-    NORMAL_MODE     = 100000UL,   	/* 100 kHz */
-    FAST_MODE       = 400000UL,   	/* 400 kHz */
-    FAST_MODE_PLUS  = 1000000UL,  	/* 1 MHz */
-    HIGH_SPEED_MODE = 3400000UL   	/* 3.4 MHz */
-} TWI_BaudRate;
-
-/* Structure defining TWI Configuration */
-typedef struct {
-    TWI_BaudRate bit_rate; 			/* Bit rate for TWI communication */
-    TWI_Address address; 			/* Address of the TWI slave device */
-} TWI_ConfigType;
-
 /* Enum defining TWI operation with slave */
 typedef enum {
     WRITE,  						/* Write operation for TWI communication */
@@ -53,8 +89,8 @@ typedef enum {
  *                      Functions Prototypes                                   *
  *******************************************************************************/
 
-/* Initialize TWI (I2C) communication */
-void TWI_init(const TWI_ConfigType * Config_Ptr);
+/* Initialize TWI (I2C) communication at TWI_BIT_RATE, with the given address of this device */
+void TWI_init(TWI_Address address);
 
 /* Transmit start condition */
 void TWI_start(void);
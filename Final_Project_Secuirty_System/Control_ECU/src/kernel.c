@@ -0,0 +1,683 @@
+/*
+ * kernel.c
+ *	Description: Source file for the optional preemptive kernel
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "kernel.h"
+
+#if (KERNEL_ENABLE == 1)
+
+#include "timer1.h"
+#include <string.h>  		/* For memcpy and memset */
+#include <avr/io.h> 		/* To use the SREG Register */
+#include <avr/interrupt.h> 	/* For cli() */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/*
+ * Running task, read by the context switch. It is not static because the assembly code
+ * of the context switch uses its name.
+ */
+KERNEL_TaskType * volatile g_kernelCurrentTask = NULL_PTR;
+
+/* Task of each priority and one bit for each ready task */
+static KERNEL_TaskType * g_tasks[KERNEL_MAX_TASKS];
+static volatile uint8 g_readyMask = 0;
+
+/* Ticks since start and the Timer1 timestamp of the last tick */
+static volatile uint32 g_ticks = 0;
+static volatile uint32 g_tickTimestamp = 0;
+
+/* Idle task and its stack */
+static KERNEL_TaskType g_idleTask;
+static uint8 g_idleStack[KERNEL_IDLE_STACK_SIZE];
+
+/* Context of main() saved by the first switch, it is never resumed */
+static KERNEL_TaskType g_mainContext;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/*
+ * Save the full context of the running task on its stack, select the highest priority ready
+ * task and restore its context. It can be called from a task or from an ISR.
+ */
+void KERNEL_switchContext(void) __attribute__((naked, noinline));
+
+/* Select the highest priority ready task, called by the context switch only */
+void KERNEL_selectTask(void) __attribute__((used));
+
+/* Kernel tick, Timer1 compare B callback */
+static void KERNEL_tick(void);
+
+/* Switch to the highest priority ready task if it is not the running one (interrupts disabled) */
+static void KERNEL_preempt(void);
+
+/* Block the running task on a waiting mask for up to timeout ticks (interrupts disabled) */
+static boolean KERNEL_block(uint8 * wait_list, uint16 timeout);
+
+/* Make the highest priority task of a waiting mask ready (interrupts disabled) */
+static void KERNEL_wake(uint8 * wait_list);
+
+/* Return the priority of the highest priority task in a mask, the mask must not be zero */
+static uint8 KERNEL_highestPriority(uint8 mask);
+
+/* Idle task, runs when no other task is ready */
+static void KERNEL_idleTask(void);
+
+/* Wait up to timeout ticks for a message in the queue (interrupts disabled) */
+static boolean KERNEL_queueWait(KERNEL_QueueType * queue_ptr, uint16 timeout);
+
+/* Send a string through the output function */
+static void KERNEL_sendString(void (*send_byte)(const uint8 data), const char * str);
+
+/* Send an unsigned number in decimal through the output function */
+static void KERNEL_sendNumber(void (*send_byte)(const uint8 data), uint16 number);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Clear the task table and create the idle task.
+ */
+void KERNEL_init(void)
+{
+	uint8 priority;
+
+	for (priority = 0; priority < KERNEL_MAX_TASKS; priority++)
+	{
+		g_tasks[priority] = NULL_PTR;
+	}
+	g_readyMask = 0;
+	g_ticks = 0;
+
+	KERNEL_createTask(&g_idleTask, KERNEL_idleTask, g_idleStack, KERNEL_IDLE_STACK_SIZE, KERNEL_IDLE_PRIORITY);
+}
+
+/*
+ * Description :
+ * Create a task that starts at entry when the kernel is started. The entry function must never return.
+ * returns: TRUE if created, FALSE if the priority is used or invalid or the stack is too small.
+ */
+boolean KERNEL_createTask(KERNEL_TaskType * task_ptr, void (*entry)(void), uint8 * stack, uint16 stack_size, uint8 priority)
+{
+	uint8 * sp;
+	uint8 reg;
+	uint8 sreg;
+
+	if ((priority >= KERNEL_MAX_TASKS) || (g_tasks[priority] != NULL_PTR) || (stack_size < KERNEL_MIN_STACK_SIZE))
+	{
+		return FALSE;
+	}
+
+	/* Paint the stack to find its used part later */
+	memset(stack, KERNEL_STACK_FILL, stack_size);
+
+	/*
+	 * Build the frame the context switch restores, from the top of the stack downwards:
+	 * return address (low byte first), r0, SREG with the interrupts enabled, r1 = 0, r2 to r31.
+	 * The AVR stack pointer points to the first free byte below the frame.
+	 */
+	sp = &stack[stack_size - 1];
+	*sp-- = (uint8)((uint16)entry);
+	*sp-- = (uint8)((uint16)entry >> 8);
+	*sp-- = 0;
+	*sp-- = (1 << 7);
+	for (reg = 1; reg < 32; reg++)
+	{
+		*sp-- = 0;
+	}
+
+	task_ptr->sp = sp;
+	task_ptr->stack = stack;
+	task_ptr->stack_size = stack_size;
+	task_ptr->delay = 0;
+	task_ptr->wait_list = NULL_PTR;
+	task_ptr->priority = priority;
+	task_ptr->wait_result = FALSE;
+
+	sreg = SREG;
+	cli();
+	g_tasks[priority] = task_ptr;
+	g_readyMask |= (1 << priority);
+	SREG = sreg;
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Take the compare B channel of Timer1 for the kernel tick and run the highest priority task.
+ * Timer1 must be initialized before. This function never returns.
+ */
+void KERNEL_start(void)
+{
+	cli();
+
+	TIMER1_allocateChannel(TIMER1_CHANNEL_B, KERNEL_tick);
+	TIMER1_setCompare(TIMER1_CHANNEL_B, TIMER1_getCount() + KERNEL_TICK_COUNTS);
+
+	/* The context of main() is saved in a task that is never selected again */
+	g_kernelCurrentTask = &g_mainContext;
+	KERNEL_switchContext();
+
+	/* Not reached */
+	while (1);
+}
+
+/*
+ * Description :
+ * Block the calling task for the required number of ticks (milliseconds).
+ */
+void KERNEL_delay(uint16 ticks)
+{
+	uint8 sreg = SREG;
+	cli();
+
+	if (ticks != 0)
+	{
+		KERNEL_block(NULL_PTR, ticks);
+	}
+
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Return the number of ticks since the kernel was started.
+ */
+uint32 KERNEL_getTicks(void)
+{
+	uint32 ticks;
+	uint8 sreg = SREG;
+	cli();
+	ticks = g_ticks;
+	SREG = sreg;
+
+	return ticks;
+}
+
+/*
+ * Description :
+ * Return the Timer1 timestamp of the last tick, to measure the time until a task runs after it.
+ */
+uint32 KERNEL_getTickTimestamp(void)
+{
+	uint32 timestamp;
+	uint8 sreg = SREG;
+	cli();
+	timestamp = g_tickTimestamp;
+	SREG = sreg;
+
+	return timestamp;
+}
+
+/*
+ * Description :
+ * Return the number of stack bytes of a task that were never used.
+ */
+uint16 KERNEL_getStackUnused(const KERNEL_TaskType * task_ptr)
+{
+	uint16 unused = 0;
+
+	/* The stack grows down, the painted bytes left at the bottom were never written */
+	while ((unused < task_ptr->stack_size) && (task_ptr->stack[unused] == KERNEL_STACK_FILL))
+	{
+		unused++;
+	}
+	return unused;
+}
+
+/*
+ * Description :
+ * Write one text line per task with the stack use, each byte is given to the send_byte function.
+ * "TASK <priority> stack=<bytes> unused=<bytes>\r\n"
+ */
+void KERNEL_dump(void (*send_byte)(const uint8 data))
+{
+	uint8 priority;
+
+	for (priority = 0; priority < KERNEL_MAX_TASKS; priority++)
+	{
+		if (g_tasks[priority] == NULL_PTR)
+		{
+			continue;
+		}
+		KERNEL_sendString(send_byte, "TASK ");
+		KERNEL_sendNumber(send_byte, priority);
+		KERNEL_sendString(send_byte, " stack=");
+		KERNEL_sendNumber(send_byte, g_tasks[priority]->stack_size);
+		KERNEL_sendString(send_byte, " unused=");
+		KERNEL_sendNumber(send_byte, KERNEL_getStackUnused(g_tasks[priority]));
+		KERNEL_sendString(send_byte, "\r\n");
+	}
+}
+
+/*
+ * Description :
+ * Set the initial number of tokens of a semaphore.
+ */
+void KERNEL_semaphoreInit(KERNEL_SemaphoreType * sem_ptr, uint8 count)
+{
+	sem_ptr->count = count;
+	sem_ptr->waiting = 0;
+}
+
+/*
+ * Description :
+ * Take a token, waiting up to timeout ticks (0 does not wait, KERNEL_WAIT_FOREVER has no limit).
+ * returns: TRUE if a token is taken, FALSE on timeout.
+ */
+boolean KERNEL_semaphoreTake(KERNEL_SemaphoreType * sem_ptr, uint16 timeout)
+{
+	boolean taken = FALSE;
+	uint8 sreg = SREG;
+	cli();
+
+	if (sem_ptr->count != 0)
+	{
+		sem_ptr->count--;
+		taken = TRUE;
+	}
+	else if (timeout != 0)
+	{
+		/* The giver hands the token over directly to the woken task */
+		taken = KERNEL_block(&sem_ptr->waiting, timeout);
+	}
+
+	SREG = sreg;
+	return taken;
+}
+
+/*
+ * Description :
+ * Give a token, the highest priority waiting task takes it. It is safe to call from ISRs,
+ * then it should be the last thing the ISR does because a switch to the woken task may happen.
+ */
+void KERNEL_semaphoreGive(KERNEL_SemaphoreType * sem_ptr)
+{
+	uint8 sreg = SREG;
+	cli();
+
+	if (sem_ptr->waiting != 0)
+	{
+		KERNEL_wake(&sem_ptr->waiting);
+		KERNEL_preempt();
+	}
+	else if (sem_ptr->count != 0xFF)
+	{
+		sem_ptr->count++;
+	}
+
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Set the storage of a queue, the buffer must hold length * item_size bytes.
+ */
+void KERNEL_queueInit(KERNEL_QueueType * queue_ptr, uint8 * buffer, uint8 item_size, uint8 length)
+{
+	queue_ptr->buffer = buffer;
+	queue_ptr->item_size = item_size;
+	queue_ptr->length = length;
+	queue_ptr->head = 0;
+	queue_ptr->count = 0;
+	queue_ptr->receivers = 0;
+	queue_ptr->senders = 0;
+}
+
+/*
+ * Description :
+ * Copy a message at the end of the queue, waiting up to timeout ticks for a free place.
+ * From ISRs it must be called with a zero timeout, and last, like KERNEL_semaphoreGive.
+ * returns: TRUE if the message is queued, FALSE on timeout.
+ */
+boolean KERNEL_queueSend(KERNEL_QueueType * queue_ptr, const void * item_ptr, uint16 timeout)
+{
+	uint8 tail;
+	uint8 sreg = SREG;
+	cli();
+
+	/* A woken sender checks again, another task may have taken the place first */
+	while (queue_ptr->count == queue_ptr->length)
+	{
+		if ((timeout == 0) || !KERNEL_block(&queue_ptr->senders, timeout))
+		{
+			SREG = sreg;
+			return FALSE;
+		}
+	}
+
+	tail = queue_ptr->head + queue_ptr->count;
+	if (tail >= queue_ptr->length)
+	{
+		tail -= queue_ptr->length;
+	}
+	memcpy(&queue_ptr->buffer[tail * queue_ptr->item_size], item_ptr, queue_ptr->item_size);
+	queue_ptr->count++;
+
+	if (queue_ptr->receivers != 0)
+	{
+		KERNEL_wake(&queue_ptr->receivers);
+		KERNEL_preempt();
+	}
+
+	SREG = sreg;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Copy the oldest message out of the queue, waiting up to timeout ticks for a message.
+ * returns: TRUE if a message is received, FALSE on timeout.
+ */
+boolean KERNEL_queueReceive(KERNEL_QueueType * queue_ptr, void * item_ptr, uint16 timeout)
+{
+	uint8 sreg = SREG;
+	cli();
+
+	if (!KERNEL_queueWait(queue_ptr, timeout))
+	{
+		SREG = sreg;
+		return FALSE;
+	}
+
+	memcpy(item_ptr, &queue_ptr->buffer[queue_ptr->head * queue_ptr->item_size], queue_ptr->item_size);
+	queue_ptr->head++;
+	if (queue_ptr->head == queue_ptr->length)
+	{
+		queue_ptr->head = 0;
+	}
+	queue_ptr->count--;
+
+	if (queue_ptr->senders != 0)
+	{
+		KERNEL_wake(&queue_ptr->senders);
+		KERNEL_preempt();
+	}
+
+	SREG = sreg;
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Copy the oldest message without taking it out of the queue, waiting up to timeout ticks for
+ * a message. A sent message wakes one waiting task, so one task only may wait on a queue.
+ * returns: TRUE if a message is copied, FALSE on timeout.
+ */
+boolean KERNEL_queuePeek(KERNEL_QueueType * queue_ptr, void * item_ptr, uint16 timeout)
+{
+	boolean found;
+	uint8 sreg = SREG;
+	cli();
+
+	found = KERNEL_queueWait(queue_ptr, timeout);
+	if (found)
+	{
+		memcpy(item_ptr, &queue_ptr->buffer[queue_ptr->head * queue_ptr->item_size], queue_ptr->item_size);
+	}
+
+	SREG = sreg;
+	return found;
+}
+
+/*
+ * Save the full context of the running task on its stack, select the highest priority ready
+ * task and restore its context. It can be called from a task or from an ISR.
+ * The frame is: return address (pushed by the call), r0, SREG, r1 to r31.
+ */
+void KERNEL_switchContext(void)
+{
+	__asm__ __volatile__ (
+		"push r0                        \n\t"
+		"in   r0, __SREG__              \n\t"
+		"cli                            \n\t"
+		"push r0                        \n\t"
+		"push r1                        \n\t"
+		"clr  r1                        \n\t"
+		"push r2                        \n\t"
+		"push r3                        \n\t"
+		"push r4                        \n\t"
+		"push r5                        \n\t"
+		"push r6                        \n\t"
+		"push r7                        \n\t"
+		"push r8                        \n\t"
+		"push r9                        \n\t"
+		"push r10                       \n\t"
+		"push r11                       \n\t"
+		"push r12                       \n\t"
+		"push r13                       \n\t"
+		"push r14                       \n\t"
+		"push r15                       \n\t"
+		"push r16                       \n\t"
+		"push r17                       \n\t"
+		"push r18                       \n\t"
+		"push r19                       \n\t"
+		"push r20                       \n\t"
+		"push r21                       \n\t"
+		"push r22                       \n\t"
+		"push r23                       \n\t"
+		"push r24                       \n\t"
+		"push r25                       \n\t"
+		"push r26                       \n\t"
+		"push r27                       \n\t"
+		"push r28                       \n\t"
+		"push r29                       \n\t"
+		"push r30                       \n\t"
+		"push r31                       \n\t"
+
+		/* g_kernelCurrentTask->sp = SP */
+		"lds  r26, g_kernelCurrentTask  \n\t"
+		"lds  r27, g_kernelCurrentTask+1\n\t"
+		"in   r0, __SP_L__              \n\t"
+		"st   x+, r0                    \n\t"
+		"in   r0, __SP_H__              \n\t"
+		"st   x+, r0                    \n\t"
+
+		"call KERNEL_selectTask         \n\t"
+
+		/* SP = g_kernelCurrentTask->sp */
+		"lds  r26, g_kernelCurrentTask  \n\t"
+		"lds  r27, g_kernelCurrentTask+1\n\t"
+		"ld   r28, x+                   \n\t"
+		"out  __SP_L__, r28             \n\t"
+		"ld   r29, x+                   \n\t"
+		"out  __SP_H__, r29             \n\t"
+
+		"pop  r31                       \n\t"
+		"pop  r30                       \n\t"
+		"pop  r29                       \n\t"
+		"pop  r28                       \n\t"
+		"pop  r27                       \n\t"
+		"pop  r26                       \n\t"
+		"pop  r25                       \n\t"
+		"pop  r24                       \n\t"
+		"pop  r23                       \n\t"
+		"pop  r22                       \n\t"
+		"pop  r21                       \n\t"
+		"pop  r20                       \n\t"
+		"pop  r19                       \n\t"
+		"pop  r18                       \n\t"
+		"pop  r17                       \n\t"
+		"pop  r16                       \n\t"
+		"pop  r15                       \n\t"
+		"pop  r14                       \n\t"
+		"pop  r13                       \n\t"
+		"pop  r12                       \n\t"
+		"pop  r11                       \n\t"
+		"pop  r10                       \n\t"
+		"pop  r9                        \n\t"
+		"pop  r8                        \n\t"
+		"pop  r7                        \n\t"
+		"pop  r6                        \n\t"
+		"pop  r5                        \n\t"
+		"pop  r4                        \n\t"
+		"pop  r3                        \n\t"
+		"pop  r2                        \n\t"
+		"pop  r1                        \n\t"
+		"pop  r0                        \n\t"
+		"out  __SREG__, r0              \n\t"
+		"pop  r0                        \n\t"
+		"ret                            \n\t"
+	);
+}
+
+/* Select the highest priority ready task, called by the context switch only */
+void KERNEL_selectTask(void)
+{
+	g_kernelCurrentTask = g_tasks[KERNEL_highestPriority(g_readyMask)];
+}
+
+/* Kernel tick, Timer1 compare B callback */
+static void KERNEL_tick(void)
+{
+	uint8 priority;
+	KERNEL_TaskType * task_ptr;
+
+	/* Schedule the next tick relative to this one so the tick never drifts */
+	TIMER1_advanceCompare(TIMER1_CHANNEL_B, KERNEL_TICK_COUNTS);
+	g_tickTimestamp = TIMER1_getTimestamp();
+	g_ticks++;
+
+	/* Count down the timeouts of the blocked tasks */
+	for (priority = 0; priority < KERNEL_IDLE_PRIORITY; priority++)
+	{
+		task_ptr = g_tasks[priority];
+		if ((task_ptr == NULL_PTR) || (g_readyMask & (1 << priority)) ||
+			(task_ptr->delay == 0) || (task_ptr->delay == KERNEL_WAIT_FOREVER))
+		{
+			continue;
+		}
+
+		task_ptr->delay--;
+		if (task_ptr->delay == 0)
+		{
+			/* Timed out, leave the waiting mask of the object */
+			if (task_ptr->wait_list != NULL_PTR)
+			{
+				*task_ptr->wait_list &= ~(1 << priority);
+				task_ptr->wait_list = NULL_PTR;
+			}
+			task_ptr->wait_result = FALSE;
+			g_readyMask |= (1 << priority);
+		}
+	}
+
+	KERNEL_preempt();
+}
+
+/* Switch to the highest priority ready task if it is not the running one (interrupts disabled) */
+static void KERNEL_preempt(void)
+{
+	if (KERNEL_highestPriority(g_readyMask) != g_kernelCurrentTask->priority)
+	{
+		KERNEL_switchContext();
+	}
+}
+
+/* Block the running task on a waiting mask for up to timeout ticks (interrupts disabled) */
+static boolean KERNEL_block(uint8 * wait_list, uint16 timeout)
+{
+	KERNEL_TaskType * task_ptr = g_kernelCurrentTask;
+	uint8 bit = (1 << task_ptr->priority);
+
+	task_ptr->wait_list = wait_list;
+	task_ptr->wait_result = FALSE;
+	task_ptr->delay = timeout;
+	if (wait_list != NULL_PTR)
+	{
+		*wait_list |= bit;
+	}
+	g_readyMask &= ~bit;
+
+	/* Returns when the task is woken or timed out and selected again */
+	KERNEL_switchContext();
+
+	return task_ptr->wait_result;
+}
+
+/* Make the highest priority task of a waiting mask ready (interrupts disabled) */
+static void KERNEL_wake(uint8 * wait_list)
+{
+	uint8 priority = KERNEL_highestPriority(*wait_list);
+	KERNEL_TaskType * task_ptr = g_tasks[priority];
+
+	*wait_list &= ~(1 << priority);
+	task_ptr->wait_list = NULL_PTR;
+	task_ptr->wait_result = TRUE;
+	task_ptr->delay = 0;
+	g_readyMask |= (1 << priority);
+}
+
+/* Return the priority of the highest priority task in a mask, the mask must not be zero */
+static uint8 KERNEL_highestPriority(uint8 mask)
+{
+	uint8 priority = 0;
+
+	while (!(mask & 0x01))
+	{
+		mask >>= 1;
+		priority++;
+	}
+	return priority;
+}
+
+/* Idle task, runs when no other task is ready */
+static void KERNEL_idleTask(void)
+{
+	while (1);
+}
+
+/* Wait up to timeout ticks for a message in the queue (interrupts disabled) */
+static boolean KERNEL_queueWait(KERNEL_QueueType * queue_ptr, uint16 timeout)
+{
+	/* A woken receiver checks again, another task may have taken the message first */
+	while (queue_ptr->count == 0)
+	{
+		if ((timeout == 0) || !KERNEL_block(&queue_ptr->receivers, timeout))
+		{
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/* Send a string through the output function */
+static void KERNEL_sendString(void (*send_byte)(const uint8 data), const char * str)
+{
+	while (*str != '\0')
+	{
+		(*send_byte)(*str);
+		str++;
+	}
+}
+
+/* Send an unsigned number in decimal through the output function */
+static void KERNEL_sendNumber(void (*send_byte)(const uint8 data), uint16 number)
+{
+	/* A 16-bit number has at most 5 decimal digits, they are found from the lowest one */
+	uint8 digits[5];
+	uint8 i = 0;
+
+	do
+	{
+		digits[i++] = '0' + (number % 10);
+		number /= 10;
+	} while (number != 0);
+
+	while (i > 0)
+	{
+		(*send_byte)(digits[--i]);
+	}
+}
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ * kernel.h
+ *	Description: Header file for the optional preemptive kernel
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * Small fixed-priority preemptive kernel for the ATmega32:
+ *  - Every task has its own priority (0 is the highest) and a stack given by the application.
+ *  - The compare B channel of Timer1 gives the 1 ms kernel tick used for delays and timeouts.
+ *  - The highest priority ready task always runs. A task gives the CPU away only by waiting
+ *    (delay, semaphore, queue) or when a higher priority task becomes ready in a tick or an ISR.
+ *  - The idle task of the kernel takes the lowest priority.
+ *  - Message queues carry fixed size messages between tasks, and from ISRs to tasks.
+ *
+ * RAM cost of a task = sizeof(KERNEL_TaskType) (12 bytes) + its stack. The saved context alone
+ * takes KERNEL_CONTEXT_SIZE bytes of the stack and an interrupt adds its own frame on top.
+ * RAM cost of a queue = sizeof(KERNEL_QueueType) (8 bytes) + length * item size.
+ *
+ * Context switch: 168 cycles (21 us at 8 MHz) in KERNEL_switchContext, counted from the cycles
+ * of its instructions in the datasheet, plus KERNEL_selectTask. The time from the system tick
+ * until a task runs is measured on the target by the KERNEL_WAKE region of the profiler, and the
+ * stack left to each task by KERNEL_dump.
+ *
+ * The kernel is compiled out unless KERNEL_ENABLE is set to 1.
+ */
+
+#ifndef KERNEL_H_
+#define KERNEL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Kernel configuration, its value should be 0 (disabled) or 1 (enabled) */
+#define KERNEL_ENABLE               0
+
+#if((KERNEL_ENABLE != 0) && (KERNEL_ENABLE != 1))
+
+#error "KERNEL_ENABLE should be equal to 0 or 1"
+
+#endif
+
+/* Number of priorities including the idle task, one task per priority (8 at most) */
+#define KERNEL_MAX_TASKS            5
+
+#if((KERNEL_MAX_TASKS < 2) || (KERNEL_MAX_TASKS > 8))
+
+#error "Number of kernel tasks should be between 2 and 8"
+
+#endif
+
+/*
+ * Kernel tick calculation for one millisecond
+ * Timer1 must run from F_CPU / 8 = 1 MHz
+ * compare B moves forward 1000 timer ticks each time = 1 milli sec
+ */
+#define KERNEL_TICK_COUNTS          1000
+
+/* Bytes pushed by a context switch: return address, r0, SREG and r1 to r31 */
+#define KERNEL_CONTEXT_SIZE         35
+
+/*
+ * Stack an interrupt takes on top of the running task, with a context switch from the ISR. The
+ * interrupts do not nest, one chain is on a stack at a time. Estimated from the frames of the -O0
+ * build (an ISR that calls a function saves 17 bytes, a function about 4 bytes and its arguments
+ * and locals), the deepest chains are:
+ *  - USART RXC: ISR 20, receive callback 8, KERNEL_queueSend 14, KERNEL_preempt 6, switch 37: 85
+ *  - Timer1 COMPA: ISR 19, system tick 16, ready callback 4, KERNEL_semaphoreGive 7,
+ *    KERNEL_preempt 6, switch 37: 89
+ *  - Timer1 COMPB: ISR 19, kernel tick 10, KERNEL_preempt 6, switch 37: 72
+ *  - Timer2 COMP (software UART) and INT2: no switch, less than 40
+ * The size adds 8 bytes to the deepest one. KERNEL_dump gives what the stacks really used.
+ */
+#define KERNEL_ISR_STACK_SIZE       96
+
+/* Smallest useful stack: the interrupt chain and the switch of a task that blocks */
+#define KERNEL_MIN_STACK_SIZE       (KERNEL_ISR_STACK_SIZE + 16)
+
+/* Stack of the idle task, it calls nothing: only the interrupts use it */
+#define KERNEL_IDLE_STACK_SIZE      KERNEL_MIN_STACK_SIZE
+
+/* Priority of the idle task */
+#define KERNEL_IDLE_PRIORITY        (KERNEL_MAX_TASKS - 1)
+
+/* Timeout value to wait without limit */
+#define KERNEL_WAIT_FOREVER         0xFFFF
+
+/* Value written in the whole stack when a task is created, to measure the used part */
+#define KERNEL_STACK_FILL           0xA5
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Structure of a task, the application owns the storage */
+typedef struct
+{
+	uint8 * sp;                 /* Saved stack pointer, must stay the first member */
+	uint8 * stack;              /* Lowest address of the stack */
+	uint16 stack_size;          /* Size of the stack in bytes */
+	uint16 delay;               /* Ticks left before the wait times out */
+	uint8 * wait_list;          /* Waiting mask of the object the task waits for */
+	uint8 priority;             /* Task priority, 0 is the highest */
+	boolean wait_result;        /* TRUE if the wait ended because the object was given */
+}KERNEL_TaskType;
+
+/* Structure of a counting semaphore */
+typedef struct
+{
+	uint8 count;                /* Number of available tokens */
+	uint8 waiting;              /* One bit for each waiting task priority */
+}KERNEL_SemaphoreType;
+
+/* Structure of a message queue of fixed size items */
+typedef struct
+{
+	uint8 * buffer;             /* Storage of length * item_size bytes */
+	uint8 item_size;            /* Size of one message in bytes */
+	uint8 length;               /* Number of messages the buffer can hold */
+	uint8 head;                 /* Index of the oldest message */
+	uint8 count;                /* Number of messages in the queue */
+	uint8 receivers;            /* Tasks waiting for a message */
+	uint8 senders;              /* Tasks waiting for a free place */
+}KERNEL_QueueType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+#if (KERNEL_ENABLE == 1)
+
+/*
+ * Description :
+ * Clear the task table and create the idle task.
+ */
+void KERNEL_init(void);
+
+/*
+ * Description :
+ * Create a task that starts at entry when the kernel is started. The entry function must never return.
+ * returns: TRUE if created, FALSE if the priority is used or invalid or the stack is too small.
+ */
+boolean KERNEL_createTask(KERNEL_TaskType * task_ptr, void (*entry)(void), uint8 * stack, uint16 stack_size, uint8 priority);
+
+/*
+ * Description :
+ * Take the compare B channel of Timer1 for the kernel tick and run the highest priority task.
+ * Timer1 must be initialized before. This function never returns.
+ */
+void KERNEL_start(void);
+
+/*
+ * Description :
+ * Block the calling task for the required number of ticks (milliseconds).
+ */
+void KERNEL_delay(uint16 ticks);
+
+/*
+ * Description :
+ * Return the number of ticks since the kernel was started.
+ */
+uint32 KERNEL_getTicks(void);
+
+/*
+ * Description :
+ * Return the Timer1 timestamp of the last tick, to measure the time until a task runs after it.
+ */
+uint32 KERNEL_getTickTimestamp(void);
+
+/*
+ * Description :
+ * Return the number of stack bytes of a task that were never used.
+ */
+uint16 KERNEL_getStackUnused(const KERNEL_TaskType * task_ptr);
+
+/*
+ * Description :
+ * Write one text line per task with the stack use, each byte is given to the send_byte function.
+ * "TASK <priority> stack=<bytes> unused=<bytes>\r\n"
+ */
+void KERNEL_dump(void (*send_byte)(const uint8 data));
+
+/*
+ * Description :
+ * Set the initial number of tokens of a semaphore.
+ */
+void KERNEL_semaphoreInit(KERNEL_SemaphoreType * sem_ptr, uint8 count);
+
+/*
+ * Description :
+ * Take a token, waiting up to timeout ticks (0 does not wait, KERNEL_WAIT_FOREVER has no limit).
+ * returns: TRUE if a token is taken, FALSE on timeout.
+ */
+boolean KERNEL_semaphoreTake(KERNEL_SemaphoreType * sem_ptr, uint16 timeout);
+
+/*
+ * Description :
+ * Give a token, the highest priority waiting task takes it. It is safe to call from ISRs,
+ * then it should be the last thing the ISR does because a switch to the woken task may happen.
+ */
+void KERNEL_semaphoreGive(KERNEL_SemaphoreType * sem_ptr);
+
+/*
+ * Description :
+ * Set the storage of a queue, the buffer must hold length * item_size bytes.
+ */
+void KERNEL_queueInit(KERNEL_QueueType * queue_ptr, uint8 * buffer, uint8 item_size, uint8 length);
+
+/*
+ * Description :
+ * Copy a message at the end of the queue, waiting up to timeout ticks for a free place.
+ * From ISRs it must be called with a zero timeout, and last, like KERNEL_semaphoreGive.
+ * returns: TRUE if the message is queued, FALSE on timeout.
+ */
+boolean KERNEL_queueSend(KERNEL_QueueType * queue_ptr, const void * item_ptr, uint16 timeout);
+
+/*
+ * Description :
+ * Copy the oldest message out of the queue, waiting up to timeout ticks for a message.
+ * returns: TRUE if a message is received, FALSE on timeout.
+ */
+boolean KERNEL_queueReceive(KERNEL_QueueType * queue_ptr, void * item_ptr, uint16 timeout);
+
+/*
+ * Description :
+ * Copy the oldest message without taking it out of the queue, waiting up to timeout ticks for
+ * a message. A sent message wakes one waiting task, so one task only may wait on a queue.
+ * returns: TRUE if a message is copied, FALSE on timeout.
+ */
+boolean KERNEL_queuePeek(KERNEL_QueueType * queue_ptr, void * item_ptr, uint16 timeout);
+
+#endif
+
+#endif /* KERNEL_H_ */
@@ -15,22 +15,15 @@
 /*
  * Description :
  * Function responsible To start the pwm signal using timer0 compare mode
+ * The compare value comes from PWM_DUTY_CYCLE, 255 keeps the output high.
  */
-void PWM_Timer0_Start(uint8 duty_cycle)
+void PWM_Timer0_Start(uint8 compare_value)
 {
-	GPIO_setupPinDirection(PORTB_ID, PIN3_ID,PIN_OUTPUT);
+	GPIO_SETUP_PIN_DIRECTION(PORTB_ID, PIN3_ID, PIN_OUTPUT);
 
 	TCNT0 = 0; /* Set Timer Initial value */
 
-	if (duty_cycle > 100)
-	{
-		duty_cycle = 100;
-	}
-	else if (duty_cycle < 0)
-	{
-		duty_cycle = 0;
-	}
-	OCR0  = (uint8)(((float)(duty_cycle)/(100)) * 255); /* Set Compare Value */
+	OCR0  = compare_value; /* Set Compare Value */
 
 	/* Configure timer control register
 	 * 1. Fast PWM mode FOC0=0
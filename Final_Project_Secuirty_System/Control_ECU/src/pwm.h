@@ -10,6 +10,13 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Compare value of OCR0 for a duty cycle in percent (0 to 100), rounded by the preprocessor */
+#define PWM_DUTY_CYCLE(percent)     ((uint8)((((percent) * 255UL) + 50UL) / 100UL))
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -17,8 +24,9 @@
 /*
  * Description :
  * Function responsible To start the pwm signal using timer0 compare mode
+ * The compare value comes from PWM_DUTY_CYCLE, 255 keeps the output high.
  */
-void PWM_Timer0_Start(uint8 duty_cycle);
+void PWM_Timer0_Start(uint8 compare_value);
 
 /*
  * Description :
@@ -0,0 +1,142 @@
+/*
+ * scheduler.c
+ *	Description: Source file for the event queue scheduler of the Control ECU
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "scheduler.h"
+#include "timer1.h"
+#include "profile.h"
+#include "trace.h"
+#include <avr/io.h> 		/* To use the SREG Register */
+#include <avr/interrupt.h> 	/* For cli() */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Ring buffer of events, written at the head and read at the tail */
+static volatile SCHEDULER_EventType g_queue[SCHEDULER_QUEUE_SIZE];
+static volatile uint8 g_head = 0;
+static volatile uint8 g_tail = 0;
+
+/* Number of events lost because the queue was full */
+static volatile uint16 g_lostEvents = 0;
+
+/* Handler of each event */
+static void (*g_handlers[EVENT_NUM_OF_EVENTS])(const SCHEDULER_EventType * event_ptr);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Empty the queue and remove all the handlers.
+ */
+void SCHEDULER_init(void)
+{
+	uint8 id;
+	uint8 sreg = SREG;
+	cli();
+
+	g_head = 0;
+	g_tail = 0;
+	g_lostEvents = 0;
+	for (id = 0; id < EVENT_NUM_OF_EVENTS; id++)
+	{
+		g_handlers[id] = NULL_PTR;
+	}
+
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Set the function that handles an event, the handler runs from the main loop.
+ */
+void SCHEDULER_setHandler(SCHEDULER_EventId id, void (*handler)(const SCHEDULER_EventType * event_ptr))
+{
+	g_handlers[id] = handler;
+}
+
+/*
+ * Description :
+ * Add an event at the end of the queue, it is safe to call from ISRs and from the main program.
+ * returns: TRUE if the event is queued, FALSE if the queue is full and the event is lost.
+ */
+boolean SCHEDULER_post(SCHEDULER_EventId id, uint8 data)
+{
+	boolean queued = FALSE;
+	uint8 sreg = SREG;
+	cli();
+
+	/* The indices run freely, their difference is the number of queued events */
+	if ((uint8)(g_head - g_tail) < SCHEDULER_QUEUE_SIZE)
+	{
+		g_queue[g_head & (SCHEDULER_QUEUE_SIZE - 1)].id = id;
+		g_queue[g_head & (SCHEDULER_QUEUE_SIZE - 1)].data = data;
+		g_queue[g_head & (SCHEDULER_QUEUE_SIZE - 1)].timestamp = TIMER1_getTimestamp();
+		g_head++;
+		queued = TRUE;
+	}
+	else
+	{
+		g_lostEvents++;
+		TRACE1(EVENT_LOST, id);
+	}
+
+	SREG = sreg;
+	return queued;
+}
+
+/*
+ * Description :
+ * Take the oldest event out of the queue and run its handler.
+ * returns: TRUE if an event was handled, FALSE if the queue was empty.
+ */
+boolean SCHEDULER_dispatch(void)
+{
+	SCHEDULER_EventType event;
+	uint8 sreg = SREG;
+	cli();
+
+	if (g_head == g_tail)
+	{
+		SREG = sreg;
+		return FALSE;
+	}
+
+	/* Copy the event out so the slot is free before the handler runs */
+	event = g_queue[g_tail & (SCHEDULER_QUEUE_SIZE - 1)];
+	g_tail++;
+
+	SREG = sreg;
+
+#if (PROFILE_ENABLE == 1)
+	/* Time from posting the event until its handler starts */
+	PROFILE_record(PROFILE_EVENT_LATENCY, TIMER1_getTimestamp() - event.timestamp);
+#endif
+
+	if (g_handlers[event.id] != NULL_PTR)
+	{
+		(*g_handlers[event.id])(&event);
+	}
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return the number of events lost because the queue was full.
+ */
+uint16 SCHEDULER_getLostEvents(void)
+{
+	uint16 lost;
+	uint8 sreg = SREG;
+	cli();
+	lost = g_lostEvents;
+	SREG = sreg;
+
+	return lost;
+}
@@ -0,0 +1,88 @@
+/*
+ * scheduler.h
+ *	Description: Header file for the event queue scheduler of the Control ECU
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * Interrupts (UART receive, software timers) only post small events to a queue, the main loop
+ * takes them out one by one and calls the handler of each event to completion. A handler must
+ * never wait for anything, long operations are split in steps that are started by later events.
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Number of events the queue can hold, must be a power of two */
+#define SCHEDULER_QUEUE_SIZE        16
+
+#if (SCHEDULER_QUEUE_SIZE & (SCHEDULER_QUEUE_SIZE - 1))
+
+#error "Size of the event queue should be a power of two"
+
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum defining the events of the Control ECU */
+typedef enum
+{
+	EVENT_UART_RX,          /* A byte is received from the HMI, data is the byte */
+	EVENT_EEPROM_READY,     /* The EEPROM write cycle is over */
+	EVENT_DOOR_TIMER,       /* The current door step is over */
+	EVENT_ALARM_TIMER,      /* The alarm time is over */
+	EVENT_NUM_OF_EVENTS
+}SCHEDULER_EventId;
+
+/* Structure of an event in the queue */
+typedef struct
+{
+	SCHEDULER_EventId id;   /* Type of the event */
+	uint8 data;             /* Event data, for example the received byte */
+	uint32 timestamp;       /* Timer1 timestamp when the event was posted */
+}SCHEDULER_EventType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Empty the queue and remove all the handlers.
+ */
+void SCHEDULER_init(void);
+
+/*
+ * Description :
+ * Set the function that handles an event, the handler runs from the main loop.
+ */
+void SCHEDULER_setHandler(SCHEDULER_EventId id, void (*handler)(const SCHEDULER_EventType * event_ptr));
+
+/*
+ * Description :
+ * Add an event at the end of the queue, it is safe to call from ISRs and from the main program.
+ * returns: TRUE if the event is queued, FALSE if the queue is full and the event is lost.
+ */
+boolean SCHEDULER_post(SCHEDULER_EventId id, uint8 data);
+
+/*
+ * Description :
+ * Take the oldest event out of the queue and run its handler.
+ * returns: TRUE if an event was handled, FALSE if the queue was empty.
+ */
+boolean SCHEDULER_dispatch(void);
+
+/*
+ * Description :
+ * Return the number of events lost because the queue was full.
+ */
+uint16 SCHEDULER_getLostEvents(void);
+
+#endif /* SCHEDULER_H_ */
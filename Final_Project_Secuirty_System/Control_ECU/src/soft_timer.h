@@ -0,0 +1,172 @@
+/*
+ * soft_timer.h
+ *	Description: Header file for the software timers driver
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The compare A channel of Timer1 gives a single 1 ms system tick. Any number of one-shot and periodic
+ * software timers hang on a hashed timer wheel: a timer is kept in the slot selected by the
+ * low bits of its deadline, so each tick only visits the timers of one slot.
+ * Deadlines are 32-bit tick counts compared with wraparound-safe signed differences.
+ *
+ * The callback of a timer runs in the tick ISR, with the interrupts disabled. The callback of a
+ * deferred timer (SOFT_TIMER_startDeferred) runs later from SOFT_TIMER_runDeferred, called by the
+ * main loop with the interrupts enabled: on its expiry the tick ISR only puts the timer in a
+ * ready list. The long callbacks (the keypad row step and the LCD drain of the HMI ECU) are
+ * deferred, so the tick ISR stays short and the other interrupts are not held behind it.
+ * A deferred timer that expires again before its callback ran is called once: the callback of a
+ * periodic deferred timer must not count its calls to measure the time.
+ * With KERNEL_ENABLE the task that calls SOFT_TIMER_runDeferred blocks between the expiries: the
+ * callback of SOFT_TIMER_setReadyCallBack wakes it from the tick ISR.
+ *
+ * SOFT_TIMER_suspendTick stops the tick interrupt while no timer is running, for a sleep that only
+ * other interrupts end. The counter of Timer1 keeps running: the next SOFT_TIMER_start starts the
+ * tick again on its old phase, and SOFT_TIMER_getTicks counts the ticks missed meanwhile. A wait
+ * polled with SOFT_TIMER_getTicks must hold a timer (its callback may be NULL_PTR) to keep the tick,
+ * or it is only seen at the next interrupt.
+ */
+
+#ifndef SOFT_TIMER_H_
+#define SOFT_TIMER_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * System tick calculation for one millisecond
+ * Timer1 runs at TIMER1_FREQUENCY = 1 MHz
+ * each timer tick = 1 micro sec
+ * compare A moves forward 1000 timer ticks each time = 1000 micro sec = 1 milli sec
+ */
+#define SOFT_TIMER_TICK_COUNTS      1000    /* Timer1 counts between two system ticks */
+
+/*
+ * Timer1 counts the next tick must be away at least when the tick starts again, or the compare match
+ * could pass before it is set: that tick is counted as missed instead
+ */
+#define SOFT_TIMER_RESUME_MARGIN    32
+
+/* Number of slots in the timer wheel, must be a power of two */
+#define SOFT_TIMER_WHEEL_SIZE       16
+
+#if (SOFT_TIMER_WHEEL_SIZE & (SOFT_TIMER_WHEEL_SIZE - 1))
+
+#error "Number of timer wheel slots should be a power of two"
+
+#endif
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*
+ * Structure of a software timer.
+ * The application owns the storage (usually a static variable), the driver only links it.
+ */
+typedef struct SOFT_TIMER_Type
+{
+	struct SOFT_TIMER_Type *next;   /* Next timer in the same wheel slot */
+	struct SOFT_TIMER_Type *prev;   /* Previous timer in the same wheel slot */
+	uint32 deadline;                /* Tick count at which the timer expires */
+	uint32 period;                  /* Reload period in ms, zero for a one-shot timer */
+	void (*callback)(void);         /* Function called on expiry */
+	struct SOFT_TIMER_Type *ready_next; /* Next timer in the ready list */
+	boolean active;                 /* TRUE while the timer is linked in the wheel */
+	boolean deferred;               /* TRUE if the callback is called by SOFT_TIMER_runDeferred */
+	boolean ready;                  /* TRUE while the timer waits in the ready list */
+} SOFT_TIMER_Type;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Take the compare A channel of Timer1 for the 1 ms system tick and clear the timer wheel.
+ * Timer1 must be initialized before.
+ */
+void SOFT_TIMER_init(void);
+
+/*
+ * Description :
+ * Start (or restart) a software timer.
+ * 	1. The callback is called from the tick ISR after delay_ms milliseconds.
+ * 	2. If period_ms is not zero the timer is reloaded and fires every period_ms milliseconds.
+ * The callback runs in interrupt context so it should be short.
+ */
+void SOFT_TIMER_start(SOFT_TIMER_Type * timer_ptr, uint32 delay_ms, uint32 period_ms, void (*callback)(void));
+
+/*
+ * Description :
+ * Start (or restart) a deferred software timer, same as SOFT_TIMER_start except that the callback
+ * is called from SOFT_TIMER_runDeferred, outside of the tick ISR. It may be called from ISRs.
+ */
+void SOFT_TIMER_startDeferred(SOFT_TIMER_Type * timer_ptr, uint32 delay_ms, uint32 period_ms, void (*callback)(void));
+
+/*
+ * Description :
+ * Call the callbacks of the deferred timers expired since the last call, in the order of their
+ * expiries. It must be called from one place only, the main loop (or one task with KERNEL_ENABLE),
+ * at least once per tick for the periodic deferred timers of 1 ms.
+ * returns: TRUE if a callback was called.
+ */
+boolean SOFT_TIMER_runDeferred(void);
+
+/*
+ * Description :
+ * Set the function called by the tick ISR, as its last step, on a tick that put deferred timers
+ * in the ready list. It may give a kernel semaphore.
+ */
+void SOFT_TIMER_setReadyCallBack(void (*callback)(void));
+
+/*
+ * Description :
+ * Stop the tick interrupt if no timer is running and no deferred callback waits, so the tick does
+ * not wake the CPU. It must be called with the interrupts disabled, just before the sleep.
+ * returns: TRUE if the tick is stopped.
+ */
+boolean SOFT_TIMER_suspendTick(void);
+
+/*
+ * Description :
+ * Return TRUE if a deferred callback waits for SOFT_TIMER_runDeferred.
+ */
+boolean SOFT_TIMER_isReady(void);
+
+/*
+ * Description :
+ * Stop a software timer, it is safe to stop a timer that is not running.
+ * A deferred timer waiting in the ready list is removed from it, its callback is not called.
+ */
+void SOFT_TIMER_stop(SOFT_TIMER_Type * timer_ptr);
+
+/*
+ * Description :
+ * Return TRUE if the timer is running, or if its deferred callback is still to be called.
+ */
+boolean SOFT_TIMER_isActive(const SOFT_TIMER_Type * timer_ptr);
+
+/*
+ * Description :
+ * Return the number of milliseconds since SOFT_TIMER_init (wraps after ~49.7 days), the ticks
+ * missed while the tick was stopped included.
+ */
+uint32 SOFT_TIMER_getTicks(void);
+
+/*
+ * Description :
+ * Return the Timer1 timestamp taken at the start of the last tick ISR, for example to know when
+ * the tick woke the CPU.
+ */
+uint32 SOFT_TIMER_getTickTimestamp(void);
+
+/*
+ * Description :
+ * Busy wait for the required number of milliseconds using the system tick.
+ */
+void SOFT_TIMER_delay(uint32 delay_ms);
+
+#endif /* SOFT_TIMER_H_ */
@@ -14,113 +14,297 @@
  *                           Global Variables                                  *
  *******************************************************************************/
 
-/* Global variables to hold the address of the call back function in the application */
-static volatile void (*g_CallBackFunction)(void) = NULL_PTR;
+/* Global variables to hold the address of the call back function of each channel */
+static void (* volatile g_callBackFunctions[TIMER1_NUM_OF_CHANNELS])(void) = {NULL_PTR};
+
+/* Interrupt enable bit in TIMSK and flag bit in TIFR of each channel */
+static const uint8 g_interruptEnableBit[TIMER1_NUM_OF_CHANNELS] = {OCIE1A, OCIE1B, TOIE1, TICIE1};
+static const uint8 g_interruptFlagBit[TIMER1_NUM_OF_CHANNELS] = {OCF1A, OCF1B, TOV1, ICF1};
+
+/* Upper 16 bits of the timestamp, incremented on every counter overflow */
+static volatile uint16 g_overflows = 0;
+
+/* The overflow interrupt always runs for the timestamp, this flag enables its channel callback */
+static volatile boolean g_overflowChannelEnabled = FALSE;
 
 /*******************************************************************************
  *                      Functions and ISRS Definitions                         *
  *******************************************************************************/
 
-
-/* Interrupt Service Routine for timer1 compare mode handle call back function */
+/* Interrupt Service Routine for timer1 compare A channel */
 ISR(TIMER1_COMPA_vect)
 {
 	/* check if the pointer is not equal null */
-	if (g_CallBackFunction != NULL_PTR)
+	if (g_callBackFunctions[TIMER1_CHANNEL_A] != NULL_PTR)
+	{
+		/* call back the function of the channel owner */
+		(*g_callBackFunctions[TIMER1_CHANNEL_A])();
+	}
+}
+
+/* Interrupt Service Routine for timer1 compare B channel */
+ISR(TIMER1_COMPB_vect)
+{
+	if (g_callBackFunctions[TIMER1_CHANNEL_B] != NULL_PTR)
 	{
-		/* call back the function passed to you */
-		(*g_CallBackFunction)();
+		(*g_callBackFunctions[TIMER1_CHANNEL_B])();
 	}
 }
 
-/* Interrupt Service Routine for timer1 overflow mode to handle call back function */
+/* Interrupt Service Routine for timer1 overflow channel */
 ISR(TIMER1_OVF_vect)
 {
-	/* check if the pointer is not equal null */
-	if (g_CallBackFunction != NULL_PTR)
+	/* Extend the counter for the timestamp */
+	g_overflows++;
+
+	if (g_overflowChannelEnabled && (g_callBackFunctions[TIMER1_CHANNEL_OVF] != NULL_PTR))
 	{
-		/* call back the function passed to you */
-		(*g_CallBackFunction)();
+		(*g_callBackFunctions[TIMER1_CHANNEL_OVF])();
 	}
 }
 
+/* Interrupt Service Routine for timer1 input capture channel */
+ISR(TIMER1_CAPT_vect)
+{
+	if (g_callBackFunctions[TIMER1_CHANNEL_CAPT] != NULL_PTR)
+	{
+		(*g_callBackFunctions[TIMER1_CHANNEL_CAPT])();
+	}
+}
 
 /*
  * Description : Function to initialize the Timer1
- * 	1. Set timer1 initial count.
- * 	2. Set the required Mode.
- * 	3. Set the required clock.
- * 	4. Set the required compare value.
- * 	5. Initialize Timer1 Registers.
+ * 	1. Set the Normal (free-running) mode with OC1A and OC1B disconnected.
+ * 	2. Set the clock and capture edge of the configuration above.
+ * 	3. Release all channels.
  */
-void TIMER1_init(const TIMER1_ConfigType * config_ptr)
+void TIMER1_init(void)
 {
-	/* Set timer1 initial count as configured */
-	TCNT1 = config_ptr->initial_value;
+	uint8 channel;
+
+	for (channel = 0; channel < TIMER1_NUM_OF_CHANNELS; channel++)
+	{
+		TIMER1_releaseChannel(channel);
+	}
+
+	/* Start counting from zero */
+	TCNT1 = 0;
+	g_overflows = 0;
 
 	/*
 	 * Configure timer control register TCCR1A
 	 * 1. Disconnect OC1A and OC1B  COM1A1=0 COM1A0=0 COM1B0=0 COM1B1=0
-	 * 2. FOC1A=1 FOC1B=0 NON PWM mode
+	 * 2. Normal mode WGM11=0 WGM10=0
+	 */
+	TCCR1A = 0;
+
+	/*
+	 * Configure timer control register TCCR1B
+	 * 1. Normal mode WGM13=0 WGM12=0, the counter runs over the whole 16 bits.
+	 * 2. Input capture edge ICES1 as configured, noise canceler off.
+	 * 3. Set the prescaler chosen at compile time. Prescaler bits CS10, CS11, CS12.
 	 */
-	TCCR1A = (1<<FOC1A);
+	TCCR1B = (TIMER1_CAPTURE_EDGE << ICES1) | TIMER1_PRESCALER;
+
+	/* Enable Timer1 overflow Interrupt for the timestamp */
+	TIFR = (1 << TOV1);
+	SET_BIT(TIMSK, TOIE1);
+}
+
+/*
+ * Description: Function to disable & stop Timer1 and release all channels.
+ */
+void TIMER1_deinit(void)
+{
+	uint8 channel;
 
-	/* If the configured mode is overflow mode */
-	if (config_ptr->mode == OVERFLOW_MODE)
+	/* Disable all the channel interrupts */
+	for (channel = 0; channel < TIMER1_NUM_OF_CHANNELS; channel++)
 	{
-		/* Set the mode of the timer to Normal mode */
-		CLEAR_BIT(TCCR1B, WGM12);
+		TIMER1_releaseChannel(channel);
+	}
+	CLEAR_BIT(TIMSK, TOIE1);
+
+	/* Clear All Timer1 Registers Turn off the timer clock */
+	TCCR1B = 0;
+	TCCR1A = 0;
+	TCNT1  = 0;
+	OCR1A  = 0;
+	OCR1B  = 0;
+}
+
+/*
+ * Description: Function to take a channel and set its Call Back function address.
+ * The channel interrupt stays disabled until the channel is enabled or a compare is set.
+ * returns: TRUE if the channel was free, FALSE if another user owns it.
+ */
+boolean TIMER1_allocateChannel(TIMER1_Channel channel, void (*ptr_func)(void))
+{
+	boolean allocated = FALSE;
+	uint8 sreg = SREG;
+	cli();
 
-		/* Enable Timer1 overflow Interrupt */
-		SET_BIT(TIMSK, TOIE1);
+	if (g_callBackFunctions[channel] == NULL_PTR)
+	{
+		/* Save the address of the Call back function of the channel */
+		g_callBackFunctions[channel] = ptr_func;
+		allocated = TRUE;
 	}
 
-	/* If the configured mode is compare mode */
-	else if (config_ptr->mode == COMPARE_MODE)
+	SREG = sreg;
+	return allocated;
+}
+
+/*
+ * Description: Function to disable a channel and make it free for another user.
+ */
+void TIMER1_releaseChannel(TIMER1_Channel channel)
+{
+	TIMER1_disableChannel(channel);
+	g_callBackFunctions[channel] = NULL_PTR;
+}
+
+/*
+ * Description: Function to enable the interrupt of a channel (clears any old pending flag).
+ */
+void TIMER1_enableChannel(TIMER1_Channel channel)
+{
+	/* TIMSK is shared with Timer0 and Timer2, the read-modify-write must not be interrupted */
+	uint8 sreg = SREG;
+	cli();
+
+	if (channel == TIMER1_CHANNEL_OVF)
 	{
-		/* Set the Compare value as configured */
-		OCR1A = config_ptr->compare_value;
+		/* The overflow interrupt is already running for the timestamp */
+		g_overflowChannelEnabled = TRUE;
+	}
+	else
+	{
+		/* The flag is cleared by writing one to it */
+		TIFR = (1 << g_interruptFlagBit[channel]);
+		SET_BIT(TIMSK, g_interruptEnableBit[channel]);
+	}
 
-		/* Set the mode of the timer to (CTC mode number 4) */
-		SET_BIT(TCCR1B, WGM12);
+	SREG = sreg;
+}
+
+/*
+ * Description: Function to disable the interrupt of a channel without releasing it.
+ */
+void TIMER1_disableChannel(TIMER1_Channel channel)
+{
+	uint8 sreg = SREG;
+	cli();
 
-		/* Enable Timer1 Compare A Interrupt */
-		SET_BIT(TIMSK, OCIE1A);
+	if (channel == TIMER1_CHANNEL_OVF)
+	{
+		g_overflowChannelEnabled = FALSE;
+	}
+	else
+	{
+		CLEAR_BIT(TIMSK, g_interruptEnableBit[channel]);
 	}
 
-	/*
-	 * Configure timer control register TCCR1B
-	 * Set the prescaler as configured.
-	 * Prescaler bits CS10, CS11, CS12.
-	 */
-	TCCR1B = (TCCR1B & 0xF8)|(config_ptr->prescaler & 0x07);
+	SREG = sreg;
 }
 
+/*
+ * Description: Function to schedule a compare channel (A or B) at an absolute counter value.
+ */
+void TIMER1_setCompare(TIMER1_Channel channel, uint16 count)
+{
+	/* 16-bit registers share the TEMP register, no ISR may access Timer1 in between */
+	uint8 sreg = SREG;
+	cli();
+
+	if (channel == TIMER1_CHANNEL_A)
+	{
+		OCR1A = count;
+	}
+	else if (channel == TIMER1_CHANNEL_B)
+	{
+		OCR1B = count;
+	}
+	TIMER1_enableChannel(channel);
+
+	SREG = sreg;
+}
 
 /*
- * Description: Function to disable & stop Timer1.
+ * Description: Function to move a compare channel (A or B) forward by a number of counts.
+ * Called from the channel callback it gives a periodic event with no drift.
  */
-void TIMER1_deinit(void)
+void TIMER1_advanceCompare(TIMER1_Channel channel, uint16 counts)
 {
-	/* Clear All Timer1 Registers Turn off the timer clock */
-	TCNT1  = 0;
-	OCR1A  = 0;
-	TCCR1A = 0;
-	TCCR1B = 0;
+	uint8 sreg = SREG;
+	cli();
 
-	/* Disable COMPARE A interrupt */
-	CLEAR_BIT(TIMSK, OCIE1A);
+	/* The compare registers wrap around like the counter */
+	if (channel == TIMER1_CHANNEL_A)
+	{
+		OCR1A += counts;
+	}
+	else if (channel == TIMER1_CHANNEL_B)
+	{
+		OCR1B += counts;
+	}
 
-	/* Disable OVERFLOW interrupt */
-	CLEAR_BIT(TIMSK, TOIE1);
+	SREG = sreg;
 }
 
 /*
- * Description: Function to set the Call Back function address.
+ * Description: Function to read the free-running counter.
  */
-void TIMER1_setCallBack(void (*ptr_func)(void))
+uint16 TIMER1_getCount(void)
 {
-	/* Save the address of the Call back function in a global variable */
-	g_CallBackFunction = (void*) ptr_func;
+	uint16 count;
+	uint8 sreg = SREG;
+	cli();
+
+	count = TCNT1;
+
+	SREG = sreg;
+	return count;
 }
 
+/*
+ * Description: Function to read the counter value latched by the last input capture.
+ */
+uint16 TIMER1_getCapture(void)
+{
+	uint16 capture;
+	uint8 sreg = SREG;
+	cli();
+
+	capture = ICR1;
+
+	SREG = sreg;
+	return capture;
+}
+
+/*
+ * Description: Function to read the 32-bit monotonic timestamp (counter + overflow count).
+ * At TIMER1_FREQUENCY one count is one micro second (wraps after ~71 minutes).
+ * It is safe to call from ISRs and from the main program.
+ */
+uint32 TIMER1_getTimestamp(void)
+{
+	uint16 count, overflows;
+	uint8 sreg = SREG;
+	cli();
+
+	count = TCNT1;
+	overflows = g_overflows;
+
+	/*
+	 * The counter may have overflowed after interrupts were disabled and the overflow ISR
+	 * did not run yet. A small count with the flag set belongs to the next overflow period.
+	 */
+	if (BIT_IS_SET(TIFR, TOV1) && (count < 0x8000))
+	{
+		overflows++;
+	}
+
+	SREG = sreg;
+	return ((uint32)overflows << 16) | count;
+}
@@ -0,0 +1,115 @@
+/*
+ * trace.h
+ *	Description: Header file for the binary trace logger
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * A trace point stores only a record in a RAM ring buffer: the message id, the Timer1 timestamp
+ * (one micro second per count) and up to two raw 16-bit arguments. Nothing is formatted on the
+ * target. The format strings are kept in the .trace_fmt section of the ELF file, a section that
+ * is never loaded to the flash, and Host_Tools/src/trace_decode.c rebuilds the text on Linux.
+ * A trace point takes a few micro seconds with the interrupts disabled, so it can be used in ISRs.
+ *
+ * The records are sent by TRACE_drain as hex text lines "~HHHH...\r\n", one line per record, so
+ * they never contain the READY byte of the link and can be mixed with the profiler text.
+ * The logger is compiled out unless TRACE_ENABLE is set to 1, then the trace points cost nothing.
+ *
+ * Memory cost: TRACE_BUFFER_SIZE + 3 bytes of RAM, no flash for the format strings.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Trace configuration, its value should be 0 (disabled) or 1 (enabled) */
+#define TRACE_ENABLE                0
+
+#if((TRACE_ENABLE != 0) && (TRACE_ENABLE != 1))
+
+#error "TRACE_ENABLE should be equal to 0 or 1"
+
+#endif
+
+/* Size of the ring buffer in bytes, must be a power of two up to 128 */
+#define TRACE_BUFFER_SIZE           128
+
+/* Bytes of a record: header, 32-bit timestamp and 16-bit arguments */
+#define TRACE_RECORD_SIZE(args)     (5 + (2 * (args)))
+
+/*
+ * List of the trace messages of the Control ECU.
+ * To add a message add a MESSAGE(name, format) line. Each % conversion of the format takes one
+ * 16-bit argument (%u, %d, %x, %X, %c), two at most. The format must not contain '"' or '\'.
+ */
+#define TRACE_MESSAGES(MESSAGE) \
+	MESSAGE(UART_RX, "uart rx 0x%02X") \
+	MESSAGE(COMMAND, "command 0x%02X") \
+	MESSAGE(PASSWORD_ATTEMPT, "password attempt %u") \
+	MESSAGE(PASSWORD_CHECKED, "password checked, command 0x%02X result 0x%02X") \
+	MESSAGE(PASSWORDS_UNMATCH, "new passwords do not match") \
+	MESSAGE(PASSWORD_SAVED, "new password saved") \
+	MESSAGE(DOOR_STATE, "door state %u") \
+	MESSAGE(ALARM_ON, "alarm on") \
+	MESSAGE(ALARM_OFF, "alarm off") \
+	MESSAGE(EVENT_LOST, "event %u lost, queue full")
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum of the trace messages, generated from the list above */
+#define TRACE_MESSAGE_ID(name, format)  TRACE_##name,
+typedef enum
+{
+	TRACE_MESSAGES(TRACE_MESSAGE_ID)
+	TRACE_NUM_OF_MESSAGES
+}TRACE_Message;
+#undef TRACE_MESSAGE_ID
+
+/* The header byte keeps the id in its low 6 bits, the last id reports the lost records */
+#define TRACE_LOST_ID               0x3F
+
+#if (TRACE_ENABLE == 1)
+
+/* Trace points with zero, one or two arguments, the name is one of the TRACE_MESSAGES list */
+#define TRACE0(name)                TRACE_write(TRACE_##name, 0, 0, 0)
+#define TRACE1(name, arg1)          TRACE_write(TRACE_##name, 1, (uint16)(arg1), 0)
+#define TRACE2(name, arg1, arg2)    TRACE_write(TRACE_##name, 2, (uint16)(arg1), (uint16)(arg2))
+
+#else
+
+#define TRACE0(name)                ((void)0)
+#define TRACE1(name, arg1)          ((void)0)
+#define TRACE2(name, arg1, arg2)    ((void)0)
+
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+#if (TRACE_ENABLE == 1)
+
+/*
+ * Description :
+ * Store a record in the ring buffer, it is counted as lost if the buffer is full.
+ * It is safe to call from ISRs and from the main program, use the TRACE macros instead.
+ */
+void TRACE_write(TRACE_Message message, uint8 args, uint16 arg1, uint16 arg2);
+
+/*
+ * Description :
+ * Send the oldest record as one hex text line through the given byte output function.
+ * When records were lost, a record of TRACE_LOST_ID with their number is sent first.
+ * returns: TRUE if a line is sent, FALSE if there is nothing to send.
+ */
+boolean TRACE_drain(void (*send_byte)(const uint8 data));
+
+#endif
+
+#endif /* TRACE_H_ */
@@ -7,23 +7,42 @@
 
 #include "uart.h"
 #include <avr/io.h>
+#include <avr/interrupt.h> 	/* For the receive complete ISR */
 #include "common_macros.h"
 
 /*******************************************************************************
- *                      Functions Definitions                                  *
+ *                           Global Variables                                  *
  *******************************************************************************/
 
+/* Global variable to hold the address of the receive call back function */
+static void (* volatile g_rxCallBackPtr)(uint8 data) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Functions and ISRS Definitions                         *
+ *******************************************************************************/
+
+/* Interrupt Service Routine for the receive complete interrupt */
+ISR(USART_RXC_vect)
+{
+	/* Reading UDR clears the RXC flag */
+	uint8 data = UDR;
+
+	if (g_rxCallBackPtr != NULL_PTR)
+	{
+		(*g_rxCallBackPtr)(data);
+	}
+}
+
 /*
  * Description :
  * Functional responsible for Initialize the UART device by:
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
  * 2. Enable the UART.
  * 3. Setup the UART baud rate.
+ * The configuration is the one above, the register values are computed at compile time.
  */
-void UART_init(const UART_ConfigType *config_ptr)
+void UART_init(void)
 {
-	uint16 ubbr;
-
 	UCSRA = (1<<U2X); /* U2X = 1 for double transmission speed */
 
 	/************************** UCSRB Description **************************
@@ -40,33 +59,18 @@ void UART_init(const UART_ConfigType *config_ptr)
 	/************************** UCSRC Description **************************
 	 * URSEL   = 1 The URSEL must be one when writing the UCSRC
 	 * UMSEL   = 0 Asynchronous Operation
+	 * UPM1:0  = UART_PARITY
+	 * USBS    = UART_STOP_BIT
+	 * UCSZ1:0 = UART_DATA_SIZE
 	 * UCPOL   = 0 Used with the Synchronous operation only
+	 * One store: UCSRC shares its address with UBRRH, a read returns UBRRH
 	 ***********************************************************************/
-	UCSRC = (1<<URSEL);
-
-	/* Set the parity bits (UPM1:0) based on the configuration */
-	UCSRC = (UCSRC & 0xCF) | ((config_ptr->parity & 0x03) << 4);
-
-	/* Set the stop bit (USBS) based on the configuration */
-	if (config_ptr->stop_bit)
-	{
-		UCSRC |= (1<<USBS); /* Two stop bits */
-	}
-	else
-	{
-		UCSRC &= ~(1<<USBS); /* One stop bit */
-	}
-
-	/* Set the data size bits (UCSZ1:0) based on the configuration */
-	UCSRC = (UCSRC & 0xF9) | ((config_ptr->data_size & 0x03) << 1);
-
-	/* calculating the 12 bit number baud rate */
-	ubbr = (uint16) (((float)(F_CPU)/(8 * config_ptr->baud_rate)) - 1);
+	UCSRC = (1<<URSEL) | (UART_PARITY<<UPM0) | (UART_STOP_BIT<<USBS) | (UART_DATA_SIZE<<UCSZ0);
 
 	/* First 8 bits from the BAUD_PRESCALE inside UBRRL and last 4 bits in UBRRH*/
 	/* URSEL = 0  The URSEL must be one when writing the UCSRC */
-	UBRRH = ubbr>>8;
-	UBRRL = ubbr;
+	UBRRH = (uint8)(UART_UBRR>>8);
+	UBRRL = (uint8)UART_UBRR;
 }
 
 /*
@@ -177,3 +181,23 @@ void UART_receiveData(uint8 *arr, uint8 arr_size)
 		arr[i] = UART_recieveByte();
 	}
 }
+
+/*
+ * Description :
+ * Enable the receive complete interrupt and call the given function with every received byte.
+ * The function runs in interrupt context. Passing NULL_PTR disables the interrupt again so
+ * the bytes can be received with UART_recieveByte.
+ */
+void UART_setRxCallBack(void (*ptr_func)(uint8 data))
+{
+	g_rxCallBackPtr = ptr_func;
+
+	if (ptr_func != NULL_PTR)
+	{
+		SET_BIT(UCSRB, RXCIE);
+	}
+	else
+	{
+		CLEAR_BIT(UCSRB, RXCIE);
+	}
+}
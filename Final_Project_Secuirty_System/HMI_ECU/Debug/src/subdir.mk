@@ -5,29 +5,53 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
 ../src/HMI_ECU.c \
+../src/clock_sync.c \
 ../src/gpio.c \
 ../src/hmi_functions.c \
+../src/kernel.c \
 ../src/keypad.c \
 ../src/lcd.c \
+../src/power.c \
+../src/profile.c \
+../src/soft_timer.c \
+../src/soft_uart.c \
+../src/stack.c \
 ../src/timer1.c \
+../src/trace.c \
 ../src/uart.c 
 
 OBJS += \
 ./src/HMI_ECU.o \
+./src/clock_sync.o \
 ./src/gpio.o \
 ./src/hmi_functions.o \
+./src/kernel.o \
 ./src/keypad.o \
 ./src/lcd.o \
+./src/power.o \
+./src/profile.o \
+./src/soft_timer.o \
+./src/soft_uart.o \
+./src/stack.o \
 ./src/timer1.o \
+./src/trace.o \
 ./src/uart.o 
 
 C_DEPS += \
 ./src/HMI_ECU.d \
+./src/clock_sync.d \
 ./src/gpio.d \
 ./src/hmi_functions.d \
+./src/kernel.d \
 ./src/keypad.d \
 ./src/lcd.d \
+./src/power.d \
+./src/profile.d \
+./src/soft_timer.d \
+./src/soft_uart.d \
+./src/stack.d \
 ./src/timer1.d \
+./src/trace.d \
 ./src/uart.d 
 
 
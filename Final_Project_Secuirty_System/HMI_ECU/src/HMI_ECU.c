@@ -11,92 +11,178 @@
  */
 
 #include "hmi_functions.h" 	/* Include header for HMI-related functions */
-#include "lcd.h"          	/* Include header for LCD-related functions */
+#include "pt.h"           	/* Include header for the protothreads */
+#include "kernel.h"       	/* Include header for the optional preemptive kernel */
+#include "timer1.h"       	/* Include header for the Timer1 timestamp */
+#include "soft_timer.h"   	/* Include header for the deferred timers */
+#include "profile.h"      	/* Include header for the execution time profiler */
+#include "soft_uart.h"    	/* Include header for the software UART debug channel */
+#include "trace.h"        	/* Include header for the binary trace logger */
+#include "power.h"        	/* Include header for the idle sleep */
+#include <avr/interrupt.h> 	/* Include header for cli() */
+
+/* The HMI has no other output for the trace records than the software UART */
+#if((TRACE_ENABLE == 1) && (SOFT_UART_ENABLE == 0))
+
+#error "The trace of the HMI needs SOFT_UART_ENABLE"
+
+#endif
+
+#if (KERNEL_ENABLE == 1)
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Task priorities, 0 is the highest */
+#define DRIVER_TASK_PRIORITY    0
+#define LINK_TASK_PRIORITY      1
+#define UI_TASK_PRIORITY        2
+#define DEBUG_TASK_PRIORITY     3
+
+/*
+ * Task stacks: the interrupt chain of KERNEL_ISR_STACK_SIZE on top of the deepest calls of each task,
+ * estimated for the -O0 build. KERNEL_dump on the debug channel gives the bytes they never used.
+ */
+#define DRIVER_STACK_SIZE       (KERNEL_ISR_STACK_SIZE + 96)
+#define LINK_STACK_SIZE         (KERNEL_ISR_STACK_SIZE + 128)
+#define UI_STACK_SIZE           (KERNEL_ISR_STACK_SIZE + 160)
+#define DEBUG_STACK_SIZE        (KERNEL_ISR_STACK_SIZE + 128)
+
+/* Period of the debug task in milliseconds, it sends one trace record per round */
+#define DEBUG_PERIOD            1
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static KERNEL_TaskType g_driverTask;
+static KERNEL_TaskType g_linkTask;
+static KERNEL_TaskType g_uiTask;
+static uint8 g_driverStack[DRIVER_STACK_SIZE];
+static uint8 g_linkStack[LINK_STACK_SIZE];
+static uint8 g_uiStack[UI_STACK_SIZE];
+#if (SOFT_UART_ENABLE == 1)
+static KERNEL_TaskType g_debugTask;
+static uint8 g_debugStack[DEBUG_STACK_SIZE];
+#endif
+
+/* Given by the system tick when deferred timers expired, the task of the drivers waits on it */
+static KERNEL_SemaphoreType g_deferredSemaphore;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Ready callback of the deferred timers, called last in the tick ISR */
+static void Deferred_readyCallBack(void)
+{
+	KERNEL_semaphoreGive(&g_deferredSemaphore);
+}
+
+/*
+ * Highest priority task: the keypad scan and the LCD drain, the deferred timers of the system tick.
+ * It hands the key events to the user interface task, and preempts the other tasks even in the
+ * middle of an UART frame or a screen drawn in the shadow of the LCD.
+ */
+static void Driver_task(void)
+{
+	while (1)
+	{
+		KERNEL_semaphoreTake(&g_deferredSemaphore, KERNEL_WAIT_FOREVER);
+
+#if (PROFILE_ENABLE == 1)
+		/* Time from the system tick until this task runs: tick ISR, scheduler and context switch */
+		PROFILE_record(PROFILE_KERNEL_WAKE, TIMER1_getTimestamp() - SOFT_TIMER_getTickTimestamp());
+#endif
+
+		SOFT_TIMER_runDeferred();
+		Ui_forwardKeys();
+	}
+}
+
+/* Task running the link thread, woken by the bytes of the Control ECU and the requests of the user interface */
+static void Link_task(void)
+{
+	PT_Type link_thread;
+
+	PT_INIT(&link_thread);
+
+	while (1)
+	{
+		Link_thread(&link_thread);
+		Link_wait();
+	}
+}
+
+/* Task running the user interface, woken by the key events, the screen times and the end of its requests */
+static void Ui_task(void)
+{
+	while (1)
+	{
+		Ui_dispatch();
+		Ui_waitEvent();
+	}
+}
+
+#if (SOFT_UART_ENABLE == 1)
+/* Lowest priority task, the debug text takes the time left by the other tasks */
+static void Debug_task(void)
+{
+	while (1)
+	{
+		Debug_output();
+		KERNEL_delay(DEBUG_PERIOD);
+	}
+}
+#endif
+
+#endif
 
 int main(void)
 {
-	uint8 g_status; 	/* Declare a variable to store the status of received commands */
+#if (KERNEL_ENABLE == 0)
+	/* Continuation point of the link thread */
+	PT_Type link_thread;
+#endif
+
 	Init_Function(); 	/* Initialize HMI-related functions and LCD */
 
-	/* Infinite loop to continuously check for and execute commands */
+#if (KERNEL_ENABLE == 1)
+	/* The drivers, the link, the user interface and the debug text in their own tasks, KERNEL_start never returns */
+	KERNEL_init();
+	KERNEL_semaphoreInit(&g_deferredSemaphore, 0);
+	SOFT_TIMER_setReadyCallBack(Deferred_readyCallBack);
+	KERNEL_createTask(&g_driverTask, Driver_task, g_driverStack, DRIVER_STACK_SIZE, DRIVER_TASK_PRIORITY);
+	KERNEL_createTask(&g_linkTask, Link_task, g_linkStack, LINK_STACK_SIZE, LINK_TASK_PRIORITY);
+	KERNEL_createTask(&g_uiTask, Ui_task, g_uiStack, UI_STACK_SIZE, UI_TASK_PRIORITY);
+#if (SOFT_UART_ENABLE == 1)
+	KERNEL_createTask(&g_debugTask, Debug_task, g_debugStack, DEBUG_STACK_SIZE, DEBUG_TASK_PRIORITY);
+#endif
+	KERNEL_start();
+#else
+	PT_INIT(&link_thread);
+
+	/*
+	 * Infinite loop calling the user interface and the link in turn, each one returns as soon as it has to wait.
+	 * Everything they wait for comes with an interrupt, so the CPU can sleep until the next one.
+	 * The keypad scan and the LCD drain run first, from the deferred timers the last tick expired.
+	 */
 	while(1)
 	{
-		g_status = receive_command(); 	/* Receive command and update status */
-		switch (g_status) 				/* Switch case based on the received command status */
+		SOFT_TIMER_runDeferred();
+		Ui_dispatch();
+		Link_thread(&link_thread);
+		Debug_output();
+#if (POWER_SLEEP_ENABLE == 1)
+		/* Sleep only if no interrupt left work since the round started, the check and the sleep are atomic */
+		cli();
+		if (!SOFT_TIMER_isReady() && !Ui_isPending())
 		{
-			case NO_PASSWORD_FOUND:
-				Taking_newPassword(); 	/* Prompt user to set a new password if none is found */
-				break;
-			case PASSWORD_FOUND:
-				Main_Menu(); 			/* Display main menu if password is found */
-				break;
-			case PASSWORDS_MATCH:
-				LCD_clearScreen(); 									/* Clear the LCD screen */
-				LCD_displaySringRowColumn("PASSWORD SAVED", 0, 1); 	/* Display success message */
-				LCD_displaySringRowColumn("SUCCESSFULLY", 1, 2); 	/* Continue success message */
-				Timer1_countSeconds(TWO_SECONDS); 					/* Wait for two seconds */
-				g_attempt = ZERO_ATTEMPTS; 							/* Reset password attempt counter */
-				Main_Menu(); 										/* Return to main menu */
-				break;
-			case PASSWORDS_UNMATCH:
-				LCD_clearScreen(); 				/* Clear the LCD screen */
-				if (g_attempt == MAX_ATTEMPTS) 	/* Check if maximum attempts reached */
-				{
-					Taking_newPassword(); 		/* Prompt user to set a new password */
-				}
-				else
-				{
-					LCD_displaySringRowColumn("PASSWORD UNMATCH", 0, 0); /* Display error message */
-					LCD_displaySringRowColumn("TRY AGAIN", 1, 3); 		 /* Prompt to try again */
-					Timer1_countSeconds(TWO_SECONDS); 					 /* Wait for two seconds */
-					Taking_newPassword(); 								 /* Prompt user to set a new password */
-				}
-
-				break;
-			case PASSWORD_MATCH_OPEN:
-				LCD_clearScreen(); 			/* Clear the LCD screen */
-				g_attempt = ZERO_ATTEMPTS; 	/* Reset password attempt counter */
-				Open_Door(); 				/* Open the door if password matches */
-				Main_Menu(); 				/* Return to main menu */
-				break;
-			case PASSWORD_MATCH_CHANGE:
-				LCD_clearScreen();							 			/* Clear the LCD screen */
-				LCD_displaySringRowColumn("PASSWORD IS", 0, 2); 		/* Display confirmation message */
-				LCD_displaySringRowColumn("CORRECT WELCOME", 0, 1); 	/* Continue confirmation message */
-				Timer1_countSeconds(TWO_SECONDS); 						/* Wait for two seconds */
-				g_attempt = ZERO_ATTEMPTS; 								/* Reset password attempt counter */
-				Change_Password(); 										/* Proceed to change password */
-				break;
-			case PASSWORD_UNMATCH_OPEN:
-				if (g_attempt == MAX_ATTEMPTS)	 	/* Check if maximum attempts reached */
-				{
-					LCD_clearScreen(); 				/* Clear the LCD screen */
-					Checking_Password(OPEN_DOOR); 	/* Check password for opening door */
-				}
-				else
-				{
-					LCD_clearScreen(); 										/* Clear the LCD screen */
-					LCD_displaySringRowColumn("PASSWORD ISN'T", 0, 1); 		/* Display error message */
-					LCD_displaySringRowColumn("CORRECT TRY AGAIN", 1, 0); 	/* Prompt to try again */
-					Timer1_countSeconds(TWO_SECONDS); 						/* Wait for two seconds */
-					Checking_Password(OPEN_DOOR); 							/* Check password for opening door */
-				}
-				break;
-			case PASSWORD_UNMATCH_CHANGE:
-				if (g_attempt == MAX_ATTEMPTS) 				/* Check if maximum attempts reached */
-				{
-					LCD_clearScreen(); 						/* Clear the LCD screen */
-					Checking_Password(CHANGING_PASSWORD); 	/* Check password for changing password */
-				}
-				else
-				{
-					LCD_clearScreen(); 										/* Clear the LCD screen */
-					LCD_displaySringRowColumn("PASSWORD ISN'T", 0, 1); 		/* Display error message */
-					LCD_displaySringRowColumn("CORRECT TRY AGAIN", 1, 0); 	/* Prompt to try again */
-					Timer1_countSeconds(TWO_SECONDS); 						/* Wait for two seconds */
-					Checking_Password(CHANGING_PASSWORD); 					/* Check password for changing password */
-				}
-				break;
+			POWER_idle();
 		}
+		sei();
+#endif
 	}
+#endif
 }
@@ -0,0 +1,124 @@
+/*
+ * clock_sync.c
+ *	Description: Source file for the clock synchronization with the Control ECU
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "clock_sync.h"
+
+#if (CLOCK_SYNC_ENABLE == 1)
+
+#include "timer1.h"
+#include "trace.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* TRUE after the first accepted sample, and TRUE after the first drift measure */
+static boolean g_clockSynced = FALSE;
+static boolean g_clockDriftKnown = FALSE;
+
+/* HMI time of the midpoint of the last accepted sample and the offset measured there */
+static uint32 g_clockTime;
+static uint32 g_clockOffset;
+
+/* Drift in ppm and the shortest round trip delay seen in micro seconds */
+static sint32 g_clockDrift = 0;
+static uint32 g_clockMinDelay = 0xFFFFFFFF;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add the four timestamps of one exchange.
+ * returns: TRUE if the sample is accepted, FALSE if it is dropped for its long delay.
+ */
+boolean CLOCK_SYNC_addSample(uint32 t1, uint32 t2, uint32 t3, uint32 t4)
+{
+	/* The clocks are unrelated, only differences of timestamps of the same clock are meaningful */
+	uint32 delay = (t4 - t1) - (t3 - t2);
+	uint32 offset = (t2 - t1) - (delay / 2);
+	uint32 middle = t1 + ((t4 - t1) / 2);
+	uint32 span_ms;
+	sint32 drift;
+#if (TRACE_ENABLE == 1)
+	uint32 now;
+#endif
+
+	if (delay < g_clockMinDelay)
+	{
+		g_clockMinDelay = delay;
+	}
+	else if ((delay - g_clockMinDelay) > CLOCK_SYNC_DELAY_MARGIN)
+	{
+		TRACE1(CLOCK_DROPPED, (delay > 0xFFFF) ? 0xFFFF : delay);
+		return FALSE;
+	}
+
+	if (g_clockSynced && ((middle - g_clockTime) >= CLOCK_SYNC_DRIFT_SPAN))
+	{
+		/* Change of the offset in micro seconds per second of HMI time, in milliseconds to stay on 32 bits */
+		span_ms = (middle - g_clockTime) / 1000;
+		drift = ((sint32)(offset - g_clockOffset) * 1000) / (sint32)span_ms;
+		if (g_clockDriftKnown)
+		{
+			g_clockDrift += (drift - g_clockDrift) / 4;
+		}
+		else
+		{
+			g_clockDrift = drift;
+			g_clockDriftKnown = TRUE;
+		}
+	}
+
+	/* The drift is measured between samples at least CLOCK_SYNC_DRIFT_SPAN apart */
+	if (!g_clockSynced || ((middle - g_clockTime) >= CLOCK_SYNC_DRIFT_SPAN))
+	{
+		g_clockTime = middle;
+		g_clockOffset = offset;
+		g_clockSynced = TRUE;
+	}
+
+	TRACE2(CLOCK_SYNC, delay, g_clockDrift);
+
+#if (TRACE_ENABLE == 1)
+	/* The offset at the time of this record, for the merge of the traces of both ECUs */
+	now = TIMER1_getTimestamp();
+	offset = CLOCK_SYNC_toControl(now) - now;
+	TRACE2(CLOCK_OFFSET, offset >> 16, offset);
+#endif
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return the timestamp of the Control ECU at the given timestamp of the HMI.
+ */
+uint32 CLOCK_SYNC_toControl(uint32 local_time)
+{
+	/* Signed time since the last sample: the drift correction in micro seconds is ppm * seconds */
+	sint32 elapsed_ms = (sint32)(local_time - g_clockTime) / 1000;
+
+	if (!g_clockSynced)
+	{
+		return local_time;
+	}
+
+	return local_time + g_clockOffset + (g_clockDrift * (elapsed_ms / 1000)) + ((g_clockDrift * (elapsed_ms % 1000)) / 1000);
+}
+
+/*
+ * Description :
+ * Return the drift of the Control clock against the HMI clock in ppm.
+ */
+sint32 CLOCK_SYNC_getDrift(void)
+{
+	return g_clockDrift;
+}
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * clock_sync.h
+ *	Description: Header file for the clock synchronization with the Control ECU
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The Timer1 timestamps of the two ECUs (one micro second per count) start at different times and
+ * run at slightly different rates. Every CLOCK_SYNC_PERIOD the link thread exchanges the
+ * CLOCK_SYNC command, which gives four timestamps:
+ *  - t1: the HMI sends the command            (HMI clock)
+ *  - t2: the Control ECU receives it          (Control clock)
+ *  - t3: the Control ECU sends its answer     (Control clock)
+ *  - t4: the HMI receives the answer          (HMI clock)
+ * Both ways take one byte on the same link, so the midpoints of the two ECUs are the same instant:
+ *  - round trip delay = (t4 - t1) - (t3 - t2)
+ *  - offset           = (t2 - t1) - delay / 2 = Control clock - HMI clock
+ * The error is half the difference between the two ways, a few tens of micro seconds of interrupt
+ * latency. A sample whose delay is longer than the shortest one by more than CLOCK_SYNC_DELAY_MARGIN
+ * waited behind a long interrupt and is dropped. The drift is the change of the offset between two
+ * samples in ppm, averaged over the samples.
+ *
+ * Every accepted sample is traced as CLOCK_SYNC and CLOCK_OFFSET records. Host_Tools/src/trace_decode.c
+ * uses the CLOCK_OFFSET records to put the trace records of both ECUs on the time line of the HMI.
+ * The exchange is compiled out unless CLOCK_SYNC_ENABLE is set to 1, the Control ECU always answers.
+ */
+
+#ifndef CLOCK_SYNC_H_
+#define CLOCK_SYNC_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Clock synchronization configuration, its value should be 0 (disabled) or 1 (enabled) */
+#define CLOCK_SYNC_ENABLE           0
+
+#if((CLOCK_SYNC_ENABLE != 0) && (CLOCK_SYNC_ENABLE != 1))
+
+#error "CLOCK_SYNC_ENABLE should be equal to 0 or 1"
+
+#endif
+
+/* Time between two exchanges in milliseconds */
+#define CLOCK_SYNC_PERIOD           10000UL
+
+/*
+ * Time to wait for the answer of the Control ECU in milliseconds, it may send its profiler results
+ * on the link just before it reads the command.
+ */
+#define CLOCK_SYNC_TIMEOUT          1000UL
+
+/* Longest extra delay of an accepted sample over the shortest delay, in micro seconds */
+#define CLOCK_SYNC_DELAY_MARGIN     200UL
+
+/* Shortest time between two samples to measure the drift, in micro seconds */
+#define CLOCK_SYNC_DRIFT_SPAN       5000000UL
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+#if (CLOCK_SYNC_ENABLE == 1)
+
+/*
+ * Description :
+ * Add the four timestamps of one exchange, see above.
+ * returns: TRUE if the sample is accepted, FALSE if it is dropped for its long delay.
+ */
+boolean CLOCK_SYNC_addSample(uint32 t1, uint32 t2, uint32 t3, uint32 t4);
+
+/*
+ * Description :
+ * Return the timestamp of the Control ECU at the given timestamp of the HMI, from the offset of the
+ * last sample corrected by the drift. It returns the same timestamp before the first sample.
+ */
+uint32 CLOCK_SYNC_toControl(uint32 local_time);
+
+/*
+ * Description :
+ * Return the drift of the Control clock against the HMI clock in ppm, positive if it runs faster.
+ */
+sint32 CLOCK_SYNC_getDrift(void);
+
+#endif
+
+#endif /* CLOCK_SYNC_H_ */
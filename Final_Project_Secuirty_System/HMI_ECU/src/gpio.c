@@ -14,6 +14,7 @@
  * Description :
  * Setup the direction of the required pin input/output.
  * If the input port number or pin number are not correct, The function will not handle the request.
+ * The direction register is updated atomically.
  */
 void GPIO_setupPinDirection(uint8 port_num, uint8 pin_num, GPIO_PinDirectionType direction)
 {
@@ -28,50 +29,8 @@ void GPIO_setupPinDirection(uint8 port_num, uint8 pin_num, GPIO_PinDirectionType
 	}
 	else
 	{
-		/* Setup the pin direction as required */
-		switch(port_num)
-		{
-		case PORTA_ID:
-			if(direction == PIN_OUTPUT)
-			{
-				SET_BIT(DDRA,pin_num);
-			}
-			else
-			{
-				CLEAR_BIT(DDRA,pin_num);
-			}
-			break;
-		case PORTB_ID:
-			if(direction == PIN_OUTPUT)
-			{
-				SET_BIT(DDRB,pin_num);
-			}
-			else
-			{
-				CLEAR_BIT(DDRB,pin_num);
-			}
-			break;
-		case PORTC_ID:
-			if(direction == PIN_OUTPUT)
-			{
-				SET_BIT(DDRC,pin_num);
-			}
-			else
-			{
-				CLEAR_BIT(DDRC,pin_num);
-			}
-			break;
-		case PORTD_ID:
-			if(direction == PIN_OUTPUT)
-			{
-				SET_BIT(DDRD,pin_num);
-			}
-			else
-			{
-				CLEAR_BIT(DDRD,pin_num);
-			}
-			break;
-		}
+		/* Setup the pin direction as required, in one atomic update of the direction register */
+		GPIO_setupPortDirectionMasked(port_num, (uint8)(1 << pin_num), (direction == PIN_OUTPUT) ? 0xFF : 0x00);
 	}
 }
 
@@ -80,6 +39,7 @@ void GPIO_setupPinDirection(uint8 port_num, uint8 pin_num, GPIO_PinDirectionType
  * Write the value Logic High or Logic Low on the required pin.
  * If the input port number or pin number are not correct, The function will not handle the request.
  * If the pin is input, this function will enable/disable the internal pull-up resistor.
+ * The port register is updated atomically.
  */
 void GPIO_writePin(uint8 port_num, uint8 pin_num, uint8 value)
 {
@@ -94,50 +54,8 @@ void GPIO_writePin(uint8 port_num, uint8 pin_num, uint8 value)
 	}
 	else
 	{
-		/* Write the pin value as required */
-		switch(port_num)
-		{
-		case PORTA_ID:
-			if(value == LOGIC_HIGH)
-			{
-				SET_BIT(PORTA,pin_num);
-			}
-			else
-			{
-				CLEAR_BIT(PORTA,pin_num);
-			}
-			break;
-		case PORTB_ID:
-			if(value == LOGIC_HIGH)
-			{
-				SET_BIT(PORTB,pin_num);
-			}
-			else
-			{
-				CLEAR_BIT(PORTB,pin_num);
-			}
-			break;
-		case PORTC_ID:
-			if(value == LOGIC_HIGH)
-			{
-				SET_BIT(PORTC,pin_num);
-			}
-			else
-			{
-				CLEAR_BIT(PORTC,pin_num);
-			}
-			break;
-		case PORTD_ID:
-			if(value == LOGIC_HIGH)
-			{
-				SET_BIT(PORTD,pin_num);
-			}
-			else
-			{
-				CLEAR_BIT(PORTD,pin_num);
-			}
-			break;
-		}
+		/* Write the pin value as required, in one atomic update of the port register */
+		GPIO_writePortMasked(port_num, (uint8)(1 << pin_num), (value == LOGIC_HIGH) ? 0xFF : 0x00);
 	}
 }
 
@@ -325,3 +243,55 @@ uint8 GPIO_readPort(uint8 port_num)
 
 	return value;
 }
+
+/*
+ * Description :
+ * Setup the direction of the pins of the mask in one atomic update of the direction register:
+ * each pin of the mask is an output if its bit in direction is 1, the other pins are unchanged.
+ * If the input port number is not correct, The function will not handle the request.
+ */
+void GPIO_setupPortDirectionMasked(uint8 port_num, uint8 mask, uint8 direction)
+{
+	volatile uint8 * reg_ptr;
+
+	/*
+	 * Check if the input number is greater than NUM_OF_PORTS value.
+	 * In this case the input is not valid port number
+	 */
+	if(port_num >= NUM_OF_PORTS)
+	{
+		/* Do Nothing */
+	}
+	else
+	{
+		/* The register address is computed before the interrupts are masked */
+		reg_ptr = &GPIO_DDR_REGISTER(port_num);
+		GPIO_UPDATE_REGISTER(*reg_ptr, mask, direction);
+	}
+}
+
+/*
+ * Description :
+ * Write the pins of the mask in one atomic update of the port register: each pin of the mask takes
+ * its bit of the value, the other pins are unchanged, even if an ISR writes them at the same time.
+ * If the input port number is not correct, The function will not handle the request.
+ */
+void GPIO_writePortMasked(uint8 port_num, uint8 mask, uint8 value)
+{
+	volatile uint8 * reg_ptr;
+
+	/*
+	 * Check if the input number is greater than NUM_OF_PORTS value.
+	 * In this case the input is not valid port number
+	 */
+	if(port_num >= NUM_OF_PORTS)
+	{
+		/* Do Nothing */
+	}
+	else
+	{
+		/* The register address is computed before the interrupts are masked */
+		reg_ptr = &GPIO_PORT_REGISTER(port_num);
+		GPIO_UPDATE_REGISTER(*reg_ptr, mask, value);
+	}
+}
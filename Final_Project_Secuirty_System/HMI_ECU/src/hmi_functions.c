@@ -7,6 +7,18 @@
  * Description: This file contains the implementation of functions for the Human-Machine Interface (HMI)
  *              of an Electronic Control Unit (ECU). It includes initialization, password handling,
  *              command sending and receiving, and user interface interactions.
+ *              The user interface is a flat state machine: every transition is a row of a table kept
+ *              in flash, and one dispatcher runs them without waiting and without recursion, so the
+ *              stack used by the user interface is the same after any number of attempts.
+ *              The link with the Control ECU is a protothread called in turn with the dispatcher.
+ *              With KERNEL_ENABLE they run in their own tasks: the key events and the bytes of the
+ *              Control ECU reach them through kernel queues, and the end of each request of the user
+ *              interface comes back through a third one.
+ *              The screens are descriptors in flash too (text and position of each row, password
+ *              entry column, countdown column and display time), drawn by one function straight from
+ *              flash: their text takes no RAM, and a new screen is one more row of the screen table.
+ *              A countdown shows the seconds left of a timed screen, only its changed digit reaches
+ *              the LCD once per second.
  */
 
 #include "hmi_functions.h" /* HMI function prototypes */
@@ -14,9 +26,236 @@
 #include "keypad.h"        /* Keypad input functions */
 #include "std_types.h"     /* Standard data types */
 #include "uart.h"          /* UART communication functions */
-#include "timer1.h"        /* Timer1 control functions */
-#include <util/delay.h>    /* For the delay functions */
+#include "timer1.h"        /* Timer1 channels */
+#include "soft_timer.h"    /* System tick and software timers */
+#include "soft_uart.h"     /* Software UART debug channel */
+#include "profile.h"       /* Execution time profiler */
+#include "stack.h"         /* RAM high-water mark */
+#include "trace.h"         /* Binary trace logger */
+#include "clock_sync.h"    /* Clock synchronization with the Control ECU */
+#include "power.h"         /* Idle sleep and CPU duty cycle */
+#include "kernel.h"        /* Optional preemptive kernel */
 #include <avr/io.h>        /* For AVR device-specific IO definitions (SREG) */
+#include <avr/interrupt.h> /* For cli() */
+#include <avr/pgmspace.h>  /* For the transition table in flash */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Number of bytes the receive buffer (or with KERNEL_ENABLE the link queue) can hold, a power of two */
+#define LINK_RX_BUFFER_SIZE         16
+
+/* Number of key events the queue of the user interface task can hold */
+#define UI_KEY_QUEUE_SIZE           KEYPAD_FIFO_SIZE
+
+/* Time between two dumps of the profiler results and the RAM use on the debug channel */
+#define DEBUG_DUMP_PERIOD           10000UL
+
+/* Answer of the clock synchronization: SYNCING_CLOCK, then two timestamps of the Control ECU */
+#define LINK_SYNC_ANSWER_SIZE       9
+
+/* Key erasing the last digit of a password, held down it erases all of them */
+#define UI_ERASE_KEY                '*'
+
+/* Number of rows of the transition table */
+#define UI_TRANSITIONS_NUM          (sizeof(g_uiTransitions) / sizeof(g_uiTransitions[0]))
+
+/* Password entry column of a screen without password entry */
+#define UI_NO_PIN                   0xFF
+
+/* Countdown column of a screen without countdown, and the cells of the countdown */
+#define UI_NO_COUNT                 0xFF
+#define UI_COUNT_WIDTH              2
+
+/* Milliseconds of the screen times to seconds, at compile time */
+#define UI_SECONDS(time_ms)         ((time_ms) / 1000UL)
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum defining the requests of the user interface to the link thread */
+typedef enum
+{
+	LINK_IDLE,              /* No request */
+	LINK_RECEIVE,           /* Send READY and receive one result byte */
+	LINK_SEND               /* Send a command followed by the password(s) */
+} Link_Request;
+
+#if (KERNEL_ENABLE == 1)
+/* Enum defining the kinds of messages of the link queue */
+typedef enum
+{
+	LINK_MESSAGE_BYTE,      /* A byte from the Control ECU, sent by the UART receive interrupt */
+	LINK_MESSAGE_REQUEST    /* A request of the user interface, it only wakes the link task */
+} Link_MessageKind;
+
+/* Structure of a message of the link queue */
+typedef struct
+{
+	uint8 kind;             /* Link_MessageKind */
+	uint8 data;             /* The byte received, or the request */
+} Link_MessageType;
+#endif
+
+/* Enum defining the states of the user interface */
+typedef enum
+{
+	UI_WAIT_RESULT,         /* Waiting for the result of the last command from the Control ECU */
+	UI_SAVED,               /* Showing that the new password is saved */
+	UI_UNMATCH,             /* Showing that the two new passwords are different */
+	UI_CORRECT,             /* Showing that the password is correct before changing it */
+	UI_WRONG,               /* Showing that the password is wrong before taking it again */
+	UI_DOOR_OPENING,        /* Showing the door steps while the Control ECU moves the door */
+	UI_DOOR_HOLDING,
+	UI_DOOR_CLOSING,
+	UI_MENU,                /* Main menu shown, waiting for '+' or '-' */
+	UI_CHECK,               /* Counting an attempt before taking the password of a command */
+	UI_CHECK_ALARM,         /* Too many attempts, error shown before the main menu */
+	UI_NEW,                 /* Counting an attempt before taking a new password */
+	UI_NEW_ALARM,           /* Too many attempts, error shown before the new password */
+	UI_PIN_FIRST,           /* Taking the first new password */
+	UI_PIN_SECOND,          /* Taking the new password again */
+	UI_PIN_CHECK,           /* Taking the password of a command */
+	UI_SENDING              /* Link thread sending the command and the password(s) */
+} Ui_State;
+
+/* Enum defining the events of the user interface */
+typedef enum
+{
+	UI_EVENT_NONE,          /* Nothing happened */
+	UI_EVENT_NO_PASSWORD,   /* Results received from the Control ECU */
+	UI_EVENT_PASSWORD_FOUND,
+	UI_EVENT_SAVED,
+	UI_EVENT_UNMATCH,
+	UI_EVENT_MATCH_OPEN,
+	UI_EVENT_MATCH_CHANGE,
+	UI_EVENT_WRONG_OPEN,
+	UI_EVENT_WRONG_CHANGE,
+	UI_EVENT_UNKNOWN,       /* Result without meaning for the user interface */
+	UI_EVENT_SENT,          /* The link thread sent the command and the password(s) */
+	UI_EVENT_TIMEOUT,       /* The time of the current screen elapsed */
+	UI_EVENT_KEY_DIGIT,     /* Key presses from the keypad, the key is kept in g_key */
+	UI_EVENT_KEY_PLUS,
+	UI_EVENT_KEY_MINUS,
+	UI_EVENT_KEY_OTHER,
+	UI_EVENT_KEY_ERASE,     /* Erase key pressed or repeated */
+	UI_EVENT_KEY_CLEAR,     /* Erase key held down (long press) */
+	UI_EVENT_DONE,          /* Raised by an action: the step is complete */
+	UI_EVENT_ALARM          /* Raised by an action: the attempts are used up */
+} Ui_Event;
+
+/* Enum defining the screens, in the order of the screen table */
+typedef enum
+{
+	UI_SCREEN_SAVED,
+	UI_SCREEN_UNMATCH,
+	UI_SCREEN_CORRECT,
+	UI_SCREEN_WRONG,
+	UI_SCREEN_OPENING,
+	UI_SCREEN_HOLDING,
+	UI_SCREEN_CLOSING,
+	UI_SCREEN_MENU,
+	UI_SCREEN_ALARM,
+	UI_SCREEN_PIN_FIRST,
+	UI_SCREEN_PIN_SECOND,
+	UI_SCREENS_NUM
+} Ui_Screen;
+
+/* Structure of a screen, kept in flash */
+typedef struct
+{
+	char text[LCD_NUM_ROWS][LCD_NUM_COLS];  /* Text of each row, it ends at a null or at the end of the row */
+	uint8 column[LCD_NUM_ROWS];             /* Column of the first character of each row */
+	uint8 pin_column;                       /* Column of the first digit on the last row, or UI_NO_PIN */
+	uint8 count_column;                     /* Column of the seconds left on the last row, or UI_NO_COUNT */
+	uint8 seconds;                          /* Time the screen is kept in seconds, 0 until the next event */
+} Ui_ScreenType;
+
+/* Action of a transition, it runs after the state is changed and may raise the next event */
+typedef Ui_Event (*Ui_ActionType)(void);
+
+/* Structure of one row of the transition table */
+typedef struct
+{
+	uint8 state;            /* Current state */
+	uint8 event;            /* Event handled in this state */
+	uint8 next;             /* State after the transition */
+	Ui_ActionType action;   /* Action of the transition */
+} Ui_TransitionType;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* UART receive call back, keeps the received bytes for the link thread and wakes its task */
+static void Link_rxCallBack(uint8 data);
+
+/* Take the oldest received byte, returns FALSE if there is none */
+static boolean Link_getByte(uint8 * data_ptr);
+
+/* Return TRUE if a received byte (with KERNEL_ENABLE any message) waits for the link thread */
+static boolean Link_hasByte(void);
+
+/* Drop received bytes until READY, returns TRUE when READY is taken */
+static boolean Link_takeReady(void);
+
+#if (CLOCK_SYNC_ENABLE == 1)
+/* Return TRUE when the Control ECU waits for a command and the clock synchronization is due */
+static boolean Link_syncDue(void);
+
+/* Return a timestamp of the answer of the clock synchronization, low byte first */
+static uint32 Link_syncTimestamp(const uint8 * bytes_ptr);
+#endif
+
+/* Give a request to the link thread */
+static void Link_start(Link_Request request, uint8 command, uint8 passwords);
+
+/* Return the next event of the link, the screen timer or the keypad */
+static Ui_Event Ui_getEvent(void);
+
+/* Take the oldest key event, returns FALSE if there is none */
+static boolean Ui_getKey(KEYPAD_EventType * event_ptr);
+
+/* Drop the key events typed so far */
+static void Ui_flushKeys(void);
+
+/* Translate a result byte of the Control ECU to an event */
+static Ui_Event Ui_resultEvent(uint8 status);
+
+/* Keep the current screen for the required number of milliseconds */
+static void Ui_wait(uint32 delay_ms);
+
+/* Draw a screen of the screen table from flash, place the password entry and start its time */
+static void Ui_showScreen(Ui_Screen screen);
+
+/* Count the seconds left of the current screen down at each second */
+static void Ui_showCount(void);
+
+/* Actions of the transition table */
+static Ui_Event Ui_receiveResult(void);
+static Ui_Event Ui_showSaved(void);
+static Ui_Event Ui_showUnmatch(void);
+static Ui_Event Ui_showCorrect(void);
+static Ui_Event Ui_showWrongOpen(void);
+static Ui_Event Ui_showWrongChange(void);
+static Ui_Event Ui_showWrong(void);
+static Ui_Event Ui_showOpening(void);
+static Ui_Event Ui_showHolding(void);
+static Ui_Event Ui_showClosing(void);
+static Ui_Event Ui_showMenu(void);
+static Ui_Event Ui_selectOpen(void);
+static Ui_Event Ui_selectChange(void);
+static Ui_Event Ui_countAttempt(void);
+static Ui_Event Ui_showAlarm(void);
+static Ui_Event Ui_promptFirst(void);
+static Ui_Event Ui_promptSecond(void);
+static Ui_Event Ui_storeDigit(void);
+static Ui_Event Ui_eraseDigit(void);
+static Ui_Event Ui_clearDigits(void);
+static Ui_Event Ui_sendPasswords(void);
+static Ui_Event Ui_sendCheck(void);
 
 /*******************************************************************************
  *                          Global Variables                                   *
@@ -25,7 +264,157 @@
 /* Global variables for password storage and attempt tracking */
 uint8 g_firstPass[PASSWORD_SIZE] = {0};
 uint8 g_secondPass[PASSWORD_SIZE] = {0};
-uint8 g_attempt = 0, g_seconds = 0;
+uint8 g_attempt = 0;
+
+#if (KERNEL_ENABLE == 1)
+/*
+ * Bytes of the Control ECU and requests of the user interface for the link task, the key events for
+ * the user interface task, and the result of each request (the result byte, or 0 once sent) back
+ */
+static KERNEL_QueueType g_linkQueue;
+static Link_MessageType g_linkMessages[LINK_RX_BUFFER_SIZE];
+static KERNEL_QueueType g_keyQueue;
+static KEYPAD_EventType g_keyMessages[UI_KEY_QUEUE_SIZE];
+static KERNEL_QueueType g_resultQueue;
+static uint8 g_resultMessage;
+#else
+/* Bytes received from the Control ECU, written by the UART ISR and read by the link thread */
+static volatile uint8 g_rxBuffer[LINK_RX_BUFFER_SIZE];
+static volatile uint8 g_rxHead = 0;
+static volatile uint8 g_rxTail = 0;
+#endif
+
+/* Current request of the link thread and its parameters and result */
+static volatile Link_Request g_linkRequest = LINK_IDLE;
+static uint8 g_linkCommand;
+static uint8 g_linkPasswords;
+static uint8 g_linkIndex;
+static uint8 g_linkResult;
+
+/* TRUE if the Control ECU sent READY while no request was running */
+static boolean g_controlReady = FALSE;
+
+#if (CLOCK_SYNC_ENABLE == 1)
+/* Tick of the last clock synchronization, the answer and its timestamps */
+static uint32 g_syncTick = 0;
+static uint8 g_syncAnswer[LINK_SYNC_ANSWER_SIZE];
+static uint32 g_syncSent;
+static volatile uint32 g_syncReceived;
+
+/* TRUE while the receive interrupt has to take the timestamp of the next byte */
+static volatile boolean g_syncWaiting = FALSE;
+
+/* TRUE while the link thread waits for the answer of the clock synchronization */
+static boolean g_syncRunning = FALSE;
+#endif
+
+/* State of the user interface and the data of its actions */
+static Ui_State g_uiState = UI_WAIT_RESULT;
+static Link_Request g_uiLink = LINK_IDLE;
+static uint8 g_uiCommand;
+static uint32 g_uiDelay = 0;
+static uint32 g_waitStart;
+
+/* Timer without callback running for the time of the screen, it keeps the tick while the CPU sleeps */
+static SOFT_TIMER_Type g_uiTimer;
+static uint8 g_key;
+#if (PROFILE_ENABLE == 1)
+/* Timestamp of the press of g_key, for the time until the display shows it, and TRUE until it does */
+static uint32 g_keyTime;
+static boolean g_keyPending = FALSE;
+#endif
+static uint8 * g_pinBuffer;
+static uint8 g_pinIndex;
+static uint8 g_pinColumn;
+
+/* Countdown of the current screen: its column, the seconds shown and the tick of the next second */
+static uint8 g_countColumn = UI_NO_COUNT;
+static uint8 g_countSeconds;
+static uint32 g_countNext;
+
+#if ((SOFT_UART_ENABLE == 1) && ((PROFILE_ENABLE == 1) || (POWER_SLEEP_ENABLE == 1)))
+/* Tick of the last dump on the debug channel */
+static uint32 g_debugDumpTime = 0;
+#endif
+
+/*
+ * Screens of the user interface in the order of Ui_Screen. The text of a row ends at its first null
+ * or after LCD_NUM_COLS characters, the characters beyond the last column are not shown.
+ */
+static const Ui_ScreenType g_uiScreens[] PROGMEM =
+{
+	/* Text of the rows                          Columns  Password    Countdown    Time */
+	{{"PASSWORD SAVED",   "SUCCESSFULLY"},      {1, 2},  UI_NO_PIN,  UI_NO_COUNT, UI_SECONDS(TWO_SECONDS)},      /* UI_SCREEN_SAVED */
+	{{"PASSWORD UNMATCH", "TRY AGAIN"},         {0, 3},  UI_NO_PIN,  UI_NO_COUNT, UI_SECONDS(TWO_SECONDS)},      /* UI_SCREEN_UNMATCH */
+	{{"PASSWORD IS",      "CORRECT WELCOME"},   {2, 1},  UI_NO_PIN,  UI_NO_COUNT, UI_SECONDS(TWO_SECONDS)},      /* UI_SCREEN_CORRECT */
+	{{"PASSWORD ISN'T",   "CORRECT - RETRY"},   {1, 0},  UI_NO_PIN,  UI_NO_COUNT, UI_SECONDS(TWO_SECONDS)},      /* UI_SCREEN_WRONG */
+	{{"OPNING THE DOOR",  "SECONDS"},           {0, 7},  UI_NO_PIN,  4,           UI_SECONDS(FIFTEEN_SECONDS)},  /* UI_SCREEN_OPENING */
+	{{"HOLDING THE DOOR", "SECONDS"},           {0, 7},  UI_NO_PIN,  4,           UI_SECONDS(THREE_SECONDS)},    /* UI_SCREEN_HOLDING */
+	{{"CLOSING THE DOOR", "SECONDS"},           {0, 7},  UI_NO_PIN,  4,           UI_SECONDS(FIFTEEN_SECONDS)},  /* UI_SCREEN_CLOSING */
+	{{"+ : Open Door",    "- : Change Pass"},   {0, 0},  UI_NO_PIN,  UI_NO_COUNT, 0},                            /* UI_SCREEN_MENU */
+	{{"ERROR",            "SECONDS"},           {5, 7},  UI_NO_PIN,  4,           UI_SECONDS(ONE_MINUTE)},       /* UI_SCREEN_ALARM */
+	{{"plz enter pass:",  ""},                  {0, 0},  5,          UI_NO_COUNT, 0},                            /* UI_SCREEN_PIN_FIRST */
+	{{"plz re-enter the", "same pass:"},        {0, 0},  10,         UI_NO_COUNT, 0},                            /* UI_SCREEN_PIN_SECOND */
+};
+
+/* The screen table has one row per screen */
+typedef char Ui_CheckScreens[((sizeof(g_uiScreens) / sizeof(g_uiScreens[0])) == UI_SCREENS_NUM) ? 1 : -1];
+
+/*
+ * Transitions of the user interface, an event without a row in the current state is ignored.
+ * The rows of one state are kept together to read the table state by state.
+ */
+static const Ui_TransitionType g_uiTransitions[] PROGMEM =
+{
+	/* Results of the Control ECU */
+	{UI_WAIT_RESULT,        UI_EVENT_NO_PASSWORD,       UI_NEW,                 Ui_countAttempt},
+	{UI_WAIT_RESULT,        UI_EVENT_PASSWORD_FOUND,    UI_MENU,                Ui_showMenu},
+	{UI_WAIT_RESULT,        UI_EVENT_SAVED,             UI_SAVED,               Ui_showSaved},
+	{UI_WAIT_RESULT,        UI_EVENT_UNMATCH,           UI_UNMATCH,             Ui_showUnmatch},
+	{UI_WAIT_RESULT,        UI_EVENT_MATCH_OPEN,        UI_DOOR_OPENING,        Ui_showOpening},
+	{UI_WAIT_RESULT,        UI_EVENT_MATCH_CHANGE,      UI_CORRECT,             Ui_showCorrect},
+	{UI_WAIT_RESULT,        UI_EVENT_WRONG_OPEN,        UI_WRONG,               Ui_showWrongOpen},
+	{UI_WAIT_RESULT,        UI_EVENT_WRONG_CHANGE,      UI_WRONG,               Ui_showWrongChange},
+	{UI_WAIT_RESULT,        UI_EVENT_UNKNOWN,           UI_WAIT_RESULT,         Ui_receiveResult},
+
+	/* Result screens */
+	{UI_SAVED,              UI_EVENT_TIMEOUT,           UI_MENU,                Ui_showMenu},
+	{UI_UNMATCH,            UI_EVENT_TIMEOUT,           UI_NEW,                 Ui_countAttempt},
+	{UI_CORRECT,            UI_EVENT_TIMEOUT,           UI_NEW,                 Ui_countAttempt},
+	{UI_WRONG,              UI_EVENT_TIMEOUT,           UI_CHECK,               Ui_countAttempt},
+	{UI_DOOR_OPENING,       UI_EVENT_TIMEOUT,           UI_DOOR_HOLDING,        Ui_showHolding},
+	{UI_DOOR_HOLDING,       UI_EVENT_TIMEOUT,           UI_DOOR_CLOSING,        Ui_showClosing},
+	{UI_DOOR_CLOSING,       UI_EVENT_TIMEOUT,           UI_MENU,                Ui_showMenu},
+
+	/* Main menu, the other keys are ignored */
+	{UI_MENU,               UI_EVENT_KEY_PLUS,          UI_CHECK,               Ui_selectOpen},
+	{UI_MENU,               UI_EVENT_KEY_MINUS,         UI_CHECK,               Ui_selectChange},
+
+	/* Password of a command, the alarm comes first after too many attempts */
+	{UI_CHECK,              UI_EVENT_DONE,              UI_PIN_CHECK,           Ui_promptFirst},
+	{UI_CHECK,              UI_EVENT_ALARM,             UI_CHECK_ALARM,         Ui_showAlarm},
+	{UI_CHECK_ALARM,        UI_EVENT_TIMEOUT,           UI_MENU,                Ui_showMenu},
+	{UI_PIN_CHECK,          UI_EVENT_KEY_DIGIT,         UI_PIN_CHECK,           Ui_storeDigit},
+	{UI_PIN_CHECK,          UI_EVENT_KEY_ERASE,         UI_PIN_CHECK,           Ui_eraseDigit},
+	{UI_PIN_CHECK,          UI_EVENT_KEY_CLEAR,         UI_PIN_CHECK,           Ui_clearDigits},
+	{UI_PIN_CHECK,          UI_EVENT_DONE,              UI_SENDING,             Ui_sendCheck},
+
+	/* New password taken twice, the alarm comes first after too many attempts */
+	{UI_NEW,                UI_EVENT_DONE,              UI_PIN_FIRST,           Ui_promptFirst},
+	{UI_NEW,                UI_EVENT_ALARM,             UI_NEW_ALARM,           Ui_showAlarm},
+	{UI_NEW_ALARM,          UI_EVENT_TIMEOUT,           UI_PIN_FIRST,           Ui_promptFirst},
+	{UI_PIN_FIRST,          UI_EVENT_KEY_DIGIT,         UI_PIN_FIRST,           Ui_storeDigit},
+	{UI_PIN_FIRST,          UI_EVENT_KEY_ERASE,         UI_PIN_FIRST,           Ui_eraseDigit},
+	{UI_PIN_FIRST,          UI_EVENT_KEY_CLEAR,         UI_PIN_FIRST,           Ui_clearDigits},
+	{UI_PIN_FIRST,          UI_EVENT_DONE,              UI_PIN_SECOND,          Ui_promptSecond},
+	{UI_PIN_SECOND,         UI_EVENT_KEY_DIGIT,         UI_PIN_SECOND,          Ui_storeDigit},
+	{UI_PIN_SECOND,         UI_EVENT_KEY_ERASE,         UI_PIN_SECOND,          Ui_eraseDigit},
+	{UI_PIN_SECOND,         UI_EVENT_KEY_CLEAR,         UI_PIN_SECOND,          Ui_clearDigits},
+	{UI_PIN_SECOND,         UI_EVENT_DONE,              UI_SENDING,             Ui_sendPasswords},
+
+	/* Command sent, wait for its result */
+	{UI_SENDING,            UI_EVENT_SENT,              UI_WAIT_RESULT,         Ui_receiveResult},
+};
 
 /*******************************************************************************
  *                      Functions  Definitions                                 *
@@ -34,248 +423,830 @@ uint8 g_attempt = 0, g_seconds = 0;
 /* Function to initialize HMI components */
 void Init_Function (void)
 {
-	/* UART configuration structure */
-	UART_ConfigType uart = {EVEN_PARITY, ONE_STOP_BIT, EIGHT_BIT, 9600};
-
-	/* Initialize UART, LCD, and Timer1 with callback function */
-	UART_init(&uart);
+	/*
+	 * Initialize UART, LCD, Timer1 (1 MHz free-running counter) and the system tick. The
+	 * configurations of UART and Timer1 are in their headers.
+	 */
+	UART_init();
 	LCD_init();
-	TIMER1_setCallBack(Count_Seconds);
+	TIMER1_init();
+	SOFT_TIMER_init();
+	KEYPAD_init();
+#if (SOFT_UART_ENABLE == 1)
+	SOFT_UART_init();
+#endif
+#if (KERNEL_ENABLE == 1)
+	KERNEL_queueInit(&g_linkQueue, (uint8 *)g_linkMessages, sizeof(Link_MessageType), LINK_RX_BUFFER_SIZE);
+	KERNEL_queueInit(&g_keyQueue, (uint8 *)g_keyMessages, sizeof(KEYPAD_EventType), UI_KEY_QUEUE_SIZE);
+	KERNEL_queueInit(&g_resultQueue, &g_resultMessage, sizeof(uint8), 1);
+#endif
+
+	/* Every byte from the Control ECU is kept until the link thread needs it */
+	UART_setRxCallBack(Link_rxCallBack);
+
+	/* The user interface starts by waiting for the password status */
+	Ui_receiveResult();
 
 	/* Enable global interrupts */
 	SREG |= (1<<7);
 }
 
-/* Function to take the first password input from the user */
-void Take_firstPassword (void)
+#if (KERNEL_ENABLE == 1)
+/*
+ * Function to block the link task until its next message comes, or until the clock synchronization
+ * is due or its answer timed out
+ */
+void Link_wait(void)
 {
-	/* Local variables for keypad input and loop control */
-	uint8 number, i;
+	Link_MessageType message;
+	uint16 timeout = KERNEL_WAIT_FOREVER;
+#if (CLOCK_SYNC_ENABLE == 1)
+	uint32 elapsed = SOFT_TIMER_getTicks() - g_syncTick;
+	uint32 limit = g_syncRunning ? (CLOCK_SYNC_TIMEOUT + 1) : CLOCK_SYNC_PERIOD;
 
-	/* Clear the LCD and prompt for password input */
-	LCD_clearScreen();
-	LCD_displayString("plz enter pass:");
-	LCD_moveCursor(1,5);
+	if (g_syncRunning || (g_controlReady && (g_linkRequest == LINK_IDLE)))
+	{
+		timeout = (elapsed < limit) ? (uint16)(limit - elapsed) : 1;
+	}
+#endif
 
-	/* Loop to read PASSWORD_SIZE digits from the keypad */
-	for (i = 0; i < PASSWORD_SIZE; i++)
+	/* The message stays in the queue for the link thread */
+	(void)KERNEL_queuePeek(&g_linkQueue, &message, timeout);
+}
+
+/* Function to hand the key events to the user interface task, called by the task of the drivers */
+void Ui_forwardKeys(void)
+{
+	KEYPAD_EventType key_event;
+
+	/* An event beyond the queue is lost, as one beyond the FIFO of the keypad */
+	while (KEYPAD_getEvent(&key_event))
 	{
-		/* Get a single digit and validate it */
-		number = KEYPAD_getPressedKey();
-		while(number > 9 )
+		(void)KERNEL_queueSend(&g_keyQueue, &key_event, 0);
+	}
+}
+
+/*
+ * Function to block the user interface task until its next event: the end of its request to the
+ * link task, or a key event, the end of the kept screen or the next second of its countdown
+ */
+void Ui_waitEvent(void)
+{
+	KEYPAD_EventType key_event;
+	uint8 result;
+	uint16 timeout = KERNEL_WAIT_FOREVER;
+	uint32 elapsed;
+	sint32 count_left;
+
+	if (g_uiDelay != 0)
+	{
+		elapsed = SOFT_TIMER_getTicks() - g_waitStart;
+		timeout = (elapsed < g_uiDelay) ? (uint16)(g_uiDelay - elapsed) : 0;
+	}
+	if ((g_countColumn != UI_NO_COUNT) && (g_countSeconds != 0))
+	{
+		count_left = (sint32)(g_countNext - SOFT_TIMER_getTicks());
+		if (count_left < (sint32)timeout)
 		{
-			number = KEYPAD_getPressedKey();
+			timeout = (count_left > 0) ? (uint16)count_left : 0;
 		}
-		/* Store the digit and display an asterisk */
-		g_firstPass[i] = number;
-		LCD_displayCharacter('*');
-		_delay_ms(500);
+	}
+#if (PROFILE_ENABLE == 1)
+	/* The drain of the key shown is checked at each tick */
+	if (g_keyPending && (timeout > 1))
+	{
+		timeout = 1;
+	}
+#endif
+
+	/* While a request runs the keys stay in their queue, the message stays for Ui_getEvent */
+	if (g_uiLink != LINK_IDLE)
+	{
+		(void)KERNEL_queuePeek(&g_resultQueue, &result, timeout);
+	}
+	else
+	{
+		(void)KERNEL_queuePeek(&g_keyQueue, &key_event, timeout);
 	}
 }
+#endif
 
-/* Function to take the second password input for confirmation */
-void Take_secondPassword (void)
+/* Thread running the link with the Control ECU */
+PT_Status Link_thread(PT_Type * pt)
 {
-	/* Local variables for keypad input and loop control */
-	uint8 number, i;
+	uint8 data;
 
-	/* Clear the LCD and prompt for password re-entry */
-	LCD_clearScreen();
-	LCD_displayString("plz re-enter the");
-	LCD_displaySringRowColumn("same pass:", 1, 0);
+	PT_BEGIN(pt);
+
+	while (1)
+	{
+		/* A READY byte between requests means the Control ECU waits for a command */
+#if (CLOCK_SYNC_ENABLE == 1)
+		PT_WAIT_UNTIL(pt, (g_linkRequest != LINK_IDLE) || Link_hasByte() || Link_syncDue());
+#else
+		PT_WAIT_UNTIL(pt, (g_linkRequest != LINK_IDLE) || Link_hasByte());
+#endif
+		if (g_linkRequest == LINK_IDLE)
+		{
+#if (CLOCK_SYNC_ENABLE == 1)
+			if (Link_syncDue())
+			{
+				/* The receive interrupt takes the timestamp of the SYNCING_CLOCK byte of the answer */
+				g_controlReady = FALSE;
+				g_syncTick = SOFT_TIMER_getTicks();
+				g_syncWaiting = TRUE;
+				g_syncRunning = TRUE;
+				UART_sendByte(SYNCING_CLOCK);
+				g_syncSent = TIMER1_getTimestamp();
+
+				/* The Control ECU may send its debug text first, it never contains SYNCING_CLOCK */
+				g_linkIndex = 0;
+				while (g_linkIndex < LINK_SYNC_ANSWER_SIZE)
+				{
+					PT_WAIT_UNTIL(pt, Link_getByte(&g_syncAnswer[g_linkIndex]) ||
+							((SOFT_TIMER_getTicks() - g_syncTick) > CLOCK_SYNC_TIMEOUT));
+					if ((SOFT_TIMER_getTicks() - g_syncTick) > CLOCK_SYNC_TIMEOUT)
+					{
+						break;
+					}
+					if ((g_linkIndex > 0) || (g_syncAnswer[0] == SYNCING_CLOCK))
+					{
+						g_linkIndex++;
+					}
+				}
+				g_syncRunning = FALSE;
+
+				if (g_linkIndex == LINK_SYNC_ANSWER_SIZE)
+				{
+					CLOCK_SYNC_addSample(g_syncSent, Link_syncTimestamp(&g_syncAnswer[1]),
+							Link_syncTimestamp(&g_syncAnswer[5]), g_syncReceived);
+				}
+				else if (g_linkIndex == 0)
+				{
+					/* No answer, the Control ECU ignored the command and still waits for one */
+					g_syncWaiting = FALSE;
+					g_controlReady = TRUE;
+				}
+				continue;
+			}
+#endif
+			if (Link_getByte(&data) && (data == READY_TO_RECEVIE))
+			{
+				g_controlReady = TRUE;
+				TRACE0(CONTROL_READY);
+			}
+			continue;
+		}
+
+		/* The result stays 0 for a request that only sends */
+		g_linkResult = 0;
+
+		if (g_linkRequest == LINK_RECEIVE)
+		{
+			/* Send ready signal and receive a command */
+			UART_sendByte(READY_TO_RECEVIE);
+			PT_WAIT_UNTIL(pt, Link_getByte(&g_linkResult));
+			TRACE1(LINK_RESULT, g_linkResult);
+		}
+		else
+		{
+			/* Wait for control ECU to be ready, then send the command */
+			PT_WAIT_UNTIL(pt, Link_takeReady());
+			UART_sendByte(g_linkCommand);
+			TRACE1(LINK_COMMAND, g_linkCommand);
+
+			/* Wait for control ECU to be ready before each password */
+			for (g_linkIndex = 0; g_linkIndex < g_linkPasswords; g_linkIndex++)
+			{
+				PT_WAIT_UNTIL(pt, Link_takeReady());
+				UART_sendData((g_linkIndex == 0) ? g_firstPass : g_secondPass, PASSWORD_SIZE);
+			}
+		}
+
+		g_linkRequest = LINK_IDLE;
+#if (KERNEL_ENABLE == 1)
+		/* The user interface task waits for the end of its request, it never holds more than one */
+		(void)KERNEL_queueSend(&g_resultQueue, &g_linkResult, KERNEL_WAIT_FOREVER);
+#endif
+	}
 
-	/* Loop to read PASSWORD_SIZE digits from the keypad */
-	for (i = 0; i < PASSWORD_SIZE; i++)
+	PT_END(pt);
+}
+
+/* Run the transitions of the user interface */
+void Ui_dispatch(void)
+{
+	const Ui_TransitionType * row_ptr;
+	Ui_ActionType action;
+	Ui_Event event = Ui_getEvent();
+	uint8 i;
+#if (PROFILE_ENABLE == 1)
+	boolean key_event = (event >= UI_EVENT_KEY_DIGIT) && (event <= UI_EVENT_KEY_CLEAR);
+	boolean key_handled = FALSE;
+#endif
+
+	/* An action may raise the next event, it is handled in this same loop */
+	while (event != UI_EVENT_NONE)
 	{
-		/* Get a single digit and validate it */
-		number = KEYPAD_getPressedKey();
-		while(number > 9 )
+		row_ptr = NULL_PTR;
+		for (i = 0; i < UI_TRANSITIONS_NUM; i++)
 		{
-			number = KEYPAD_getPressedKey();
+			if ((pgm_read_byte(&g_uiTransitions[i].state) == g_uiState) &&
+				(pgm_read_byte(&g_uiTransitions[i].event) == event))
+			{
+				row_ptr = &g_uiTransitions[i];
+				break;
+			}
+		}
+
+		/* No transition for this event in the current state */
+		if (row_ptr == NULL_PTR)
+		{
+			break;
 		}
-		/* Store the digit and display an asterisk */
-		g_secondPass[i] = number;
-		LCD_displayCharacter('*');
-		_delay_ms(500);
+
+		TRACE2(UI_TRANSITION, g_uiState, event);
+		g_uiState = (Ui_State)pgm_read_byte(&row_ptr->next);
+		action = (Ui_ActionType)pgm_read_ptr(&row_ptr->action);
+		event = action();
+#if (PROFILE_ENABLE == 1)
+		key_handled = key_handled || key_event;
+#endif
+	}
+
+	/* The actions draw in the shadow of the LCD, the changed cells are sent once at the end */
+	Ui_showCount();
+	LCD_flush();
+
+#if (PROFILE_ENABLE == 1)
+	/* The drain sends the changed cells to the LCD, the display shows the key when the drain stops */
+	g_keyPending = g_keyPending || key_handled;
+	if (g_keyPending && LCD_isIdle())
+	{
+		PROFILE_record(PROFILE_KEY_TO_DISPLAY, TIMER1_getTimestamp() - g_keyTime);
+		g_keyPending = FALSE;
+	}
+#endif
+}
+
+#if (KERNEL_ENABLE == 0)
+/*
+ * Return TRUE if the main loop has work left: a byte of the Control ECU, a key event, or the end of
+ * a request of the user interface, finished by the link thread after the user interface ran
+ */
+boolean Ui_isPending(void)
+{
+	return Link_hasByte() || KEYPAD_hasEvent() ||
+			((g_uiLink != LINK_IDLE) && (g_linkRequest == LINK_IDLE));
+}
+#endif
+
+/* Send the debug text on the software UART, called in turn with the user interface */
+void Debug_output(void)
+{
+#if (SOFT_UART_ENABLE == 1)
+#if (TRACE_ENABLE == 1)
+	/* One record per call, so the user interface waits one line at most */
+	if (TRACE_drain(SOFT_UART_sendByte))
+	{
+		return;
+	}
+#endif
+#if ((PROFILE_ENABLE == 1) || (POWER_SLEEP_ENABLE == 1))
+	if ((SOFT_TIMER_getTicks() - g_debugDumpTime) >= DEBUG_DUMP_PERIOD)
+	{
+		g_debugDumpTime = SOFT_TIMER_getTicks();
+#if (PROFILE_ENABLE == 1)
+		PROFILE_dump(SOFT_UART_sendByte);
+		STACK_dump(SOFT_UART_sendByte);
+#if (KERNEL_ENABLE == 1)
+		KERNEL_dump(SOFT_UART_sendByte);
+#endif
+#endif
+#if (POWER_SLEEP_ENABLE == 1)
+		POWER_dump(SOFT_UART_sendByte);
+#endif
 	}
+#endif
+#endif
 }
 
-/* Function to send both entered passwords to the control ECU */
-void send_Password(void)
+/* Return the next event of the link, the screen timer or the keypad */
+static Ui_Event Ui_getEvent(void)
 {
-	/* Wait for control ECU to be ready, then send first password */
-	while(UART_recieveByte() != READY_TO_RECEVIE);
-	UART_sendData(g_firstPass, PASSWORD_SIZE);
+	Link_Request request;
+	KEYPAD_EventType key_event;
+	uint8 result;
+
+	/* A request of the user interface is finished when the link thread is idle again */
+	if (g_uiLink != LINK_IDLE)
+	{
+#if (KERNEL_ENABLE == 1)
+		if (!KERNEL_queueReceive(&g_resultQueue, &result, 0))
+		{
+			return UI_EVENT_NONE;
+		}
+#else
+		if (g_linkRequest != LINK_IDLE)
+		{
+			return UI_EVENT_NONE;
+		}
+		result = g_linkResult;
+#endif
+		request = g_uiLink;
+		g_uiLink = LINK_IDLE;
+		return (request == LINK_RECEIVE) ? Ui_resultEvent(result) : UI_EVENT_SENT;
+	}
+
+	/* The keys typed while a screen is kept are not meant for the next screen, they are dropped at once */
+	if (g_uiDelay != 0)
+	{
+		Ui_flushKeys();
+		if ((SOFT_TIMER_getTicks() - g_waitStart) < g_uiDelay)
+		{
+			return UI_EVENT_NONE;
+		}
+		g_uiDelay = 0;
+		return UI_EVENT_TIMEOUT;
+	}
+
+	/*
+	 * The keys typed ahead wait in the FIFO of the keypad. The presses are used, and the repeats and
+	 * the long press of the erase key, the other events are skipped.
+	 */
+	do
+	{
+		if (!Ui_getKey(&key_event))
+		{
+			return UI_EVENT_NONE;
+		}
+	} while ((key_event.kind != KEYPAD_PRESS) &&
+			((key_event.key != UI_ERASE_KEY) || ((key_event.kind != KEYPAD_REPEAT) && (key_event.kind != KEYPAD_LONG_PRESS))));
+
+	g_key = key_event.key;
+#if (PROFILE_ENABLE == 1)
+	g_keyTime = key_event.time;
+#endif
+	TRACE2(KEY, g_key, key_event.kind);
+	if (g_key == UI_ERASE_KEY)
+	{
+		return (key_event.kind == KEYPAD_LONG_PRESS) ? UI_EVENT_KEY_CLEAR : UI_EVENT_KEY_ERASE;
+	}
+	else if (g_key <= 9)
+	{
+		return UI_EVENT_KEY_DIGIT;
+	}
+	else if (g_key == '+')
+	{
+		return UI_EVENT_KEY_PLUS;
+	}
+	else if (g_key == '-')
+	{
+		return UI_EVENT_KEY_MINUS;
+	}
+	else
+	{
+		return UI_EVENT_KEY_OTHER;
+	}
+}
 
-	/* Wait for control ECU to be ready, then send second password */
-	while(UART_recieveByte() != READY_TO_RECEVIE);
-	UART_sendData(g_secondPass, PASSWORD_SIZE);
+/* Take the oldest key event, from the keypad or with KERNEL_ENABLE from the queue of the task */
+static boolean Ui_getKey(KEYPAD_EventType * event_ptr)
+{
+#if (KERNEL_ENABLE == 1)
+	return KERNEL_queueReceive(&g_keyQueue, event_ptr, 0);
+#else
+	return KEYPAD_getEvent(event_ptr);
+#endif
 }
 
-/* Function to receive a command from the control ECU */
-uint8 receive_command(void)
+/* Drop the key events typed so far */
+static void Ui_flushKeys(void)
 {
-	/* Local variable to store the received command */
-	uint8 response;
+#if (KERNEL_ENABLE == 1)
+	KEYPAD_EventType key_event;
 
-	/* Send ready signal and receive a command */
-	UART_sendByte(READY_TO_RECEVIE);
-	response = UART_recieveByte();
-	return response;
+	while (KERNEL_queueReceive(&g_keyQueue, &key_event, 0));
+#else
+	KEYPAD_flush();
+#endif
 }
 
-/* Function to send a command to the control ECU */
-void send_command(uint8 command)
+/* Translate a result byte of the Control ECU to an event */
+static Ui_Event Ui_resultEvent(uint8 status)
 {
-	/* Wait for control ECU to be ready, then send the command */
-	while(UART_recieveByte() != READY_TO_RECEVIE);
-	UART_sendByte(command);
+	switch (status)
+	{
+		case NO_PASSWORD_FOUND:
+			return UI_EVENT_NO_PASSWORD;
+		case PASSWORD_FOUND:
+			return UI_EVENT_PASSWORD_FOUND;
+		case PASSWORDS_MATCH:
+			return UI_EVENT_SAVED;
+		case PASSWORDS_UNMATCH:
+			return UI_EVENT_UNMATCH;
+		case PASSWORD_MATCH_OPEN:
+			return UI_EVENT_MATCH_OPEN;
+		case PASSWORD_MATCH_CHANGE:
+			return UI_EVENT_MATCH_CHANGE;
+		case PASSWORD_UNMATCH_OPEN:
+			return UI_EVENT_WRONG_OPEN;
+		case PASSWORD_UNMATCH_CHANGE:
+			return UI_EVENT_WRONG_CHANGE;
+		default:
+			return UI_EVENT_UNKNOWN;
+	}
 }
 
-/* Function to display the main menu and handle user selection */
-void Main_Menu (void)
+/* Keep the current screen for the required number of milliseconds */
+static void Ui_wait(uint32 delay_ms)
 {
-	/* Local variable to store the user's menu selection */
-	uint8 option;
+	g_waitStart = SOFT_TIMER_getTicks();
+	g_uiDelay = delay_ms;
+
+	/* The end of the screen and its countdown are polled on the tick, it must keep running */
+	SOFT_TIMER_start(&g_uiTimer, delay_ms, 0, NULL_PTR);
+}
+
+/* Draw a screen of the screen table from flash, place the password entry and start its time */
+static void Ui_showScreen(Ui_Screen screen)
+{
+	const Ui_ScreenType * screen_ptr = &g_uiScreens[screen];
+	uint8 row, i;
+	char character;
+	uint8 seconds;
 
-	/* Clear the LCD and display menu options */
 	LCD_clearScreen();
-	LCD_displayString("+ : Open Door");
-	LCD_displaySringRowColumn("- : Change Pass", 1, 0);
+	for (row = 0; row < LCD_NUM_ROWS; row++)
+	{
+		LCD_moveCursor(row, pgm_read_byte(&screen_ptr->column[row]));
+		for (i = 0; i < LCD_NUM_COLS; i++)
+		{
+			character = pgm_read_byte(&screen_ptr->text[row][i]);
+			if (character == '\0')
+			{
+				break;
+			}
+			LCD_displayCharacter(character);
+		}
+	}
 
-	/* Get the user's selection and validate it */
-	option = KEYPAD_getPressedKey();
-	_delay_ms(500);
-	while (option != '+' && option != '-')
+	/* The digits of a password are entered on the last row */
+	g_pinColumn = pgm_read_byte(&screen_ptr->pin_column);
+	if (g_pinColumn != UI_NO_PIN)
 	{
-		option = KEYPAD_getPressedKey();
+		LCD_moveCursor(LCD_NUM_ROWS - 1, g_pinColumn);
 	}
 
-	/* Handle the selected option */
-	switch (option)
+	seconds = pgm_read_byte(&screen_ptr->seconds);
+	if (seconds != 0)
 	{
-		case '+':
-			Checking_Password(OPEN_DOOR);
-			break;
-		case '-':
-			Checking_Password(CHANGING_PASSWORD);
+		Ui_wait(seconds * 1000UL);
+	}
+
+	/* The countdown starts with the whole time of the screen */
+	g_countColumn = pgm_read_byte(&screen_ptr->count_column);
+	if (g_countColumn != UI_NO_COUNT)
+	{
+		g_countSeconds = seconds;
+		g_countNext = g_waitStart + 1000UL;
+		LCD_moveCursor(LCD_NUM_ROWS - 1, g_countColumn);
+		LCD_displayNumber(g_countSeconds, UI_COUNT_WIDTH);
 	}
 }
 
-/* Function to initiate the password change process */
-void Change_Password (void)
+/*
+ * Count the seconds left of the current screen down at each second: the number is drawn again in
+ * the shadow, and the flush sends only the digit cells that changed
+ */
+static void Ui_showCount(void)
 {
-	Taking_newPassword();
+	/* The second boundaries are kept in ticks, no division, and compared across the wrap */
+	if ((g_countColumn == UI_NO_COUNT) || (g_countSeconds == 0) ||
+		((sint32)(SOFT_TIMER_getTicks() - g_countNext) < 0))
+	{
+		return;
+	}
+
+	g_countSeconds--;
+	g_countNext += 1000UL;
+	LCD_moveCursor(LCD_NUM_ROWS - 1, g_countColumn);
+	LCD_displayNumber(g_countSeconds, UI_COUNT_WIDTH);
 }
 
-/* Function to handle new password entry and send it to the control ECU */
-void Taking_newPassword (void)
+/* Ask the link thread for the result of the last command, or the password status at start-up */
+static Ui_Event Ui_receiveResult(void)
 {
-	/* Increment the attempt counter */
-	g_attempt++;
+	g_uiLink = LINK_RECEIVE;
+	Link_start(LINK_RECEIVE, 0, 0);
+	return UI_EVENT_NONE;
+}
 
-	/* If maximum attempts reached, trigger the alarm and reset */
-	if (g_attempt == 5)
+/* New password saved by the Control ECU */
+static Ui_Event Ui_showSaved(void)
+{
+	Ui_showScreen(UI_SCREEN_SAVED); 	/* Display success message for two seconds */
+	g_attempt = ZERO_ATTEMPTS; 			/* Reset password attempt counter */
+	return UI_EVENT_NONE;
+}
+
+/* The two new passwords are different */
+static Ui_Event Ui_showUnmatch(void)
+{
+	LCD_clearScreen(); 				/* Clear the LCD screen */
+
+	/* The alarm comes next after maximum attempts, skip the message */
+	if (g_attempt == MAX_ATTEMPTS)
 	{
-		Alarm();
-		g_attempt = ZERO_ATTEMPTS;
-		Take_firstPassword();
-		Take_secondPassword();
-		send_command(SENDING_PASSWORDS);
-		send_Password();
+		return UI_EVENT_TIMEOUT;
 	}
-	else
+
+	Ui_showScreen(UI_SCREEN_UNMATCH); 	/* Display error message for two seconds */
+	return UI_EVENT_NONE;
+}
+
+/* Password correct, the new password is taken next */
+static Ui_Event Ui_showCorrect(void)
+{
+	Ui_showScreen(UI_SCREEN_CORRECT); 	/* Display confirmation message for two seconds */
+	g_attempt = ZERO_ATTEMPTS; 			/* Reset password attempt counter */
+	return UI_EVENT_NONE;
+}
+
+/* Password wrong for opening the door, it is checked again for the same command */
+static Ui_Event Ui_showWrongOpen(void)
+{
+	g_uiCommand = CHECKING_PASSWORD_OPEN;
+	return Ui_showWrong();
+}
+
+/* Password wrong for changing it, it is checked again for the same command */
+static Ui_Event Ui_showWrongChange(void)
+{
+	g_uiCommand = CHECKING_PASSWORD_CHANGE;
+	return Ui_showWrong();
+}
+
+/* Message of a wrong password */
+static Ui_Event Ui_showWrong(void)
+{
+	LCD_clearScreen(); 											/* Clear the LCD screen */
+
+	/* The alarm comes next after maximum attempts, skip the message */
+	if (g_attempt == MAX_ATTEMPTS)
 	{
-		/* Otherwise, take new password entries and send them */
-		Take_firstPassword();
-		Take_secondPassword();
-		send_command(SENDING_PASSWORDS);
-		send_Password();
+		return UI_EVENT_TIMEOUT;
 	}
+
+	Ui_showScreen(UI_SCREEN_WRONG); 	/* Display error message for two seconds */
+	return UI_EVENT_NONE;
+}
+
+/* Password correct for opening the door, show the door steps while the Control ECU moves it */
+static Ui_Event Ui_showOpening(void)
+{
+	g_attempt = ZERO_ATTEMPTS; 	/* Reset password attempt counter */
+	Ui_showScreen(UI_SCREEN_OPENING);
+	return UI_EVENT_NONE;
 }
 
-/* Function to check the entered password based on the given command */
-void Checking_Password(uint8 command)
+static Ui_Event Ui_showHolding(void)
+{
+	Ui_showScreen(UI_SCREEN_HOLDING);
+	return UI_EVENT_NONE;
+}
+
+static Ui_Event Ui_showClosing(void)
+{
+	Ui_showScreen(UI_SCREEN_CLOSING);
+	return UI_EVENT_NONE;
+}
+
+/* Clear the LCD and display menu options */
+static Ui_Event Ui_showMenu(void)
+{
+	Ui_showScreen(UI_SCREEN_MENU);
+	return UI_EVENT_NONE;
+}
+
+/* Check the password before opening the door */
+static Ui_Event Ui_selectOpen(void)
+{
+	g_uiCommand = CHECKING_PASSWORD_OPEN;
+	return Ui_countAttempt();
+}
+
+/* Check the password before changing it */
+static Ui_Event Ui_selectChange(void)
+{
+	g_uiCommand = CHECKING_PASSWORD_CHANGE;
+	return Ui_countAttempt();
+}
+
+/* Increment the attempt counter, the alarm is raised when maximum attempts are passed */
+static Ui_Event Ui_countAttempt(void)
 {
-	/* Increment the attempt counter */
 	g_attempt++;
+	return (g_attempt == (MAX_ATTEMPTS + 1)) ? UI_EVENT_ALARM : UI_EVENT_DONE;
+}
+
+/* Show the error for one minute and start counting the attempts again */
+static Ui_Event Ui_showAlarm(void)
+{
+	Ui_showScreen(UI_SCREEN_ALARM);
+	g_attempt = ZERO_ATTEMPTS;
+	return UI_EVENT_NONE;
+}
 
-	/* If maximum attempts reached, trigger the alarm and return to main menu */
-	if (g_attempt == 5)
+/* Take the first new password */
+static Ui_Event Ui_promptFirst(void)
+{
+	Ui_showScreen(UI_SCREEN_PIN_FIRST);
+	g_pinBuffer = g_firstPass;
+	g_pinIndex = 0;
+	return UI_EVENT_NONE;
+}
+
+/* Take the new password again */
+static Ui_Event Ui_promptSecond(void)
+{
+	Ui_showScreen(UI_SCREEN_PIN_SECOND);
+	g_pinBuffer = g_secondPass;
+	g_pinIndex = 0;
+	return UI_EVENT_NONE;
+}
+
+/* Store the digit and display an asterisk, the password is complete after PASSWORD_SIZE digits */
+static Ui_Event Ui_storeDigit(void)
+{
+	g_pinBuffer[g_pinIndex] = g_key;
+	g_pinIndex++;
+	LCD_displayCharacter('*');
+	return (g_pinIndex == PASSWORD_SIZE) ? UI_EVENT_DONE : UI_EVENT_NONE;
+}
+
+/* Erase the last digit and its asterisk */
+static Ui_Event Ui_eraseDigit(void)
+{
+	if (g_pinIndex > 0)
 	{
-		Alarm();
-		g_attempt = ZERO_ATTEMPTS;
-		Main_Menu();
+		g_pinIndex--;
+		LCD_moveCursor(LCD_NUM_ROWS - 1, g_pinColumn + g_pinIndex);
+		LCD_displayCharacter(' ');
+		LCD_moveCursor(LCD_NUM_ROWS - 1, g_pinColumn + g_pinIndex);
 	}
-	else
+	return UI_EVENT_NONE;
+}
+
+/* Erase all the digits and their asterisks */
+static Ui_Event Ui_clearDigits(void)
+{
+	while (g_pinIndex > 0)
+	{
+		Ui_eraseDigit();
+	}
+	return UI_EVENT_NONE;
+}
+
+/* Send the new password twice to the Control ECU */
+static Ui_Event Ui_sendPasswords(void)
+{
+	g_uiLink = LINK_SEND;
+	Link_start(LINK_SEND, SENDING_PASSWORDS, 2);
+	return UI_EVENT_NONE;
+}
+
+/* Send the command and its password to the Control ECU */
+static Ui_Event Ui_sendCheck(void)
+{
+	g_uiLink = LINK_SEND;
+	Link_start(LINK_SEND, g_uiCommand, 1);
+	return UI_EVENT_NONE;
+}
+
+/* UART receive call back, keeps the received bytes for the link thread and wakes its task */
+static void Link_rxCallBack(uint8 data)
+{
+#if (CLOCK_SYNC_ENABLE == 1)
+	if (g_syncWaiting && (data == SYNCING_CLOCK))
 	{
-		/* Otherwise, take the password and send the command for verification */
-		Take_firstPassword();
+		g_syncReceived = TIMER1_getTimestamp();
+		g_syncWaiting = FALSE;
+	}
+#endif
 
-		/* Send the appropriate command based on the action to be taken */
-		switch(command)
+#if (KERNEL_ENABLE == 1)
+	Link_MessageType message;
+
+	/* Last, the link task may run at once from here. A byte beyond the queue is lost */
+	message.kind = LINK_MESSAGE_BYTE;
+	message.data = data;
+	(void)KERNEL_queueSend(&g_linkQueue, &message, 0);
+#else
+	/* The indices run freely, their difference is the number of kept bytes */
+	if ((uint8)(g_rxHead - g_rxTail) < LINK_RX_BUFFER_SIZE)
+	{
+		g_rxBuffer[g_rxHead & (LINK_RX_BUFFER_SIZE - 1)] = data;
+		g_rxHead++;
+	}
+#endif
+}
+
+/* Take the oldest received byte, returns FALSE if there is none */
+static boolean Link_getByte(uint8 * data_ptr)
+{
+#if (KERNEL_ENABLE == 1)
+	Link_MessageType message;
+
+	/* The requests only woke the link task, the thread reads them from g_linkRequest */
+	while (KERNEL_queueReceive(&g_linkQueue, &message, 0))
+	{
+		if (message.kind == LINK_MESSAGE_BYTE)
 		{
-			case OPEN_DOOR:
-				send_command(CHECKING_PASSWORD_OPEN);
-				break;
-			case CHANGING_PASSWORD:
-				send_command(CHECKING_PASSWORD_CHANGE);
-				break;
+			*data_ptr = message.data;
+			return TRUE;
 		}
-		/* Wait for control ECU to be ready, then send the entered password */
-		while(UART_recieveByte() != READY_TO_RECEVIE);
-		UART_sendData(g_firstPass, PASSWORD_SIZE);
 	}
+	return FALSE;
+#else
+	boolean available = FALSE;
+	uint8 sreg = SREG;
+	cli();
+
+	if (g_rxHead != g_rxTail)
+	{
+		*data_ptr = g_rxBuffer[g_rxTail & (LINK_RX_BUFFER_SIZE - 1)];
+		g_rxTail++;
+		available = TRUE;
+	}
+
+	SREG = sreg;
+	return available;
+#endif
 }
 
-/* Function to simulate the door opening process */
-void Open_Door(void)
+/* Return TRUE if a received byte (with KERNEL_ENABLE any message) waits for the link thread */
+static boolean Link_hasByte(void)
 {
-	/* Clear the LCD and display the door opening message */
-	LCD_clearScreen();
-	LCD_displayString("OPNING THE DOOR");
-	Timer1_countSeconds(FIFTEEN_SECONDS);
+#if (KERNEL_ENABLE == 1)
+	Link_MessageType message;
 
-	/* Display the door holding message */
-	LCD_clearScreen();
-	LCD_displayString("HOLDING THE DOOR");
-	Timer1_countSeconds(THREE_SECONDS);
-
-	/* Display the door closing message */
-	LCD_clearScreen();
-	LCD_displayString("CLOSING THE DOOR");
-	Timer1_countSeconds(FIFTEEN_SECONDS);
+	return KERNEL_queuePeek(&g_linkQueue, &message, 0);
+#else
+	return (g_rxHead != g_rxTail);
+#endif
 }
 
-/* Function to trigger the alarm and display an error message */
-void Alarm(void)
+/* Drop received bytes until READY, returns TRUE when READY is taken */
+static boolean Link_takeReady(void)
 {
-	/* Clear the LCD and display the error message */
-	LCD_clearScreen();
-	LCD_displaySringRowColumn("ERROR", 0, 5);
-	Timer1_countSeconds(ONE_MINUTE);
+	uint8 data;
+
+	if (g_controlReady)
+	{
+		g_controlReady = FALSE;
+		return TRUE;
+	}
+
+	while (Link_getByte(&data))
+	{
+		if (data == READY_TO_RECEVIE)
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
 }
 
-/* Callback function to count seconds using Timer1 */
-void Count_Seconds(void)
+#if (CLOCK_SYNC_ENABLE == 1)
+/* Return TRUE when the Control ECU waits for a command and the clock synchronization is due */
+static boolean Link_syncDue(void)
 {
-	/* Increment the seconds counter */
-	g_seconds++;
+	return g_controlReady && ((SOFT_TIMER_getTicks() - g_syncTick) >= CLOCK_SYNC_PERIOD);
 }
 
-/* Function to count a specified number of seconds using Timer1 */
-void Timer1_countSeconds(uint8 seconds)
+/* Return a timestamp of the answer of the clock synchronization, low byte first */
+static uint32 Link_syncTimestamp(const uint8 * bytes_ptr)
 {
-	/* Timer1 configuration structure */
-	TIMER1_ConfigType count_sec = {COMPARE_MODE, F_CPU_256, 0, ONE_SECOND};
+	return (uint32)bytes_ptr[0] | ((uint32)bytes_ptr[1] << 8) | ((uint32)bytes_ptr[2] << 16) | ((uint32)bytes_ptr[3] << 24);
+}
+#endif
 
-	/* Initialize Timer1 with the specified configuration */
-	TIMER1_init(&count_sec);
+/* Give a request to the link thread */
+static void Link_start(Link_Request request, uint8 command, uint8 passwords)
+{
+#if (KERNEL_ENABLE == 1)
+	Link_MessageType message;
+#endif
 
-	/* Wait until the specified number of seconds has passed */
-	while(g_seconds != seconds);
+	g_linkCommand = command;
+	g_linkPasswords = passwords;
+	g_linkRequest = request;
 
-	/* Reset the seconds counter and deinitialize Timer1 */
-	g_seconds = ZERO_SECONDS;
-	TIMER1_deinit();
+#if (KERNEL_ENABLE == 1)
+	/* Last, the link task has the higher priority and may run at once from here */
+	message.kind = LINK_MESSAGE_REQUEST;
+	message.data = request;
+	(void)KERNEL_queueSend(&g_linkQueue, &message, KERNEL_WAIT_FOREVER);
+#endif
 }
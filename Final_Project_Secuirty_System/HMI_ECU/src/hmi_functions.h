@@ -12,6 +12,8 @@
 #define HMI_FUNCTIONS_H_
 
 #include "std_types.h" /* Include standard data types */
+#include "pt.h"        /* Protothreads */
+#include "kernel.h"    /* KERNEL_ENABLE */
 
 
 /*******************************************************************************
@@ -36,26 +38,17 @@
 #define CHANGING_PASSWORD           0x23 /* Command to change the password */
 #define PASSWORD_UNMATCH_OPEN       0x24 /* Password does not match for 'Open Door' command */
 #define PASSWORD_UNMATCH_CHANGE     0x25 /* Password does not match for 'Change Password' command */
+#define SYNCING_CLOCK               0x26 /* Command to exchange the timestamps of the clock synchronization */
 
 /* Macros for attempt limits */
 #define MAX_ATTEMPTS        		4 	/* Maximum number of password attempts */
 #define ZERO_ATTEMPTS       		0 	/* Reset the number of attempts to zero */
 
-/*
- * Timer tick calculation for one second
- * 31250 timer tick
- * each tick = 32 micro sec
- * 32 * 31250 = 1000000 micro sec
- * 1000000 micro sec = 1 sec
- */
-#define ONE_SECOND          31250 /* Number of timer ticks for one second */
-
-/* Macros for time durations in seconds */
-#define ZERO_SECONDS        0  /* Zero seconds */
-#define TWO_SECONDS         2  /* Two seconds */
-#define THREE_SECONDS       3  /* Three seconds */
-#define FIFTEEN_SECONDS     15 /* Fifteen seconds */
-#define ONE_MINUTE          60 /* Sixty seconds or one minute */
+/* Macros for time durations in milliseconds */
+#define TWO_SECONDS         2000UL	/* Two seconds */
+#define THREE_SECONDS       3000UL	/* Three seconds */
+#define FIFTEEN_SECONDS     15000UL	/* Fifteen seconds */
+#define ONE_MINUTE          60000UL	/* Sixty seconds or one minute */
 
 /* Global variable for tracking password attempts */
 extern uint8 g_attempt;
@@ -67,44 +60,30 @@ extern uint8 g_attempt;
 /* Initialize HMI components */
 void Init_Function (void);
 
- /* Take the first password input */
-void Take_firstPassword (void);
-
-/* Take the second password input for confirmation */
-void Take_secondPassword (void);
-
-/* Send the password to the control unit */
-void send_Password(void);
-
-/* Receive a command from the control unit */
-uint8 receive_command(void);
-
-/* Send a command to the control unit */
-void send_command(uint8 command);
+/* Run the transitions of the user interface for the events that happened, it never waits */
+void Ui_dispatch(void);
 
-/* Display the main menu and handle user selection */
-void Main_Menu (void);
+/* Thread running the link with the control unit: READY handshakes, commands and results */
+PT_Status Link_thread(PT_Type * pt);
 
-/* Initiate the password change process */
-void Change_Password (void);
+#if (KERNEL_ENABLE == 1)
+/* Block the link task until its next message, or until the clock synchronization is due or timed out */
+void Link_wait(void);
 
-/* Handle new password entry and sending */
-void Taking_newPassword (void);
+/* Hand the key events of the keypad to the user interface task, called by the task of the drivers */
+void Ui_forwardKeys(void);
 
-/* Check the entered password based on the command */
-void Checking_Password(uint8 command);
-
-/* Simulate the door opening process */
-void Open_Door(void);
-
-/* Trigger the alarm and display an error message */
-void Alarm(void);
-
-/* Callback function to count seconds using Timer1 */
-void Count_Seconds(void);
+/* Block the user interface task until its next event */
+void Ui_waitEvent(void);
+#else
+/*
+ * Return TRUE if the main loop has work left: a byte of the control unit, a key event or the end of
+ * a request of the user interface. The main loop checks it with the interrupts disabled before it sleeps.
+ */
+boolean Ui_isPending(void);
+#endif
 
-/* Count a specified number of seconds using Timer1 */
-void Timer1_countSeconds(uint8 seconds);
+/* Send the trace records and, every 10 seconds, the profiler results on the software UART */
+void Debug_output(void);
 
 #endif /* SRC_HMI_FUNCTIONS_H_ */
-
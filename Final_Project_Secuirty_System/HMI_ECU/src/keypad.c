@@ -5,172 +5,471 @@
  *      Author: abdalla
  */
 
-#include "gpio.h"
 #include "keypad.h"
-#include <util/delay.h>
+#include "gpio.h"
+#include "soft_timer.h"
+#include "timer1.h"
+#include "profile.h"
+#include "common_macros.h"
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#if (KEYPAD_WAKE_ENABLE == 1)
+#include <avr/interrupt.h>
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if (KEYPAD_ROW_PORT_ID != KEYPAD_COLUMN_PORT_ID)
+#error "The rows and the columns of the keypad should be on the same port"
+#endif
+
+/* Registers of the keypad port, a row step is one masked DDR write and one PIN read */
+#define KEYPAD_DDR              GPIO_DDR_REGISTER(KEYPAD_ROW_PORT_ID)
+#define KEYPAD_PORT             GPIO_PORT_REGISTER(KEYPAD_ROW_PORT_ID)
+#define KEYPAD_PIN              GPIO_PIN_REGISTER(KEYPAD_ROW_PORT_ID)
+
+/* Pins of the rows and of the columns in the port */
+#define KEYPAD_ROWS_MASK        (((1 << KEYPAD_NUM_ROWS) - 1) << KEYPAD_ROW_PIN_ID)
+#define KEYPAD_COLUMNS_MASK     (((1 << KEYPAD_NUM_COLS) - 1) << KEYPAD_COLUMN_PIN_ID)
+
+/* Hold times in full scans */
+#define KEYPAD_SCAN_TIME        (KEYPAD_NUM_ROWS * KEYPAD_SCAN_PERIOD)
+#define KEYPAD_LONG_PRESS_SCANS (KEYPAD_LONG_PRESS_TIME / KEYPAD_SCAN_TIME)
+#define KEYPAD_REPEAT_SCANS     (KEYPAD_REPEAT_PERIOD / KEYPAD_SCAN_TIME)
+#define KEYPAD_DELAY_SCANS      (KEYPAD_REPEAT_DELAY / KEYPAD_SCAN_TIME)
+
+#if ((KEYPAD_REPEAT_SCANS == 0) || (KEYPAD_DELAY_SCANS == 0) || (KEYPAD_LONG_PRESS_SCANS == 0))
+#error "The hold times of the keypad should be one full scan at least"
+#endif
+
+/* Value of the followed key when no key is followed */
+#define KEYPAD_NO_INDEX         0xFF
+
+/* Columns read by a row step, one bit per column */
+#define KEYPAD_COLUMN_BITS      ((1 << KEYPAD_NUM_COLS) - 1)
+
+#if ((KEYPAD_ROWS_MASK & KEYPAD_COLUMNS_MASK) != 0)
+#error "The rows and the columns of the keypad should not share pins"
+#endif
+
+#if ((KEYPAD_FIFO_SIZE & (KEYPAD_FIFO_SIZE - 1)) != 0) || (KEYPAD_FIFO_SIZE > 128)
+#error "KEYPAD_FIFO_SIZE should be a power of two up to 128"
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Periodic timer of the scan and the row driven since the last tick */
+static SOFT_TIMER_Type g_keypadTimer;
+static uint8 g_keypadRow = 0;
+
+/* Debounced state of the keys, one bit per column for each row, set while the key is down */
+static uint8 g_keypadDown[KEYPAD_NUM_ROWS];
+
+/* Number of full scans in a row that read the other level than the debounced state of each key */
+static uint8 g_keypadCount[KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS];
+
+/* Events waiting for the application, the indices run freely */
+static volatile KEYPAD_EventType g_keypadFifo[KEYPAD_FIFO_SIZE];
+static volatile uint8 g_keypadHead = 0;
+static volatile uint8 g_keypadTail = 0;
+
+/* Number of keys down after the debounce */
+static uint8 g_keypadDownKeys = 0;
+
+/*
+ * Index of the key followed for the long press and the repeat, full scans since its press,
+ * full scans until its next repeat and TRUE once its long press is sent
+ */
+static uint8 g_keypadHeld = KEYPAD_NO_INDEX;
+static uint16 g_keypadHeldScans;
+static uint8 g_keypadRepeatScans;
+static boolean g_keypadLongSent;
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+/* Full scans without any key down, and TRUE if the current scan read a key down */
+static uint8 g_keypadIdleScans = 0;
+static boolean g_keypadBusy = FALSE;
+#endif
+
+/* Value of each key, indexed by (row * KEYPAD_NUM_COLS) + column */
+static const uint8 g_keypadKeys[KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS] PROGMEM =
+{
+#if defined(STANDARD_KEYPAD)
+#if (KEYPAD_NUM_COLS == 3)
+	1, 2, 3,
+	4, 5, 6,
+	7, 8, 9,
+	10, 11, 12
+#else
+	1, 2, 3, 4,
+	5, 6, 7, 8,
+	9, 10, 11, 12,
+	13, 14, 15, 16
+#endif
+#elif (KEYPAD_NUM_COLS == 3)
+	/* Keys of the 4x3 keypad of Proteus */
+	1, 2, 3,
+	4, 5, 6,
+	7, 8, 9,
+	'*', 0, '#'
+#else
+	/* Keys of the 4x4 keypad of Proteus */
+	7, 8, 9, '/',
+	4, 5, 6, '*',
+	1, 2, 3, '-',
+	13, 0, '=', '+'
+#endif
+};
 
 /*******************************************************************************
  *                      Functions Prototypes(For keypad file only)            *
  ******************************************************************************/
 
-#ifndef STANDARD_KEYPAD
+/* Timer callback, reads the columns of the driven row and drives the next row */
+static void KEYPAD_scanRow(void);
+
+/* A key changed its state after the debounce, put its events in the FIFO (called by the scan) */
+static void KEYPAD_keyChanged(uint8 index, boolean down);
+
+/* Count the hold time of the followed key, called once per full scan */
+static void KEYPAD_holdKey(void);
+
+/* Put one event in the FIFO, it is lost if the FIFO is full (called by the scan) */
+static void KEYPAD_putEvent(uint8 index, uint8 kind, uint8 chord);
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+/* Stop the scan, drive all the rows and wait for a key on INT2 (called by the scan) */
+static void KEYPAD_waitPress(void);
+#endif
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ ******************************************************************************/
 
-#if (KEYPAD_NUM_COLS == 3)
 /*
- * Function: KEYPAD_4x3_adjustKeyNumber
+ * Function: KEYPAD_init
  * ----------------------------
- *   Maps the switch number in the keypad to its corresponding functional number in the Proteus for 4x3 keypad
- *   button_number: the switch number in the keypad
- *   returns: the adjusted key number
+ *   Sets up the keypad pins, drives the first row and starts the scan timer
  */
-static uint8 KEYPAD_4x3_adjustKeyNumber(uint8 button_number);
-#elif (KEYPAD_NUM_COLS == 4)
+void KEYPAD_init(void)
+{
+	uint8 i;
+
+	/* All keys are up */
+	for (i = 0; i < KEYPAD_NUM_ROWS; i++)
+	{
+		g_keypadDown[i] = 0;
+	}
+	g_keypadDownKeys = 0;
+	g_keypadHeld = KEYPAD_NO_INDEX;
+	for (i = 0; i < (KEYPAD_NUM_ROWS * KEYPAD_NUM_COLS); i++)
+	{
+		g_keypadCount[i] = 0;
+	}
+
+	/*
+	 * The columns are inputs and the rows keep the pressed level in PORT: a row is released as an
+	 * input and driven as an output, so a row step only writes DDR. The other pins of the port may
+	 * be driven by ISRs: the updates here and in the scan are atomic.
+	 */
+	GPIO_SETUP_PORT_DIRECTION_MASKED(KEYPAD_ROW_PORT_ID, KEYPAD_ROWS_MASK | KEYPAD_COLUMNS_MASK, 0x00);
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	GPIO_WRITE_PORT_MASKED(KEYPAD_ROW_PORT_ID, KEYPAD_ROWS_MASK, 0x00);
+#else
+	GPIO_WRITE_PORT_MASKED(KEYPAD_ROW_PORT_ID, KEYPAD_ROWS_MASK, 0xFF);
+#endif
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+	/*
+	 * INT2 pin (PB2) is an input, pulled to the released level when no key is pressed. Port B has
+	 * the control pins of the LCD, driven by its drain.
+	 */
+	GPIO_SETUP_PIN_DIRECTION(PORTB_ID, PIN2_ID, PIN_INPUT);
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	GPIO_WRITE_PIN(PORTB_ID, PIN2_ID, LOGIC_HIGH);
+#endif
+	g_keypadIdleScans = 0;
+	g_keypadBusy = FALSE;
+#endif
+
+	/* The first row is read at the first tick */
+	g_keypadRow = 0;
+	GPIO_SETUP_PIN_DIRECTION(KEYPAD_ROW_PORT_ID, KEYPAD_ROW_PIN_ID, PIN_OUTPUT);
+
+	SOFT_TIMER_startDeferred(&g_keypadTimer, KEYPAD_SCAN_PERIOD, KEYPAD_SCAN_PERIOD, KEYPAD_scanRow);
+}
+
 /*
- * Function: KEYPAD_4x4_adjustKeyNumber
+ * Function: KEYPAD_getEvent
  * ----------------------------
- *   Maps the switch number in the keypad to its corresponding functional number in the Proteus for 4x4 keypad
- *   button_number: the switch number in the keypad
- *   returns: the adjusted key number
+ *   Takes the oldest event of the FIFO
+ *   event_ptr: where the event is copied
+ *   returns: TRUE if an event is copied, FALSE if the FIFO is empty
  */
-static uint8 KEYPAD_4x4_adjustKeyNumber(uint8 button_number);
-#endif
+boolean KEYPAD_getEvent(KEYPAD_EventType * event_ptr)
+{
+	uint8 index;
 
-#endif /* STANDARD_KEYPAD */
+	/* Only the scan writes the head, only this function moves the tail */
+	if (g_keypadHead == g_keypadTail)
+	{
+		return FALSE;
+	}
 
-/*******************************************************************************
- *                      Functions Definitions                                  *
- ******************************************************************************/
+	index = g_keypadTail & (KEYPAD_FIFO_SIZE - 1);
+	event_ptr->key = g_keypadFifo[index].key;
+	event_ptr->kind = g_keypadFifo[index].kind;
+	event_ptr->chord = g_keypadFifo[index].chord;
+	event_ptr->time = g_keypadFifo[index].time;
+	g_keypadTail++;
+	return TRUE;
+}
 
 /*
- * Function: KEYPAD_getPressedKey
+ * Function: KEYPAD_hasEvent
  * ----------------------------
- *   Retrieves the pressed key on the keypad
- *   returns: the pressed key
+ *   returns: TRUE if the FIFO holds an event
  */
-uint8 KEYPAD_getPressedKey(void)
+boolean KEYPAD_hasEvent(void)
 {
-	uint8 row, column;
+	return (g_keypadHead != g_keypadTail);
+}
 
-	/* Set up pin directions for rows and columns */
-	for (row = 0; row < KEYPAD_NUM_ROWS; row++)
-		GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_ROW_PIN_ID + row, PIN_INPUT);
+/*
+ * Function: KEYPAD_flush
+ * ----------------------------
+ *   Drops the events of the FIFO
+ */
+void KEYPAD_flush(void)
+{
+	g_keypadTail = g_keypadHead;
+}
+
+/*
+ * Function: KEYPAD_scanRow
+ * ----------------------------
+ *   Runs the debounce of the keys of the row driven since the last tick, then drives the next row.
+ *   It is the callback of a deferred timer, called from SOFT_TIMER_runDeferred in the main loop.
+ */
+static void KEYPAD_scanRow(void)
+{
+	uint8 columns, column, mask;
+	uint8 * count_ptr;
+	uint8 sreg;
+
+	PROFILE_BEGIN(KEYPAD_SCAN);
+
+	/* Columns of the row at the pressed level, one bit per column */
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	columns = (uint8)~KEYPAD_PIN >> KEYPAD_COLUMN_PIN_ID;
+#else
+	columns = KEYPAD_PIN >> KEYPAD_COLUMN_PIN_ID;
+#endif
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+	if (((columns | g_keypadDown[g_keypadRow]) & KEYPAD_COLUMN_BITS) != 0)
+	{
+		g_keypadBusy = TRUE;
+	}
+#endif
 
 	for (column = 0; column < KEYPAD_NUM_COLS; column++)
-		GPIO_setupPinDirection(KEYPAD_COLUMN_PORT_ID, KEYPAD_COLUMN_PIN_ID + column, PIN_INPUT);
+	{
+		mask = (uint8)(1 << column);
+		count_ptr = &g_keypadCount[(g_keypadRow * KEYPAD_NUM_COLS) + column];
 
-	while (1)
+		/* Same level as the debounced state: a bounce, if any, is over */
+		if ((columns & mask) == (g_keypadDown[g_keypadRow] & mask))
+		{
+			*count_ptr = 0;
+			continue;
+		}
+
+		(*count_ptr)++;
+		if (*count_ptr < KEYPAD_DEBOUNCE_SCANS)
+		{
+			continue;
+		}
+
+		/* The other level is stable, the key changes its state */
+		*count_ptr = 0;
+		g_keypadDown[g_keypadRow] ^= mask;
+		KEYPAD_keyChanged((g_keypadRow * KEYPAD_NUM_COLS) + column, (g_keypadDown[g_keypadRow] & mask) != 0);
+	}
+
+	/* Release this row and drive the next one in one write, its columns settle until the next tick */
+	g_keypadRow++;
+	if (g_keypadRow == KEYPAD_NUM_ROWS)
 	{
-		/* loop for rows */
-		for (row = 0; row < KEYPAD_NUM_ROWS; row++)
+		g_keypadRow = 0;
+		KEYPAD_holdKey();
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+		/* End of a full scan, a scan with a key down or a bounce restarts the count */
+		g_keypadIdleScans = g_keypadBusy ? 0 : (g_keypadIdleScans + 1);
+		g_keypadBusy = FALSE;
+		if (g_keypadIdleScans >= KEYPAD_IDLE_SCANS)
 		{
-			/* Set the current row pin as output */
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_ROW_PIN_ID + row, PIN_OUTPUT);
-			/* Set/Clear the row output pin */
-			GPIO_writePin(KEYPAD_ROW_PORT_ID, KEYPAD_ROW_PIN_ID + row, KEYPAD_BUTTON_PRESSED);
-
-			/* loop for columns */
-			for (column = 0; column < KEYPAD_NUM_COLS; column++)
-			{
-				/* Check if the switch is pressed in this column */
-				if (GPIO_readPin(KEYPAD_COLUMN_PORT_ID, KEYPAD_COLUMN_PIN_ID + column) == KEYPAD_BUTTON_PRESSED)
-				{
-					#if (KEYPAD_NUM_COLS == 3)
-						#ifdef STANDARD_KEYPAD
-							return ((row * KEYPAD_NUM_COLS) + column + 1 );
-						#else
-							return KEYPAD_4x3_adjustKeyNumber((row *KEYPAD_NUM_COLS) + column + 1);
-						#endif
-					#elif (KEYPAD_NUM_COLS == 4)
-						#ifdef STANDARD_KEYPAD
-							return ((row * KEYPAD_NUM_COLS) + column +1);
-						#else
-							return KEYPAD_4x4_adjustKeyNumber((row *KEYPAD_NUM_COLS) + column + 1);
-						#endif
-					#endif
-				}
-			}
-			/* Restore row pins as inputs */
-			GPIO_setupPinDirection(KEYPAD_ROW_PORT_ID, KEYPAD_ROW_PIN_ID + row, PIN_INPUT);
-			_delay_ms(5);
+			KEYPAD_waitPress();
+			PROFILE_END(KEYPAD_SCAN);
+			return;
 		}
+#endif
 	}
+	sreg = SREG;
+	cli();
+	KEYPAD_DDR = (KEYPAD_DDR & (uint8)~KEYPAD_ROWS_MASK) | (uint8)(1 << (KEYPAD_ROW_PIN_ID + g_keypadRow));
+	SREG = sreg;
+
+	PROFILE_END(KEYPAD_SCAN);
 }
 
-#ifndef STANDARD_KEYPAD
+/*
+ * Function: KEYPAD_keyChanged
+ * ----------------------------
+ *   Puts the events of a key that changed its state and follows the key pressed last
+ *   index: the index of the key in the keypad
+ *   down: TRUE if the key is pressed, FALSE if it is released
+ */
+static void KEYPAD_keyChanged(uint8 index, boolean down)
+{
+	if (!down)
+	{
+		g_keypadDownKeys--;
+		if (index == g_keypadHeld)
+		{
+			g_keypadHeld = KEYPAD_NO_INDEX;
+		}
+		KEYPAD_putEvent(index, KEYPAD_RELEASE, KEYPAD_NO_KEY);
+		return;
+	}
+
+	g_keypadDownKeys++;
+	if ((g_keypadDownKeys == 2) && (g_keypadHeld != KEYPAD_NO_INDEX))
+	{
+		/* Second key while the first one is held: a chord, nothing repeats */
+		KEYPAD_putEvent(index, KEYPAD_CHORD, pgm_read_byte(&g_keypadKeys[g_keypadHeld]));
+		g_keypadHeld = KEYPAD_NO_INDEX;
+		return;
+	}
+
+	KEYPAD_putEvent(index, KEYPAD_PRESS, KEYPAD_NO_KEY);
+	if (g_keypadDownKeys == 1)
+	{
+		g_keypadHeld = index;
+		g_keypadHeldScans = 0;
+		g_keypadRepeatScans = KEYPAD_DELAY_SCANS;
+		g_keypadLongSent = FALSE;
+	}
+	else
+	{
+		g_keypadHeld = KEYPAD_NO_INDEX;
+	}
+}
 
-#if (KEYPAD_NUM_COLS == 3)
 /*
- * Function: KEYPAD_4x3_adjustKeyNumber
+ * Function: KEYPAD_holdKey
  * ----------------------------
- *   Adjusts the keypad pressed button value for a 4x3 keypad
- *   button_number: the button number pressed on the keypad
- *   returns: the adjusted key value
+ *   Counts one more full scan of the followed key and puts its long press and repeat events
  */
-static uint8 KEYPAD_4x3_adjustKeyNumber (uint8 button_number)
+static void KEYPAD_holdKey(void)
 {
-	uint8 key = 0;
-	switch(button_number)
+	if (g_keypadHeld == KEYPAD_NO_INDEX)
 	{
-		case 10 : key = '*';
-			break;
-		case 11 : key = 0;
-			break;
-		case 12 : key = '#';
-			break;
-		default: key = button_number;
+		return;
+	}
+
+	g_keypadRepeatScans--;
+	if (g_keypadRepeatScans == 0)
+	{
+		g_keypadRepeatScans = KEYPAD_REPEAT_SCANS;
+		KEYPAD_putEvent(g_keypadHeld, KEYPAD_REPEAT, KEYPAD_NO_KEY);
+	}
+
+	if (!g_keypadLongSent)
+	{
+		g_keypadHeldScans++;
+		if (g_keypadHeldScans == KEYPAD_LONG_PRESS_SCANS)
+		{
+			g_keypadLongSent = TRUE;
+			KEYPAD_putEvent(g_keypadHeld, KEYPAD_LONG_PRESS, KEYPAD_NO_KEY);
+		}
 	}
-	return key;
 }
 
-#elif (KEYPAD_NUM_COLS == 4)
 /*
- * Function: KEYPAD_4x4_adjustKeyNumber
+ * Function: KEYPAD_putEvent
  * ----------------------------
- *   Adjusts the keypad pressed button value for a 4x4 keypad
- *   button_number: the button number pressed on the keypad
- *   returns: the adjusted key value
+ *   Puts one event in the FIFO with the current time
+ *   index: the index of the key in the keypad
+ *   kind: the kind of the event
+ *   chord: the chord key of a KEYPAD_CHORD event
  */
-static uint8 KEYPAD_4x4_adjustKeyNumber (uint8 button_number)
+static void KEYPAD_putEvent(uint8 index, uint8 kind, uint8 chord)
 {
-	uint8 key = 0;
-	switch(button_number)
+	uint8 place;
+
+	if ((uint8)(g_keypadHead - g_keypadTail) >= KEYPAD_FIFO_SIZE)
 	{
-		case 1 : key = 7;
-			break;
-		case 2 : key = 8;
-			break;
-		case 3 : key = 9;
-			break;
-		case 4 : key = '/';
-			break;
-		case 5 : key = 4;
-			break;
-		case 6 : key = 5;
-			break;
-		case 7 : key = 6;
-			break;
-		case 8 : key = '*';
-			break;
-		case 9 : key = 1;
-			break;
-		case 10: key = 2;
-			break;
-		case 11: key = 3;
-			break;
-		case 12: key = '-';
-			break;
-		case 13: key = 13;
-			break;
-		case 14: key = 0;
-			break;
-		case 15: key = '=';
-			break;
-		case 16: key = '+';
-			break;
-		default: key = button_number;
+		return;
 	}
-	return key;
+
+	place = g_keypadHead & (KEYPAD_FIFO_SIZE - 1);
+	g_keypadFifo[place].key = pgm_read_byte(&g_keypadKeys[index]);
+	g_keypadFifo[place].kind = kind;
+	g_keypadFifo[place].chord = chord;
+	g_keypadFifo[place].time = TIMER1_getTimestamp();
+	g_keypadHead++;
 }
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+/*
+ * Function: KEYPAD_waitPress
+ * ----------------------------
+ *   Stops the scan and drives all the rows, so any key pressed gives an edge on INT2.
+ *   It is called by the scan, with the interrupts enabled.
+ */
+static void KEYPAD_waitPress(void)
+{
+	/* The INT2 ISR drives the first row: it must not run before all the rows are driven here */
+	uint8 sreg = SREG;
+	cli();
+
+	SOFT_TIMER_stop(&g_keypadTimer);
+
+	/*
+	 * Arm INT2 while no row is driven and the line is at the released level, so a key pressed
+	 * from now on gives an edge even if it is already down when the rows are driven.
+	 */
+	KEYPAD_DDR &= (uint8)~KEYPAD_ROWS_MASK;
+	CLEAR_BIT(GICR, INT2);
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	CLEAR_BIT(MCUCSR, ISC2);
+#else
+	SET_BIT(MCUCSR, ISC2);
 #endif
+	GIFR = (1 << INTF2);
+	SET_BIT(GICR, INT2);
 
-#endif /* STANDARD_KEYPAD */
+	KEYPAD_DDR |= KEYPAD_ROWS_MASK;
+
+	SREG = sreg;
+}
+
+/* A key is pressed while the scan waits: start scanning again from the first row */
+ISR(INT2_vect)
+{
+	CLEAR_BIT(GICR, INT2);
+
+	g_keypadIdleScans = 0;
+	g_keypadBusy = FALSE;
+	g_keypadRow = 0;
+	KEYPAD_DDR = (KEYPAD_DDR & (uint8)~KEYPAD_ROWS_MASK) | (uint8)(1 << KEYPAD_ROW_PIN_ID);
+
+	SOFT_TIMER_startDeferred(&g_keypadTimer, KEYPAD_SCAN_PERIOD, KEYPAD_SCAN_PERIOD, KEYPAD_scanRow);
+}
+#endif
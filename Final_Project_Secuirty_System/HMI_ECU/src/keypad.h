@@ -3,6 +3,37 @@
  *
  *  Created on: Feb 12, 2024
  *      Author: abdalla
+ *
+ * The keypad is scanned in the background from a periodic software timer: each tick reads the
+ * columns of the row driven since the previous tick, then drives the next row, so the columns
+ * settle for a whole tick and no delay is needed. A full scan takes KEYPAD_NUM_ROWS ticks.
+ *
+ * Each key has its own debounce state machine: its state (up or down) changes after
+ * KEYPAD_DEBOUNCE_SCANS full scans in a row that read the other level, and the change is put
+ * in an event FIFO as a press or a release with its Timer1 timestamp. The keys typed while the
+ * application is busy wait in the FIFO, a key pressed while the FIFO is full is lost.
+ *
+ * The key pressed last, while it is the only key down, is followed after the debounce: a long press
+ * event after KEYPAD_LONG_PRESS_TIME, and repeat events every KEYPAD_REPEAT_PERIOD after
+ * KEYPAD_REPEAT_DELAY. A key pressed while exactly one other key is down gives a chord event with
+ * both keys instead of its press event, and neither of them repeats. The hold time is counted once
+ * per full scan for the one key followed, so the cost of a row step does not depend on the keys.
+ *
+ * Debounce time: KEYPAD_DEBOUNCE_SCANS * KEYPAD_NUM_ROWS * KEYPAD_SCAN_PERIOD = 20 ms.
+ * CPU cost: one row step per tick, the same whether a key is pressed or not. The scan is a deferred
+ * software timer: the tick ISR only puts it in the ready list, and the row step runs from
+ * SOFT_TIMER_runDeferred in the main loop, with the interrupts enabled. A main loop late by more than
+ * a tick skips the row steps of the ticks missed, which only stretches the debounce. The rows and the columns share one port: a row step reads all the columns
+ * with one PIN read and moves to the next row with one masked DDR write, and the keys are decoded
+ * through a table in flash. With PROFILE_ENABLE the time of a row step is recorded in the
+ * KEYPAD_SCAN region of the profiler, a full scan is KEYPAD_NUM_ROWS steps.
+ *
+ * With KEYPAD_WAKE_ENABLE the scan stops after KEYPAD_IDLE_SCANS full scans without any key down:
+ * all the rows are driven and the scan waits for the INT2 interrupt. The columns must be wired to
+ * the INT2 pin (PB2) through diodes (wired-OR), so any key pressed gives an edge on INT2 and the
+ * scan starts again from the first row. Once the scan and the other software timers are stopped, POWER_idle
+ * also stops the 1 ms system tick: the CPU sleeps until a key is pressed, and only the Timer1
+ * overflow wakes it meanwhile. See power.h for the wakes counted by Host_Tools/src/power_test.c.
  */
 
 #ifndef KEYPAD_H_
@@ -29,12 +60,86 @@
 #define KEYPAD_BUTTON_PRESSED	LOGIC_LOW
 #define KEYPAD_BUTTON_RELEASED	LOGIC_HIGH
 
+/* Value returned when no key is pressed, it is not used by any key */
+#define KEYPAD_NO_KEY			0xFF
+
+/* Milliseconds between the scans of two rows */
+#define KEYPAD_SCAN_PERIOD      1
+
+/* Number of full scans with the same level before a key changes its state */
+#define KEYPAD_DEBOUNCE_SCANS   5
+
+/* Hold times of the key pressed last in milliseconds, rounded down to whole scans */
+#define KEYPAD_LONG_PRESS_TIME  1000
+#define KEYPAD_REPEAT_DELAY     500
+#define KEYPAD_REPEAT_PERIOD    100
+
+/* Wake on press configuration, its value should be 0 (disabled) or 1 (enabled) */
+#define KEYPAD_WAKE_ENABLE      0
+
+#if((KEYPAD_WAKE_ENABLE != 0) && (KEYPAD_WAKE_ENABLE != 1))
+
+#error "KEYPAD_WAKE_ENABLE should be equal to 0 or 1"
+
+#endif
+
+/* Number of full scans without any key down before the scan waits for INT2 */
+#define KEYPAD_IDLE_SCANS       25
+
+/* Number of events the FIFO can hold, must be a power of two up to 128 */
+#define KEYPAD_FIFO_SIZE        8
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Kinds of the keypad events */
+typedef enum
+{
+	KEYPAD_PRESS,           /* The key is down after the debounce */
+	KEYPAD_RELEASE,         /* The key is up after the debounce */
+	KEYPAD_LONG_PRESS,      /* The key is held for KEYPAD_LONG_PRESS_TIME */
+	KEYPAD_REPEAT,          /* The key is still held, sent every KEYPAD_REPEAT_PERIOD */
+	KEYPAD_CHORD            /* The key is pressed while the chord key is held */
+}KEYPAD_EventKind;
+
+/* Event of one key */
+typedef struct
+{
+	uint8 key;              /* Value of the key, same values as the keys of the keypad */
+	uint8 kind;             /* One of KEYPAD_EventKind */
+	uint8 chord;            /* Key held before the key of a KEYPAD_CHORD event, KEYPAD_NO_KEY otherwise */
+	uint32 time;            /* Timer1 timestamp of the scan that ended the debounce */
+}KEYPAD_EventType;
+
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
+
+/*
+ * Description :
+ * Take the keypad pins and start the background scan.
+ * The system tick must be started before (SOFT_TIMER_init), and the main loop must call
+ * SOFT_TIMER_runDeferred.
+ */
+void KEYPAD_init(void);
+
+/*
+ * Description :
+ * Take the oldest event of the FIFO.
+ * returns: TRUE if an event is copied to event_ptr, FALSE if the FIFO is empty.
+ */
+boolean KEYPAD_getEvent(KEYPAD_EventType * event_ptr);
+
+/*
+ * Description :
+ * Return TRUE if the FIFO holds an event, without taking it.
+ */
+boolean KEYPAD_hasEvent(void);
+
 /*
  * Description :
- * Get the Keypad pressed button
+ * Drop the events of the FIFO, for the keys typed before a screen that should not take them.
  */
-uint8 KEYPAD_getPressedKey(void);
+void KEYPAD_flush(void);
 #endif /* KEYPAD_H_ */
@@ -7,145 +7,606 @@
 
 #include "lcd.h"
 
+#include <avr/io.h>         	/* For the SREG register */
+#include <avr/interrupt.h>  	/* For cli */
 #include <util/delay.h>    	/* For the delay functions */
+#include <util/delay_basic.h>	/* For the delay loop of the bus cycle */
 
-#include "common_macros.h"	/* For GET_BIT Macro */
 #include "gpio.h"
+#include "soft_timer.h"      /* For the tick draining the queue */
+#include "timer1.h"          /* For the timestamps of the operations */
+#include "profile.h"         /* For the execution time markers */
+#include "trace.h"           /* For the trace of the flushes */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Number of cells of the screen */
+#define LCD_NUM_CELLS				(LCD_NUM_ROWS * LCD_NUM_COLS)
+
+/* Address counter of the LCD not known to be on a visible cell */
+#define LCD_NO_CELL					0xFF
+
+#if (LCD_RS_PORT_ID != LCD_ENABLE_PORT_ID)
+#error "RS and E of the LCD should be on the same port"
+#endif
+
+#if ((LCD_BIT_MODE == 4) && (LCD_DATA_FIRST_PIN_ID > 4))
+#error "The 4 data pins of the LCD should be in the same port"
+#endif
+
+/*
+ * Registers of the data port and of the RS and E port, each one is written directly. The bus is
+ * driven by the drain only, or by the init before the drain starts, and no ISR writes these ports:
+ * the other pins of the ports must not be driven from ISRs. The init sets the directions with
+ * masked updates.
+ */
+#define LCD_DATA_DDR				GPIO_DDR_REGISTER(LCD_DATA_PORT_ID)
+#define LCD_DATA_PORT				GPIO_PORT_REGISTER(LCD_DATA_PORT_ID)
+#define LCD_CONTROL_PORT			GPIO_PORT_REGISTER(LCD_ENABLE_PORT_ID)
+
+#define LCD_RS_MASK					(1 << LCD_RS_PIN_ID)
+#define LCD_ENABLE_MASK				(1 << LCD_ENABLE_PIN_ID)
+
+/*
+ * Pins of the data bus in the data port, and the two halves of a byte moved on them in 4-bit mode:
+ * the shifts are constants, with the data on pins 4 to 7 the high half needs no shift at all
+ */
+#if (LCD_BIT_MODE == 8)
+#define LCD_DATA_MASK				0xFF
+#elif (LCD_BIT_MODE == 4)
+#define LCD_DATA_MASK				(0x0F << LCD_DATA_FIRST_PIN_ID)
+#define LCD_HIGH_NIBBLE(value)		(((value) >> (4 - LCD_DATA_FIRST_PIN_ID)) & LCD_DATA_MASK)
+#define LCD_LOW_NIBBLE(value)		(((value) << LCD_DATA_FIRST_PIN_ID) & LCD_DATA_MASK)
+#endif
+
+/* Data pin of the busy flag (D7) */
+#if (LCD_BIT_MODE == 8)
+#define LCD_BUSY_PIN_ID				PIN7_ID
+#elif (LCD_BIT_MODE == 4)
+#define LCD_BUSY_PIN_ID				(LCD_DATA_FIRST_PIN_ID + 3)
+#endif
+
+/*
+ * Loops of _delay_loop_1, 3 cycles each, covering 1 us: every timing of the bus cycle is below
+ * 0.5 us. _delay_us would compute its count in floating point at run time in the Debug build (-O0),
+ * far longer than the bus cycle, and the drain runs once per tick.
+ */
+#define LCD_BUS_DELAY_LOOPS			((F_CPU + 2999999UL) / 3000000UL)
+
+#if (LCD_BUS_DELAY_LOOPS > 255)
+#error "F_CPU is too high for the delay loop of the LCD bus cycle"
+#endif
+
+/* Decimal digits of a 16-bit number: 65535 */
+#define LCD_NUMBER_DIGITS			5
+
+/* Bytes of the mask of the cells waiting for the drain, one bit per cell */
+#define LCD_DIRTY_BYTES				(LCD_NUM_CELLS / 8)
+
+#if ((LCD_NUM_CELLS % 8) != 0)
+#error "The number of cells of the LCD should be a multiple of 8"
+#endif
+
+#if ((LCD_COMMAND_QUEUE_SIZE & (LCD_COMMAND_QUEUE_SIZE - 1)) != 0) || (LCD_COMMAND_QUEUE_SIZE > 128)
+#error "LCD_COMMAND_QUEUE_SIZE should be a power of two up to 128"
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/*
+ * Characters written by the application, and characters of the last flush: the LCD shows them
+ * once the drain has sent the cells of g_lcdDirty. One byte per cell.
+ */
+static uint8 g_lcdShadow[LCD_NUM_CELLS];
+static uint8 g_lcdScreen[LCD_NUM_CELLS];
+
+/* Cells of g_lcdScreen not sent to the LCD yet, one bit per cell, cleared by the drain */
+static volatile uint8 g_lcdDirty[LCD_DIRTY_BYTES];
+
+/* TRUE if the drain sends a clear command before the marked cells */
+static volatile boolean g_lcdClear = FALSE;
+
+/* Cursor of the shadow, the column is LCD_NUM_COLS or more after the end of a row */
+static uint8 g_lcdRow = 0;
+static uint8 g_lcdCol = 0;
+
+/* Cell of the address counter of the LCD, where its next character goes */
+static uint8 g_lcdAddress = LCD_NO_CELL;
+
+/* TRUE if the shadow may differ from the screen */
+static boolean g_lcdModified = FALSE;
+
+/* TRUE if the last operation sent by LCD_init is a clear or return home command, the long ones */
+static boolean g_lcdSlow = TRUE;
+
+/* Commands waiting for the drain, they go before the cells, the indices run freely */
+static uint8 g_lcdCommands[LCD_COMMAND_QUEUE_SIZE];
+static volatile uint8 g_lcdHead = 0;
+static volatile uint8 g_lcdTail = 0;
+
+/* TRUE while the drain timer runs */
+static volatile boolean g_lcdDraining = FALSE;
+
+/* Timer1 timestamp of the last operation of the drain, and its execution time in micro seconds */
+static uint32 g_lcdSentTime = 0;
+static uint16 g_lcdWaitTime = 0;
+
+static SOFT_TIMER_Type g_lcdTimer;
+
+#if (LCD_RW_ENABLE == 1)
+/* TRUE after the function set of LCD_init, the busy flag cannot be read before it */
+static boolean g_lcdBusyReadable = FALSE;
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Send one command to the LCD and wait for it, used by LCD_init before the queue */
+static void LCD_sendNow(uint8 command);
+
+/* Mark one cell of g_lcdScreen to be sent by the drain */
+static void LCD_markCell(uint8 cell);
+
+/* Start the drain if it is stopped */
+static void LCD_startDrain(void);
+
+/* Send one command or one cell waiting for the drain, called from SOFT_TIMER_runDeferred */
+static void LCD_drain(void);
+
+/* Return the first cell waiting for the drain from the cell start on, LCD_NO_CELL if there is none */
+static uint8 LCD_nextDirtyCell(uint8 start);
+
+/* Count the bytes the drain sends to turn the screen into the shadow, or a blank screen if cleared is TRUE */
+static uint8 LCD_countBytes(boolean cleared);
+
+/* Write one byte to the LCD */
+static void LCD_write(uint8 rs, uint8 value);
+
+#if (LCD_BIT_MODE == 4)
+/* Write one half of a byte on the data pins, already shifted to them, with one E pulse */
+static void LCD_writeNibble(uint8 nibble);
+#endif
+
+/* Wait until the LCD has executed the last operation sent by LCD_sendNow */
+static void LCD_waitReady(void);
+
+#if (LCD_RW_ENABLE == 1)
+/* Read the busy flag once, TRUE while the LCD executes an operation */
+static boolean LCD_isBusy(void);
+
+/* Turn the data pins into inputs and set RW, before the busy flag reads */
+static void LCD_beginBusyReads(void);
+
+/* Read the busy flag with the data pins already turned into inputs */
+static boolean LCD_readBusy(void);
+
+/* Clear RW and drive the data pins again, after the busy flag reads */
+static void LCD_endBusyReads(void);
+#endif
+
+/* Return the DDRAM address of a cell */
+static uint8 LCD_cellAddress(uint8 row, uint8 col);
+
+/* Add 3 to each BCD digit of 5 or more, before the digits are doubled */
+static uint8 LCD_bcdAdjust(uint8 bcd);
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
  *******************************************************************************/
 
 /*
- * Function to send a command to the LCD
+ * Function to put a command in the queue of the drain, it returns FALSE if the queue is full
  */
-void LCD_SendCommand(uint8 command)
+boolean LCD_SendCommand(uint8 command)
 {
-    GPIO_writePin(LCD_RS_PORT_ID, LCD_RS_PIN_ID, LOGIC_LOW);
-    _delay_us(2);
-    GPIO_writePin(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, LOGIC_HIGH);
-    _delay_us(2);
+    boolean queued = FALSE;
+    uint8 sreg = SREG;
+    cli();
+
+    if ((uint8)(g_lcdHead - g_lcdTail) < LCD_COMMAND_QUEUE_SIZE)
+    {
+        g_lcdCommands[g_lcdHead & (LCD_COMMAND_QUEUE_SIZE - 1)] = command;
+        g_lcdHead++;
+        queued = TRUE;
+    }
+    SREG = sreg;
+
+    LCD_startDrain();
+    return queued;
+}
+
+/*
+ * Function to send one command to the LCD and wait for it, before the queue is used
+ */
+static void LCD_sendNow(uint8 command)
+{
+    PROFILE_BEGIN(LCD_COMMAND);
+
+    LCD_waitReady();
+    LCD_write(LOGIC_LOW, command);
+
+    /* Clear (0x01) and return home (0x02 or 0x03) are the only commands below 0x04 */
+    g_lcdSlow = (command <= (LCD_RETURN_HOME | 0x01));
+
+    PROFILE_END(LCD_COMMAND);
+}
+
+/*
+ * Function to mark one cell of g_lcdScreen to be sent. The drain clears the bit from another task
+ * with KERNEL_ENABLE, the update of the mask byte must not be cut by it.
+ */
+static void LCD_markCell(uint8 cell)
+{
+    uint8 sreg = SREG;
+    cli();
+    g_lcdDirty[cell >> 3] |= (uint8)(1 << (cell & 0x07));
+    SREG = sreg;
+}
+
+/*
+ * Function to start the drain timer if it is stopped
+ */
+static void LCD_startDrain(void)
+{
+    uint8 sreg = SREG;
+    cli();
+    if (!g_lcdDraining)
+    {
+        g_lcdDraining = TRUE;
+        SOFT_TIMER_startDeferred(&g_lcdTimer, LCD_DRAIN_PERIOD, LCD_DRAIN_PERIOD, LCD_drain);
+    }
+    SREG = sreg;
+}
+
+/*
+ * Function to send one operation, one per call: the waiting commands first, then the marked cells
+ * from the address counter of the LCD on, so the cells that follow each other need no cursor move.
+ * A cell away from the address counter takes two calls, the cursor move and the character.
+ * The calls come from SOFT_TIMER_runDeferred, with the interrupts enabled, once per period at most
+ * but not at a fixed time of the tick: a call before the end of the execution time of the last
+ * operation (a clear, or a late call followed by an early one) sends nothing.
+ */
+static void LCD_drain(void)
+{
+    uint8 cell;
+    uint8 command;
+    uint8 sreg;
+
+    if ((TIMER1_getTimestamp() - g_lcdSentTime) < g_lcdWaitTime)
+    {
+        return;
+    }
+
+#if (LCD_RW_ENABLE == 1)
+    /* A slower LCD than the datasheet gets one more period */
+    if (LCD_isBusy())
+    {
+        return;
+    }
+#endif
+
+    if (g_lcdClear)
+    {
+        g_lcdClear = FALSE;
+
+        PROFILE_BEGIN(LCD_COMMAND);
+        LCD_write(LOGIC_LOW, LCD_CLEAR_COMMAND);
+        PROFILE_END(LCD_COMMAND);
+
+        g_lcdAddress = 0;
+        g_lcdSentTime = TIMER1_getTimestamp();
+        g_lcdWaitTime = LCD_CLEAR_TIME;
+        return;
+    }
+
+    if (g_lcdTail != g_lcdHead)
+    {
+        command = g_lcdCommands[g_lcdTail & (LCD_COMMAND_QUEUE_SIZE - 1)];
+        g_lcdTail++;
+
+        PROFILE_BEGIN(LCD_COMMAND);
+        LCD_write(LOGIC_LOW, command);
+        PROFILE_END(LCD_COMMAND);
+
+        /* The command may move the address counter, the next cell moves the cursor first */
+        g_lcdAddress = LCD_NO_CELL;
+        g_lcdSentTime = TIMER1_getTimestamp();
+        g_lcdWaitTime = (command <= (LCD_RETURN_HOME | 0x01)) ? LCD_CLEAR_TIME : LCD_EXECUTION_TIME;
+        return;
+    }
 
     /*
-     * Check the LCD bit mode and send the command accordingly
+     * Nothing is waiting one period after the last operation, its wait is over. The timer stops
+     * with the interrupts disabled, so a flush from another task either marks its cells before the
+     * search or sees the drain stopped and starts it again.
      */
-    #if (LCD_BIT_MODE == 8)
-        GPIO_writePort(LCD_DATA_PORT_ID, command);
-        _delay_us(2);
-    #elif (LCD_BIT_MODE == 4)
-
-        /* Send high bit command */
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID, GET_BIT(command, 4));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 1, GET_BIT(command, 5));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 2, GET_BIT(command, 6));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 3, GET_BIT(command, 7));
+    sreg = SREG;
+    cli();
+    cell = LCD_nextDirtyCell((g_lcdAddress == LCD_NO_CELL) ? 0 : g_lcdAddress);
+    if (cell == LCD_NO_CELL)
+    {
+        SOFT_TIMER_stop(&g_lcdTimer);
+        g_lcdDraining = FALSE;
+        SREG = sreg;
+        return;
+    }
+    SREG = sreg;
 
-        /* delay */
-        _delay_us(2);
+    if (cell != g_lcdAddress)
+    {
+        PROFILE_BEGIN(LCD_COMMAND);
+        LCD_write(LOGIC_LOW, LCD_cellAddress(cell / LCD_NUM_COLS, cell % LCD_NUM_COLS) | LCD_MOVE_CURSOR);
+        PROFILE_END(LCD_COMMAND);
+        g_lcdAddress = cell;
+        g_lcdSentTime = TIMER1_getTimestamp();
+        g_lcdWaitTime = LCD_EXECUTION_TIME;
+        return;
+    }
 
-        /* Disable */
-        GPIO_writePin(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, LOGIC_LOW);
-        _delay_us(2);
+    /* The bit is cleared first: a cell written again meanwhile is marked again and sent again */
+    sreg = SREG;
+    cli();
+    g_lcdDirty[cell >> 3] &= (uint8)~(1 << (cell & 0x07));
+    SREG = sreg;
 
-        /* enable */
-        GPIO_writePin(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, LOGIC_HIGH);
-        _delay_us(2);
+    PROFILE_BEGIN(LCD_CHARACTER);
+    LCD_write(LOGIC_HIGH, g_lcdScreen[cell]);
+    PROFILE_END(LCD_CHARACTER);
+    g_lcdSentTime = TIMER1_getTimestamp();
+    g_lcdWaitTime = LCD_EXECUTION_TIME;
 
-        /* send low bit */
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID, GET_BIT(command, 0));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 1, GET_BIT(command, 1));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 2, GET_BIT(command, 2));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 3, GET_BIT(command, 3));
+    /* The address counter moves by itself after each character, except to the next row */
+    g_lcdAddress = (((cell + 1) % LCD_NUM_COLS) == 0) ? LCD_NO_CELL : (cell + 1);
+}
 
-        /* delay */
-        _delay_us(2);
-    #endif
+/*
+ * Function to find the first marked cell from the cell start on, round the screen. A mask byte
+ * without any mark skips its 8 cells at once.
+ */
+static uint8 LCD_nextDirtyCell(uint8 start)
+{
+    uint8 cell = start;
+    uint8 left = LCD_NUM_CELLS;
 
-    GPIO_writePin(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, LOGIC_LOW);
-    _delay_us(2);
+    while (left != 0)
+    {
+        if (((cell & 0x07) == 0) && (left >= 8) && (g_lcdDirty[cell >> 3] == 0))
+        {
+            cell += 8;
+            left -= 8;
+        }
+        else if (g_lcdDirty[cell >> 3] & (1 << (cell & 0x07)))
+        {
+            return cell;
+        }
+        else
+        {
+            cell++;
+            left--;
+        }
+
+        if (cell >= LCD_NUM_CELLS)
+        {
+            cell = 0;
+        }
+    }
+    return LCD_NO_CELL;
 }
 
 /*
- * Function to display a character on the LCD
+ * Function to write one byte to the LCD, a command (rs LOW) or a character (rs HIGH)
  */
-void LCD_displayCharacter(uint8 data)
+static void LCD_write(uint8 rs, uint8 value)
 {
-    GPIO_writePin(LCD_RS_PORT_ID, LCD_RS_PIN_ID, LOGIC_HIGH);
-    _delay_us(2);
-    GPIO_writePin(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, LOGIC_HIGH);
-    _delay_us(2);
+    if (rs == LOGIC_HIGH)
+    {
+        LCD_CONTROL_PORT |= LCD_RS_MASK;
+    }
+    else
+    {
+        LCD_CONTROL_PORT &= (uint8)~LCD_RS_MASK;
+    }
+    _delay_loop_1(LCD_BUS_DELAY_LOOPS);
 
     /*
-     * Check the LCD bit mode and send the data accordingly
+     * Check the LCD bit mode and send the byte accordingly
      */
     #if (LCD_BIT_MODE == 8)
-        GPIO_writePort(LCD_DATA_PORT_ID, data);
-        _delay_us(2);
+        LCD_CONTROL_PORT |= LCD_ENABLE_MASK;
+        LCD_DATA_PORT = value;
+        _delay_loop_1(LCD_BUS_DELAY_LOOPS);
+        LCD_CONTROL_PORT &= (uint8)~LCD_ENABLE_MASK;
+        _delay_loop_1(LCD_BUS_DELAY_LOOPS);
     #elif (LCD_BIT_MODE == 4)
+        LCD_writeNibble(LCD_HIGH_NIBBLE(value));
+        LCD_writeNibble(LCD_LOW_NIBBLE(value));
+    #endif
+}
+
+#if (LCD_BIT_MODE == 4)
+/*
+ * Function to write one half of a byte on the data pins with one E pulse: one read-modify-write
+ * of the data port, the LCD reads it on the falling edge of E
+ */
+static void LCD_writeNibble(uint8 nibble)
+{
+    #if (LCD_DATA_PORT_ID == LCD_ENABLE_PORT_ID)
+        /* The data and the rising edge of E in the same write */
+        LCD_DATA_PORT = (LCD_DATA_PORT & (uint8)~LCD_DATA_MASK) | nibble | LCD_ENABLE_MASK;
+    #else
+        LCD_CONTROL_PORT |= LCD_ENABLE_MASK;
+        LCD_DATA_PORT = (LCD_DATA_PORT & (uint8)~LCD_DATA_MASK) | nibble;
+    #endif
+    _delay_loop_1(LCD_BUS_DELAY_LOOPS);
+    LCD_CONTROL_PORT &= (uint8)~LCD_ENABLE_MASK;
+    _delay_loop_1(LCD_BUS_DELAY_LOOPS);
+}
+#endif
 
-        /* Send high command */
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID, GET_BIT(data, 4));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 1, GET_BIT(data, 5));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 2, GET_BIT(data, 6));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 3, GET_BIT(data, 7));
+/*
+ * Function to wait until the LCD has executed the last operation sent by LCD_sendNow
+ */
+static void LCD_waitReady(void)
+{
+#if (LCD_RW_ENABLE == 1)
+    uint16 polls = LCD_BUSY_POLLS;
+
+    if (g_lcdBusyReadable)
+    {
+        /* The data pins stay inputs from the first poll to the last, each poll is one E pulse */
+        LCD_beginBusyReads();
+        while (LCD_readBusy() && (polls != 0))
+        {
+            polls--;
+        }
+        LCD_endBusyReads();
+        return;
+    }
+#endif
+
+    if (g_lcdSlow)
+    {
+        _delay_us(LCD_CLEAR_TIME);
+    }
+    else
+    {
+        _delay_us(LCD_EXECUTION_TIME);
+    }
+}
 
-        /* delay */
-        _delay_us(2);
+#if (LCD_RW_ENABLE == 1)
+/*
+ * Function to read the busy flag once, TRUE while the LCD executes an operation
+ */
+static boolean LCD_isBusy(void)
+{
+    boolean busy;
 
-        /* Disable */
-        GPIO_writePin(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, LOGIC_LOW);
-        _delay_us(2);
+    LCD_beginBusyReads();
+    busy = LCD_readBusy();
+    LCD_endBusyReads();
 
-        /* enable */
-        GPIO_writePin(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, LOGIC_HIGH);
-        _delay_us(2);
+    return busy;
+}
 
-        /* send low command */
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID, GET_BIT(data, 0));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 1, GET_BIT(data, 1));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 2, GET_BIT(data, 2));
-        GPIO_writePin(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 3, GET_BIT(data, 3));
+/*
+ * Function to turn the data pins into inputs and set RW, the LCD drives the data pins while RW is high
+ */
+static void LCD_beginBusyReads(void)
+{
+    LCD_DATA_DDR &= (uint8)~LCD_DATA_MASK;
+    LCD_CONTROL_PORT &= (uint8)~LCD_RS_MASK;
+    GPIO_WRITE_PIN(LCD_RW_PORT_ID, LCD_RW_PIN_ID, LOGIC_HIGH);
+}
 
-        /* delay */
-        _delay_us(2);
+/*
+ * Function to read the busy flag, between LCD_beginBusyReads and LCD_endBusyReads
+ */
+static boolean LCD_readBusy(void)
+{
+    uint8 busy;
+
+    LCD_CONTROL_PORT |= LCD_ENABLE_MASK;
+    _delay_loop_1(LCD_BUS_DELAY_LOOPS);
+    busy = GPIO_READ_PIN(LCD_DATA_PORT_ID, LCD_BUSY_PIN_ID);
+    LCD_CONTROL_PORT &= (uint8)~LCD_ENABLE_MASK;
+    _delay_loop_1(LCD_BUS_DELAY_LOOPS);
+
+    #if (LCD_BIT_MODE == 4)
+        /* The second half of the read holds the low bits of the address counter */
+        LCD_CONTROL_PORT |= LCD_ENABLE_MASK;
+        _delay_loop_1(LCD_BUS_DELAY_LOOPS);
+        LCD_CONTROL_PORT &= (uint8)~LCD_ENABLE_MASK;
+        _delay_loop_1(LCD_BUS_DELAY_LOOPS);
     #endif
 
-    GPIO_writePin(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, LOGIC_LOW);
-    _delay_us(2);
+    return (busy == LOGIC_HIGH);
+}
+
+/*
+ * Function to clear RW and drive the data pins again, the LCD releases them first
+ */
+static void LCD_endBusyReads(void)
+{
+    GPIO_WRITE_PIN(LCD_RW_PORT_ID, LCD_RW_PIN_ID, LOGIC_LOW);
+    LCD_DATA_DDR |= LCD_DATA_MASK;
 }
+#endif
 
 /*
  * Function to initialize the LCD
  */
 void LCD_init(void)
 {
+    uint8 cell;
+
 	/* Configure the direction for RS and E pins as output pins */
-    GPIO_setupPinDirection(LCD_RS_PORT_ID, LCD_RS_PIN_ID, PIN_OUTPUT);
-    GPIO_setupPinDirection(LCD_ENABLE_PORT_ID, LCD_ENABLE_PIN_ID, PIN_OUTPUT);
-    _delay_ms(20); /* LCD Power ON delay */
+    GPIO_SETUP_PORT_DIRECTION_MASKED(LCD_ENABLE_PORT_ID, LCD_RS_MASK | LCD_ENABLE_MASK, 0xFF);
+#if (LCD_RW_ENABLE == 1)
+    GPIO_WRITE_PIN(LCD_RW_PORT_ID, LCD_RW_PIN_ID, LOGIC_LOW);
+    GPIO_SETUP_PIN_DIRECTION(LCD_RW_PORT_ID, LCD_RW_PIN_ID, PIN_OUTPUT);
+#endif
+
+    /*
+     * LCD Power ON delay: the busy flag cannot be read before the function set, and the LCD
+     * ignores the instructions until its internal reset ends, 15 ms after the supply reaches 4.5 V
+     */
+    _delay_ms(20);
 
     #if (LCD_BIT_MODE == 8)
 
     	/* Configure the data port as output port */
-        GPIO_setupPortDirection(LCD_DATA_PORT_ID, PORT_OUTPUT);
+        GPIO_SETUP_PORT_DIRECTION_MASKED(LCD_DATA_PORT_ID, LCD_DATA_MASK, 0xFF);
 
         /* use 2-lines LCD + 8-bits Data Mode + 5*7 dot display Mode */
-        LCD_SendCommand(LCD_8BIT);
+        LCD_sendNow(LCD_8BIT);
     #elif (LCD_BIT_MODE == 4)
 
         /* Configure 4 pins in the data port as output pins */
-        GPIO_setupPinDirection(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID, PIN_OUTPUT);
-        GPIO_setupPinDirection(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 1, PIN_OUTPUT);
-        GPIO_setupPinDirection(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 2, PIN_OUTPUT);
-        GPIO_setupPinDirection(LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID + 3, PIN_OUTPUT);
-
-        LCD_SendCommand(LCD_4BIT);	/* use 2-lines LCD + 4-bits Data Mode + 5*7 dot display Mode */
-        LCD_SendCommand(LCD_4BIT1);	/* Send for 4 bit initialization of LCD  */
-        LCD_SendCommand(LCD_4BIT2);
+        GPIO_SETUP_PORT_DIRECTION_MASKED(LCD_DATA_PORT_ID, LCD_DATA_MASK, 0xFF);
+
+        LCD_sendNow(LCD_4BIT);	/* use 2-lines LCD + 4-bits Data Mode + 5*7 dot display Mode */
+        LCD_sendNow(LCD_4BIT1);	/* Send for 4 bit initialization of LCD  */
+        LCD_sendNow(LCD_4BIT2);
     #endif
 
-    LCD_SendCommand(LCD_CURSOR_OFF);		/* cursor off */
-    LCD_SendCommand(LCD_CLEAR_COMMAND);		/* clear LCD at the beginning */
+#if (LCD_RW_ENABLE == 1)
+    /* The interface width is set, the next operations wait for the busy flag */
+    g_lcdBusyReadable = TRUE;
+#endif
+
+    LCD_sendNow(LCD_CURSOR_OFF);		/* cursor off */
+    LCD_sendNow(LCD_CLEAR_COMMAND);		/* clear LCD at the beginning */
+
+    /* The LCD shows spaces and its address counter is on the first cell */
+    for (cell = 0; cell < LCD_NUM_CELLS; cell++)
+    {
+        g_lcdScreen[cell] = ' ';
+    }
+    g_lcdAddress = 0;
+    LCD_clearScreen();
+    g_lcdModified = FALSE;
+
+    /* The queue starts after the clear */
+    LCD_waitReady();
+}
+
+/*
+ * Function to display a character in the shadow and move the cursor to the next cell
+ */
+void LCD_displayCharacter(uint8 data)
+{
+    if (g_lcdCol < LCD_NUM_COLS)
+    {
+        g_lcdShadow[(g_lcdRow * LCD_NUM_COLS) + g_lcdCol] = data;
+        g_lcdModified = TRUE;
+    }
+    g_lcdCol++;
 }
 
 /*
@@ -166,24 +627,11 @@ void LCD_displayString(const char* string)
  */
 void LCD_moveCursor(uint8 row, uint8 col)
 {
-    uint8 address;
-    switch (row)
+    if (row < LCD_NUM_ROWS)
     {
-    case 0:
-        address = col;
-        break;
-    case 1:
-        address = col + 0x40;
-        break;
-    case 2:
-        address = col + 0x10;
-        break;
-    case 3:
-        address = col + 0x50;
-        break;
+        g_lcdRow = row;
+        g_lcdCol = col;
     }
-    LCD_SendCommand(address | LCD_MOVE_CURSOR);
-    _delay_us(2);
 }
 
 /*
@@ -196,19 +644,246 @@ void LCD_displaySringRowColumn(const char* string, uint8 row, uint8 col)
 }
 
 /*
- * Function to clear the LCD screen
+ * Function to clear the shadow of the LCD screen
  */
 void LCD_clearScreen(void)
 {
-    LCD_SendCommand(LCD_CLEAR_COMMAND);
+    uint8 cell;
+
+    for (cell = 0; cell < LCD_NUM_CELLS; cell++)
+    {
+        g_lcdShadow[cell] = ' ';
+    }
+    g_lcdRow = 0;
+    g_lcdCol = 0;
+    g_lcdModified = TRUE;
 }
 
 /*
- * Function to convert an integer to a string and display it on the LCD
+ * Function to mark the changed cells of the shadow for the drain. It never waits: the marks are
+ * one bit per cell, a cell changed again before the drain sent it is sent once with its last value.
+ * When a clear command and the cells that are not blank take fewer bytes than the changed cells,
+ * the drain clears the LCD first: a new screen with blank rows costs one byte for them.
+ */
+uint8 LCD_flush(void)
+{
+    uint8 cell, i;
+    uint8 bytes;
+    uint8 clearBytes;
+    uint8 sreg;
+
+    if (!g_lcdModified)
+    {
+        return 0;
+    }
+    g_lcdModified = FALSE;
+
+    PROFILE_BEGIN(LCD_FLUSH);
+
+    bytes = LCD_countBytes(FALSE);
+    clearBytes = 1 + LCD_countBytes(TRUE);
+
+    if (clearBytes < bytes)
+    {
+        /* No cell is sent until the clear is queued, the drain stops meanwhile if it has nothing else */
+        sreg = SREG;
+        cli();
+        for (i = 0; i < LCD_DIRTY_BYTES; i++)
+        {
+            g_lcdDirty[i] = 0;
+        }
+        g_lcdClear = TRUE;
+        SREG = sreg;
+
+        for (cell = 0; cell < LCD_NUM_CELLS; cell++)
+        {
+            g_lcdScreen[cell] = g_lcdShadow[cell];
+            if (g_lcdShadow[cell] != ' ')
+            {
+                LCD_markCell(cell);
+            }
+        }
+        bytes = clearBytes;
+    }
+    else
+    {
+        for (cell = 0; cell < LCD_NUM_CELLS; cell++)
+        {
+            if (g_lcdShadow[cell] != g_lcdScreen[cell])
+            {
+                g_lcdScreen[cell] = g_lcdShadow[cell];
+                LCD_markCell(cell);
+            }
+        }
+    }
+
+    if (bytes != 0)
+    {
+        LCD_startDrain();
+    }
+
+    PROFILE_END(LCD_FLUSH);
+    TRACE1(LCD_FLUSH, bytes);
+
+    return bytes;
+}
+
+/*
+ * Function to count the bytes the drain sends to show the shadow, if the previous flush is over:
+ * the changed cells, and a cursor move before each cell that does not follow the last one sent.
+ * After a clear (cleared TRUE) the changed cells are the ones that are not blank, from the first cell.
+ */
+static uint8 LCD_countBytes(boolean cleared)
+{
+    uint8 row, col, cell;
+    uint8 shown;
+    uint8 address = cleared ? 0 : g_lcdAddress;
+    uint8 bytes = 0;
+
+    for (row = 0; row < LCD_NUM_ROWS; row++)
+    {
+        for (col = 0; col < LCD_NUM_COLS; col++)
+        {
+            cell = (row * LCD_NUM_COLS) + col;
+            shown = cleared ? ' ' : g_lcdScreen[cell];
+            if (g_lcdShadow[cell] == shown)
+            {
+                continue;
+            }
+
+            /* The address counter moves by itself after each character, except to the next row */
+            if (address != cell)
+            {
+                bytes++;
+            }
+            bytes++;
+            address = (col == (LCD_NUM_COLS - 1)) ? LCD_NO_CELL : (cell + 1);
+        }
+    }
+    return bytes;
+}
+
+/*
+ * Function to check if the drain is stopped: no command and no cell is waiting
+ */
+boolean LCD_isIdle(void)
+{
+    return !g_lcdDraining;
+}
+
+/*
+ * Function to display an integer on the LCD
  */
 void LCD_intgerToString(int data)
 {
-   char buff[16];
-   itoa(data, buff, 10);
-   LCD_displayString(buff);
+    uint16 value = (uint16)data;
+
+    if (data < 0)
+    {
+        LCD_displayCharacter('-');
+        value = (uint16)0 - value;
+    }
+    LCD_displayNumber(value, 0);
+}
+
+/*
+ * Function to display an unsigned number on the LCD in decimal, right aligned on width cells.
+ * The binary to BCD conversion is the double dabble (shift and add 3): the AVR has no divider, and
+ * a few shifts and compares per bit of the value replace a division by 10 per digit.
+ */
+void LCD_displayNumber(uint16 value, uint8 width)
+{
+    /* Packed BCD digits, two per byte: units and tens, hundreds and thousands, ten thousands */
+    uint8 low = 0;
+    uint8 middle = 0;
+    uint8 high = 0;
+    uint8 digits[LCD_NUMBER_DIGITS];
+    uint8 bits = 16;
+    uint8 i;
+
+    PROFILE_BEGIN(LCD_NUMBER);
+
+    /* The leading zero bits give zero digits, skip them */
+    while ((bits != 0) && ((value & 0x8000) == 0))
+    {
+        value <<= 1;
+        bits--;
+    }
+
+    /*
+     * Shift the bits of the value into the digits from the highest one. The ten thousands digit is
+     * 6 at most at the end, so it is 3 at most before a shift and never needs the adjust.
+     */
+    for (; bits != 0; bits--)
+    {
+        low = LCD_bcdAdjust(low);
+        middle = LCD_bcdAdjust(middle);
+        high = (uint8)(high << 1) | (middle >> 7);
+        middle = (uint8)(middle << 1) | (low >> 7);
+        low = (uint8)(low << 1) | ((value & 0x8000) ? 1 : 0);
+        value <<= 1;
+    }
+
+    digits[0] = high;
+    digits[1] = middle >> 4;
+    digits[2] = middle & 0x0F;
+    digits[3] = low >> 4;
+    digits[4] = low & 0x0F;
+
+    /* The leading zeros are spaces inside the width and dropped outside, the units are always shown */
+    for (; width > LCD_NUMBER_DIGITS; width--)
+    {
+        LCD_displayCharacter(' ');
+    }
+    for (i = 0; (i < (LCD_NUMBER_DIGITS - 1)) && (digits[i] == 0); i++)
+    {
+        if ((LCD_NUMBER_DIGITS - i) <= width)
+        {
+            LCD_displayCharacter(' ');
+        }
+    }
+    for (; i < LCD_NUMBER_DIGITS; i++)
+    {
+        LCD_displayCharacter('0' + digits[i]);
+    }
+
+    PROFILE_END(LCD_NUMBER);
+}
+
+/*
+ * Function to add 3 to each BCD digit of 5 or more: doubled, it goes over 9 and carries into the
+ * next digit, as a decimal digit would
+ */
+static uint8 LCD_bcdAdjust(uint8 bcd)
+{
+    if ((bcd & 0x0F) >= 0x05)
+    {
+        bcd += 0x03;
+    }
+    if ((bcd & 0xF0) >= 0x50)
+    {
+        bcd += 0x30;
+    }
+    return bcd;
+}
+
+/*
+ * Function to get the DDRAM address of a cell
+ */
+static uint8 LCD_cellAddress(uint8 row, uint8 col)
+{
+    uint8 address = col;
+    switch (row)
+    {
+    case 1:
+        address = col + 0x40;
+        break;
+    case 2:
+        address = col + 0x10;
+        break;
+    case 3:
+        address = col + 0x50;
+        break;
+    }
+    return address;
 }
@@ -3,6 +3,37 @@
  *	Description: Header file for the LCD driver
  *  Created on: Feb 10, 2024
  *      Author: abdalla
+ *
+ * The display functions write to a shadow of the screen in RAM, nothing is sent to the LCD until
+ * LCD_flush. The flush compares the shadow with what the LCD shows and sends only the changed
+ * cells, with a cursor move only where the next changed cell does not follow the last one written.
+ * A new screen starts with LCD_clearScreen, which clears the shadow only: the cells that stay the
+ * same are not sent again. When a clear command and the cells that are not blank take fewer bytes
+ * than the changed cells, as for a screen with fewer rows than the last one, the flush sends the
+ * clear command instead and the LCD is blank for LCD_CLEAR_TIME.
+ * Characters written beyond the end of a row are dropped, as the LCD would not show them.
+ * LCD_SendCommand goes to the LCD without the shadow, it must not change the characters shown.
+ *
+ * LCD_flush and LCD_SendCommand never wait for the LCD. The flush marks the changed cells, one bit
+ * per cell, and LCD_SendCommand puts the command in a queue of LCD_COMMAND_QUEUE_SIZE commands;
+ * it returns FALSE when the queue is full. A deferred software timer drains them, one operation
+ * every LCD_DRAIN_PERIOD, which is longer than the execution time of the HD44780, LCD_EXECUTION_TIME:
+ * the queued commands first, then the marked cells from the address counter of the LCD on.
+ * A cell marked twice before it is sent is sent once, so any number of flushes fits in the marks.
+ * The drain runs from SOFT_TIMER_runDeferred in the main loop, and sends nothing before the
+ * execution time of its last operation is over: a clear or return home command takes
+ * LCD_CLEAR_TIME and skips the next drains. With the RW pin
+ * (LCD_RW_ENABLE) the drain also reads the busy flag and waits one more period for a slower LCD.
+ * A whole screen (32 characters and 2 cursor moves) takes 34 ms.
+ * LCD_init sends its commands directly and waits for each of them, before the system tick starts.
+ *
+ * CPU cost: the drain writes one byte per tick in the main loop (LCD_COMMAND and LCD_CHARACTER
+ * regions of the profiler) while a command or a cell is waiting, none in the tick ISR.
+ * Estimate only, not measured on the target: without the edge delays a character costs about 40
+ * cycles at -Os in 4-bit mode (one masked write of the data port per nibble), against about 490
+ * cycles with one GPIO_writePin call per pin. The profiler regions give the real figure.
+ * Memory cost: LCD_COMMAND_QUEUE_SIZE + 2 * LCD_NUM_ROWS * LCD_NUM_COLS bytes of RAM, and one bit
+ * per cell.
  */
 
 #ifndef LCD_H_
@@ -22,6 +53,43 @@
 
 #endif
 
+/*
+ * LCD RW pin configuration, its value should be 0 (RW tied to ground, fixed waits) or
+ * 1 (RW on LCD_RW_PIN_ID, the busy flag is read).
+ * The drain sends one operation per LCD_DRAIN_PERIOD either way, so the busy flag does not make
+ * the screens faster: it only shortens the waits of LCD_init and covers an LCD slower than the
+ * datasheet, for one more read with its E pulse in each drain. It pays off in
+ * builds optimized for speed or size; at -O0 (the Debug build) each read costs about as much as
+ * the fixed wait it replaces.
+ */
+#define LCD_RW_ENABLE				0
+
+#if((LCD_RW_ENABLE != 0) && (LCD_RW_ENABLE != 1))
+
+#error "LCD_RW_ENABLE should be equal to 0 or 1"
+
+#endif
+
+/* Execution times of the datasheet in micro seconds, for the slowest LCD oscillator (190 kHz) */
+#define LCD_EXECUTION_TIME			53
+#define LCD_CLEAR_TIME				2160
+
+/*
+ * Longest wait for the busy flag in polls, 10 ms at least: a missing LCD reads busy through the
+ * pull-ups of the data pins and must not stop the program
+ */
+#define LCD_BUSY_POLLS				1000
+
+/* Size of the queue of the commands, must be a power of two up to 128 */
+#define LCD_COMMAND_QUEUE_SIZE		4
+
+/* Time between two operations sent by the drain in milliseconds (system ticks) */
+#define LCD_DRAIN_PERIOD			1
+
+/* LCD size in characters */
+#define LCD_NUM_ROWS				2
+#define LCD_NUM_COLS				16
+
 /* LCD HW Ports and Pins Ids */
 #define LCD_RS_PORT_ID				PORTB_ID
 #define LCD_RS_PIN_ID				PIN0_ID
@@ -29,11 +97,15 @@
 #define LCD_ENABLE_PORT_ID			PORTB_ID
 #define LCD_ENABLE_PIN_ID			PIN1_ID
 
+#define LCD_RW_PORT_ID				PORTB_ID
+#define LCD_RW_PIN_ID				PIN3_ID
+
 #define LCD_DATA_PORT_ID			PORTC_ID
 #define LCD_DATA_FIRST_PIN_ID		PIN0_ID
 
 /* LCD Commands */
 #define LCD_CLEAR_COMMAND			0x01
+#define LCD_RETURN_HOME				0x02
 #define LCD_8BIT			   		0x38
 #define LCD_4BIT			   		0x28
 #define LCD_4BIT1			   		0x33
@@ -51,13 +123,14 @@
 
 /*
  * Description :
- * Send the required command to the screen
+ * Put the required command in the queue of the screen, it never waits.
+ * returns: FALSE if the queue is full and the command is dropped.
  */
-void LCD_SendCommand(uint8 command);
+boolean LCD_SendCommand(uint8 command);
 
 /*
  * Description :
- * Display the required character on the screen
+ * Display the required character on the screen (in the shadow) and move the cursor to the next cell
  */
 void LCD_displayCharacter(uint8 data);
 /*
@@ -89,8 +162,28 @@ void LCD_displaySringRowColumn(const char* string, uint8 row, uint8 col);
 void LCD_intgerToString(int data);
 /*
  * Description :
- * Send the clear screen command
+ * Display the required unsigned value on the screen in decimal, right aligned with spaces on width
+ * cells at least (0 for no alignment), without any division.
+ * Its cost was not measured: about 35 cycles per significant bit against about 140 per digit for
+ * itoa are estimates from the instruction sequences, the LCD_NUMBER profiler region measures it.
+ */
+void LCD_displayNumber(uint16 value, uint8 width);
+/*
+ * Description :
+ * Clear the screen (the shadow) and move the cursor to the first cell
  */
 void LCD_clearScreen(void);
+/*
+ * Description :
+ * Mark the cells of the shadow that changed since the last flush for the drain, it never waits.
+ * returns: the number of bytes (cursor moves and characters) the drain sends for them, once the
+ * previous flush is sent.
+ */
+uint8 LCD_flush(void);
+/*
+ * Description :
+ * Return TRUE when the drain is stopped: the LCD shows the shadow of the last flush.
+ */
+boolean LCD_isIdle(void);
 
 #endif /* SRC_LCD_H_ */
@@ -0,0 +1,153 @@
+/*
+ * power.c
+ *	Description: Source file for the idle sleep and the CPU duty cycle measure
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "power.h"
+
+#if (POWER_SLEEP_ENABLE == 1)
+
+#include "timer1.h"
+#include "soft_timer.h"
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Start of the measure and the time asleep since then, in micro seconds */
+static uint32 g_powerStart = 0;
+static uint32 g_powerAsleep = 0;
+
+/* Sleeps ended by an interrupt since the start of the measure */
+static uint32 g_powerWakes = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Send a string through the output function */
+static void POWER_sendString(void (*send_byte)(const uint8 data), const char * str);
+
+/* Send an unsigned number in decimal through the output function, with at least min_digits digits */
+static void POWER_sendNumber(void (*send_byte)(const uint8 data), uint32 number, uint8 min_digits);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Sleep in the idle mode until the next interrupt and add the time asleep to the measure.
+ * It must be called with the interrupts disabled, it returns with the interrupts enabled.
+ */
+void POWER_idle(void)
+{
+	uint32 sleep_start, wake_end, tick_start;
+
+	/* Without any timer running the tick is stopped, only the other interrupts wake the CPU */
+	(void)SOFT_TIMER_suspendTick();
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	sleep_enable();
+	sleep_start = TIMER1_getTimestamp();
+
+	/*
+	 * The instruction after sei always runs before an interrupt: an interrupt pending since the
+	 * check of the caller runs after the sleep instruction, and wakes the CPU at once.
+	 */
+	sei();
+	sleep_cpu();
+	sleep_disable();
+	wake_end = TIMER1_getTimestamp();
+	g_powerWakes++;
+
+	/*
+	 * A tick ISR that started during the sleep woke the CPU, its time is awake time. A tick with the
+	 * timestamp of the sleep start ran before it, in the same micro second.
+	 */
+	tick_start = SOFT_TIMER_getTickTimestamp();
+	if ((tick_start != sleep_start) && ((tick_start - sleep_start) <= (wake_end - sleep_start)))
+	{
+		g_powerAsleep += tick_start - sleep_start;
+	}
+	else
+	{
+		g_powerAsleep += wake_end - sleep_start;
+	}
+}
+
+/*
+ * Description :
+ * Write one text line with the awake share of the CPU, the estimated current and the number of
+ * wakes since the last dump, then start a new measure.
+ */
+void POWER_dump(void (*send_byte)(const uint8 data))
+{
+	uint32 now = TIMER1_getTimestamp();
+	uint32 total = now - g_powerStart;
+	uint32 awake;
+	uint32 current;
+
+	/* Awake share in hundredths of percent, a measure shorter than 10 ms is not written */
+	total /= 10000;
+	if (total == 0)
+	{
+		return;
+	}
+	awake = (now - g_powerStart) - g_powerAsleep;
+	awake /= total;
+	if (awake > 10000)
+	{
+		awake = 10000;
+	}
+	current = POWER_IDLE_CURRENT + (((POWER_ACTIVE_CURRENT - POWER_IDLE_CURRENT) * awake) / 10000);
+
+	POWER_sendString(send_byte, "CPU awake=");
+	POWER_sendNumber(send_byte, awake / 100, 1);
+	(*send_byte)('.');
+	POWER_sendNumber(send_byte, awake % 100, 2);
+	POWER_sendString(send_byte, "% current=");
+	POWER_sendNumber(send_byte, current, 1);
+	POWER_sendString(send_byte, " uA wakes=");
+	POWER_sendNumber(send_byte, g_powerWakes, 1);
+	POWER_sendString(send_byte, "\r\n");
+
+	g_powerStart = now;
+	g_powerAsleep = 0;
+	g_powerWakes = 0;
+}
+
+/* Send a string through the output function */
+static void POWER_sendString(void (*send_byte)(const uint8 data), const char * str)
+{
+	while (*str != '\0')
+	{
+		(*send_byte)(*str);
+		str++;
+	}
+}
+
+/* Send an unsigned number in decimal through the output function, with at least min_digits digits */
+static void POWER_sendNumber(void (*send_byte)(const uint8 data), uint32 number, uint8 min_digits)
+{
+	/* A 32-bit number has at most 10 decimal digits, they are found from the lowest one */
+	uint8 digits[10];
+	uint8 i = 0;
+
+	do
+	{
+		digits[i++] = '0' + (number % 10);
+		number /= 10;
+	} while ((number != 0) || (i < min_digits));
+
+	while (i > 0)
+	{
+		(*send_byte)(digits[--i]);
+	}
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * power.h
+ *	Description: Header file for the idle sleep and the CPU duty cycle measure
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The main loop of the HMI only waits for interrupts: the keypad, the UART, the system tick and
+ * the software UART. POWER_idle puts the CPU in the idle sleep mode after each round of the loop,
+ * the clocks of the peripherals keep running and any interrupt wakes it up. The main loop checks
+ * for pending work with the interrupts disabled and calls POWER_idle without enabling them: the
+ * sleep instruction follows sei, so an interrupt that comes after the check wakes the CPU at once
+ * and no event waits for the next interrupt.
+ *
+ * POWER_idle stops the system tick (SOFT_TIMER_suspendTick) when no software timer is running.
+ * With KEYPAD_WAKE_ENABLE the scan stops after its idle scans and waits for INT2, and the LCD drain
+ * stops once the screen is sent, so an idle HMI only wakes for the Timer1 overflow of the timestamps,
+ * 15.3 times a second, instead of 1000 ticks a second. Without KEYPAD_WAKE_ENABLE the scan keeps a
+ * timer running and the tick never stops. The waits polled by the HMI without a timer, the debug
+ * dump period and the clock synchronization period and timeout, are seen at the next wake while the
+ * tick is stopped: up to one overflow period (65.5 ms) late.
+ *
+ * The time spent asleep is summed with Timer1. When the system tick wakes the CPU the sleep ends
+ * at the start of the tick ISR, so the time of the tick is counted as awake. The time of the other
+ * interrupts that wake the CPU is counted as asleep. POWER_dump gives the awake share of the CPU and
+ * the number of wakes since the last dump, and the estimated supply current of the MCU from the
+ * typical currents below; the LCD and the keypad are not included.
+ *
+ * Host_Tools/src/power_test.c runs this sleep on the models and counts the wakes (ten idle seconds):
+ *   KEYPAD_WAKE_ENABLE 0: 1015.3 wakes/s (1000 ticks, 15.3 overflows)
+ *   KEYPAD_WAKE_ENABLE 1: 25.3 wakes/s in the first ten seconds (the idle scans), 15.3 wakes/s after
+ * The host does not run the code in target time, so the awake time of a wake is not measured; at an
+ * estimated 150 us per wake (-O0) the awake share is 15.2% (6489 uA) against 0.22% (5514 uA). The
+ * awake share and the current of the target are only given by POWER_dump on the target.
+ *
+ * The sleep is compiled out unless POWER_SLEEP_ENABLE is set to 1. It is only used by the main
+ * loop, with KERNEL_ENABLE the idle task of the kernel keeps the CPU running.
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Idle sleep configuration, its value should be 0 (disabled) or 1 (enabled) */
+#define POWER_SLEEP_ENABLE          0
+
+#if((POWER_SLEEP_ENABLE != 0) && (POWER_SLEEP_ENABLE != 1))
+
+#error "POWER_SLEEP_ENABLE should be equal to 0 or 1"
+
+#endif
+
+/* Typical supply currents of the ATmega32 at 8 MHz and 5 V in micro amperes (datasheet) */
+#define POWER_ACTIVE_CURRENT        12000UL
+#define POWER_IDLE_CURRENT          5500UL
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+#if (POWER_SLEEP_ENABLE == 1)
+
+/*
+ * Description :
+ * Sleep in the idle mode until the next interrupt and add the time asleep to the measure. The tick
+ * is stopped if no software timer is running. It must be called with the interrupts disabled, after
+ * the check for pending work, and returns with the interrupts enabled.
+ */
+void POWER_idle(void);
+
+/*
+ * Description :
+ * Write one text line with the awake share of the CPU in percent, the estimated current and the
+ * number of wakes since the last dump, then start a new measure. Each byte is given to the send_byte function.
+ */
+void POWER_dump(void (*send_byte)(const uint8 data));
+
+#endif
+
+#endif /* POWER_H_ */
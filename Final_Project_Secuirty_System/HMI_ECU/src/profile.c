@@ -0,0 +1,169 @@
+/*
+ * profile.c
+ *	Description: Source file for the execution time profiler
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "profile.h"
+
+#if (PROFILE_ENABLE == 1)
+
+#include <avr/io.h> 		/* To use the SREG Register */
+#include <avr/interrupt.h> 	/* For cli() */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Structure of the results of one region */
+typedef struct
+{
+	uint32 count;       /* Number of runs */
+	uint32 min;         /* Shortest run in micro seconds */
+	uint32 max;         /* Longest run in micro seconds */
+	uint32 total;       /* Sum of all runs in micro seconds */
+}PROFILE_StatsType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Start time of each region, written by PROFILE_BEGIN */
+volatile uint32 g_profileStart[PROFILE_NUM_OF_REGIONS];
+
+/* Results of each region */
+static volatile PROFILE_StatsType g_profileStats[PROFILE_NUM_OF_REGIONS];
+
+/* Names of the regions for the dump, generated from the list in profile.h */
+#define PROFILE_REGION_NAME(name)   #name,
+static const char * const g_regionNames[PROFILE_NUM_OF_REGIONS] = {PROFILE_REGIONS(PROFILE_REGION_NAME)};
+#undef PROFILE_REGION_NAME
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Send a string through the output function */
+static void PROFILE_sendString(void (*send_byte)(const uint8 data), const char * str);
+
+/* Send an unsigned number in decimal through the output function */
+static void PROFILE_sendNumber(void (*send_byte)(const uint8 data), uint32 number);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Add one run of a region that took the given number of micro seconds.
+ * It is safe to call from ISRs and from the main program.
+ */
+void PROFILE_record(PROFILE_Region region, uint32 elapsed_us)
+{
+	volatile PROFILE_StatsType * stats_ptr = &g_profileStats[region];
+	uint8 sreg = SREG;
+	cli();
+
+	if ((stats_ptr->count == 0) || (elapsed_us < stats_ptr->min))
+	{
+		stats_ptr->min = elapsed_us;
+	}
+	if (elapsed_us > stats_ptr->max)
+	{
+		stats_ptr->max = elapsed_us;
+	}
+	stats_ptr->total += elapsed_us;
+	stats_ptr->count++;
+
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Clear the results of all regions.
+ */
+void PROFILE_reset(void)
+{
+	uint8 region;
+	uint8 sreg = SREG;
+	cli();
+
+	for (region = 0; region < PROFILE_NUM_OF_REGIONS; region++)
+	{
+		g_profileStats[region].count = 0;
+		g_profileStats[region].min = 0;
+		g_profileStats[region].max = 0;
+		g_profileStats[region].total = 0;
+	}
+
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Send the results as text lines "NAME n=.. min=.. max=.. mean=.. us" through the given
+ * byte output function (for example UART_sendByte). Regions that never ran are skipped.
+ */
+void PROFILE_dump(void (*send_byte)(const uint8 data))
+{
+	uint8 region;
+	PROFILE_StatsType stats;
+	uint8 sreg;
+
+	for (region = 0; region < PROFILE_NUM_OF_REGIONS; region++)
+	{
+		/* Take a consistent copy, an ISR may record the same region while sending */
+		sreg = SREG;
+		cli();
+		stats = g_profileStats[region];
+		SREG = sreg;
+
+		if (stats.count == 0)
+		{
+			continue;
+		}
+
+		PROFILE_sendString(send_byte, g_regionNames[region]);
+		PROFILE_sendString(send_byte, " n=");
+		PROFILE_sendNumber(send_byte, stats.count);
+		PROFILE_sendString(send_byte, " min=");
+		PROFILE_sendNumber(send_byte, stats.min);
+		PROFILE_sendString(send_byte, " max=");
+		PROFILE_sendNumber(send_byte, stats.max);
+		PROFILE_sendString(send_byte, " mean=");
+		PROFILE_sendNumber(send_byte, stats.total / stats.count);
+		PROFILE_sendString(send_byte, " us\r\n");
+	}
+}
+
+/* Send a string through the output function */
+static void PROFILE_sendString(void (*send_byte)(const uint8 data), const char * str)
+{
+	while (*str != '\0')
+	{
+		(*send_byte)(*str);
+		str++;
+	}
+}
+
+/* Send an unsigned number in decimal through the output function */
+static void PROFILE_sendNumber(void (*send_byte)(const uint8 data), uint32 number)
+{
+	/* A 32-bit number has at most 10 decimal digits, they are found from the lowest one */
+	uint8 digits[10];
+	uint8 i = 0;
+
+	do
+	{
+		digits[i++] = '0' + (number % 10);
+		number /= 10;
+	} while (number != 0);
+
+	while (i > 0)
+	{
+		(*send_byte)(digits[--i]);
+	}
+}
+
+#endif
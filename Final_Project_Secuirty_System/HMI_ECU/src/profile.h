@@ -0,0 +1,107 @@
+/*
+ * profile.h
+ *	Description: Header file for the execution time profiler
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * A region is timed between PROFILE_BEGIN and PROFILE_END with the Timer1 timestamp
+ * (one micro second per count). Each region keeps the number of runs, the minimum, the
+ * maximum and the total time, the mean is calculated when the results are dumped.
+ * The profiler is compiled out unless PROFILE_ENABLE is set to 1, then the markers cost nothing.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Profiler configuration, its value should be 0 (disabled) or 1 (enabled) */
+#define PROFILE_ENABLE              0
+
+#if((PROFILE_ENABLE != 0) && (PROFILE_ENABLE != 1))
+
+#error "PROFILE_ENABLE should be equal to 0 or 1"
+
+#endif
+
+/*
+ * List of the profiled regions of the HMI ECU.
+ * To add a region add a REGION(name) line, the name is used in PROFILE_BEGIN/PROFILE_END.
+ */
+#define PROFILE_REGIONS(REGION) \
+	REGION(LCD_COMMAND) \
+	REGION(LCD_CHARACTER) \
+	REGION(LCD_FLUSH) \
+	REGION(LCD_NUMBER) \
+	REGION(KERNEL_WAKE) \
+	REGION(SOFT_UART_BYTE) \
+	REGION(KEYPAD_SCAN) \
+	REGION(KEY_TO_DISPLAY)
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum of the profiled regions, generated from the list above */
+#define PROFILE_REGION_ID(name)     PROFILE_##name,
+typedef enum
+{
+	PROFILE_REGIONS(PROFILE_REGION_ID)
+	PROFILE_NUM_OF_REGIONS
+}PROFILE_Region;
+#undef PROFILE_REGION_ID
+
+#if (PROFILE_ENABLE == 1)
+
+#include "timer1.h"
+
+/* Start time of each region, written by PROFILE_BEGIN */
+extern volatile uint32 g_profileStart[PROFILE_NUM_OF_REGIONS];
+
+/*
+ * Mark the start and the end of a profiled region. Both are plain statements so they can be
+ * used anywhere a statement is allowed, the region name is one of the PROFILE_REGIONS list.
+ */
+#define PROFILE_BEGIN(name)         (g_profileStart[PROFILE_##name] = TIMER1_getTimestamp())
+#define PROFILE_END(name)           PROFILE_record(PROFILE_##name, TIMER1_getTimestamp() - g_profileStart[PROFILE_##name])
+
+#else
+
+#define PROFILE_BEGIN(name)         ((void)0)
+#define PROFILE_END(name)           ((void)0)
+
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+#if (PROFILE_ENABLE == 1)
+
+/*
+ * Description :
+ * Add one run of a region that took the given number of micro seconds.
+ * It is safe to call from ISRs and from the main program.
+ */
+void PROFILE_record(PROFILE_Region region, uint32 elapsed_us);
+
+/*
+ * Description :
+ * Clear the results of all regions.
+ */
+void PROFILE_reset(void);
+
+/*
+ * Description :
+ * Send the results as text lines "NAME n=.. min=.. max=.. mean=.. us" through the given
+ * byte output function (for example UART_sendByte). Regions that never ran are skipped.
+ */
+void PROFILE_dump(void (*send_byte)(const uint8 data));
+
+#endif
+
+#endif /* PROFILE_H_ */
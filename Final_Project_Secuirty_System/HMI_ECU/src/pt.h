@@ -0,0 +1,64 @@
+/*
+ * pt.h
+ *	Description: Stackless threads (protothreads) built on the switch statement
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * A thread is a function that returns each time it has to wait. The line to continue from is kept
+ * in a PT_Type variable (2 bytes), so all the threads share the one stack of the main loop.
+ * Rules for the thread functions:
+ *  - Local variables are lost at every wait, keep the thread state in static variables.
+ *  - The waiting macros must not be used inside a switch statement of the thread itself.
+ */
+
+#ifndef PT_H_
+#define PT_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Structure holding the continuation point of a thread */
+typedef struct
+{
+	uint16 line;    /* Source line of the last wait, zero before the first run */
+}PT_Type;
+
+/* Enum defining the values returned by a thread function */
+typedef enum
+{
+	PT_WAITING,     /* The thread is waiting and must be called again */
+	PT_EXITED       /* The thread reached its end */
+}PT_Status;
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Make the thread start from its beginning on the next call */
+#define PT_INIT(pt)                 ((pt)->line = 0)
+
+/* First and last statements of a thread function */
+#define PT_BEGIN(pt)                { uint8 pt_yielded = TRUE; (void)pt_yielded; switch ((pt)->line) { case 0:
+#define PT_END(pt)                  } PT_INIT(pt); return PT_EXITED; }
+
+/* Return to the caller until the condition is true, the condition is checked on every call */
+#define PT_WAIT_UNTIL(pt, condition) \
+	do { (pt)->line = __LINE__; case __LINE__: if (!(condition)) { return PT_WAITING; } } while (0)
+
+#define PT_WAIT_WHILE(pt, condition)    PT_WAIT_UNTIL((pt), !(condition))
+
+/* Return to the caller once so the other threads can run */
+#define PT_YIELD(pt) \
+	do { pt_yielded = FALSE; (pt)->line = __LINE__; case __LINE__: if (!pt_yielded) { return PT_WAITING; } } while (0)
+
+/* Run a child thread from its beginning and wait until it exits */
+#define PT_SPAWN(pt, child, thread) \
+	do { PT_INIT(child); PT_WAIT_UNTIL((pt), (thread) != PT_WAITING); } while (0)
+
+/* Leave the thread, it starts from its beginning on the next call */
+#define PT_EXIT(pt)                 do { PT_INIT(pt); return PT_EXITED; } while (0)
+
+#endif /* PT_H_ */
@@ -0,0 +1,478 @@
+/*
+ * soft_timer.c
+ *	Description: Source file for the software timers driver
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "soft_timer.h"
+#include "timer1.h"
+#include <avr/io.h> 		/* To use the SREG Register */
+#include <avr/interrupt.h> 	/* For cli() */
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Milliseconds since the tick started, written by the tick ISR only */
+static volatile uint32 g_ticks = 0;
+
+/* Timer1 timestamp taken at the start of the last tick ISR */
+static volatile uint32 g_tickTimestamp = 0;
+
+/* Timer1 timestamp of the compare match of the next tick */
+static volatile uint32 g_nextTick = 0;
+
+/* Timers linked in the wheel, and TRUE while the tick interrupt is stopped */
+static volatile uint8 g_activeTimers = 0;
+static volatile boolean g_tickSuspended = FALSE;
+
+/* Timer wheel, each slot is a doubly linked list of timers */
+static SOFT_TIMER_Type * volatile g_wheel[SOFT_TIMER_WHEEL_SIZE];
+
+/* Deferred timers expired and waiting for SOFT_TIMER_runDeferred, oldest first */
+static SOFT_TIMER_Type * volatile g_readyHead = NULL_PTR;
+static SOFT_TIMER_Type * volatile g_readyTail = NULL_PTR;
+
+/* Called by the tick when it puts deferred timers in the ready list */
+static void (*volatile g_readyCallBack)(void) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Timer1 compare callback, runs every 1 ms */
+static void SOFT_TIMER_tick(void);
+
+/* Link a timer in the slot of its deadline (interrupts must be disabled) */
+static void SOFT_TIMER_link(SOFT_TIMER_Type * timer_ptr);
+
+/* Unlink a timer from its slot (interrupts must be disabled) */
+static void SOFT_TIMER_unlink(SOFT_TIMER_Type * timer_ptr);
+
+/* Start a timer, deferred or not (interrupts must be disabled) */
+static void SOFT_TIMER_set(SOFT_TIMER_Type * timer_ptr, uint32 delay_ms, uint32 period_ms, void (*callback)(void), boolean deferred);
+
+/* Remove a timer from the ready list if it waits in it (interrupts must be disabled) */
+static void SOFT_TIMER_unready(SOFT_TIMER_Type * timer_ptr);
+
+/* Count the ticks missed while the tick is stopped (interrupts must be disabled) */
+static void SOFT_TIMER_catchUp(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Take the compare A channel of Timer1 for the 1 ms system tick and clear the timer wheel.
+ * Timer1 must be initialized before.
+ */
+void SOFT_TIMER_init(void)
+{
+	uint8 i;
+
+	for (i = 0; i < SOFT_TIMER_WHEEL_SIZE; i++)
+	{
+		g_wheel[i] = NULL_PTR;
+	}
+	g_ticks = 0;
+	g_readyHead = NULL_PTR;
+	g_readyTail = NULL_PTR;
+	g_activeTimers = 0;
+	g_tickSuspended = FALSE;
+
+	/* The first tick is one period after now, the counter is never stopped */
+	g_nextTick = TIMER1_getTimestamp() + SOFT_TIMER_TICK_COUNTS;
+	TIMER1_allocateChannel(TIMER1_CHANNEL_A, SOFT_TIMER_tick);
+	TIMER1_setCompare(TIMER1_CHANNEL_A, (uint16)g_nextTick);
+}
+
+/*
+ * Description :
+ * Start (or restart) a software timer.
+ * 	1. The callback is called from the tick ISR after delay_ms milliseconds.
+ * 	2. If period_ms is not zero the timer is reloaded and fires every period_ms milliseconds.
+ * The callback runs in interrupt context so it should be short.
+ */
+void SOFT_TIMER_start(SOFT_TIMER_Type * timer_ptr, uint32 delay_ms, uint32 period_ms, void (*callback)(void))
+{
+	/* Save the interrupt state and disable interrupts while the wheel is changed */
+	uint8 sreg = SREG;
+	cli();
+
+	SOFT_TIMER_set(timer_ptr, delay_ms, period_ms, callback, FALSE);
+
+	/* Restore the interrupt state */
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Start (or restart) a deferred software timer, same as SOFT_TIMER_start except that the callback
+ * is called from SOFT_TIMER_runDeferred, outside of the tick ISR. It may be called from ISRs.
+ */
+void SOFT_TIMER_startDeferred(SOFT_TIMER_Type * timer_ptr, uint32 delay_ms, uint32 period_ms, void (*callback)(void))
+{
+	uint8 sreg = SREG;
+	cli();
+
+	SOFT_TIMER_set(timer_ptr, delay_ms, period_ms, callback, TRUE);
+
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Call the callbacks of the deferred timers expired since the last call, in the order of their
+ * expiries. It must be called from one place only, the main loop (or one task with KERNEL_ENABLE),
+ * at least once per tick for the periodic deferred timers of 1 ms.
+ * returns: TRUE if a callback was called.
+ */
+boolean SOFT_TIMER_runDeferred(void)
+{
+	SOFT_TIMER_Type *timer_ptr;
+	void (*callback)(void) = NULL_PTR;
+	boolean called = FALSE;
+	uint8 sreg;
+
+	/*
+	 * Take the timers one by one with the interrupts disabled, and call their callbacks with the
+	 * interrupts enabled: the tick may put the same timer in the list again meanwhile.
+	 */
+	do
+	{
+		sreg = SREG;
+		cli();
+		timer_ptr = g_readyHead;
+		if (timer_ptr != NULL_PTR)
+		{
+			g_readyHead = timer_ptr->ready_next;
+			if (g_readyHead == NULL_PTR)
+			{
+				g_readyTail = NULL_PTR;
+			}
+			timer_ptr->ready_next = NULL_PTR;
+			timer_ptr->ready = FALSE;
+			callback = timer_ptr->callback;
+		}
+		SREG = sreg;
+
+		if ((timer_ptr != NULL_PTR) && (callback != NULL_PTR))
+		{
+			(*callback)();
+			called = TRUE;
+		}
+	} while (timer_ptr != NULL_PTR);
+
+	return called;
+}
+
+/*
+ * Description :
+ * Set the function called by the tick ISR, as its last step, on a tick that put deferred timers
+ * in the ready list. It may give a kernel semaphore.
+ */
+void SOFT_TIMER_setReadyCallBack(void (*callback)(void))
+{
+	g_readyCallBack = callback;
+}
+
+/*
+ * Description :
+ * Stop the tick interrupt if no timer is running and no deferred callback waits, so the tick does
+ * not wake the CPU. It must be called with the interrupts disabled, just before the sleep.
+ * returns: TRUE if the tick is stopped.
+ */
+boolean SOFT_TIMER_suspendTick(void)
+{
+	if ((g_activeTimers != 0) || (g_readyHead != NULL_PTR))
+	{
+		return FALSE;
+	}
+
+	if (!g_tickSuspended)
+	{
+		TIMER1_disableChannel(TIMER1_CHANNEL_A);
+		g_tickSuspended = TRUE;
+	}
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Return TRUE if a deferred callback waits for SOFT_TIMER_runDeferred.
+ */
+boolean SOFT_TIMER_isReady(void)
+{
+	return (g_readyHead != NULL_PTR);
+}
+
+/*
+ * Description :
+ * Stop a software timer, it is safe to stop a timer that is not running.
+ */
+void SOFT_TIMER_stop(SOFT_TIMER_Type * timer_ptr)
+{
+	uint8 sreg = SREG;
+	cli();
+
+	if (timer_ptr->active)
+	{
+		SOFT_TIMER_unlink(timer_ptr);
+	}
+	SOFT_TIMER_unready(timer_ptr);
+
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Return TRUE if the timer is running, or if its deferred callback is still to be called.
+ */
+boolean SOFT_TIMER_isActive(const SOFT_TIMER_Type * timer_ptr)
+{
+	return (timer_ptr->active || timer_ptr->ready);
+}
+
+/*
+ * Description :
+ * Return the number of milliseconds since SOFT_TIMER_init (wraps after ~49.7 days).
+ */
+uint32 SOFT_TIMER_getTicks(void)
+{
+	uint32 ticks;
+
+	/* The 32-bit counter is read in 4 instructions, the tick ISR must not run in between */
+	uint8 sreg = SREG;
+	cli();
+	SOFT_TIMER_catchUp();
+	ticks = g_ticks;
+	SREG = sreg;
+
+	return ticks;
+}
+
+/*
+ * Description :
+ * Return the Timer1 timestamp taken at the start of the last tick ISR.
+ */
+uint32 SOFT_TIMER_getTickTimestamp(void)
+{
+	uint32 timestamp;
+	uint8 sreg = SREG;
+	cli();
+	timestamp = g_tickTimestamp;
+	SREG = sreg;
+
+	return timestamp;
+}
+
+/*
+ * Description :
+ * Busy wait for the required number of milliseconds using the system tick.
+ */
+void SOFT_TIMER_delay(uint32 delay_ms)
+{
+	uint32 start = SOFT_TIMER_getTicks();
+
+	/* Unsigned subtraction keeps the comparison correct across the counter wraparound */
+	while ((SOFT_TIMER_getTicks() - start) < delay_ms);
+}
+
+/* Timer1 compare callback, runs every 1 ms */
+static void SOFT_TIMER_tick(void)
+{
+	SOFT_TIMER_Type *timer_ptr;
+	uint32 ticks = g_ticks + 1;
+	boolean readied = FALSE;
+
+	g_tickTimestamp = TIMER1_getTimestamp();
+
+	/* Schedule the next tick relative to this one so the tick never drifts */
+	TIMER1_advanceCompare(TIMER1_CHANNEL_A, SOFT_TIMER_TICK_COUNTS);
+	g_nextTick += SOFT_TIMER_TICK_COUNTS;
+	g_ticks = ticks;
+
+	/*
+	 * Visit only the slot of the current tick. Timers with a deadline in a later round of
+	 * the wheel stay in the slot. The slot is searched again after each callback because
+	 * the callback may start or stop other timers of the same slot.
+	 */
+	do
+	{
+		timer_ptr = g_wheel[ticks & (SOFT_TIMER_WHEEL_SIZE - 1)];
+		while ((timer_ptr != NULL_PTR) && ((sint32)(ticks - timer_ptr->deadline) < 0))
+		{
+			timer_ptr = timer_ptr->next;
+		}
+
+		if (timer_ptr != NULL_PTR)
+		{
+			SOFT_TIMER_unlink(timer_ptr);
+
+			if (timer_ptr->period != 0)
+			{
+				/* Reload from the deadline, not from now, so periodic timers do not drift */
+				timer_ptr->deadline += timer_ptr->period;
+				SOFT_TIMER_link(timer_ptr);
+			}
+
+			if (timer_ptr->deferred)
+			{
+				/* Only put it in the ready list, once even if it expired again */
+				if (!timer_ptr->ready)
+				{
+					timer_ptr->ready = TRUE;
+					timer_ptr->ready_next = NULL_PTR;
+					if (g_readyTail != NULL_PTR)
+					{
+						g_readyTail->ready_next = timer_ptr;
+					}
+					else
+					{
+						g_readyHead = timer_ptr;
+					}
+					g_readyTail = timer_ptr;
+					readied = TRUE;
+				}
+			}
+			else if (timer_ptr->callback != NULL_PTR)
+			{
+				(*timer_ptr->callback)();
+			}
+		}
+	} while (timer_ptr != NULL_PTR);
+
+	/* Last, a task woken by the callback may run before this ISR returns */
+	if (readied && (g_readyCallBack != NULL_PTR))
+	{
+		(*g_readyCallBack)();
+	}
+}
+
+/* Link a timer in the slot of its deadline (interrupts must be disabled) */
+static void SOFT_TIMER_link(SOFT_TIMER_Type * timer_ptr)
+{
+	uint8 slot = timer_ptr->deadline & (SOFT_TIMER_WHEEL_SIZE - 1);
+
+	timer_ptr->prev = NULL_PTR;
+	timer_ptr->next = g_wheel[slot];
+	if (g_wheel[slot] != NULL_PTR)
+	{
+		g_wheel[slot]->prev = timer_ptr;
+	}
+	g_wheel[slot] = timer_ptr;
+	timer_ptr->active = TRUE;
+	g_activeTimers++;
+}
+
+/* Unlink a timer from its slot (interrupts must be disabled) */
+static void SOFT_TIMER_unlink(SOFT_TIMER_Type * timer_ptr)
+{
+	uint8 slot = timer_ptr->deadline & (SOFT_TIMER_WHEEL_SIZE - 1);
+
+	if (timer_ptr->prev != NULL_PTR)
+	{
+		timer_ptr->prev->next = timer_ptr->next;
+	}
+	else
+	{
+		g_wheel[slot] = timer_ptr->next;
+	}
+	if (timer_ptr->next != NULL_PTR)
+	{
+		timer_ptr->next->prev = timer_ptr->prev;
+	}
+	timer_ptr->next = NULL_PTR;
+	timer_ptr->prev = NULL_PTR;
+	timer_ptr->active = FALSE;
+	g_activeTimers--;
+}
+
+/* Start a timer, deferred or not (interrupts must be disabled) */
+static void SOFT_TIMER_set(SOFT_TIMER_Type * timer_ptr, uint32 delay_ms, uint32 period_ms, void (*callback)(void), boolean deferred)
+{
+	if (timer_ptr->active)
+	{
+		SOFT_TIMER_unlink(timer_ptr);
+	}
+
+	/* A restart drops the expiry still waiting for SOFT_TIMER_runDeferred */
+	SOFT_TIMER_unready(timer_ptr);
+
+	/* A zero delay expires on the next tick, the current slot was already visited */
+	if (delay_ms == 0)
+	{
+		delay_ms = 1;
+	}
+
+	/* The tick starts again on its old phase, after the ticks missed while it was stopped */
+	if (g_tickSuspended)
+	{
+		SOFT_TIMER_catchUp();
+		g_tickSuspended = FALSE;
+		TIMER1_setCompare(TIMER1_CHANNEL_A, (uint16)g_nextTick);
+	}
+
+	timer_ptr->deadline = g_ticks + delay_ms;
+	timer_ptr->period = period_ms;
+	timer_ptr->callback = callback;
+	timer_ptr->deferred = deferred;
+	SOFT_TIMER_link(timer_ptr);
+}
+
+/* Remove a timer from the ready list if it waits in it (interrupts must be disabled) */
+static void SOFT_TIMER_unready(SOFT_TIMER_Type * timer_ptr)
+{
+	SOFT_TIMER_Type *previous_ptr = NULL_PTR;
+	SOFT_TIMER_Type *current_ptr;
+
+	if (!timer_ptr->ready)
+	{
+		return;
+	}
+
+	/* The list holds one entry per deferred timer at most, a short walk */
+	current_ptr = g_readyHead;
+	while (current_ptr != timer_ptr)
+	{
+		previous_ptr = current_ptr;
+		current_ptr = current_ptr->ready_next;
+	}
+
+	if (previous_ptr != NULL_PTR)
+	{
+		previous_ptr->ready_next = timer_ptr->ready_next;
+	}
+	else
+	{
+		g_readyHead = timer_ptr->ready_next;
+	}
+	if (g_readyTail == timer_ptr)
+	{
+		g_readyTail = previous_ptr;
+	}
+	timer_ptr->ready_next = NULL_PTR;
+	timer_ptr->ready = FALSE;
+}
+
+/* Count the ticks missed while the tick is stopped (interrupts must be disabled) */
+static void SOFT_TIMER_catchUp(void)
+{
+	uint32 late;
+
+	if (!g_tickSuspended)
+	{
+		return;
+	}
+
+	/* The matches passed, and the next one if it is too close to be set in time */
+	late = (TIMER1_getTimestamp() + SOFT_TIMER_RESUME_MARGIN) - g_nextTick;
+	if ((sint32)late >= 0)
+	{
+		late = (late / SOFT_TIMER_TICK_COUNTS) + 1;
+		g_ticks += late;
+		g_nextTick += late * SOFT_TIMER_TICK_COUNTS;
+	}
+}
@@ -0,0 +1,205 @@
+/*
+ * soft_uart.c
+ *	Description: Source file for the software UART debug channel
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "soft_uart.h"
+
+#if (SOFT_UART_ENABLE == 1)
+
+#include "gpio.h"
+#include "common_macros.h"
+#include "profile.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Smallest Timer2 prescaler that gives a bit time of 256 counts at most */
+#if ((F_CPU / SOFT_UART_BAUD_RATE) <= 256)
+#define SOFT_UART_PRESCALER         1
+#define SOFT_UART_CLOCK             (1 << CS20)
+#elif ((F_CPU / 8 / SOFT_UART_BAUD_RATE) <= 256)
+#define SOFT_UART_PRESCALER         8
+#define SOFT_UART_CLOCK             (1 << CS21)
+#elif ((F_CPU / 32 / SOFT_UART_BAUD_RATE) <= 256)
+#define SOFT_UART_PRESCALER         32
+#define SOFT_UART_CLOCK             ((1 << CS21) | (1 << CS20))
+#else
+#error "SOFT_UART_BAUD_RATE is too low"
+#endif
+
+/* Compare value of one bit time, rounded to the nearest count */
+#define SOFT_UART_TOP               ((((F_CPU / SOFT_UART_PRESCALER) + (SOFT_UART_BAUD_RATE / 2)) / SOFT_UART_BAUD_RATE) - 1)
+
+/* Timer2 in CTC mode, the next compare match sets (1) or clears (0) the OC2 pin */
+#define SOFT_UART_HIGH              ((1 << WGM21) | (1 << COM21) | (1 << COM20) | SOFT_UART_CLOCK)
+#define SOFT_UART_LOW               ((1 << WGM21) | (1 << COM21) | SOFT_UART_CLOCK)
+
+/* Number of the data bits, the next interrupt after them selects the stop bit */
+#define SOFT_UART_DATA_BITS         8
+
+#if ((SOFT_UART_BUFFER_SIZE & (SOFT_UART_BUFFER_SIZE - 1)) != 0) || (SOFT_UART_BUFFER_SIZE > 128)
+#error "SOFT_UART_BUFFER_SIZE should be a power of two up to 128"
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Bytes waiting to be sent, the indices run freely */
+static volatile uint8 g_softUartBuffer[SOFT_UART_BUFFER_SIZE];
+static volatile uint8 g_softUartHead = 0;
+static volatile uint8 g_softUartTail = 0;
+
+/* TRUE while the interrupt of the bits is enabled */
+static volatile boolean g_softUartBusy = FALSE;
+
+/* Bits of the byte being sent that are not selected yet, and the number of bits selected */
+static uint8 g_softUartShift;
+static uint8 g_softUartBit;
+
+#if (PROFILE_ENABLE == 1)
+/* Timer2 counts spent in the interrupt for the byte being sent and for the last byte sent */
+static uint16 g_softUartCounts = 0;
+static volatile uint16 g_softUartByteCounts = 0;
+
+/* Number of bytes sent, by the interrupt, and number of bytes given to the profiler */
+static volatile uint8 g_softUartSent = 0;
+static uint8 g_softUartRecorded = 0;
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Start sending the oldest byte of the buffer, called with the interrupts disabled */
+static void SOFT_UART_start(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Start Timer2 and drive the idle (high) level on the OC2 pin.
+ */
+void SOFT_UART_init(void)
+{
+	OCR2 = SOFT_UART_TOP;
+
+	/* Force the output high once before the pin becomes an output, so the line never glitches */
+	TCCR2 = SOFT_UART_HIGH | (1 << FOC2);
+	GPIO_SETUP_PIN_DIRECTION(PORTD_ID, PIN7_ID, PIN_OUTPUT);
+}
+
+/*
+ * Description :
+ * Put one byte in the transmit buffer and start the transmission if it is stopped.
+ * It waits while the buffer is full, so it must not be called from ISRs.
+ */
+void SOFT_UART_sendByte(const uint8 data)
+{
+	uint8 sreg;
+
+#if (PROFILE_ENABLE == 1)
+	/* Time of the interrupts of the last byte sent, recording it would make the interrupt too long */
+	if (g_softUartSent != g_softUartRecorded)
+	{
+		uint16 counts;
+
+		sreg = SREG;
+		cli();
+		g_softUartRecorded = g_softUartSent;
+		counts = g_softUartByteCounts;
+		SREG = sreg;
+		PROFILE_record(PROFILE_SOFT_UART_BYTE, ((uint32)counts * SOFT_UART_PRESCALER) / (F_CPU / 1000000UL));
+	}
+#endif
+
+	/* The interrupt frees one place every ten bits */
+	while ((uint8)(g_softUartHead - g_softUartTail) == SOFT_UART_BUFFER_SIZE)
+	{
+	}
+	g_softUartBuffer[g_softUartHead & (SOFT_UART_BUFFER_SIZE - 1)] = data;
+
+	sreg = SREG;
+	cli();
+	g_softUartHead++;
+	if (!g_softUartBusy)
+	{
+		SOFT_UART_start();
+	}
+	SREG = sreg;
+}
+
+/* Start sending the oldest byte of the buffer, called with the interrupts disabled */
+static void SOFT_UART_start(void)
+{
+	g_softUartShift = g_softUartBuffer[g_softUartTail & (SOFT_UART_BUFFER_SIZE - 1)];
+	g_softUartTail++;
+	g_softUartBit = 0;
+	g_softUartBusy = TRUE;
+
+	/*
+	 * Restart the bit time so the start bit begins one full bit after the last stop bit at least,
+	 * and the interrupt of the start bit cannot be missed by a match happening right now.
+	 */
+	TCNT2 = 0;
+	TCCR2 = SOFT_UART_LOW;
+	TIFR = (1 << OCF2);
+	SET_BIT(TIMSK, OCIE2);
+}
+
+/*
+ * The level of the bit that begins at this compare match was selected by the previous interrupt,
+ * select the level of the next bit: the data bits with the least significant first, then the stop
+ * bit, then the start bit of the next byte or the idle level.
+ */
+ISR(TIMER2_COMP_vect)
+{
+	if (g_softUartBit < SOFT_UART_DATA_BITS)
+	{
+		TCCR2 = (g_softUartShift & 0x01) ? SOFT_UART_HIGH : SOFT_UART_LOW;
+		g_softUartShift >>= 1;
+		g_softUartBit++;
+	}
+	else if (g_softUartBit == SOFT_UART_DATA_BITS)
+	{
+		TCCR2 = SOFT_UART_HIGH;
+		g_softUartBit++;
+	}
+	else
+	{
+		/* The stop bit begins now */
+#if (PROFILE_ENABLE == 1)
+		g_softUartByteCounts = g_softUartCounts;
+		g_softUartCounts = 0;
+		g_softUartSent++;
+#endif
+		if (g_softUartTail != g_softUartHead)
+		{
+			g_softUartShift = g_softUartBuffer[g_softUartTail & (SOFT_UART_BUFFER_SIZE - 1)];
+			g_softUartTail++;
+			g_softUartBit = 0;
+			TCCR2 = SOFT_UART_LOW;
+		}
+		else
+		{
+			/* The pin stays high, the timer keeps running without interrupts */
+			CLEAR_BIT(TIMSK, OCIE2);
+			g_softUartBusy = FALSE;
+		}
+	}
+
+#if (PROFILE_ENABLE == 1)
+	/* The counter restarted at the compare match: counts from the match up to here */
+	g_softUartCounts += TCNT2;
+#endif
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * soft_uart.h
+ *	Description: Header file for the software UART debug channel
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * A transmit-only UART (8 data bits, no parity, 1 stop bit) on the OC2 pin (PD7) for the debug
+ * text: the trace records, the profiler results and the RAM use. The USART stays reserved for
+ * the link between the ECUs, so the debug output can be sent at any time.
+ *
+ * Timer2 runs in CTC mode with one compare match per bit. The level of each bit is driven on the
+ * pin by the compare match hardware (set or clear OC2), so the edges do not move with the
+ * interrupt latency. The interrupt of a match only has to select the level of the next bit before
+ * the following match, so the interrupt of a bit plus the longest interrupt or disabled section
+ * of the program must fit in one bit time, the #error below checks it. The longest one is the
+ * 1 ms tick of the soft timers: its ISR runs with the interrupts disabled and walks one slot of the
+ * timer wheel, and switches the task with KERNEL_ENABLE. The long callbacks (the keypad row step and
+ * the LCD drain of the HMI ECU) are deferred timers run by the main loop, not by the tick ISR.
+ *
+ * 115200 baud is not reached: a bit time of 8.7 us is 69 cycles at 8 MHz, less than the prologue
+ * and epilogue of any ISR of the -O0 Debug build, and the tick ISR would have to fit in it too.
+ * The highest rate allowed by the estimates below is 8333 baud, the default is 4800.
+ * Timer1 is not touched, its compare matches are set by the hardware too and the interrupt of a bit
+ * delays its callbacks by a few micro seconds at most, without any effect on the following ticks.
+ *
+ * The channel is compiled out unless SOFT_UART_ENABLE is set to 1.
+ * Memory cost: SOFT_UART_BUFFER_SIZE + 5 bytes of RAM.
+ * CPU cost: one interrupt per bit while sending, none when the buffer is empty. With PROFILE_ENABLE
+ * the interrupt time of the sent bytes is recorded in the SOFT_UART_BYTE region of the profiler,
+ * in micro seconds per byte. Divided by the time of a byte (10 bits) it gives the CPU load while
+ * the channel sends continuously.
+ */
+
+#ifndef SOFT_UART_H_
+#define SOFT_UART_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Software UART configuration, its value should be 0 (disabled) or 1 (enabled) */
+#define SOFT_UART_ENABLE            0
+
+#if((SOFT_UART_ENABLE != 0) && (SOFT_UART_ENABLE != 1))
+
+#error "SOFT_UART_ENABLE should be equal to 0 or 1"
+
+#endif
+
+/*
+ * Longest time in micro seconds the interrupts stay disabled outside the channel, which is the
+ * tick ISR of the soft timers without its deferred callbacks. It is an estimate for the -O0 Debug
+ * build (about 800 cycles), not a measured value: measure the tick ISR on target before lowering it.
+ */
+#define SOFT_UART_LONGEST_ISR_US    100
+
+/*
+ * Time of the interrupt of a bit in micro seconds, an estimate for the -O0 Debug build. The
+ * measured value is the SOFT_UART_BYTE figure of the profiler divided by 10 bits.
+ */
+#define SOFT_UART_BIT_ISR_US        20
+
+/*
+ * Bit rate of the channel. A bit time must cover the longest other interrupt plus the interrupt
+ * of a bit, 120 us with the estimates above, which allows 4800 (208 us per bit) but not 9600.
+ * The text of a profiler dump is then sent at 480 bytes per second, and SOFT_UART_sendByte waits in
+ * the main loop while the buffer is full.
+ */
+#define SOFT_UART_BAUD_RATE         4800UL
+
+#if ((1000000UL / SOFT_UART_BAUD_RATE) < (SOFT_UART_LONGEST_ISR_US + SOFT_UART_BIT_ISR_US))
+
+#error "SOFT_UART_BAUD_RATE is too high, a bit time must cover the longest interrupt and the interrupt of a bit"
+
+#endif
+
+/* Size of the transmit buffer in bytes, must be a power of two up to 128 */
+#define SOFT_UART_BUFFER_SIZE       64
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+#if (SOFT_UART_ENABLE == 1)
+
+/*
+ * Description :
+ * Start Timer2 and drive the idle (high) level on the OC2 pin.
+ */
+void SOFT_UART_init(void);
+
+/*
+ * Description :
+ * Put one byte in the transmit buffer and start the transmission if it is stopped.
+ * It waits while the buffer is full, so it must not be called from ISRs.
+ */
+void SOFT_UART_sendByte(const uint8 data);
+
+#endif
+
+#endif /* SOFT_UART_H_ */
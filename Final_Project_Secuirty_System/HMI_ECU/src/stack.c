@@ -0,0 +1,144 @@
+/*
+ * stack.c
+ *	Description: Source file for the stack painting and RAM high-water mark
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "stack.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Symbols of the linker script: start of .data, end of the static data and top of the RAM */
+extern uint8 __data_start;
+extern uint8 _end;
+extern uint8 __stack;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Paint the free RAM, runs from the .init1 section before the stack pointer is set */
+void STACK_paint(void) __attribute__((naked, used, section(".init1")));
+
+/* Return the lowest address written by the stack since reset */
+static const uint8 * STACK_getDeepest(void);
+
+/* Send a string through the output function */
+static void STACK_sendString(void (*send_byte)(const uint8 data), const char * str);
+
+/* Send an unsigned number in decimal through the output function */
+static void STACK_sendNumber(void (*send_byte)(const uint8 data), uint16 number);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Nothing may be pushed here and r1 is not cleared yet, so only the Z pointer, r24 and r25 are
+ * used. The .data and .bss sections are initialized after this code, in .init4.
+ */
+void STACK_paint(void)
+{
+	__asm__ __volatile__ (
+		"    ldi r30, lo8(_end)         \n"
+		"    ldi r31, hi8(_end)         \n"
+		"    ldi r24, %0                \n"
+		"    ldi r25, hi8(__stack)      \n"
+		"    rjmp 2f                    \n"
+		"1:  st Z+, r24                 \n"
+		"2:  cpi r30, lo8(__stack)      \n"
+		"    cpc r31, r25               \n"
+		"    brlo 1b                    \n"
+		"    breq 1b                    \n"
+		:
+		: "i" (STACK_CANARY)
+	);
+}
+
+/*
+ * Description :
+ * Return the size in bytes of the static data: .data, .bss and .noinit.
+ */
+uint16 STACK_getStaticSize(void)
+{
+	return (uint16)(&_end - &__data_start);
+}
+
+/*
+ * Description :
+ * Return the deepest stack use since reset in bytes.
+ */
+uint16 STACK_getHighWater(void)
+{
+	return (uint16)(&__stack - STACK_getDeepest()) + 1;
+}
+
+/*
+ * Description :
+ * Return the number of bytes between the static data and the deepest stack use that were
+ * never written since reset.
+ */
+uint16 STACK_getUnused(void)
+{
+	return (uint16)(STACK_getDeepest() - &_end);
+}
+
+/*
+ * Description :
+ * Write one text line with the RAM use, each byte is given to the send_byte function.
+ */
+void STACK_dump(void (*send_byte)(const uint8 data))
+{
+	STACK_sendString(send_byte, "RAM static=");
+	STACK_sendNumber(send_byte, STACK_getStaticSize());
+	STACK_sendString(send_byte, " stack=");
+	STACK_sendNumber(send_byte, STACK_getHighWater());
+	STACK_sendString(send_byte, " unused=");
+	STACK_sendNumber(send_byte, STACK_getUnused());
+	STACK_sendString(send_byte, "\r\n");
+}
+
+/* Return the lowest address written by the stack since reset */
+static const uint8 * STACK_getDeepest(void)
+{
+	/* The first byte that lost the canary, searched from the end of the static data */
+	const uint8 * ptr = &_end;
+
+	while ((ptr <= &__stack) && (*ptr == STACK_CANARY))
+	{
+		ptr++;
+	}
+	return ptr;
+}
+
+/* Send a string through the output function */
+static void STACK_sendString(void (*send_byte)(const uint8 data), const char * str)
+{
+	while (*str != '\0')
+	{
+		(*send_byte)(*str);
+		str++;
+	}
+}
+
+/* Send an unsigned number in decimal through the output function */
+static void STACK_sendNumber(void (*send_byte)(const uint8 data), uint16 number)
+{
+	/* A 16-bit number has at most 5 decimal digits, they are found from the lowest one */
+	uint8 digits[5];
+	uint8 i = 0;
+
+	do
+	{
+		digits[i++] = '0' + (number % 10);
+		number /= 10;
+	} while (number != 0);
+
+	while (i > 0)
+	{
+		(*send_byte)(digits[--i]);
+	}
+}
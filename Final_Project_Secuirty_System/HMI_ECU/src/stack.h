@@ -0,0 +1,59 @@
+/*
+ * stack.h
+ *	Description: Header file for the stack painting and RAM high-water mark
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * Before the C start-up code runs, every byte between the end of the static data (.data, .bss
+ * and .noinit) and the top of the RAM is written with STACK_CANARY. The stack grows down into
+ * this area, so the canary bytes still found above the static data give the deepest stack use
+ * since reset. There is no heap (malloc is not used), so nothing else writes there.
+ *
+ * Memory cost: no RAM, about 20 bytes of flash for the painting and less than 1 ms at start-up.
+ * The query functions take flash only when they are called.
+ * The stacks of the kernel tasks are in .bss, KERNEL_getStackUnused() measures them.
+ */
+
+#ifndef STACK_H_
+#define STACK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Value written in the free RAM at reset, it must match the painting code */
+#define STACK_CANARY                0xC5
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Return the size in bytes of the static data: .data, .bss and .noinit.
+ */
+uint16 STACK_getStaticSize(void);
+
+/*
+ * Description :
+ * Return the deepest stack use since reset in bytes.
+ */
+uint16 STACK_getHighWater(void);
+
+/*
+ * Description :
+ * Return the number of bytes between the static data and the deepest stack use that were
+ * never written since reset, the margin left before the stack overwrites the globals.
+ */
+uint16 STACK_getUnused(void);
+
+/*
+ * Description :
+ * Write one text line with the RAM use, each byte is given to the send_byte function.
+ * "RAM static=<bytes> stack=<bytes> unused=<bytes>\r\n"
+ */
+void STACK_dump(void (*send_byte)(const uint8 data));
+
+#endif /* STACK_H_ */
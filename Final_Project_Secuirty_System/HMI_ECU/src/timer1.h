@@ -3,6 +3,13 @@
  *
  *  Created on: Mar 10, 2024
  *      Author: abdalla
+ *
+ * Timer1 runs as a free-running 16-bit counter (normal mode) and is shared between users.
+ * Each interrupt source is a channel that is handed out with its own callback:
+ *  - Compare A and Compare B schedule events at any count without stopping the counter.
+ *  - Overflow is called every 65536 counts. The driver also counts the overflows itself to
+ *    extend the counter to a 32-bit monotonic timestamp.
+ *  - Input capture latches the counter on an edge of the ICP1 pin (PD6) for timestamping.
  */
 
 #ifndef TIMER1_H_
@@ -10,16 +17,44 @@
 
 #include "std_types.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Frequency of the counter in Hz. The timestamps, the system tick and the clock synchronization
+ * count micro seconds, the preprocessor takes the prescaler that gives it from F_CPU.
+ */
+#define TIMER1_FREQUENCY        1000000UL
+
+#if ((F_CPU) == (TIMER1_FREQUENCY))
+#define TIMER1_PRESCALER        F_CPU_CLOCK
+#elif ((F_CPU) == (8UL * TIMER1_FREQUENCY))
+#define TIMER1_PRESCALER        F_CPU_8
+#elif ((F_CPU) == (64UL * TIMER1_FREQUENCY))
+#define TIMER1_PRESCALER        F_CPU_64
+#else
+
+#error "No Timer1 prescaler gives TIMER1_FREQUENCY from F_CPU"
+
+#endif
+
+/* Edge of the ICP1 pin latched by the input capture */
+#define TIMER1_CAPTURE_EDGE     CAPTURE_RISING_EDGE
+
 /*******************************************************************************
  *                       Types Declaration                                     *
  *******************************************************************************/
 
-/* Enum defining different modes of operation for Timer1 */
+/* Enum defining the interrupt channels of Timer1 */
 typedef enum
 {
-    OVERFLOW_MODE,    	/* Normal mode of operation for Timer1 */
-    COMPARE_MODE    	/* Compare mode of operation for Timer1 */
-}TIMER1_Mode;
+	TIMER1_CHANNEL_A,       	/* Output compare A (OCR1A) */
+	TIMER1_CHANNEL_B,       	/* Output compare B (OCR1B) */
+	TIMER1_CHANNEL_OVF,     	/* Counter overflow */
+	TIMER1_CHANNEL_CAPT,    	/* Input capture (ICR1) */
+	TIMER1_NUM_OF_CHANNELS
+}TIMER1_Channel;
 
 /* Enum defining different prescaler options for Timer1 */
 typedef enum
@@ -34,14 +69,12 @@ typedef enum
 	EXTERNAL_RISING 	/* External clock source on T1 pin. Clock on rising edge.*/
 }TIMER1_Prescaler;
 
-/* Structure defining configuration parameters for Timer1 */
-typedef struct
+/* Enum defining the edge of the ICP1 pin that triggers the input capture */
+typedef enum
 {
-    TIMER1_Mode mode; 			/* Timer mode (normal mode, compare mode) */
-    TIMER1_Prescaler prescaler; /* Prescaler value for timer */
-    uint16 initial_value; 		/* Initial value for timer counter */
-    uint16 compare_value; 		/* Value to compare with timer counter for comparison */
-}TIMER1_ConfigType;
+	CAPTURE_FALLING_EDGE,	/* Capture on the falling edge */
+	CAPTURE_RISING_EDGE 	/* Capture on the rising edge */
+}TIMER1_CaptureEdge;
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -49,24 +82,65 @@ typedef struct
 
 /*
  * Description : Function to initialize the Timer1
- * 	1. Set timer1 initial count.
- * 	2. Set the required Mode.
- * 	3. Set the required clock.
- * 	4. Set the required compare value.
- * 	5. Initialize Timer1 Registers.
+ * 	1. Set the Normal (free-running) mode with OC1A and OC1B disconnected.
+ * 	2. Set the clock and capture edge of the configuration above.
+ * 	3. Release all channels.
  */
-void TIMER1_init(const TIMER1_ConfigType * config_ptr);
+void TIMER1_init(void);
 
 /*
- * Description: Function to disable & stop Timer1.
+ * Description: Function to disable & stop Timer1 and release all channels.
  */
 void TIMER1_deinit(void);
 
 /*
- * Description: Function to set the Call Back function address.
+ * Description: Function to take a channel and set its Call Back function address.
+ * The channel interrupt stays disabled until the channel is enabled or a compare is set.
+ * returns: TRUE if the channel was free, FALSE if another user owns it.
+ */
+boolean TIMER1_allocateChannel(TIMER1_Channel channel, void (*ptr_func)(void));
+
+/*
+ * Description: Function to disable a channel and make it free for another user.
+ */
+void TIMER1_releaseChannel(TIMER1_Channel channel);
+
+/*
+ * Description: Function to enable the interrupt of a channel (clears any old pending flag).
  */
-void TIMER1_setCallBack(void (*ptr_func)(void));
+void TIMER1_enableChannel(TIMER1_Channel channel);
 
+/*
+ * Description: Function to disable the interrupt of a channel without releasing it.
+ */
+void TIMER1_disableChannel(TIMER1_Channel channel);
+
+/*
+ * Description: Function to schedule a compare channel (A or B) at an absolute counter value.
+ */
+void TIMER1_setCompare(TIMER1_Channel channel, uint16 count);
+
+/*
+ * Description: Function to move a compare channel (A or B) forward by a number of counts.
+ * Called from the channel callback it gives a periodic event with no drift.
+ */
+void TIMER1_advanceCompare(TIMER1_Channel channel, uint16 counts);
 
+/*
+ * Description: Function to read the free-running counter.
+ */
+uint16 TIMER1_getCount(void);
+
+/*
+ * Description: Function to read the counter value latched by the last input capture.
+ */
+uint16 TIMER1_getCapture(void);
+
+/*
+ * Description: Function to read the 32-bit monotonic timestamp (counter + overflow count).
+ * At TIMER1_FREQUENCY one count is one micro second (wraps after ~71 minutes).
+ * It is safe to call from ISRs and from the main program.
+ */
+uint32 TIMER1_getTimestamp(void);
 
 #endif /* SRC_TIMER1_H_ */
@@ -0,0 +1,176 @@
+/*
+ * trace.c
+ *	Description: Source file for the binary trace logger
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "trace.h"
+
+#if (TRACE_ENABLE == 1)
+
+#include "timer1.h"
+#include <avr/io.h>        /* For SREG */
+#include <avr/interrupt.h> /* For cli() */
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* First character of a record line */
+#define TRACE_LINE_START            '~'
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* The ids must fit in the header byte below the id of the lost records */
+typedef char TRACE_CheckMessages[(TRACE_NUM_OF_MESSAGES < TRACE_LOST_ID) ? 1 : -1];
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/*
+ * The format strings in the order of the ids, in a section without the alloc flag: they stay in
+ * the ELF file for the decoder but they are not part of the flash image.
+ */
+#define TRACE_FORMAT(name, format)  ".asciz \"" format "\"\n"
+__asm__ (
+	".pushsection .trace_fmt, \"\", @progbits\n"
+	TRACE_MESSAGES(TRACE_FORMAT)
+	".popsection\n"
+);
+#undef TRACE_FORMAT
+
+/* Records waiting to be sent, the indices run freely */
+static volatile uint8 g_traceBuffer[TRACE_BUFFER_SIZE];
+static volatile uint8 g_traceHead = 0;
+static volatile uint8 g_traceTail = 0;
+
+/* Number of records dropped because the buffer was full, it stops at 255 */
+static volatile uint8 g_traceLost = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Send the bytes of a record as hex digits */
+static void TRACE_sendHex(void (*send_byte)(const uint8 data), uint8 data);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Store a record in the ring buffer, it is counted as lost if the buffer is full.
+ */
+void TRACE_write(TRACE_Message message, uint8 args, uint16 arg1, uint16 arg2)
+{
+	uint8 size = TRACE_RECORD_SIZE(args);
+	uint32 timestamp;
+	uint8 head;
+	uint8 sreg = SREG;
+	cli();
+
+	if ((uint8)(TRACE_BUFFER_SIZE - (uint8)(g_traceHead - g_traceTail)) < size)
+	{
+		if (g_traceLost != 0xFF)
+		{
+			g_traceLost++;
+		}
+		SREG = sreg;
+		return;
+	}
+
+	timestamp = TIMER1_getTimestamp();
+	head = g_traceHead;
+
+	/* Header, then every value with its low byte first */
+	g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)message | (args << 6);
+	g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)timestamp;
+	g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)(timestamp >> 8);
+	g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)(timestamp >> 16);
+	g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)(timestamp >> 24);
+	if (args > 0)
+	{
+		g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)arg1;
+		g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)(arg1 >> 8);
+	}
+	if (args > 1)
+	{
+		g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)arg2;
+		g_traceBuffer[head++ & (TRACE_BUFFER_SIZE - 1)] = (uint8)(arg2 >> 8);
+	}
+	g_traceHead = head;
+
+	SREG = sreg;
+}
+
+/*
+ * Description :
+ * Send the oldest record as one hex text line through the given byte output function.
+ */
+boolean TRACE_drain(void (*send_byte)(const uint8 data))
+{
+	uint8 tail = g_traceTail;
+	uint8 size, lost;
+	uint32 timestamp;
+	uint8 sreg;
+
+	/* The number of lost records goes first, as a record of its own */
+	if (g_traceLost != 0)
+	{
+		sreg = SREG;
+		cli();
+		lost = g_traceLost;
+		g_traceLost = 0;
+		SREG = sreg;
+
+		timestamp = TIMER1_getTimestamp();
+		(*send_byte)(TRACE_LINE_START);
+		TRACE_sendHex(send_byte, TRACE_LOST_ID | (1 << 6));
+		TRACE_sendHex(send_byte, (uint8)timestamp);
+		TRACE_sendHex(send_byte, (uint8)(timestamp >> 8));
+		TRACE_sendHex(send_byte, (uint8)(timestamp >> 16));
+		TRACE_sendHex(send_byte, (uint8)(timestamp >> 24));
+		TRACE_sendHex(send_byte, lost);
+		TRACE_sendHex(send_byte, 0);
+		(*send_byte)('\r');
+		(*send_byte)('\n');
+		return TRUE;
+	}
+
+	/* Only this function moves the tail, a record between tail and head is complete */
+	if (tail == g_traceHead)
+	{
+		return FALSE;
+	}
+
+	size = TRACE_RECORD_SIZE(g_traceBuffer[tail & (TRACE_BUFFER_SIZE - 1)] >> 6);
+	(*send_byte)(TRACE_LINE_START);
+	while (size > 0)
+	{
+		TRACE_sendHex(send_byte, g_traceBuffer[tail++ & (TRACE_BUFFER_SIZE - 1)]);
+		size--;
+	}
+	(*send_byte)('\r');
+	(*send_byte)('\n');
+
+	/* Free the place of the record only after it is sent */
+	g_traceTail = tail;
+	return TRUE;
+}
+
+/* Send the bytes of a record as hex digits */
+static void TRACE_sendHex(void (*send_byte)(const uint8 data), uint8 data)
+{
+	uint8 digit = data >> 4;
+
+	(*send_byte)((digit < 10) ? ('0' + digit) : ('A' - 10 + digit));
+	digit = data & 0x0F;
+	(*send_byte)((digit < 10) ? ('0' + digit) : ('A' - 10 + digit));
+}
+
+#endif
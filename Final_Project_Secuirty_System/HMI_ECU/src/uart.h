@@ -19,10 +19,39 @@
 /* Define the a byte to indicate that the MCU is ready to receive DATA */
 #define READY_TO_RECEVIE 0xFF
 
+/* Frame and speed of the link between the two ECUs, fixed at compile time */
+#define UART_BAUD_RATE          9600UL
+#define UART_PARITY             EVEN_PARITY
+#define UART_STOP_BIT           ONE_STOP_BIT
+#define UART_DATA_SIZE          EIGHT_BIT
+
+/* Largest error of the real baud rate in tenths of percent, the two ends may be off in opposite ways */
+#define UART_BAUD_ERROR_MAX     20
+
+/*
+ * UBRR of the double speed mode (U2X = 1), baud rate = F_CPU / (8 * (UBRR + 1)), rounded to the
+ * nearest by the preprocessor: the init only stores it.
+ */
+#define UART_UBRR               ((((F_CPU) + (4UL * UART_BAUD_RATE)) / (8UL * UART_BAUD_RATE)) - 1UL)
+#define UART_REAL_BAUD_RATE     ((F_CPU) / (8UL * (UART_UBRR + 1UL)))
+
+#if (UART_UBRR > 4095)
+
+#error "UART_BAUD_RATE is out of the UBRR range for F_CPU"
+
+#endif
+
+#if(((UART_REAL_BAUD_RATE * 1000UL) > (UART_BAUD_RATE * (1000UL + UART_BAUD_ERROR_MAX))) || \
+	((UART_REAL_BAUD_RATE * 1000UL) < (UART_BAUD_RATE * (1000UL - UART_BAUD_ERROR_MAX))))
+
+#error "UART_BAUD_RATE cannot be reached from F_CPU within UART_BAUD_ERROR_MAX"
+
+#endif
+
 /*******************************************************************************
  *                               Types Declaration                             *
  *******************************************************************************/
-/* Enum defining UART Parity types */
+/* Enum defining UART Parity types, the values of the UPM1:0 bits */
 typedef enum
 {
 	NO_PARITY,      /* No parity */
@@ -30,14 +59,14 @@ typedef enum
 	ODD_PARITY      /* Odd parity */
 } UART_Parity;
 
-/* Enum defining UART Stop Bit options */
+/* Enum defining UART Stop Bit options, the value of the USBS bit */
 typedef enum
 {
 	ONE_STOP_BIT,   /* One stop bit */
 	TWO_STOP_BIT    /* Two stop bits */
 } UART_StopBit;
 
-/* Enum defining UART Data Size options */
+/* Enum defining UART Data Size options, the values of the UCSZ1:0 bits */
 typedef enum
 {
 	FIVE_BIT,       /* 5-bit data */
@@ -46,15 +75,6 @@ typedef enum
 	EIGHT_BIT       /* 8-bit data */
 } UART_DataSize;
 
-/* Structure defining UART Configuration */
-typedef struct
-{
-	UART_Parity parity;     /* Parity setting */
-	UART_StopBit stop_bit;  /* Stop bit setting */
-	UART_DataSize data_size;/* Data size setting */
-	uint32 baud_rate;       /* Baud rate setting */
-} UART_ConfigType;
-
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -66,8 +86,9 @@ typedef struct
  * 1. Setup the Frame format like number of data bits, parity bit type and number of stop bits.
  * 2. Enable the UART.
  * 3. Setup the UART baud rate.
+ * The configuration is the one above, the register values are computed at compile time.
  */
-void UART_init(const UART_ConfigType *config_ptr);
+void UART_init(void);
 
 /*
  * Description :
@@ -105,6 +126,14 @@ void UART_sendData(const uint8 *arr, uint8 arr_size);
  */
 void UART_receiveData(uint8 *arr, uint8 arr_size);
 
+/*
+ * Description :
+ * Enable the receive complete interrupt and call the given function with every received byte.
+ * The function runs in interrupt context. Passing NULL_PTR disables the interrupt again so
+ * the bytes can be received with UART_recieveByte.
+ */
+void UART_setRxCallBack(void (*ptr_func)(uint8 data));
+
 
 
 #endif /* UART_H_ */
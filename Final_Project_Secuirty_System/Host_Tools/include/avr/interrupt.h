@@ -0,0 +1,24 @@
+/*
+ * avr/interrupt.h
+ *	Description: Host replacement for the avr-libc interrupt definitions
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * cli and sei change the I bit of the SREG register of io_model.c, so the SREG save and restore of
+ * the drivers work as on the target. An ISR is a plain function, the host models call it.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+/* Global interrupt enable bit of SREG */
+#define HOST_SREG_I		7
+
+#define cli()			(SREG &= (uint8)~(1 << HOST_SREG_I))
+#define sei()			(SREG |= (uint8)(1 << HOST_SREG_I))
+
+#define ISR(vector, ...)	void vector(void); void vector(void)
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
@@ -0,0 +1,75 @@
+/*
+ * avr/io.h
+ *	Description: Host replacement for the avr-libc IO definitions
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The TWI registers are backed by twi_model.c so that i2c.c and eeprom.c build unchanged on
+ * Linux and talk to the M24C16 model.
+ * The registers of the ports, of the INT2 interrupt and SREG are backed by io_model.c so that the
+ * GPIO, LCD and keypad drivers build unchanged and the device models read and drive their pins.
+ */
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include "std_types.h"
+
+/* TWCR bits */
+#define TWIE	0
+#define TWEN	2
+#define TWWC	3
+#define TWSTO	4
+#define TWSTA	5
+#define TWEA	6
+#define TWINT	7
+
+/* TWSR prescaler bits */
+#define TWPS0	0
+#define TWPS1	1
+
+/* TWI registers backed by the model */
+extern volatile uint8 TWBR;
+extern volatile uint8 TWSR;
+extern volatile uint8 TWDR;
+extern volatile uint8 TWAR;
+
+/*
+ * TWCR is accessed through a function so the model sees every access.
+ * Writing the register is detected on the next access and executed at that point.
+ */
+volatile uint16 * TWI_MODEL_accessTWCR(void);
+#define TWCR (*TWI_MODEL_accessTWCR())
+
+/* INT2 bits of GICR, GIFR and MCUCSR */
+#define INT2	5
+#define INTF2	5
+#define ISC2	6
+
+/*
+ * I/O registers backed by io_model.c, at their I/O addresses of the ATmega32. The PIN, DDR and
+ * PORT registers of the ports keep their places relative to each other, so the register
+ * arithmetic of gpio.h gives the same registers as on the target.
+ */
+#define HOST_IO_SIZE	0x40
+
+extern volatile uint8 HOST_IO_REGISTERS[HOST_IO_SIZE];
+
+#define PIND	HOST_IO_REGISTERS[0x10]
+#define DDRD	HOST_IO_REGISTERS[0x11]
+#define PORTD	HOST_IO_REGISTERS[0x12]
+#define PINC	HOST_IO_REGISTERS[0x13]
+#define DDRC	HOST_IO_REGISTERS[0x14]
+#define PORTC	HOST_IO_REGISTERS[0x15]
+#define PINB	HOST_IO_REGISTERS[0x16]
+#define DDRB	HOST_IO_REGISTERS[0x17]
+#define PORTB	HOST_IO_REGISTERS[0x18]
+#define PINA	HOST_IO_REGISTERS[0x19]
+#define DDRA	HOST_IO_REGISTERS[0x1A]
+#define PORTA	HOST_IO_REGISTERS[0x1B]
+#define MCUCSR	HOST_IO_REGISTERS[0x34]
+#define GIFR	HOST_IO_REGISTERS[0x3A]
+#define GICR	HOST_IO_REGISTERS[0x3B]
+#define SREG	HOST_IO_REGISTERS[0x3F]
+
+#endif /* HOST_AVR_IO_H_ */
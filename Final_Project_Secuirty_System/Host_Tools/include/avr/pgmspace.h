@@ -0,0 +1,21 @@
+/*
+ * avr/pgmspace.h
+ *	Description: Host replacement for the avr-libc program memory definitions
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The host has one address space, the tables kept in flash on the target are plain constants.
+ */
+
+#ifndef HOST_AVR_PGMSPACE_H_
+#define HOST_AVR_PGMSPACE_H_
+
+#include "std_types.h"
+
+#define PROGMEM
+
+#define pgm_read_byte(address)		(*(const uint8 *)(address))
+#define pgm_read_word(address)		(*(const uint16 *)(address))
+#define pgm_read_ptr(address)		(*(void * const *)(address))
+
+#endif /* HOST_AVR_PGMSPACE_H_ */
@@ -0,0 +1,25 @@
+/*
+ * avr/sleep.h
+ *	Description: Host replacement for the avr-libc sleep definitions
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The sleep instruction calls HOST_SLEEP_cpu, given by the host tool that runs the sleep: it moves
+ * the virtual clock to the next interrupt of its models and calls that interrupt, as the wake of
+ * the idle mode does. The mode and the enable bit have no effect here.
+ */
+
+#ifndef HOST_AVR_SLEEP_H_
+#define HOST_AVR_SLEEP_H_
+
+#define SLEEP_MODE_IDLE			0
+
+#define set_sleep_mode(mode)	((void)(mode))
+#define sleep_enable()			((void)0)
+#define sleep_disable()			((void)0)
+#define sleep_cpu()				HOST_SLEEP_cpu()
+
+/* Sleep until the next interrupt of the host models, given by the host tool */
+void HOST_SLEEP_cpu(void);
+
+#endif /* HOST_AVR_SLEEP_H_ */
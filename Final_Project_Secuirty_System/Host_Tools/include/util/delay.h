@@ -0,0 +1,25 @@
+/*
+ * util/delay.h
+ *	Description: Host replacement for the avr-libc busy-wait delays
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The delays advance the virtual clock of the host models instead of spinning.
+ */
+
+#ifndef HOST_UTIL_DELAY_H_
+#define HOST_UTIL_DELAY_H_
+
+#include "host_clock.h"
+
+static inline void _delay_ms(float64 ms)
+{
+	HOST_CLOCK_advance((uint64)(ms * 1000000.0));
+}
+
+static inline void _delay_us(float64 us)
+{
+	HOST_CLOCK_advance((uint64)(us * 1000.0));
+}
+
+#endif /* HOST_UTIL_DELAY_H_ */
@@ -0,0 +1,27 @@
+/*
+ * util/delay_basic.h
+ *	Description: Host replacement for the avr-libc delay loops
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The loops advance the virtual clock of the host models by their cycles at F_CPU instead of
+ * spinning: 3 cycles per count for _delay_loop_1, 4 for _delay_loop_2, a count of 0 is the
+ * largest one as on the target.
+ */
+
+#ifndef HOST_UTIL_DELAY_BASIC_H_
+#define HOST_UTIL_DELAY_BASIC_H_
+
+#include "host_clock.h"
+
+static inline void _delay_loop_1(uint8 count)
+{
+	HOST_CLOCK_advance((((count == 0) ? 256ULL : count) * 3ULL * 1000000000ULL) / F_CPU);
+}
+
+static inline void _delay_loop_2(uint16 count)
+{
+	HOST_CLOCK_advance((((count == 0) ? 65536ULL : count) * 4ULL * 1000000000ULL) / F_CPU);
+}
+
+#endif /* HOST_UTIL_DELAY_BASIC_H_ */
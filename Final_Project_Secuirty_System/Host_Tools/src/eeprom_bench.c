@@ -0,0 +1,148 @@
+/*
+ * eeprom_bench.c
+ *	Description: Runs the Control ECU EEPROM driver on Linux against the M24C16 model
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * eeprom.c and i2c.c are built unchanged from Control_ECU/src. Every operation is reported
+ * with the virtual time it takes on the ATmega32 (F_CPU = 8 MHz) and the bus.
+ *
+ * Build (from Host_Tools/src):
+ *   gcc -std=gnu99 -Wall -DF_CPU=8000000UL -I../include -I. -I../../Control_ECU/src \
+ *       -o eeprom_bench eeprom_bench.c m24c16_model.c twi_model.c host_clock.c \
+ *       ../../Control_ECU/src/eeprom.c ../../Control_ECU/src/i2c.c
+ *
+ * Usage:
+ *   ./eeprom_bench [image file] [read bit error rate] [write bit error rate]
+ */
+
+#include "m24c16_model.h"
+#include "host_clock.h"
+#include "control_functions.h"  /* Password locations and codes */
+#include "eeprom.h"
+#include "i2c.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <avr/io.h>        /* TWBR */
+#include <util/delay.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Address of a page not used by the application for the page roll over check */
+#define SCRATCH_PAGE        0x0700
+
+/* Bytes written to the scratch page, more than a page to show the roll over */
+#define SCRATCH_SIZE        20
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Virtual time when the current operation started */
+static uint64 g_start;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Start timing an operation */
+static void BENCH_begin(void)
+{
+	g_start = HOST_CLOCK_getTime();
+}
+
+/* Report the result and the virtual time of an operation */
+static void BENCH_end(const char *name, uint8 result)
+{
+	printf("%-44s %-7s %10.1f us\n", name, (result == SUCCESS) ? "SUCCESS" : "ERROR",
+			(HOST_CLOCK_getTime() - g_start) / 1000.0);
+
+	/* eeprom.c returns on an error without a stop condition, release the bus here */
+	if (result != SUCCESS)
+	{
+		TWI_stop();
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	M24C16_ConfigType model = {"m24c16.img", M24C16_WRITE_CYCLE_US, 0.0, 0.0, 1};
+	M24C16_StatsType stats;
+	uint8 password[PASSWORD_SIZE] = {1, 2, 3, 4, 5};
+	uint8 read_back[SCRATCH_SIZE];
+	uint8 scratch[SCRATCH_SIZE];
+	uint8 indicator, result, i;
+
+	if (argc > 1)
+		model.image_path = argv[1];
+	if (argc > 2)
+		model.read_bit_error_rate = atof(argv[2]);
+	if (argc > 3)
+		model.write_bit_error_rate = atof(argv[3]);
+
+	if (!M24C16_open(&model))
+	{
+		perror(model.image_path);
+		return 1;
+	}
+
+	TWI_init(CONTROL_ECU_ADDRESS);
+	printf("SCL period: %.2f us (TWBR = %u)\n\n", (16 + 2.0 * TWBR) * 1000000.0 / F_CPU, TWBR);
+
+	/* Same sequence as Receiving_Passwords */
+	BENCH_begin();
+	result = EEPROM_writeData(PASSWORD_LOCATION, password, PASSWORD_SIZE);
+	BENCH_end("EEPROM_writeData (password)", result);
+
+	BENCH_begin();
+	_delay_ms(10);
+	result = EEPROM_writeByte(PASSWORD_INDICATOR, PASSWORD_FOUND);
+	BENCH_end("_delay_ms(10) + EEPROM_writeByte (indicator)", result);
+
+	/* Same sequence as Find_Password and Checking_Password, after the write cycle */
+	_delay_ms(10);
+	BENCH_begin();
+	result = EEPROM_readByte(PASSWORD_INDICATOR, &indicator);
+	BENCH_end("EEPROM_readByte (indicator)", result);
+
+	BENCH_begin();
+	result = EEPROM_readData(PASSWORD_LOCATION, read_back, PASSWORD_SIZE);
+	BENCH_end("EEPROM_readData (password)", result);
+
+	/* A write right after another write is not acknowledged until the write cycle ends */
+	BENCH_begin();
+	result = EEPROM_writeByte(PASSWORD_INDICATOR, PASSWORD_FOUND);
+	BENCH_end("EEPROM_writeByte (indicator again)", result);
+	BENCH_begin();
+	result = EEPROM_writeByte(PASSWORD_INDICATOR, PASSWORD_FOUND);
+	BENCH_end("EEPROM_writeByte (during write cycle)", result);
+
+	/* More than one page in one transfer rolls over inside the page */
+	for (i = 0; i < SCRATCH_SIZE; i++)
+	{
+		scratch[i] = i;
+	}
+	_delay_ms(10);
+	BENCH_begin();
+	result = EEPROM_writeData(SCRATCH_PAGE, scratch, SCRATCH_SIZE);
+	BENCH_end("EEPROM_writeData (20 bytes, one page)", result);
+	_delay_ms(10);
+	BENCH_begin();
+	result = EEPROM_readData(SCRATCH_PAGE, read_back, M24C16_PAGE_SIZE);
+	BENCH_end("EEPROM_readData (16 bytes)", result);
+
+	printf("\nindicator: 0x%02X\npage:     ", indicator);
+	for (i = 0; i < M24C16_PAGE_SIZE; i++)
+	{
+		printf(" %02u", read_back[i]);
+	}
+
+	M24C16_getStats(&stats);
+	printf("\n\nbytes read %lu, bytes written %lu, write cycles %lu, busy NACKs %lu, bit errors %lu\n",
+			stats.bytes_read, stats.bytes_written, stats.write_cycles, stats.busy_nacks, stats.bit_errors);
+
+	M24C16_close();
+	return 0;
+}
@@ -0,0 +1,589 @@
+/*
+ * hmi_stack_test.c
+ *	Description: Runs the HMI user interface on Linux for thousands of attempts and checks its stack use stays flat
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * hmi_functions.c, lcd.c, keypad.c and soft_timer.c are built unchanged from HMI_ECU/src, on the
+ * port registers of io_model.c, the system tick of timer1_model.c, the LCD of lcd_model.c and the
+ * keypad of keypad_model.c. The UART is stubbed here: the bytes of the HMI go to a scripted Control
+ * ECU, which keeps one password and answers the commands as control_functions.c does, and its bytes
+ * reach the receive call back of the HMI one per millisecond (9600 baud).
+ * A scripted user reads the screen of the LCD model and types on the keypad model. Each round has:
+ *   - four wrong passwords for opening the door, then the alarm minute;
+ *   - the right password, then the door screens;
+ *   - the right password for changing it, two different new passwords, then two equal ones.
+ * A screen other than the one the script expects, or no screen for two minutes, fails the test.
+ * The test also reports the keystroke to display latency of the password digits: the milliseconds
+ * from the key closing on the keypad model to its asterisk shown by the LCD model. The main loop is
+ * called once per millisecond here, after the tick, so the figure is to one millisecond. The last
+ * digit of a first new password has no figure: the next screen replaces it before it is drawn.
+ *
+ * Every function is built with -finstrument-functions: the hook of each function entry keeps the
+ * lowest frame address reached while the main loop of the HMI (SOFT_TIMER_runDeferred, Ui_dispatch
+ * and Link_thread) runs.
+ * The stack span of a round is the distance from the frame of the main loop to that address. It is
+ * measured on the host stack at -O0, not on the AVR, but a call chain growing with the number of
+ * attempts shows on both. The exit status is not zero if the span of the last round is larger
+ * than the span of the first one, or if a screen is missed.
+ *
+ * Build (from Host_Tools/src), with the default configuration of the HMI headers:
+ *   gcc -std=gnu99 -Wall -finstrument-functions -DF_CPU=8000000UL -I../include -I. -I../../HMI_ECU/src \
+ *       -o hmi_stack_test hmi_stack_test.c lcd_model.c keypad_model.c io_model.c timer1_model.c host_clock.c \
+ *       ../../HMI_ECU/src/hmi_functions.c ../../HMI_ECU/src/lcd.c ../../HMI_ECU/src/keypad.c \
+ *       ../../HMI_ECU/src/soft_timer.c
+ *
+ * Usage:
+ *   ./hmi_stack_test [rounds]
+ * The default is 1000 rounds: 5000 failed attempts (4000 wrong passwords and 1000 unmatched new
+ * ones) and 3000 successful ones.
+ */
+
+#include "lcd_model.h"
+#include "keypad_model.h"
+#include "timer1_model.h"
+#include "hmi_functions.h"
+#include "lcd.h"
+#include "keypad.h"
+#include "uart.h"
+#include "soft_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* One system tick in nanoseconds */
+#define TEST_TICK_TIME          1000000ULL
+
+/* Milliseconds a key is held, and released before the next one */
+#define TEST_KEY_HOLD           40
+#define TEST_KEY_GAP            40
+
+/* Longest wait for the next screen of the script in milliseconds */
+#define TEST_SCREEN_TIMEOUT     120000UL
+
+/* Bytes of the Control ECU waiting to reach the HMI */
+#define TEST_RX_QUEUE_SIZE      64
+
+/* Number of rounds run by default */
+#define TEST_DEFAULT_ROUNDS     1000
+
+/* First row of the screens the user acts on */
+#define TEST_MENU_TEXT          "+ : Open Door"
+#define TEST_PROMPT_TEXT        "plz enter pass:"
+#define TEST_REPROMPT_TEXT      "plz re-enter the"
+
+/* Keys of the commands */
+#define TEST_KEY_OPEN           '+'
+#define TEST_KEY_CHANGE         '-'
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum defining the states of the scripted Control ECU */
+typedef enum
+{
+	CONTROL_SEND_RESULT,    /* Waiting for READY from the HMI to send the result */
+	CONTROL_WAIT_COMMAND,   /* READY is sent, the next byte is a command */
+	CONTROL_FIRST_PASSWORD, /* Receiving the first new password */
+	CONTROL_SECOND_PASSWORD,/* Receiving the second new password */
+	CONTROL_CHECK_PASSWORD  /* Receiving the password to check */
+} CONTROL_State;
+
+/* Structure of one step of the user script: the screen expected and the keys typed on it */
+typedef struct
+{
+	const char * screen;    /* First row of the screen */
+	const uint8 * keys;     /* Keys typed, PASSWORD_SIZE digits or one command key */
+	uint8 count;            /* Number of keys */
+} TEST_StepType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Row and column of each key label on the 4x4 keypad of Proteus (13 is ON/C) */
+static const uint8 g_labels[4][4] =
+{
+	{7, 8, 9, '/'},
+	{4, 5, 6, '*'},
+	{1, 2, 3, '-'},
+	{13, 0, '=', '+'},
+};
+
+/* Passwords typed by the user, the stored one changes between the two first ones each round */
+static const uint8 g_pinA[PASSWORD_SIZE] = {1, 2, 3, 4, 5};
+static const uint8 g_pinB[PASSWORD_SIZE] = {5, 4, 3, 2, 1};
+static const uint8 g_pinWrong[PASSWORD_SIZE] = {9, 9, 9, 9, 9};
+static const uint8 g_pinOther[PASSWORD_SIZE] = {0, 0, 0, 0, 0};
+static const uint8 g_keyOpen[1] = {TEST_KEY_OPEN};
+static const uint8 g_keyChange[1] = {TEST_KEY_CHANGE};
+
+/* Scripted Control ECU: its state, the password kept and the one received, and the command */
+static CONTROL_State g_controlState = CONTROL_SEND_RESULT;
+static uint8 g_controlPass[PASSWORD_SIZE];
+static uint8 g_controlFirst[PASSWORD_SIZE];
+static uint8 g_controlSecond[PASSWORD_SIZE];
+static boolean g_controlHasPass = FALSE;
+static uint8 g_controlCommand;
+static uint8 g_controlIndex;
+static uint8 g_controlResult = NO_PASSWORD_FOUND;
+
+/* Bytes from the Control ECU to the HMI and the receive call back of the HMI */
+static uint8 g_rxQueue[TEST_RX_QUEUE_SIZE];
+static uint32 g_rxHead = 0;
+static uint32 g_rxTail = 0;
+static void (*g_rxCallBack)(uint8 data) = NULL_PTR;
+
+/* Keys the user still has to type, and the millisecond of the next key change */
+static const uint8 * g_typeKeys;
+static uint8 g_typeCount = 0;
+static boolean g_typeHeld = FALSE;
+static uint32 g_typeNext = 0;
+
+/* Keystroke to display latency: the millisecond of the digit pressed and the asterisks shown then */
+static boolean g_latencyPending = FALSE;
+static uint32 g_latencyStart;
+static uint8 g_latencyStars;
+
+/* Latencies measured: the number, their sum, the shortest and the longest */
+static uint32 g_latencyCount = 0;
+static uint64 g_latencySum = 0;
+static uint32 g_latencyMin = UINT32_MAX;
+static uint32 g_latencyMax = 0;
+
+/* First row of the screen of the last step, a step runs on a screen drawn after it */
+static char g_lastScreen[LCD_NUM_COLS + 1] = "";
+
+/* Milliseconds run */
+static uint32 g_time = 0;
+
+/* TRUE while the main loop of the HMI runs, and the lowest frame address reached meanwhile */
+static volatile boolean g_probing = FALSE;
+static volatile uintptr_t g_lowestFrame = UINTPTR_MAX;
+
+/* Frame address of the function calling the main loop of the HMI */
+static uintptr_t g_loopFrame = 0;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+void __cyg_profile_func_enter(void * function, void * call_site) __attribute__((no_instrument_function));
+void __cyg_profile_func_exit(void * function, void * call_site) __attribute__((no_instrument_function));
+
+/* One pass of the main loop of the HMI, never inlined so its frame is the base of the span */
+static void TEST_runEcu(void) __attribute__((noinline));
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Entry of every instrumented function: keep the lowest frame while the HMI runs */
+void __cyg_profile_func_enter(void * function, void * call_site)
+{
+	uintptr_t frame = (uintptr_t)__builtin_frame_address(0);
+
+	if (g_probing && (frame < g_lowestFrame))
+	{
+		g_lowestFrame = frame;
+	}
+}
+
+void __cyg_profile_func_exit(void * function, void * call_site)
+{
+}
+
+/* Queue one byte of the Control ECU to the HMI */
+static void CONTROL_send(uint8 data)
+{
+	if ((g_rxHead - g_rxTail) >= TEST_RX_QUEUE_SIZE)
+	{
+		printf("FAIL: receive queue of the HMI full\n");
+		exit(1);
+	}
+	g_rxQueue[g_rxHead % TEST_RX_QUEUE_SIZE] = data;
+	g_rxHead++;
+}
+
+/* Keep the result, it is sent when the HMI sends READY */
+static void CONTROL_setResult(uint8 result)
+{
+	g_controlResult = result;
+	g_controlState = CONTROL_SEND_RESULT;
+}
+
+/* Scripted Control ECU: handle one byte of the HMI */
+static void CONTROL_receive(uint8 data)
+{
+	switch (g_controlState)
+	{
+		case CONTROL_SEND_RESULT:
+			/* Send the result, then READY for the next command */
+			if (data == READY_TO_RECEVIE)
+			{
+				CONTROL_send(g_controlResult);
+				CONTROL_send(READY_TO_RECEVIE);
+				g_controlState = CONTROL_WAIT_COMMAND;
+			}
+			break;
+
+		case CONTROL_WAIT_COMMAND:
+			g_controlIndex = 0;
+			g_controlCommand = data;
+			if (data == SENDING_PASSWORDS)
+			{
+				g_controlState = CONTROL_FIRST_PASSWORD;
+				CONTROL_send(READY_TO_RECEVIE);
+			}
+			else if ((data == CHECKING_PASSWORD_OPEN) || (data == CHECKING_PASSWORD_CHANGE))
+			{
+				g_controlState = CONTROL_CHECK_PASSWORD;
+				CONTROL_send(READY_TO_RECEVIE);
+			}
+			break;
+
+		case CONTROL_FIRST_PASSWORD:
+			g_controlFirst[g_controlIndex++] = data;
+			if (g_controlIndex == PASSWORD_SIZE)
+			{
+				g_controlIndex = 0;
+				g_controlState = CONTROL_SECOND_PASSWORD;
+				CONTROL_send(READY_TO_RECEVIE);
+			}
+			break;
+
+		case CONTROL_SECOND_PASSWORD:
+			g_controlSecond[g_controlIndex++] = data;
+			if (g_controlIndex == PASSWORD_SIZE)
+			{
+				if (memcmp(g_controlFirst, g_controlSecond, PASSWORD_SIZE) == 0)
+				{
+					memcpy(g_controlPass, g_controlFirst, PASSWORD_SIZE);
+					g_controlHasPass = TRUE;
+					CONTROL_setResult(PASSWORDS_MATCH);
+				}
+				else
+				{
+					CONTROL_setResult(PASSWORDS_UNMATCH);
+				}
+			}
+			break;
+
+		case CONTROL_CHECK_PASSWORD:
+			g_controlFirst[g_controlIndex++] = data;
+			if (g_controlIndex == PASSWORD_SIZE)
+			{
+				if (g_controlHasPass && (memcmp(g_controlFirst, g_controlPass, PASSWORD_SIZE) == 0))
+				{
+					CONTROL_setResult((g_controlCommand == CHECKING_PASSWORD_OPEN) ? PASSWORD_MATCH_OPEN : PASSWORD_MATCH_CHANGE);
+				}
+				else
+				{
+					CONTROL_setResult((g_controlCommand == CHECKING_PASSWORD_OPEN) ? PASSWORD_UNMATCH_OPEN : PASSWORD_UNMATCH_CHANGE);
+				}
+			}
+			break;
+	}
+}
+
+/* Stub of the UART driver of the HMI: the bytes go to the scripted Control ECU */
+void UART_init(void)
+{
+}
+
+void UART_sendByte(const uint8 data)
+{
+	CONTROL_receive(data);
+}
+
+void UART_sendData(const uint8 *arr, uint8 arr_size)
+{
+	uint8 i;
+
+	for (i = 0; i < arr_size; i++)
+	{
+		CONTROL_receive(arr[i]);
+	}
+}
+
+void UART_setRxCallBack(void (*ptr_func)(uint8 data))
+{
+	g_rxCallBack = ptr_func;
+}
+
+/* Hold or release the key with the given label */
+static void TEST_setKey(uint8 label, boolean held)
+{
+	uint8 row, column;
+
+	for (row = 0; row < KEYPAD_NUM_ROWS; row++)
+	{
+		for (column = 0; column < KEYPAD_NUM_COLS; column++)
+		{
+			if (g_labels[row][column] == label)
+			{
+				KEYPAD_MODEL_setKey(row, column, held);
+				return;
+			}
+		}
+	}
+}
+
+/* Return the number of asterisks of the password shown on the last row */
+static uint8 TEST_countStars(void)
+{
+	char row[LCD_NUM_COLS + 1];
+	uint8 i, stars = 0;
+
+	LCD_MODEL_getRow(LCD_NUM_ROWS - 1, row);
+	for (i = 0; i < LCD_NUM_COLS; i++)
+	{
+		stars += (row[i] == '*');
+	}
+	return stars;
+}
+
+/* Take the latency of the digit pressed once its asterisk is shown */
+static void TEST_checkLatency(void)
+{
+	uint32 latency;
+
+	if (!g_latencyPending || (TEST_countStars() <= g_latencyStars))
+	{
+		return;
+	}
+	latency = g_time - g_latencyStart;
+	g_latencyPending = FALSE;
+	g_latencyCount++;
+	g_latencySum += latency;
+	g_latencyMin = (latency < g_latencyMin) ? latency : g_latencyMin;
+	g_latencyMax = (latency > g_latencyMax) ? latency : g_latencyMax;
+}
+
+/*
+ * Press and release the keys being typed at their times, returns TRUE while keys are left or the
+ * gap after the last one runs: a key pressed before the release of the previous one is debounced
+ * would be a chord.
+ */
+static boolean TEST_type(void)
+{
+	if (g_typeCount == 0)
+	{
+		return (g_time < g_typeNext);
+	}
+	if (g_time >= g_typeNext)
+	{
+		TEST_setKey(*g_typeKeys, !g_typeHeld);
+		g_typeHeld = !g_typeHeld;
+		if (g_typeHeld)
+		{
+			/* The digits of a password show an asterisk */
+			if (*g_typeKeys <= 9)
+			{
+				g_latencyPending = TRUE;
+				g_latencyStart = g_time;
+				g_latencyStars = TEST_countStars();
+			}
+			g_typeNext = g_time + TEST_KEY_HOLD;
+		}
+		else
+		{
+			g_typeNext = g_time + TEST_KEY_GAP;
+			g_typeKeys++;
+			g_typeCount--;
+		}
+	}
+	return TRUE;
+}
+
+/* One pass of the main loop of the HMI, the probe keeps the frames below this one */
+static void TEST_runEcu(void)
+{
+	static PT_Type link_thread;
+	static boolean started = FALSE;
+
+	if (!started)
+	{
+		PT_INIT(&link_thread);
+		started = TRUE;
+	}
+
+	g_loopFrame = (uintptr_t)__builtin_frame_address(0);
+	g_probing = TRUE;
+	(void)SOFT_TIMER_runDeferred();
+	Ui_dispatch();
+	Link_thread(&link_thread);
+	g_probing = FALSE;
+}
+
+/*
+ * Run the system tick until the LCD shows the screen of the step, then type its keys. The screen
+ * must be drawn after the one of the previous step, and no other screen where keys are typed may
+ * come first. Return the milliseconds waited, or TEST_SCREEN_TIMEOUT.
+ */
+static uint32 TEST_step(const TEST_StepType * step_ptr, uintptr_t * lowest_ptr)
+{
+	char row[LCD_NUM_COLS + 1];
+	uint32 start = g_time;
+
+	while ((g_time - start) < TEST_SCREEN_TIMEOUT)
+	{
+		TIMER1_MODEL_run(TEST_TICK_TIME);
+		g_time++;
+
+		/* The bytes of the Control ECU at 9600 baud, about one per millisecond */
+		if ((g_rxHead != g_rxTail) && (g_rxCallBack != NULL_PTR))
+		{
+			(*g_rxCallBack)(g_rxQueue[g_rxTail % TEST_RX_QUEUE_SIZE]);
+			g_rxTail++;
+		}
+
+		g_lowestFrame = UINTPTR_MAX;
+		TEST_runEcu();
+		if (g_lowestFrame < *lowest_ptr)
+		{
+			*lowest_ptr = g_lowestFrame;
+		}
+		TEST_checkLatency();
+
+		if (TEST_type())
+		{
+			continue;
+		}
+
+		LCD_MODEL_getRow(0, row);
+		if (strncmp(row, g_lastScreen, LCD_NUM_COLS) != 0)
+		{
+			/* A new screen: the same screen drawn again later is a new step */
+			g_lastScreen[0] = '\0';
+		}
+		if ((strncmp(row, TEST_MENU_TEXT, strlen(TEST_MENU_TEXT)) == 0) ||
+			(strncmp(row, TEST_PROMPT_TEXT, strlen(TEST_PROMPT_TEXT)) == 0) ||
+			(strncmp(row, TEST_REPROMPT_TEXT, strlen(TEST_REPROMPT_TEXT)) == 0))
+		{
+			if (g_lastScreen[0] != '\0')
+			{
+				continue;
+			}
+			if (strncmp(row, step_ptr->screen, strlen(step_ptr->screen)) != 0)
+			{
+				printf("FAIL at %lu ms: screen \"%s\", expected \"%s\"\n", (unsigned long)g_time, row, step_ptr->screen);
+				exit(1);
+			}
+			strcpy(g_lastScreen, row);
+			g_typeKeys = step_ptr->keys;
+			g_typeCount = step_ptr->count;
+			g_typeNext = g_time;
+			return g_time - start;
+		}
+	}
+	return TEST_SCREEN_TIMEOUT;
+}
+
+/* Run the steps of a script, returns the stack span reached in bytes */
+static uint32 TEST_script(const TEST_StepType * steps_ptr, uint32 count)
+{
+	uintptr_t lowest = UINTPTR_MAX;
+	char row0[LCD_NUM_COLS + 1];
+	char row1[LCD_NUM_COLS + 1];
+	uint32 i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (TEST_step(&steps_ptr[i], &lowest) == TEST_SCREEN_TIMEOUT)
+		{
+			LCD_MODEL_getRow(0, row0);
+			LCD_MODEL_getRow(1, row1);
+			printf("FAIL at %lu ms: no screen \"%s\" for step %lu, the LCD shows \"%s\" \"%s\"\n",
+					(unsigned long)g_time, steps_ptr[i].screen, (unsigned long)i, row0, row1);
+			exit(1);
+		}
+	}
+	return (lowest == UINTPTR_MAX) ? 0 : (uint32)(g_loopFrame - lowest);
+}
+
+int main(int argc, char * argv[])
+{
+	uint32 rounds = (argc > 1) ? (uint32)strtoul(argv[1], NULL_PTR, 0) : TEST_DEFAULT_ROUNDS;
+	uint32 round, span, first = 0, lowest = UINT32_MAX, highest = 0;
+	const uint8 * stored;
+	const uint8 * next;
+
+	/* First password, set at start-up since the Control ECU has none */
+	const TEST_StepType setup[] =
+	{
+		{TEST_PROMPT_TEXT,      g_pinA,     PASSWORD_SIZE},
+		{TEST_REPROMPT_TEXT,    g_pinA,     PASSWORD_SIZE},
+	};
+	TEST_StepType steps[] =
+	{
+		/* Four wrong passwords, then the alarm minute */
+		{TEST_MENU_TEXT,        g_keyOpen,  1},
+		{TEST_PROMPT_TEXT,      g_pinWrong, PASSWORD_SIZE},
+		{TEST_PROMPT_TEXT,      g_pinWrong, PASSWORD_SIZE},
+		{TEST_PROMPT_TEXT,      g_pinWrong, PASSWORD_SIZE},
+		{TEST_PROMPT_TEXT,      g_pinWrong, PASSWORD_SIZE},
+		/* The door opened */
+		{TEST_MENU_TEXT,        g_keyOpen,  1},
+		{TEST_PROMPT_TEXT,      NULL_PTR,   PASSWORD_SIZE},
+		/* The password changed, after two different new passwords */
+		{TEST_MENU_TEXT,        g_keyChange, 1},
+		{TEST_PROMPT_TEXT,      NULL_PTR,   PASSWORD_SIZE},
+		{TEST_PROMPT_TEXT,      NULL_PTR,   PASSWORD_SIZE},
+		{TEST_REPROMPT_TEXT,    g_pinOther, PASSWORD_SIZE},
+		{TEST_PROMPT_TEXT,      NULL_PTR,   PASSWORD_SIZE},
+		{TEST_REPROMPT_TEXT,    NULL_PTR,   PASSWORD_SIZE},
+	};
+
+	/* Same order as Init_Function of the HMI, the models first */
+	LCD_MODEL_init();
+	KEYPAD_MODEL_init();
+	Init_Function();
+
+	TEST_script(setup, sizeof(setup) / sizeof(setup[0]));
+
+	for (round = 0; round < rounds; round++)
+	{
+		/* The password is A in the even rounds and B in the odd ones */
+		stored = (round & 1) ? g_pinB : g_pinA;
+		next = (round & 1) ? g_pinA : g_pinB;
+		steps[6].keys = stored;
+		steps[8].keys = stored;
+		steps[9].keys = next;
+		steps[11].keys = next;
+		steps[12].keys = next;
+
+		span = TEST_script(steps, sizeof(steps) / sizeof(steps[0]));
+		if (round == 0)
+		{
+			first = span;
+		}
+		lowest = (span < lowest) ? span : lowest;
+		highest = (span > highest) ? span : highest;
+	}
+
+	/* The menu after the last password saved ends the last round */
+	{
+		const TEST_StepType last[] = {{TEST_MENU_TEXT, g_keyOpen, 0}};
+		TEST_script(last, 1);
+	}
+
+	printf("%lu rounds, %lu simulated ms: %lu failed and %lu successful attempts\n", (unsigned long)rounds,
+			(unsigned long)g_time, (unsigned long)(rounds * 5), (unsigned long)(rounds * 3));
+	printf("stack span of the main loop (host bytes): first round %lu, last round %lu, lowest %lu, highest %lu\n",
+			(unsigned long)first, (unsigned long)span, (unsigned long)lowest, (unsigned long)highest);
+	if (g_latencyCount != 0)
+	{
+		printf("keystroke to display latency of %lu digits: shortest %lu ms, longest %lu ms, mean %.1f ms\n",
+				(unsigned long)g_latencyCount, (unsigned long)g_latencyMin, (unsigned long)g_latencyMax,
+				(double)g_latencySum / g_latencyCount);
+	}
+	printf("%s\n", (rounds == 0) || (span <= first) ? "PASS" : "FAIL");
+	return ((rounds == 0) || (span <= first)) ? 0 : 1;
+}
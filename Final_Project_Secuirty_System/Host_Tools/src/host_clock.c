@@ -0,0 +1,57 @@
+/*
+ * host_clock.c
+ *	Description: Source file for the virtual clock used by the host (Linux) device models
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "host_clock.h"
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Virtual time in nanoseconds */
+static uint64 g_time = 0;
+
+/* Function called before every access to the clock */
+static void (*g_syncHook)(void) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Advance the virtual clock by the given number of nanoseconds.
+ */
+void HOST_CLOCK_advance(uint64 nanoseconds)
+{
+	if (g_syncHook != NULL_PTR)
+	{
+		(*g_syncHook)();
+	}
+	g_time += nanoseconds;
+}
+
+/*
+ * Description :
+ * Return the virtual time in nanoseconds since the program started.
+ */
+uint64 HOST_CLOCK_getTime(void)
+{
+	if (g_syncHook != NULL_PTR)
+	{
+		(*g_syncHook)();
+	}
+	return g_time;
+}
+
+/*
+ * Description :
+ * Set a function that is called before the clock is read or advanced.
+ */
+void HOST_CLOCK_setSyncHook(void (*ptr_func)(void))
+{
+	g_syncHook = ptr_func;
+}
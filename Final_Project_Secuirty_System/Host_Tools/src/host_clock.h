@@ -0,0 +1,41 @@
+/*
+ * host_clock.h
+ *	Description: Header file for the virtual clock used by the host (Linux) device models
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The host models never sleep. Every bus transfer and every _delay_ms/_delay_us call in the
+ * driver code advances this clock instead, so timing measured on the build machine matches
+ * what the ATmega32 would spend on the real part.
+ */
+
+#ifndef HOST_CLOCK_H_
+#define HOST_CLOCK_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Advance the virtual clock by the given number of nanoseconds.
+ */
+void HOST_CLOCK_advance(uint64 nanoseconds);
+
+/*
+ * Description :
+ * Return the virtual time in nanoseconds since the program started.
+ */
+uint64 HOST_CLOCK_getTime(void);
+
+/*
+ * Description :
+ * Set a function that is called before the clock is read or advanced.
+ * The TWI model uses it to finish any register write that is still pending, so the
+ * write lands at the correct virtual time.
+ */
+void HOST_CLOCK_setSyncHook(void (*ptr_func)(void));
+
+#endif /* HOST_CLOCK_H_ */
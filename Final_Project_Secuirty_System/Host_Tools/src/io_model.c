@@ -0,0 +1,19 @@
+/*
+ * io_model.c
+ *	Description: Host (Linux) model of the I/O registers of the ports and of SREG
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * Backs the PIN, DDR and PORT registers and SREG declared in the host avr/io.h. The registers are
+ * plain memory: the drivers write them as on the target, and the device models (LCD, keypad)
+ * read the outputs and drive the PIN registers of their inputs.
+ */
+
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* I/O registers at their I/O addresses, all cleared as after a reset */
+volatile uint8 HOST_IO_REGISTERS[HOST_IO_SIZE];
@@ -0,0 +1,198 @@
+/*
+ * keypad_model.c
+ *	Description: Host (Linux) model of the keypad matrix on the port registers
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "keypad_model.h"
+#include "timer1_model.h"
+#include "keypad.h"
+#include "gpio.h"
+#include <avr/io.h>
+#if (KEYPAD_WAKE_ENABLE == 1)
+#include <avr/interrupt.h>
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Registers of the keypad port, the rows and the columns share it */
+#define KEYPAD_MODEL_DDR        GPIO_DDR_REGISTER(KEYPAD_ROW_PORT_ID)
+#define KEYPAD_MODEL_PORT       GPIO_PORT_REGISTER(KEYPAD_ROW_PORT_ID)
+#define KEYPAD_MODEL_PIN        GPIO_PIN_REGISTER(KEYPAD_ROW_PORT_ID)
+
+/* Pins of the rows and of the columns in the port */
+#define KEYPAD_MODEL_ROWS       (((1 << KEYPAD_NUM_ROWS) - 1) << KEYPAD_ROW_PIN_ID)
+#define KEYPAD_MODEL_COLUMNS    (((1 << KEYPAD_NUM_COLS) - 1) << KEYPAD_COLUMN_PIN_ID)
+
+/* Level of a released key in the port, one for every pin */
+#if (KEYPAD_BUTTON_RELEASED == LOGIC_HIGH)
+#define KEYPAD_MODEL_RELEASED   0xFF
+#else
+#define KEYPAD_MODEL_RELEASED   0x00
+#endif
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Keys held, one bit per column for each row */
+static uint8 g_held[KEYPAD_NUM_ROWS];
+
+/* Rows driven at the last update, and the row steps seen */
+static uint8 g_rows;
+static uint32 g_rowSteps;
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+/* Level of the INT2 pin and enable bit of INT2 at the last update */
+static uint8 g_int2Level;
+static boolean g_int2Enabled;
+#endif
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+/* INT2 ISR of keypad.c */
+void INT2_vect(void);
+
+/* Set the INT2 pin from the columns and call the ISR at its edge */
+static void KEYPAD_MODEL_updateInt2(uint8 pins);
+#endif
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Release all the keys and follow the ticks of the Timer1 model.
+ */
+void KEYPAD_MODEL_init(void)
+{
+	uint8 row;
+
+	for (row = 0; row < KEYPAD_NUM_ROWS; row++)
+	{
+		g_held[row] = 0;
+	}
+	g_rows = 0;
+	g_rowSteps = 0;
+#if (KEYPAD_WAKE_ENABLE == 1)
+	g_int2Level = KEYPAD_MODEL_RELEASED & (1 << PIN2_ID);
+	g_int2Enabled = FALSE;
+#endif
+	TIMER1_MODEL_setInputHook(KEYPAD_MODEL_update);
+	KEYPAD_MODEL_update();
+}
+
+/*
+ * Description :
+ * Hold or release one key.
+ */
+void KEYPAD_MODEL_setKey(uint8 row, uint8 column, boolean held)
+{
+	if (held)
+	{
+		g_held[row] |= (uint8)(1 << column);
+	}
+	else
+	{
+		g_held[row] &= (uint8)~(1 << column);
+	}
+}
+
+/*
+ * Description :
+ * Set the PIN register: outputs read their PORT level, inputs the released level, and an input
+ * column joined to a driven row by a held key reads the level of the row.
+ */
+void KEYPAD_MODEL_update(void)
+{
+	uint8 ddr = KEYPAD_MODEL_DDR;
+	uint8 port = KEYPAD_MODEL_PORT;
+	uint8 pins = (uint8)((port & ddr) | (KEYPAD_MODEL_RELEASED & (uint8)~ddr));
+	uint8 row, column, rowPin, columnPin;
+
+	for (row = 0; row < KEYPAD_NUM_ROWS; row++)
+	{
+		rowPin = (uint8)(1 << (KEYPAD_ROW_PIN_ID + row));
+		if ((ddr & rowPin) == 0)
+		{
+			continue;
+		}
+		for (column = 0; column < KEYPAD_NUM_COLS; column++)
+		{
+			columnPin = (uint8)(1 << (KEYPAD_COLUMN_PIN_ID + column));
+			if (((g_held[row] & (1 << column)) != 0) && ((ddr & columnPin) == 0))
+			{
+				pins = (port & rowPin) ? (pins | columnPin) : (pins & (uint8)~columnPin);
+			}
+		}
+	}
+	KEYPAD_MODEL_PIN = pins;
+
+	/* A row step drives one row in place of another one */
+	if ((ddr & KEYPAD_MODEL_ROWS) != g_rows)
+	{
+		g_rows = ddr & KEYPAD_MODEL_ROWS;
+		g_rowSteps++;
+	}
+#if (KEYPAD_WAKE_ENABLE == 1)
+	KEYPAD_MODEL_updateInt2(pins);
+#endif
+}
+
+/*
+ * Description :
+ * Return the number of row steps of the scan seen since KEYPAD_MODEL_init.
+ */
+uint32 KEYPAD_MODEL_getRowSteps(void)
+{
+	return g_rowSteps;
+}
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+/* Set the INT2 pin from the columns and call the ISR at its edge */
+static void KEYPAD_MODEL_updateInt2(uint8 pins)
+{
+	uint8 columns = pins & KEYPAD_MODEL_COLUMNS;
+	uint8 level;
+
+	/* Diodes from the columns: the pin is at the pressed level when a column is */
+#if (KEYPAD_BUTTON_PRESSED == LOGIC_LOW)
+	level = (columns == KEYPAD_MODEL_COLUMNS) ? (1 << PIN2_ID) : 0;
+#else
+	level = (columns != 0) ? (1 << PIN2_ID) : 0;
+#endif
+	PINB = (PINB & (uint8)~(1 << PIN2_ID)) | level;
+
+	/*
+	 * The driver writes a one to INTF2 to clear it before it enables INT2, a plain register here:
+	 * the flag is cleared when INT2 is seen enabled.
+	 */
+	if (!g_int2Enabled && (GICR & (1 << INT2)))
+	{
+		GIFR &= (uint8)~(1 << INTF2);
+	}
+	g_int2Enabled = ((GICR & (1 << INT2)) != 0);
+
+	/* Falling edge with ISC2 cleared, rising edge with ISC2 set */
+	if (level != g_int2Level)
+	{
+		g_int2Level = level;
+		if ((level != 0) == ((MCUCSR & (1 << ISC2)) != 0))
+		{
+			GIFR |= (1 << INTF2);
+		}
+	}
+	if ((GIFR & (1 << INTF2)) && (GICR & (1 << INT2)) && (SREG & (1 << HOST_SREG_I)))
+	{
+		GIFR &= (uint8)~(1 << INTF2);
+		INT2_vect();
+	}
+}
+#endif
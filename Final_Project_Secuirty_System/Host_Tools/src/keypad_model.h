@@ -0,0 +1,51 @@
+/*
+ * keypad_model.h
+ *	Description: Header file for the host (Linux) model of the keypad matrix
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The model sets the PIN register of the keypad port from its DDR and PORT registers and the keys
+ * held, wired as keypad.h configures them: a key held joins its row pin and its column pin, so a
+ * driven row gives its level to the columns of its held keys. The other pins read their PORT level
+ * when they are outputs and the released level (the pull-ups) when they are inputs. The register is
+ * updated before each callback of timer1_model.c, the levels the scan of the tick ISR reads.
+ * With KEYPAD_WAKE_ENABLE the columns are also wired to the INT2 pin (PB2) through diodes: the pin
+ * reads the pressed level when any column does, and its edge calls the INT2 ISR of keypad.c when
+ * GICR enables it and the I bit of SREG is set.
+ * The model counts the row steps of the scan: the updates that find another row driven.
+ */
+
+#ifndef KEYPAD_MODEL_H_
+#define KEYPAD_MODEL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Release all the keys and update the PIN register before each callback of the Timer1 model.
+ */
+void KEYPAD_MODEL_init(void);
+
+/*
+ * Description :
+ * Hold (TRUE) or release (FALSE) the key of a row and a column of the matrix.
+ */
+void KEYPAD_MODEL_setKey(uint8 row, uint8 column, boolean held);
+
+/*
+ * Description :
+ * Set the PIN register of the keypad port from the keys held, also called before each callback.
+ */
+void KEYPAD_MODEL_update(void);
+
+/*
+ * Description :
+ * Return the number of row steps of the scan seen since KEYPAD_MODEL_init.
+ */
+uint32 KEYPAD_MODEL_getRowSteps(void);
+
+#endif /* KEYPAD_MODEL_H_ */
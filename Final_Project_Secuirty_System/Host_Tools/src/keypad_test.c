@@ -0,0 +1,462 @@
+/*
+ * keypad_test.c
+ *	Description: Runs the HMI keypad scan on Linux against the keypad model and checks its events
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * keypad.c and soft_timer.c are built unchanged from HMI_ECU/src, on the port registers of
+ * io_model.c, the system tick of timer1_model.c and the matrix of keypad_model.c. Each of the 16
+ * keys is pressed and released in turn, and the events taken from the FIFO must be its press and
+ * its release with the label of the key on the 4x4 keypad of Proteus, and nothing else.
+ * Then each scenario of g_scenarios holds and releases keys at given milliseconds, and the events
+ * taken must be the expected ones, in order, each within one full scan of its expected time (two
+ * for the repeats and the long press, counted in full scans from the scan of the press):
+ *   - contact bounce shorter than the debounce gives no event;
+ *   - a press and a release with contact bounce give one press and one release;
+ *   - keys typed while nothing reads the FIFO are kept up to KEYPAD_FIFO_SIZE events;
+ *   - a key held gives its repeats after KEYPAD_REPEAT_DELAY, every KEYPAD_REPEAT_PERIOD, and its
+ *     long press after KEYPAD_LONG_PRESS_TIME;
+ *   - a key pressed while one other key is held gives a chord instead of its press, and neither
+ *     key repeats;
+ *   - a key pressed while two other keys are held gives its press, and does not repeat.
+ * Last it counts the row steps of the scan in two idle seconds. With KEYPAD_WAKE_ENABLE the scan
+ * must stop after KEYPAD_IDLE_SCANS full scans, and a key pressed then must wake it through INT2
+ * and give its press and release. The system tick itself runs in every case, 1000 ticks a second.
+ *
+ * The configuration tested is the one of keypad.h: set KEYPAD_WAKE_ENABLE there to test the wake.
+ *
+ * Build (from Host_Tools/src):
+ *   gcc -std=gnu99 -Wall -DF_CPU=8000000UL -I../include -I. -I../../HMI_ECU/src \
+ *       -o keypad_test keypad_test.c keypad_model.c io_model.c timer1_model.c host_clock.c \
+ *       ../../HMI_ECU/src/keypad.c ../../HMI_ECU/src/soft_timer.c
+ *
+ * Usage:
+ *   ./keypad_test
+ * The exit status is not zero if a check fails.
+ */
+
+#include "keypad_model.h"
+#include "timer1_model.h"
+#include "keypad.h"
+#include "timer1.h"
+#include "soft_timer.h"
+#include <stdio.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* One system tick in nanoseconds */
+#define TEST_TICK_TIME      1000000ULL
+
+/* Longest wait for an event in ticks, far longer than the debounce */
+#define TEST_MAX_TICKS      100
+
+/* Ticks of the debounce: KEYPAD_DEBOUNCE_SCANS full scans */
+#define TEST_DEBOUNCE_TICKS (KEYPAD_DEBOUNCE_SCANS * KEYPAD_NUM_ROWS * KEYPAD_SCAN_PERIOD)
+
+/* Ticks of one full scan, the time of an event is known to one full scan */
+#define TEST_SCAN_TICKS     (KEYPAD_NUM_ROWS * KEYPAD_SCAN_PERIOD)
+
+/* Ticks of an idle second */
+#define TEST_IDLE_TICKS     1000
+
+/* Most events of a scenario */
+#define TEST_MAX_EVENTS     32
+
+/* Number of scenarios */
+#define TEST_SCENARIOS_NUM  (sizeof(g_scenarios) / sizeof(g_scenarios[0]))
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Key held or released at a millisecond of a scenario */
+typedef struct
+{
+	uint16 time;            /* Millisecond from the start of the scenario */
+	uint8 key;              /* Label of the key */
+	boolean held;           /* TRUE to hold the key, FALSE to release it */
+} TEST_ActionType;
+
+/* Event expected at a millisecond of a scenario */
+typedef struct
+{
+	uint16 time;            /* Millisecond from the start of the scenario, to one full scan */
+	uint8 key;              /* Label of the key */
+	uint8 kind;             /* One of KEYPAD_EventKind */
+	uint8 chord;            /* Chord key of a KEYPAD_CHORD event, KEYPAD_NO_KEY otherwise */
+} TEST_ExpectType;
+
+/* Scenario: the keys held and released, and the events expected */
+typedef struct
+{
+	const char * name;
+	const TEST_ActionType * actions;
+	uint8 actions_num;
+	const TEST_ExpectType * events;
+	uint8 events_num;
+	uint16 length;          /* Milliseconds run, all the keys are released before the end */
+	boolean read;           /* FALSE if the FIFO is read only at the end */
+} TEST_ScenarioType;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Labels of the keys of the 4x4 keypad of Proteus, row by row (13 is ON/C) */
+static const uint8 g_labels[4][4] =
+{
+	{7, 8, 9, '/'},
+	{4, 5, 6, '*'},
+	{1, 2, 3, '-'},
+	{13, 0, '=', '+'},
+};
+
+/*
+ * Contact bounce shorter than the debounce: no event. The scan samples a row once per full scan, so
+ * each level of the bounce lasts one full scan to be read.
+ */
+static const TEST_ActionType g_bounceActions[] =
+{
+	{0, 5, TRUE}, {4, 5, FALSE}, {8, 5, TRUE}, {12, 5, FALSE}, {16, 5, TRUE}, {20, 5, FALSE},
+};
+
+/* Press and release with contact bounce: one press when the key settles, one release */
+static const TEST_ActionType g_chatterActions[] =
+{
+	{0, 5, TRUE}, {4, 5, FALSE}, {8, 5, TRUE}, {12, 5, FALSE}, {16, 5, TRUE},
+	{200, 5, FALSE}, {204, 5, TRUE}, {208, 5, FALSE},
+};
+static const TEST_ExpectType g_chatterEvents[] =
+{
+	{16 + TEST_DEBOUNCE_TICKS, 5, KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{208 + TEST_DEBOUNCE_TICKS, 5, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+};
+
+/* Six keys typed ahead, the FIFO keeps the first KEYPAD_FIFO_SIZE events */
+static const TEST_ActionType g_typeAheadActions[] =
+{
+	{0, 1, TRUE}, {50, 1, FALSE}, {100, 2, TRUE}, {150, 2, FALSE}, {200, 3, TRUE}, {250, 3, FALSE},
+	{300, 4, TRUE}, {350, 4, FALSE}, {400, 5, TRUE}, {450, 5, FALSE}, {500, 6, TRUE}, {550, 6, FALSE},
+};
+static const TEST_ExpectType g_typeAheadEvents[] =
+{
+	{0 + TEST_DEBOUNCE_TICKS, 1, KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{50 + TEST_DEBOUNCE_TICKS, 1, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+	{100 + TEST_DEBOUNCE_TICKS, 2, KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{150 + TEST_DEBOUNCE_TICKS, 2, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+	{200 + TEST_DEBOUNCE_TICKS, 3, KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{250 + TEST_DEBOUNCE_TICKS, 3, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+	{300 + TEST_DEBOUNCE_TICKS, 4, KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{350 + TEST_DEBOUNCE_TICKS, 4, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+};
+
+/* Times of the events of a key held, from the end of its debounce */
+#define TEST_REPEAT(n)      (TEST_DEBOUNCE_TICKS + KEYPAD_REPEAT_DELAY + ((n) * KEYPAD_REPEAT_PERIOD))
+#define TEST_LONG_PRESS     (TEST_DEBOUNCE_TICKS + KEYPAD_LONG_PRESS_TIME)
+
+/* One key held for 1250 ms: its press, repeats from 500 ms, its long press at 1 s and its release */
+static const TEST_ActionType g_holdActions[] =
+{
+	{0, 5, TRUE}, {1250, 5, FALSE},
+};
+static const TEST_ExpectType g_holdEvents[] =
+{
+	{TEST_DEBOUNCE_TICKS, 5, KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{TEST_REPEAT(0), 5, KEYPAD_REPEAT, KEYPAD_NO_KEY},
+	{TEST_REPEAT(1), 5, KEYPAD_REPEAT, KEYPAD_NO_KEY},
+	{TEST_REPEAT(2), 5, KEYPAD_REPEAT, KEYPAD_NO_KEY},
+	{TEST_REPEAT(3), 5, KEYPAD_REPEAT, KEYPAD_NO_KEY},
+	{TEST_REPEAT(4), 5, KEYPAD_REPEAT, KEYPAD_NO_KEY},
+	{TEST_REPEAT(5), 5, KEYPAD_REPEAT, KEYPAD_NO_KEY},
+	{TEST_LONG_PRESS, 5, KEYPAD_LONG_PRESS, KEYPAD_NO_KEY},
+	{TEST_REPEAT(6), 5, KEYPAD_REPEAT, KEYPAD_NO_KEY},
+	{TEST_REPEAT(7), 5, KEYPAD_REPEAT, KEYPAD_NO_KEY},
+	{1250 + TEST_DEBOUNCE_TICKS, 5, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+};
+
+/* '+' held, then 1 pressed and released: a chord, and '+' held past the repeat delay does not repeat */
+static const TEST_ActionType g_chordActions[] =
+{
+	{0, '+', TRUE}, {100, 1, TRUE}, {300, 1, FALSE}, {900, '+', FALSE},
+};
+static const TEST_ExpectType g_chordEvents[] =
+{
+	{TEST_DEBOUNCE_TICKS, '+', KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{100 + TEST_DEBOUNCE_TICKS, 1, KEYPAD_CHORD, '+'},
+	{300 + TEST_DEBOUNCE_TICKS, 1, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+	{900 + TEST_DEBOUNCE_TICKS, '+', KEYPAD_RELEASE, KEYPAD_NO_KEY},
+};
+
+/* Three keys held: the third one is a plain press, and nothing repeats */
+static const TEST_ActionType g_threeKeysActions[] =
+{
+	{0, 7, TRUE}, {100, 8, TRUE}, {200, 9, TRUE}, {900, 7, FALSE}, {900, 8, FALSE}, {900, 9, FALSE},
+};
+static const TEST_ExpectType g_threeKeysEvents[] =
+{
+	{TEST_DEBOUNCE_TICKS, 7, KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{100 + TEST_DEBOUNCE_TICKS, 8, KEYPAD_CHORD, 7},
+	{200 + TEST_DEBOUNCE_TICKS, 9, KEYPAD_PRESS, KEYPAD_NO_KEY},
+	{900 + TEST_DEBOUNCE_TICKS, 7, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+	{900 + TEST_DEBOUNCE_TICKS, 8, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+	{900 + TEST_DEBOUNCE_TICKS, 9, KEYPAD_RELEASE, KEYPAD_NO_KEY},
+};
+
+/* Scenarios run after the check of the 16 keys */
+static const TEST_ScenarioType g_scenarios[] =
+{
+	{"bounce shorter than the debounce", g_bounceActions, sizeof(g_bounceActions) / sizeof(g_bounceActions[0]),
+			NULL_PTR, 0, 100, TRUE},
+	{"press and release with bounce", g_chatterActions, sizeof(g_chatterActions) / sizeof(g_chatterActions[0]),
+			g_chatterEvents, sizeof(g_chatterEvents) / sizeof(g_chatterEvents[0]), 300, TRUE},
+	{"keys typed ahead of a full FIFO", g_typeAheadActions, sizeof(g_typeAheadActions) / sizeof(g_typeAheadActions[0]),
+			g_typeAheadEvents, sizeof(g_typeAheadEvents) / sizeof(g_typeAheadEvents[0]), 650, FALSE},
+	{"key held: repeat and long press", g_holdActions, sizeof(g_holdActions) / sizeof(g_holdActions[0]),
+			g_holdEvents, sizeof(g_holdEvents) / sizeof(g_holdEvents[0]), 1350, TRUE},
+	{"chord of two keys", g_chordActions, sizeof(g_chordActions) / sizeof(g_chordActions[0]),
+			g_chordEvents, sizeof(g_chordEvents) / sizeof(g_chordEvents[0]), 1000, TRUE},
+	{"three keys held", g_threeKeysActions, sizeof(g_threeKeysActions) / sizeof(g_threeKeysActions[0]),
+			g_threeKeysEvents, sizeof(g_threeKeysEvents) / sizeof(g_threeKeysEvents[0]), 1000, TRUE},
+};
+
+/* Names of the kinds of the events */
+static const char * const g_kinds[] = {"press", "release", "long press", "repeat", "chord"};
+
+/* Number of failed checks */
+static uint32 g_failures = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Report a failed check */
+static void TEST_fail(const char * message, uint8 row, uint8 column)
+{
+	printf("FAIL key at row %u column %u: %s\n", row, column, message);
+	g_failures++;
+}
+
+/* Run the system tick until the FIFO has an event, return the ticks run or TEST_MAX_TICKS */
+static uint32 TEST_waitEvent(KEYPAD_EventType * event_ptr)
+{
+	uint32 ticks;
+
+	for (ticks = 1; ticks < TEST_MAX_TICKS; ticks++)
+	{
+		TIMER1_MODEL_run(TEST_TICK_TIME);
+		(void)SOFT_TIMER_runDeferred();
+		if (KEYPAD_getEvent(event_ptr))
+		{
+			return ticks;
+		}
+	}
+	return TEST_MAX_TICKS;
+}
+
+/* Check that the next event is the given one */
+static uint32 TEST_expect(uint8 row, uint8 column, uint8 kind)
+{
+	KEYPAD_EventType event;
+	uint32 ticks = TEST_waitEvent(&event);
+
+	if (ticks == TEST_MAX_TICKS)
+	{
+		TEST_fail("no event", row, column);
+	}
+	else if ((event.kind != kind) || (event.key != g_labels[row][column]) || (event.chord != KEYPAD_NO_KEY))
+	{
+		printf("  event kind %u key %u chord %u, expected kind %u key %u\n",
+				event.kind, event.key, event.chord, kind, g_labels[row][column]);
+		TEST_fail("wrong event", row, column);
+	}
+	return ticks;
+}
+
+/* Press and release one key and check its two events */
+static void TEST_key(uint8 row, uint8 column)
+{
+	KEYPAD_EventType event;
+	uint32 pressTicks, releaseTicks;
+
+	KEYPAD_MODEL_setKey(row, column, TRUE);
+	pressTicks = TEST_expect(row, column, KEYPAD_PRESS);
+	KEYPAD_MODEL_setKey(row, column, FALSE);
+	releaseTicks = TEST_expect(row, column, KEYPAD_RELEASE);
+
+	printf("row %u column %u: key %3u, press after %2lu ticks, release after %2lu ticks\n", row, column,
+			g_labels[row][column], (unsigned long)pressTicks, (unsigned long)releaseTicks);
+	if ((pressTicks > TEST_DEBOUNCE_TICKS + KEYPAD_NUM_ROWS) || (releaseTicks > TEST_DEBOUNCE_TICKS + KEYPAD_NUM_ROWS))
+	{
+		TEST_fail("debounce longer than its full scans", row, column);
+	}
+
+	/* Nothing after the release */
+	if (TEST_waitEvent(&event) != TEST_MAX_TICKS)
+	{
+		TEST_fail("extra event", row, column);
+	}
+}
+
+/* Hold or release the key with the given label */
+static void TEST_setKey(uint8 key, boolean held)
+{
+	uint8 row, column;
+
+	for (row = 0; row < KEYPAD_NUM_ROWS; row++)
+	{
+		for (column = 0; column < KEYPAD_NUM_COLS; column++)
+		{
+			if (g_labels[row][column] == key)
+			{
+				KEYPAD_MODEL_setKey(row, column, held);
+			}
+		}
+	}
+}
+
+/* Run one scenario and compare the events taken with the expected ones */
+static void TEST_scenario(const TEST_ScenarioType * scenario_ptr)
+{
+	KEYPAD_EventType events[TEST_MAX_EVENTS];
+	uint16 times[TEST_MAX_EVENTS];
+	const TEST_ExpectType * expect_ptr;
+	uint32 start = TIMER1_getTimestamp();
+	uint8 count = 0, action = 0, i;
+	uint16 time, window;
+	boolean match;
+
+	for (time = 0; time < scenario_ptr->length; time++)
+	{
+		while ((action < scenario_ptr->actions_num) && (scenario_ptr->actions[action].time == time))
+		{
+			TEST_setKey(scenario_ptr->actions[action].key, scenario_ptr->actions[action].held);
+			action++;
+		}
+		TIMER1_MODEL_run(TEST_TICK_TIME);
+		(void)SOFT_TIMER_runDeferred();
+		while ((scenario_ptr->read || (time == (scenario_ptr->length - 1))) &&
+				(count < TEST_MAX_EVENTS) && KEYPAD_getEvent(&events[count]))
+		{
+			/* Milliseconds from the start, the timestamps count micro seconds */
+			times[count] = (uint16)((events[count].time - start) / 1000UL);
+			count++;
+		}
+	}
+
+	printf("%s:\n", scenario_ptr->name);
+	for (i = 0; i < count; i++)
+	{
+		printf("  %5u ms  %-10s key %3u chord %3u\n", times[i], g_kinds[events[i].kind], events[i].key, events[i].chord);
+	}
+
+	for (i = 0; (i < count) || (i < scenario_ptr->events_num); i++)
+	{
+		if (i >= count)
+		{
+			printf("FAIL %s: event %u missing\n", scenario_ptr->name, i);
+			g_failures++;
+			continue;
+		}
+		if (i >= scenario_ptr->events_num)
+		{
+			printf("FAIL %s: event %u not expected\n", scenario_ptr->name, i);
+			g_failures++;
+			continue;
+		}
+
+		/*
+		 * The expected time is the latest, the scan may end the debounce up to one full scan before.
+		 * The hold time counts from the end of the full scan of the press, one full scan more.
+		 */
+		expect_ptr = &scenario_ptr->events[i];
+		window = ((expect_ptr->kind == KEYPAD_REPEAT) || (expect_ptr->kind == KEYPAD_LONG_PRESS)) ?
+				(2 * TEST_SCAN_TICKS) : TEST_SCAN_TICKS;
+		match = (events[i].key == expect_ptr->key) && (events[i].kind == expect_ptr->kind) &&
+				(events[i].chord == expect_ptr->chord) &&
+				(times[i] <= expect_ptr->time) && ((times[i] + window) >= expect_ptr->time);
+		if (!match)
+		{
+			printf("FAIL %s: event %u, expected at %u ms %s key %u chord %u\n", scenario_ptr->name, i,
+					expect_ptr->time, g_kinds[expect_ptr->kind], expect_ptr->key, expect_ptr->chord);
+			g_failures++;
+		}
+	}
+}
+
+/* Count the row steps of two idle seconds, then press and release a key */
+static void TEST_idle(void)
+{
+	KEYPAD_EventType event;
+	uint32 steps[2];
+	uint32 start, ticks;
+	uint8 second;
+
+	for (second = 0; second < 2; second++)
+	{
+		start = KEYPAD_MODEL_getRowSteps();
+		for (ticks = 0; ticks < TEST_IDLE_TICKS; ticks++)
+		{
+			TIMER1_MODEL_run(TEST_TICK_TIME);
+			(void)SOFT_TIMER_runDeferred();
+		}
+		steps[second] = KEYPAD_MODEL_getRowSteps() - start;
+		printf("idle second %u: %lu ticks, %lu row steps of the scan\n", second + 1, (unsigned long)TEST_IDLE_TICKS,
+				(unsigned long)steps[second]);
+	}
+	if (KEYPAD_getEvent(&event))
+	{
+		TEST_fail("event while idle", 0, 0);
+	}
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+	/* The scan stops after its idle scans in the first second and does not run in the second one */
+	if ((steps[0] > ((KEYPAD_IDLE_SCANS + 1) * KEYPAD_NUM_ROWS)) || (steps[1] != 0))
+	{
+		TEST_fail("scan not stopped when idle", 0, 0);
+	}
+#else
+	if ((steps[0] != TEST_IDLE_TICKS) || (steps[1] != TEST_IDLE_TICKS))
+	{
+		TEST_fail("scan not running every tick", 0, 0);
+	}
+#endif
+
+	/* A key pressed now is seen, through INT2 if the scan is stopped */
+	TEST_key(1, 1);
+}
+
+int main(void)
+{
+	uint8 row, column, i;
+
+	printf("KEYPAD_DEBOUNCE_SCANS %d, %d rows scanned every %d ms\n", KEYPAD_DEBOUNCE_SCANS,
+			KEYPAD_NUM_ROWS, KEYPAD_SCAN_PERIOD);
+
+	/* Same order as Init_Function of the HMI */
+	KEYPAD_MODEL_init();
+	TIMER1_init();
+	SOFT_TIMER_init();
+	KEYPAD_init();
+	sei();
+
+	for (row = 0; row < KEYPAD_NUM_ROWS; row++)
+	{
+		for (column = 0; column < KEYPAD_NUM_COLS; column++)
+		{
+			TEST_key(row, column);
+		}
+	}
+
+	for (i = 0; i < TEST_SCENARIOS_NUM; i++)
+	{
+		TEST_scenario(&g_scenarios[i]);
+	}
+
+	TEST_idle();
+
+	printf("%s\n", (g_failures == 0) ? "PASS" : "FAIL");
+	return (g_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+/*
+ * lcd_bench.c
+ *	Description: Replays the screens of the HMI on the LCD model and reports the LCD traffic
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The bench draws the screens of a session (passwords created, door opened, wrong password)
+ * with the calls the HMI makes, and reports for each screen the bytes latched by the LCD model
+ * (characters and commands), the clear commands, the time the LCD spends executing them and the
+ * instructions sent while it was busy. It also reports the time the caller waits in the delays
+ * of the driver, the time the main loop is held.
+ *
+ * It builds against two drivers, to compare them:
+ *  - the HMI lcd.c, with its shadow framebuffer and the changed cells drained by a deferred
+ *    timer. The bench flushes each screen and runs the tick and SOFT_TIMER_runDeferred until the
+ *    drain stops.
+ *  - lcd_unbuffered/lcd.c, the driver before the shadow framebuffer, which sends each call to the
+ *    LCD at once.
+ *
+ * Build (from Host_Tools/src), buffered driver:
+ *   gcc -std=gnu99 -Wall -DF_CPU=8000000UL -I../include -I. -I../../HMI_ECU/src \
+ *       -o lcd_bench lcd_bench.c lcd_model.c io_model.c timer1_model.c host_clock.c \
+ *       ../../HMI_ECU/src/lcd.c ../../HMI_ECU/src/soft_timer.c
+ * Unbuffered driver (it calls itoa of avr-libc, which lcd_bench.c defines):
+ *   gcc -std=gnu99 -Wall -Wno-implicit-function-declaration -DF_CPU=8000000UL -I../include -I. -Ilcd_unbuffered -I../../HMI_ECU/src \
+ *       -o lcd_bench_unbuffered lcd_bench.c lcd_model.c io_model.c host_clock.c \
+ *       lcd_unbuffered/lcd.c ../../HMI_ECU/src/gpio.c
+ *
+ * Usage:
+ *   ./lcd_bench
+ *   ./lcd_bench_unbuffered
+ */
+
+#include "lcd_model.h"
+#include "host_clock.h"
+#include "lcd.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <avr/interrupt.h>
+
+/* Only the buffered driver has a queue */
+#ifdef LCD_COMMAND_QUEUE_SIZE
+#include "timer1_model.h"
+#include "timer1.h"
+#include "soft_timer.h"
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Digits of a password */
+#define BENCH_PASSWORD_DIGITS   5
+
+/* One system tick in nanoseconds */
+#define BENCH_TICK_TIME         1000000ULL
+
+/* Longest time a screen may take to reach the LCD, in system ticks */
+#define BENCH_MAX_TICKS         200
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Totals of the session */
+static uint32 g_bytes = 0;
+static uint32 g_clears = 0;
+static uint32 g_overruns = 0;
+static uint64 g_lcdTime = 0;
+static uint64 g_heldTime = 0;
+
+/* Virtual time when the drawing of the screen started */
+static uint64 g_screenStart;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+#ifndef LCD_COMMAND_QUEUE_SIZE
+/* avr-libc function used by the unbuffered driver and missing from the C library of Linux */
+char * itoa(int value, char * string, int radix)
+{
+	sprintf(string, "%d", value);
+	return string;
+}
+#endif
+
+/* Start the drawing of a screen */
+static void BENCH_begin(void)
+{
+	LCD_MODEL_resetStats();
+	g_screenStart = HOST_CLOCK_getTime();
+}
+
+/* Send the screen to the LCD and report its traffic */
+static void BENCH_end(const char * name)
+{
+	LCD_MODEL_StatsType stats;
+	uint64 held;
+	uint32 bytes;
+
+#ifdef LCD_COMMAND_QUEUE_SIZE
+	uint32 ticks = 0;
+
+	(void)LCD_flush();
+	held = HOST_CLOCK_getTime() - g_screenStart;
+
+	/* The drain stops one period after the last operation, its wait is over */
+	do
+	{
+		TIMER1_MODEL_run(BENCH_TICK_TIME);
+		(void)SOFT_TIMER_runDeferred();
+		ticks++;
+	} while (!LCD_isIdle() && (ticks < BENCH_MAX_TICKS));
+	TIMER1_MODEL_run(BENCH_TICK_TIME);
+	(void)SOFT_TIMER_runDeferred();
+#else
+	held = HOST_CLOCK_getTime() - g_screenStart;
+#endif
+
+	LCD_MODEL_getStats(&stats);
+	bytes = stats.characters + stats.commands;
+	printf("%-9s %5lu %6lu %8lu %8lu %8lu\n", name, (unsigned long)bytes, (unsigned long)stats.clears,
+			(unsigned long)(stats.busy_time / 1000), (unsigned long)stats.overruns, (unsigned long)(held / 1000));
+
+	g_bytes += bytes;
+	g_clears += stats.clears;
+	g_overruns += stats.overruns;
+	g_lcdTime += stats.busy_time;
+	g_heldTime += held;
+}
+
+static void BENCH_menu(void)
+{
+	BENCH_begin();
+	LCD_clearScreen();
+	LCD_displayString("+ : Open Door");
+	LCD_displaySringRowColumn("- : Change Pass", 1, 0);
+	BENCH_end("menu");
+}
+
+static void BENCH_enterPassword(void)
+{
+	BENCH_begin();
+	LCD_clearScreen();
+	LCD_displayString("plz enter pass:");
+	LCD_moveCursor(1, 5);
+	BENCH_end("prompt");
+}
+
+static void BENCH_reenterPassword(void)
+{
+	BENCH_begin();
+	LCD_clearScreen();
+	LCD_displayString("plz re-enter the");
+	LCD_displaySringRowColumn("same pass:", 1, 0);
+	BENCH_end("prompt2");
+}
+
+static void BENCH_digits(void)
+{
+	uint8 digit;
+
+	for (digit = 0; digit < BENCH_PASSWORD_DIGITS; digit++)
+	{
+		BENCH_begin();
+		LCD_displayCharacter('*');
+		BENCH_end("digit");
+	}
+}
+
+static void BENCH_saved(void)
+{
+	BENCH_begin();
+	LCD_clearScreen();
+	LCD_displaySringRowColumn("PASSWORD SAVED", 0, 1);
+	LCD_displaySringRowColumn("SUCCESSFULLY", 1, 2);
+	BENCH_end("saved");
+}
+
+static void BENCH_door(const char * text)
+{
+	BENCH_begin();
+	LCD_clearScreen();
+	LCD_displayString(text);
+	BENCH_end("door");
+}
+
+static void BENCH_wrong(void)
+{
+	BENCH_begin();
+	LCD_clearScreen();
+	LCD_displaySringRowColumn("PASSWORD ISN'T", 0, 1);
+	LCD_displaySringRowColumn("CORRECT TRY AGAIN", 1, 0);
+	BENCH_end("wrong");
+}
+
+int main(void)
+{
+	LCD_MODEL_init();
+	LCD_init();
+#ifdef LCD_COMMAND_QUEUE_SIZE
+	printf("Buffered driver (shadow framebuffer and drain)\n");
+	TIMER1_init();
+	SOFT_TIMER_init();
+	sei();
+#else
+	printf("Unbuffered driver\n");
+#endif
+
+	printf("screen    bytes clears  LCD(us) overruns held(us)\n");
+
+	/* Passwords created */
+	BENCH_enterPassword();
+	BENCH_digits();
+	BENCH_reenterPassword();
+	BENCH_digits();
+	BENCH_saved();
+
+	/* Door opened */
+	BENCH_menu();
+	BENCH_enterPassword();
+	BENCH_digits();
+	BENCH_door("OPNING THE DOOR");
+	BENCH_door("HOLDING THE DOOR");
+	BENCH_door("CLOSING THE DOOR");
+
+	/* Wrong password */
+	BENCH_menu();
+	BENCH_enterPassword();
+	BENCH_digits();
+	BENCH_wrong();
+	BENCH_enterPassword();
+	BENCH_digits();
+	BENCH_menu();
+
+	printf("TOTAL     %5lu %6lu %8lu %8lu %8lu\n", (unsigned long)g_bytes, (unsigned long)g_clears,
+			(unsigned long)(g_lcdTime / 1000), (unsigned long)g_overruns, (unsigned long)(g_heldTime / 1000));
+	return 0;
+}
@@ -0,0 +1,337 @@
+/*
+ * lcd_model.c
+ *	Description: Host (Linux) model of the HD44780 LCD controller on the port registers
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * Only the instructions used by lcd.c are executed: clear, return home, function set (interface
+ * width) and set DDRAM address, the others only take their execution time. The address counter
+ * increments after each character, from the end of the first line to the second one, as with
+ * the entry mode of the power-on reset. The lines are 2 x 40 cells, the first LCD_NUM_COLS of
+ * each line are shown.
+ */
+
+#include "lcd_model.h"
+#include "host_clock.h"
+#include "lcd.h"
+#include "gpio.h"
+#include <avr/io.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Drivers whose lcd.h has no RW pin or no display size: RW tied to ground, 16 x 2 display */
+#ifndef LCD_RW_ENABLE
+#define LCD_RW_ENABLE               0
+#endif
+#ifndef LCD_NUM_COLS
+#define LCD_NUM_COLS                16
+#endif
+
+/* Registers of the pins of the LCD */
+#define LCD_MODEL_CONTROL           GPIO_PORT_REGISTER(LCD_ENABLE_PORT_ID)
+#define LCD_MODEL_RW                GPIO_PORT_REGISTER(LCD_RW_PORT_ID)
+#define LCD_MODEL_DATA_PORT         GPIO_PORT_REGISTER(LCD_DATA_PORT_ID)
+#define LCD_MODEL_DATA_DDR          GPIO_DDR_REGISTER(LCD_DATA_PORT_ID)
+#define LCD_MODEL_DATA_PIN          GPIO_PIN_REGISTER(LCD_DATA_PORT_ID)
+
+/* Pins of the data bus in the data port, D0 to D7 or D4 to D7 */
+#if (LCD_BIT_MODE == 8)
+#define LCD_MODEL_DATA_MASK         0xFF
+#else
+#define LCD_MODEL_DATA_MASK         (0x0F << LCD_DATA_FIRST_PIN_ID)
+#endif
+
+/* Cells of one line of the display RAM, and address of the second line */
+#define LCD_MODEL_LINE_SIZE         40
+#define LCD_MODEL_SECOND_LINE       0x40
+
+/* Instructions, from their highest bit set */
+#define LCD_MODEL_CLEAR             0x01
+#define LCD_MODEL_HOME              0x02
+#define LCD_MODEL_FUNCTION_SET      0x20
+#define LCD_MODEL_SET_DDRAM         0x80
+
+/* Interface width bit of the function set */
+#define LCD_MODEL_DL                0x10
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Display RAM of the two lines and the address counter */
+static uint8 g_ddram[2][LCD_MODEL_LINE_SIZE];
+static uint8 g_address;
+
+/* TRUE for the 8-bit interface, FALSE for 4-bit */
+static boolean g_eightBits;
+
+/* TRUE when the next nibble of the 4-bit interface is the high one, and the high nibble kept */
+static boolean g_highNibble;
+static uint8 g_nibble;
+
+/* Level of E and RW at the last sample */
+static boolean g_enable;
+static boolean g_read;
+
+/* Virtual time when the current instruction ends */
+static uint64 g_busyUntil;
+
+/* TRUE while a sample runs, the clock it reads samples again */
+static boolean g_sampling;
+
+static LCD_MODEL_StatsType g_stats;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Follow the pins of the LCD, called on each access of the virtual clock */
+static void LCD_MODEL_sample(void);
+
+/* Take the level of the data pins on a falling edge of E */
+static void LCD_MODEL_latch(uint8 rs, uint8 bus);
+
+/* Drive the busy flag and the address counter on the data pins on a rising edge of E */
+static void LCD_MODEL_drive(void);
+
+/* Execute one instruction or character write */
+static void LCD_MODEL_execute(uint8 rs, uint8 value);
+
+/* Fill the display RAM with spaces and move the address counter to the first cell */
+static void LCD_MODEL_clear(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Reset the controller to its power-on state and start watching the pins.
+ */
+void LCD_MODEL_init(void)
+{
+	LCD_MODEL_clear();
+	g_eightBits = TRUE;
+	g_highNibble = TRUE;
+	g_enable = FALSE;
+	g_read = FALSE;
+	g_busyUntil = 0;
+	g_sampling = FALSE;
+	LCD_MODEL_resetStats();
+
+	HOST_CLOCK_setSyncHook(LCD_MODEL_sample);
+}
+
+/*
+ * Description :
+ * Copy the characters shown on a row, followed by a null.
+ */
+void LCD_MODEL_getRow(uint8 row, char * text_ptr)
+{
+	uint8 col;
+
+	for (col = 0; col < LCD_NUM_COLS; col++)
+	{
+		text_ptr[col] = (char)g_ddram[row & 0x01][col];
+	}
+	text_ptr[LCD_NUM_COLS] = '\0';
+}
+
+/*
+ * Description :
+ * Copy the counters of the model.
+ */
+void LCD_MODEL_getStats(LCD_MODEL_StatsType * stats_ptr)
+{
+	*stats_ptr = g_stats;
+}
+
+/*
+ * Description :
+ * Clear the counters of the model.
+ */
+void LCD_MODEL_resetStats(void)
+{
+	g_stats.characters = 0;
+	g_stats.commands = 0;
+	g_stats.clears = 0;
+	g_stats.reads = 0;
+	g_stats.overruns = 0;
+	g_stats.busy_time = 0;
+}
+
+/*
+ * Description :
+ * Return TRUE while the controller executes an instruction.
+ */
+boolean LCD_MODEL_isBusy(void)
+{
+	return (HOST_CLOCK_getTime() < g_busyUntil);
+}
+
+/* Follow the pins of the LCD, called on each access of the virtual clock */
+static void LCD_MODEL_sample(void)
+{
+	boolean enable, read;
+	uint8 rs, bus;
+
+	if (g_sampling)
+	{
+		return;
+	}
+	g_sampling = TRUE;
+
+	enable = (LCD_MODEL_CONTROL & (1 << LCD_ENABLE_PIN_ID)) != 0;
+#if (LCD_RW_ENABLE == 1)
+	read = (LCD_MODEL_RW & (1 << LCD_RW_PIN_ID)) != 0;
+#else
+	read = FALSE;
+#endif
+	rs = (LCD_MODEL_CONTROL & (1 << LCD_RS_PIN_ID)) ? LOGIC_HIGH : LOGIC_LOW;
+
+	if (enable && !g_enable)
+	{
+		/* RW is taken on the rising edge, the controller drives the bus until the falling edge */
+		g_read = read;
+		if (g_read)
+		{
+			LCD_MODEL_drive();
+		}
+	}
+	else if (!enable && g_enable && !g_read)
+	{
+		/* Only the pins driven by the MCU carry data, the others read as zero */
+		bus = LCD_MODEL_DATA_PORT & LCD_MODEL_DATA_DDR & LCD_MODEL_DATA_MASK;
+#if (LCD_BIT_MODE == 8)
+		LCD_MODEL_latch(rs, bus);
+#else
+		LCD_MODEL_latch(rs, (uint8)((bus >> LCD_DATA_FIRST_PIN_ID) << 4));
+#endif
+	}
+	else if (!enable && g_enable && g_read && !g_eightBits)
+	{
+		/* The two reads of the 4-bit interface give the high nibble first */
+		g_highNibble = !g_highNibble;
+	}
+	g_enable = enable;
+
+	g_sampling = FALSE;
+}
+
+/* Take the level of the data pins (D7 to D0, D3 to D0 zero for a nibble) on a falling edge of E */
+static void LCD_MODEL_latch(uint8 rs, uint8 bus)
+{
+	if (g_eightBits)
+	{
+		LCD_MODEL_execute(rs, bus);
+	}
+	else if (g_highNibble)
+	{
+		g_nibble = bus & 0xF0;
+		g_highNibble = FALSE;
+	}
+	else
+	{
+		g_highNibble = TRUE;
+		LCD_MODEL_execute(rs, g_nibble | (bus >> 4));
+	}
+}
+
+/* Drive the busy flag and the address counter on the data pins on a rising edge of E */
+static void LCD_MODEL_drive(void)
+{
+	uint8 status = g_address & 0x7F;
+	uint8 pins;
+
+	if (HOST_CLOCK_getTime() < g_busyUntil)
+	{
+		status |= 0x80;
+	}
+	if (g_highNibble)
+	{
+		g_stats.reads++;
+	}
+
+#if (LCD_BIT_MODE == 8)
+	pins = status;
+#else
+	if (!g_eightBits && !g_highNibble)
+	{
+		status = (uint8)(status << 4);
+	}
+	pins = (uint8)((status >> 4) << LCD_DATA_FIRST_PIN_ID);
+#endif
+
+	/* The data pins set as outputs by the MCU fight the controller, they keep the MCU level */
+	LCD_MODEL_DATA_PIN = (LCD_MODEL_DATA_PIN & (uint8)~LCD_MODEL_DATA_MASK) |
+			(pins & LCD_MODEL_DATA_MASK & (uint8)~LCD_MODEL_DATA_DDR) |
+			(LCD_MODEL_DATA_PORT & LCD_MODEL_DATA_MASK & LCD_MODEL_DATA_DDR);
+}
+
+/* Execute one instruction (rs LOW) or character write (rs HIGH) */
+static void LCD_MODEL_execute(uint8 rs, uint8 value)
+{
+	uint64 now = HOST_CLOCK_getTime();
+	uint64 time = LCD_MODEL_EXECUTION_TIME;
+
+	if (now < g_busyUntil)
+	{
+		g_stats.overruns++;
+	}
+
+	if (rs == LOGIC_HIGH)
+	{
+		g_ddram[(g_address & LCD_MODEL_SECOND_LINE) ? 1 : 0][g_address & 0x3F] = value;
+		g_address++;
+		if ((g_address & 0x3F) == LCD_MODEL_LINE_SIZE)
+		{
+			g_address = (g_address & LCD_MODEL_SECOND_LINE) ? 0 : LCD_MODEL_SECOND_LINE;
+		}
+		g_stats.characters++;
+	}
+	else
+	{
+		g_stats.commands++;
+		if (value & LCD_MODEL_SET_DDRAM)
+		{
+			g_address = value & 0x7F;
+		}
+		else if (value & LCD_MODEL_FUNCTION_SET)
+		{
+			g_eightBits = (value & LCD_MODEL_DL) ? TRUE : FALSE;
+			g_highNibble = TRUE;
+		}
+		else if (value & LCD_MODEL_HOME)
+		{
+			g_address = 0;
+			time = LCD_MODEL_CLEAR_TIME;
+			g_stats.clears++;
+		}
+		else if (value & LCD_MODEL_CLEAR)
+		{
+			LCD_MODEL_clear();
+			time = LCD_MODEL_CLEAR_TIME;
+			g_stats.clears++;
+		}
+	}
+
+	g_busyUntil = now + time;
+	g_stats.busy_time += time;
+}
+
+/* Fill the display RAM with spaces and move the address counter to the first cell */
+static void LCD_MODEL_clear(void)
+{
+	uint8 line, cell;
+
+	for (line = 0; line < 2; line++)
+	{
+		for (cell = 0; cell < LCD_MODEL_LINE_SIZE; cell++)
+		{
+			g_ddram[line][cell] = ' ';
+		}
+	}
+	g_address = 0;
+}
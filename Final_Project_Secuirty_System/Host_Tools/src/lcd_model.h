@@ -0,0 +1,80 @@
+/*
+ * lcd_model.h
+ *	Description: Header file for the host (Linux) model of the HD44780 LCD controller
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The model watches the pins of the LCD in the port registers of io_model.c, wired as lcd.h
+ * configures them. The drivers give every edge of E a delay, and every delay reads the virtual
+ * clock, so the model samples the pins on each clock access: it latches the bus on the falling
+ * edge of E, in 8-bit mode or in two nibbles once a function set chose 4-bit mode, and drives the
+ * busy flag and the address counter on the data pins while E is high with RW high.
+ * Each instruction keeps the controller busy for its execution time at the typical 270 kHz
+ * oscillator: LCD_MODEL_EXECUTION_TIME, LCD_MODEL_CLEAR_TIME for clear and return home. An
+ * instruction latched while the controller is busy is executed but counted as an overrun.
+ */
+
+#ifndef LCD_MODEL_H_
+#define LCD_MODEL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Execution times of the datasheet in nanoseconds, at the typical oscillator (270 kHz) */
+#define LCD_MODEL_EXECUTION_TIME    37000ULL
+#define LCD_MODEL_CLEAR_TIME        1520000ULL
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Counters of the model since LCD_MODEL_init or the last LCD_MODEL_resetStats */
+typedef struct
+{
+	uint32 characters;      /* Characters written to the display RAM */
+	uint32 commands;        /* Instructions other than a character write */
+	uint32 clears;          /* Clear and return home instructions, the long ones */
+	uint32 reads;           /* Reads of the busy flag */
+	uint32 overruns;        /* Instructions latched while the controller was busy */
+	uint64 busy_time;       /* Sum of the execution times of the instructions in nanoseconds */
+} LCD_MODEL_StatsType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Reset the controller to its power-on state (8-bit interface, blank display) and start watching
+ * the pins on the virtual clock.
+ */
+void LCD_MODEL_init(void);
+
+/*
+ * Description :
+ * Copy the LCD_NUM_COLS characters shown on a row, followed by a null.
+ */
+void LCD_MODEL_getRow(uint8 row, char * text_ptr);
+
+/*
+ * Description :
+ * Copy the counters of the model.
+ */
+void LCD_MODEL_getStats(LCD_MODEL_StatsType * stats_ptr);
+
+/*
+ * Description :
+ * Clear the counters of the model.
+ */
+void LCD_MODEL_resetStats(void);
+
+/*
+ * Description :
+ * Return TRUE while the controller executes an instruction.
+ */
+boolean LCD_MODEL_isBusy(void);
+
+#endif /* LCD_MODEL_H_ */
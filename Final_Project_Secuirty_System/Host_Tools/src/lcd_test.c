@@ -0,0 +1,348 @@
+/*
+ * lcd_test.c
+ *	Description: Runs the HMI LCD driver on Linux against the HD44780 model and checks the screen
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * lcd.c and soft_timer.c are built unchanged from HMI_ECU/src, on the port registers of
+ * io_model.c and the system tick of timer1_model.c. The test draws screens through the shadow
+ * framebuffer, lets the deferred drain send the changed cells after each tick, as the main loop
+ * does with SOFT_TIMER_runDeferred, and compares the text shown by the model
+ * with the text drawn. It also checks that no instruction reaches the controller while it is busy,
+ * that the pins of the LCD ports not used by the LCD keep their levels and directions, that a
+ * return home queued by LCD_SendCommand skips the next drains and makes the next cell move the
+ * cursor, that a blank screen after a full one costs one clear command instead of a space per
+ * cell, and that the drain timer stops once nothing is waiting. Then it fills the driver: full
+ * screens flushed back to back without any tick must all return, the LCD then shows the last one
+ * only, and a command beyond LCD_COMMAND_QUEUE_SIZE must be refused. It reports the longest time
+ * a drain spends in the delays of the bus cycle, and checks that the tick ISR spends none.
+ * The wiring tested is the one of lcd.h: change LCD_BIT_MODE, LCD_RW_ENABLE and the pins there to
+ * test another one.
+ *
+ * Build (from Host_Tools/src):
+ *   gcc -std=gnu99 -Wall -DF_CPU=8000000UL -I../include -I. -I../../HMI_ECU/src \
+ *       -o lcd_test lcd_test.c lcd_model.c io_model.c timer1_model.c host_clock.c \
+ *       ../../HMI_ECU/src/lcd.c ../../HMI_ECU/src/soft_timer.c
+ *
+ * Usage:
+ *   ./lcd_test
+ * The exit status is not zero if a check fails.
+ */
+
+#include "lcd_model.h"
+#include "timer1_model.h"
+#include "host_clock.h"
+#include "lcd.h"
+#include "gpio.h"
+#include "timer1.h"
+#include "soft_timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Pins of the control port and of the data port used by the LCD */
+#if (LCD_RW_ENABLE == 1)
+#define TEST_CONTROL_PINS   ((1 << LCD_RS_PIN_ID) | (1 << LCD_ENABLE_PIN_ID) | (1 << LCD_RW_PIN_ID))
+#else
+#define TEST_CONTROL_PINS   ((1 << LCD_RS_PIN_ID) | (1 << LCD_ENABLE_PIN_ID))
+#endif
+#if (LCD_BIT_MODE == 8)
+#define TEST_DATA_PINS      0xFF
+#else
+#define TEST_DATA_PINS      (0x0F << LCD_DATA_FIRST_PIN_ID)
+#endif
+
+/* Levels and directions given to the other pins of the LCD ports before the test */
+#define TEST_OTHER_LEVELS   0xA5
+#define TEST_OTHER_OUTPUTS  0x3C
+
+/* Longest time a screen may take to reach the LCD, in system ticks */
+#define TEST_MAX_TICKS      200
+
+/* One system tick in nanoseconds */
+#define TEST_TICK_TIME      1000000ULL
+
+/* Drains spent by a return home, the first one sends it */
+#define TEST_HOME_DRAINS    ((LCD_CLEAR_TIME + (1000UL * LCD_DRAIN_PERIOD) - 1) / (1000UL * LCD_DRAIN_PERIOD))
+
+/* Ticks run after the drain stopped, the drain must not run in them */
+#define TEST_IDLE_TICKS     10
+
+/* Number of screens drawn */
+#define TEST_SCREENS_NUM    (sizeof(g_screens) / sizeof(g_screens[0]))
+
+/* Full screens flushed back to back without any tick, far more bytes than a screen */
+#define TEST_FILL_SCREENS   100
+
+/* First of the two full screens of g_screens flushed in turn */
+#define TEST_FILL_FIRST     5
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Screens drawn in turn, one string per row from its first column */
+static const char * const g_screens[][LCD_NUM_ROWS] =
+{
+	{"plz enter pass:",  ""},
+	{"plz enter pass:",  "     *****"},
+	{"plz enter pass:",  "     ***"},
+	{"+ : Open Door",    "- : Change Pass"},
+	{"HOLDING THE DOOR", "    3  SECONDS"},
+	{"0123456789ABCDEF", "abcdefghijklmnop"},
+	{"abcdefghijklmnop", "0123456789ABCDEF"},
+	{"",                 ""},
+};
+
+/* Pins of the control port and of the data port not used by the LCD */
+static uint8 g_controlOthers;
+static uint8 g_dataOthers;
+
+/* Screen after the return home: only the third cell changed, it follows the last one written */
+static const char * const g_beforeHome[LCD_NUM_ROWS] = {"AB", ""};
+static const char * const g_afterHome[LCD_NUM_ROWS] = {"ABC", ""};
+
+/* Longest time of the tick ISR and of a drain in the delays of the driver, in nanoseconds */
+static uint64 g_longestIsr = 0;
+static uint64 g_longestDrain = 0;
+
+/* Number of failed checks */
+static uint32 g_failures = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Report a failed check */
+static void TEST_fail(const char *message, uint32 screen)
+{
+	printf("FAIL screen %lu: %s\n", (unsigned long)screen, message);
+	g_failures++;
+}
+
+/*
+ * Run one system tick then the deferred callbacks, as the main loop does, and keep the longest
+ * time of the ISR and of the callbacks. Return TRUE if a deferred callback was called.
+ */
+static boolean TEST_tick(void)
+{
+	uint64 isrTime = TIMER1_MODEL_getIsrTime();
+	uint64 drainTime;
+	boolean called;
+
+	TIMER1_MODEL_run(TEST_TICK_TIME);
+	isrTime = TIMER1_MODEL_getIsrTime() - isrTime;
+	if (isrTime > g_longestIsr)
+	{
+		g_longestIsr = isrTime;
+	}
+
+	drainTime = HOST_CLOCK_getTime();
+	called = SOFT_TIMER_runDeferred();
+	drainTime = HOST_CLOCK_getTime() - drainTime;
+	if (drainTime > g_longestDrain)
+	{
+		g_longestDrain = drainTime;
+	}
+
+	return called;
+}
+
+/* Run the system tick until nothing waits for the drain and the drain is stopped */
+static uint32 TEST_drain(void)
+{
+	uint32 ticks = 0;
+
+	/* The drain stops one period after the last operation, its wait is over */
+	do
+	{
+		TEST_tick();
+		ticks++;
+	} while (!LCD_isIdle() && (ticks < TEST_MAX_TICKS));
+	TEST_tick();
+
+	return ticks;
+}
+
+/* Draw the rows of a screen from their first column and flush them, without any tick */
+static void TEST_flush(const char * const rows[])
+{
+	uint8 row;
+
+	LCD_clearScreen();
+	for (row = 0; row < LCD_NUM_ROWS; row++)
+	{
+		LCD_displaySringRowColumn(rows[row], row, 0);
+	}
+	(void)LCD_flush();
+}
+
+/* Draw the rows of a screen from their first column and send them to the LCD */
+static uint32 TEST_draw(const char * const rows[])
+{
+	TEST_flush(rows);
+	return TEST_drain();
+}
+
+/* Compare the rows shown by the model with the rows of a screen */
+static void TEST_checkScreen(const char * const rows[], uint32 screen)
+{
+	char shown[LCD_NUM_COLS + 1];
+	char expected[LCD_NUM_COLS + 1];
+	uint8 row;
+
+	for (row = 0; row < LCD_NUM_ROWS; row++)
+	{
+		memset(expected, ' ', LCD_NUM_COLS);
+		memcpy(expected, rows[row], strlen(rows[row]));
+		expected[LCD_NUM_COLS] = '\0';
+		LCD_MODEL_getRow(row, shown);
+		if (strcmp(shown, expected) != 0)
+		{
+			printf("  row %u shows \"%s\", expected \"%s\"\n", row, shown, expected);
+			TEST_fail("wrong text", screen);
+		}
+	}
+}
+
+int main(void)
+{
+	LCD_MODEL_StatsType stats;
+	uint32 screen, ticks, i, clears;
+	boolean called;
+
+	printf("LCD_BIT_MODE %d, LCD_RW_ENABLE %d, data port %d from pin %d, control port %d\n",
+			LCD_BIT_MODE, LCD_RW_ENABLE, LCD_DATA_PORT_ID, LCD_DATA_FIRST_PIN_ID, LCD_ENABLE_PORT_ID);
+
+	/* Other pins of the LCD ports, driven by other drivers */
+	g_controlOthers = (uint8)~TEST_CONTROL_PINS;
+	g_dataOthers = (uint8)~TEST_DATA_PINS;
+	if (LCD_DATA_PORT_ID == LCD_ENABLE_PORT_ID)
+	{
+		g_controlOthers &= (uint8)~TEST_DATA_PINS;
+		g_dataOthers = g_controlOthers;
+	}
+	GPIO_PORT_REGISTER(LCD_ENABLE_PORT_ID) = TEST_OTHER_LEVELS & g_controlOthers;
+	GPIO_DDR_REGISTER(LCD_ENABLE_PORT_ID) = TEST_OTHER_OUTPUTS & g_controlOthers;
+	GPIO_PORT_REGISTER(LCD_DATA_PORT_ID) = TEST_OTHER_LEVELS & g_dataOthers;
+	GPIO_DDR_REGISTER(LCD_DATA_PORT_ID) = TEST_OTHER_OUTPUTS & g_dataOthers;
+
+	/* Same order as Init_Function of the HMI */
+	LCD_MODEL_init();
+	LCD_init();
+	TIMER1_init();
+	SOFT_TIMER_init();
+	sei();
+
+	/* The init resynchronizes the 4-bit interface with nibbles sent back to back, only the operations after it are checked */
+	LCD_MODEL_resetStats();
+	TEST_checkScreen(g_screens[TEST_SCREENS_NUM - 1], 0);
+
+	for (screen = 0; screen < TEST_SCREENS_NUM; screen++)
+	{
+		ticks = TEST_draw(g_screens[screen]);
+		printf("screen %lu: shown after %3lu ticks\n", (unsigned long)screen, (unsigned long)ticks);
+		TEST_checkScreen(g_screens[screen], screen);
+	}
+
+	/* A blank screen after a full one: the clear command is the only byte */
+	(void)TEST_draw(g_screens[TEST_FILL_FIRST]);
+	LCD_MODEL_getStats(&stats);
+	clears = stats.clears;
+	LCD_clearScreen();
+	if (LCD_flush() != 1)
+	{
+		TEST_fail("a blank screen is not sent as one clear command", screen);
+	}
+	(void)TEST_drain();
+	TEST_checkScreen(g_screens[TEST_SCREENS_NUM - 1], screen);
+	LCD_MODEL_getStats(&stats);
+	if (stats.clears != (clears + 1))
+	{
+		TEST_fail("no clear command reached the LCD", screen);
+	}
+
+	/* The return home moves the address counter of the LCD back to the first cell */
+	(void)TEST_draw(g_beforeHome);
+	if (!LCD_SendCommand(LCD_RETURN_HOME))
+	{
+		TEST_fail("return home refused by an empty queue", screen);
+	}
+	ticks = TEST_draw(g_afterHome);
+	printf("return home, cursor move and character: shown after %lu ticks\n", (unsigned long)ticks);
+	TEST_checkScreen(g_afterHome, screen);
+	if (ticks < (TEST_HOME_DRAINS + 1) * LCD_DRAIN_PERIOD)
+	{
+		TEST_fail("operations sent before the end of the return home", screen);
+	}
+
+	/* The drain timer is stopped, the drain does not run any more */
+	called = FALSE;
+	for (ticks = 0; ticks < TEST_IDLE_TICKS; ticks++)
+	{
+		called |= TEST_tick();
+	}
+	if (called)
+	{
+		TEST_fail("the drain runs with nothing waiting", screen);
+	}
+
+	/* Full screens flushed back to back: each flush returns, the LCD shows the last one only */
+	for (i = 0; i < TEST_FILL_SCREENS; i++)
+	{
+		TEST_flush(g_screens[TEST_FILL_FIRST + (i & 1)]);
+	}
+	ticks = TEST_drain();
+	printf("%u full screens flushed without a tick: the last one shown after %lu ticks\n",
+			TEST_FILL_SCREENS, (unsigned long)ticks);
+	TEST_checkScreen(g_screens[TEST_FILL_FIRST + ((TEST_FILL_SCREENS - 1) & 1)], screen);
+	if (ticks > (2 * LCD_NUM_ROWS * LCD_NUM_COLS + 1) * LCD_DRAIN_PERIOD)
+	{
+		TEST_fail("the drain sent more than one screen", screen);
+	}
+
+	/* The command queue refuses the command beyond its size */
+	for (i = 0; i < LCD_COMMAND_QUEUE_SIZE; i++)
+	{
+		if (!LCD_SendCommand(LCD_CURSOR_OFF))
+		{
+			TEST_fail("command refused by a queue not full", screen);
+		}
+	}
+	if (LCD_SendCommand(LCD_CURSOR_OFF))
+	{
+		TEST_fail("command queued beyond the size of the queue", screen);
+	}
+	(void)TEST_drain();
+	TEST_checkScreen(g_screens[TEST_FILL_FIRST + ((TEST_FILL_SCREENS - 1) & 1)], screen);
+	printf("longest drain in the bus delays: %lu ns, longest tick ISR: %lu ns\n",
+			(unsigned long)g_longestDrain, (unsigned long)g_longestIsr);
+	if (g_longestIsr != 0)
+	{
+		TEST_fail("the tick ISR drives the LCD bus", screen);
+	}
+
+	LCD_MODEL_getStats(&stats);
+	printf("%lu characters, %lu commands, %lu busy flag reads, %lu overruns\n",
+			(unsigned long)stats.characters, (unsigned long)stats.commands,
+			(unsigned long)stats.reads, (unsigned long)stats.overruns);
+	if (stats.overruns != 0)
+	{
+		TEST_fail("operations sent while the LCD was busy", screen);
+	}
+
+	/* The pins of the other drivers are untouched */
+	if (((GPIO_PORT_REGISTER(LCD_ENABLE_PORT_ID) & g_controlOthers) != (TEST_OTHER_LEVELS & g_controlOthers)) ||
+		((GPIO_PORT_REGISTER(LCD_DATA_PORT_ID) & g_dataOthers) != (TEST_OTHER_LEVELS & g_dataOthers)))
+	{
+		TEST_fail("levels of the other pins changed", screen);
+	}
+
+	printf("%s\n", (g_failures == 0) ? "PASS" : "FAIL");
+	return (g_failures == 0) ? 0 : 1;
+}
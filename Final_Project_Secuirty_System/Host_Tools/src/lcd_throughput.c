@@ -0,0 +1,108 @@
+/*
+ * lcd_throughput.c
+ *	Description: Measures the throughput of the HMI LCD driver and the time its waits take
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The driver runs on the LCD model and the system tick of timer1_model.c, wired as lcd.h
+ * configures it: build it once with LCD_RW_ENABLE 0 and once with 1 to compare the fixed waits
+ * with the busy flag. The tool reports:
+ *  - the time of LCD_init and the busy flag reads it made,
+ *  - the characters per second of full screens drained from the tick, and for each operation
+ *    the time of the drain spent in the delays of the driver and the busy flag reads. The drain
+ *    runs from SOFT_TIMER_runDeferred after each tick, as in the main loop of the HMI.
+ * Only the delays advance the virtual clock: the instructions of the driver around them are not
+ * counted, their cost depends on the optimization level and is given by the LCD_COMMAND and
+ * LCD_CHARACTER profiler regions on the target.
+ *
+ * Build (from Host_Tools/src):
+ *   gcc -std=gnu99 -Wall -DF_CPU=8000000UL -I../include -I. -I../../HMI_ECU/src \
+ *       -o lcd_throughput lcd_throughput.c lcd_model.c io_model.c timer1_model.c host_clock.c \
+ *       ../../HMI_ECU/src/lcd.c ../../HMI_ECU/src/soft_timer.c
+ *
+ * Usage:
+ *   ./lcd_throughput
+ */
+
+#include "lcd_model.h"
+#include "timer1_model.h"
+#include "host_clock.h"
+#include "lcd.h"
+#include "timer1.h"
+#include "soft_timer.h"
+#include <stdio.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Full screens drained */
+#define THROUGHPUT_SCREENS      32
+
+/* One system tick in nanoseconds */
+#define THROUGHPUT_TICK_TIME    1000000ULL
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Two screens with no common cell, every cell changes at each flush */
+static const char * const g_rows[2] =
+{
+	"0123456789ABCDEF",
+	"abcdefghijklmnop",
+};
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(void)
+{
+	LCD_MODEL_StatsType stats;
+	uint64 start, time, drainTime, drainStart;
+	uint32 screen, operations;
+
+	printf("LCD_BIT_MODE %d, LCD_RW_ENABLE %d\n", LCD_BIT_MODE, LCD_RW_ENABLE);
+
+	LCD_MODEL_init();
+	start = HOST_CLOCK_getTime();
+	LCD_init();
+	time = HOST_CLOCK_getTime() - start;
+	LCD_MODEL_getStats(&stats);
+	printf("LCD_init: %lu us, %lu busy flag reads\n", (unsigned long)(time / 1000), (unsigned long)stats.reads);
+
+	TIMER1_init();
+	SOFT_TIMER_init();
+	sei();
+
+	LCD_MODEL_resetStats();
+	start = HOST_CLOCK_getTime();
+	drainTime = 0;
+	for (screen = 0; screen < THROUGHPUT_SCREENS; screen++)
+	{
+		LCD_displaySringRowColumn(g_rows[screen & 1], 0, 0);
+		LCD_displaySringRowColumn(g_rows[(screen & 1) ^ 1], 1, 0);
+		(void)LCD_flush();
+		while (!LCD_isIdle())
+		{
+			TIMER1_MODEL_run(THROUGHPUT_TICK_TIME);
+			drainStart = HOST_CLOCK_getTime();
+			(void)SOFT_TIMER_runDeferred();
+			drainTime += HOST_CLOCK_getTime() - drainStart;
+		}
+	}
+	time = HOST_CLOCK_getTime() - start;
+	LCD_MODEL_getStats(&stats);
+	operations = stats.characters + stats.commands;
+
+	printf("drain: %lu characters and %lu commands in %lu us, %lu characters/s\n",
+			(unsigned long)stats.characters, (unsigned long)stats.commands, (unsigned long)(time / 1000),
+			(unsigned long)((stats.characters * 1000000000ULL) / time));
+	printf("per operation: %lu ns of delays in the drain, %lu.%02lu busy flag reads, %lu overruns\n",
+			(unsigned long)(drainTime / operations), (unsigned long)(stats.reads / operations),
+			(unsigned long)(((stats.reads % operations) * 100) / operations), (unsigned long)stats.overruns);
+
+	return (stats.overruns == 0) ? 0 : 1;
+}
@@ -0,0 +1,303 @@
+/*
+ * m24c16_model.c
+ *	Description: Source file for the host (Linux) model of the M24C16 External EEPROM
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ */
+
+#include "m24c16_model.h"
+#include "host_clock.h"
+#include <fcntl.h>      /* open */
+#include <string.h>     /* memset, memcpy */
+#include <sys/mman.h>   /* mmap, msync, munmap */
+#include <sys/stat.h>   /* fstat */
+#include <unistd.h>     /* ftruncate, pwrite, close */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum defining the state of the device on the bus */
+typedef enum
+{
+	M24C16_IDLE,            /* Waiting for a start condition */
+	M24C16_DEVICE_SELECT,   /* Start seen, next byte is the device address */
+	M24C16_WORD_ADDRESS,    /* Addressed for write, next byte is A7..A0 */
+	M24C16_RECEIVING,       /* Data bytes go to the page buffer */
+	M24C16_TRANSMITTING,    /* Sending data to the master */
+	M24C16_NOT_SELECTED     /* Address not acknowledged, ignore the bus until next start */
+} M24C16_State;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static M24C16_ConfigType g_config;
+static M24C16_StatsType g_stats;
+static M24C16_State g_state = M24C16_IDLE;
+
+/* Memory array mapped from the image file */
+static uint8 *g_memory = NULL_PTR;
+static int g_imageFd = -1;
+
+/* Internal address counter A10..A0 */
+static uint16 g_address = 0;
+
+/* Page buffer and the mask of the bytes written in it */
+static uint8 g_pageBuffer[M24C16_PAGE_SIZE];
+static uint16 g_pageMask = 0;
+static uint16 g_pageAddress = 0;
+
+/* Virtual time at which the current write cycle ends */
+static uint64 g_busyUntil = 0;
+
+/* State of the error injection random generator */
+static uint32 g_random = 1;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Flip the bits of a byte according to the given bit error rate */
+static uint8 M24C16_injectErrors(uint8 byte, float64 bit_error_rate);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Map the image file and reset the device state.
+ * A missing or short image file is created/extended and filled with 0xFF like a blank part.
+ * returns: TRUE if the image is mapped, FALSE otherwise.
+ */
+boolean M24C16_open(const M24C16_ConfigType * config_ptr)
+{
+	struct stat image_stat;
+	uint8 blank[M24C16_SIZE];
+
+	g_config = *config_ptr;
+	memset(&g_stats, 0, sizeof(g_stats));
+	g_state = M24C16_IDLE;
+	g_address = 0;
+	g_pageMask = 0;
+	g_busyUntil = 0;
+	g_random = (config_ptr->seed != 0) ? config_ptr->seed : 1;
+
+	g_imageFd = open(config_ptr->image_path, O_RDWR | O_CREAT, 0644);
+	if (g_imageFd < 0)
+	{
+		return FALSE;
+	}
+
+	/* Extend a new or short image with erased (0xFF) bytes */
+	if (fstat(g_imageFd, &image_stat) != 0)
+	{
+		close(g_imageFd);
+		return FALSE;
+	}
+	if (image_stat.st_size < M24C16_SIZE)
+	{
+		memset(blank, 0xFF, sizeof(blank));
+		if (pwrite(g_imageFd, blank + image_stat.st_size, M24C16_SIZE - image_stat.st_size,
+				image_stat.st_size) != M24C16_SIZE - image_stat.st_size)
+		{
+			close(g_imageFd);
+			return FALSE;
+		}
+	}
+
+	g_memory = mmap(NULL_PTR, M24C16_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, g_imageFd, 0);
+	if (g_memory == MAP_FAILED)
+	{
+		g_memory = NULL_PTR;
+		close(g_imageFd);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Flush and unmap the image file.
+ */
+void M24C16_close(void)
+{
+	if (g_memory != NULL_PTR)
+	{
+		msync(g_memory, M24C16_SIZE, MS_SYNC);
+		munmap(g_memory, M24C16_SIZE);
+		g_memory = NULL_PTR;
+	}
+	if (g_imageFd >= 0)
+	{
+		close(g_imageFd);
+		g_imageFd = -1;
+	}
+}
+
+/*
+ * Description :
+ * Start (or repeated start) condition seen on the bus.
+ */
+void M24C16_start(void)
+{
+	/* A start before the stop discards the page buffer, only a stop triggers the write cycle */
+	g_pageMask = 0;
+	g_state = M24C16_DEVICE_SELECT;
+}
+
+/*
+ * Description :
+ * Stop condition seen on the bus. Programs the page buffer if data was written.
+ */
+void M24C16_stop(void)
+{
+	uint8 i;
+
+	if ((g_state == M24C16_RECEIVING) && (g_pageMask != 0))
+	{
+		/* Program only the bytes written in the page buffer */
+		for (i = 0; i < M24C16_PAGE_SIZE; i++)
+		{
+			if (g_pageMask & (1 << i))
+			{
+				g_memory[g_pageAddress + i] = M24C16_injectErrors(g_pageBuffer[i], g_config.write_bit_error_rate);
+				g_stats.bytes_written++;
+			}
+		}
+		g_pageMask = 0;
+
+		/* The device is busy for the write cycle */
+		g_busyUntil = HOST_CLOCK_getTime() + (uint64)g_config.write_cycle_us * 1000;
+		g_stats.write_cycles++;
+	}
+
+	g_state = M24C16_IDLE;
+}
+
+/*
+ * Description :
+ * First byte after a start condition (7 bit address + R/W bit).
+ * returns: TRUE if the device acknowledges the address.
+ */
+boolean M24C16_address(uint8 address_byte)
+{
+	if ((g_state != M24C16_DEVICE_SELECT) || ((address_byte >> 4) != M24C16_DEVICE_CODE))
+	{
+		g_state = M24C16_NOT_SELECTED;
+		return FALSE;
+	}
+
+	/* No acknowledge while the internal write cycle is running */
+	if (HOST_CLOCK_getTime() < g_busyUntil)
+	{
+		g_stats.busy_nacks++;
+		g_state = M24C16_NOT_SELECTED;
+		return FALSE;
+	}
+
+	/* The block select bits are A10..A8 of the address */
+	g_address = (g_address & 0x00FF) | ((uint16)(address_byte & 0x0E) << 7);
+
+	if (address_byte & 0x01)
+	{
+		g_state = M24C16_TRANSMITTING;
+	}
+	else
+	{
+		g_state = M24C16_WORD_ADDRESS;
+	}
+	return TRUE;
+}
+
+/*
+ * Description :
+ * Byte sent by the master in a write transfer.
+ * returns: TRUE if the device acknowledges the byte.
+ */
+boolean M24C16_write(uint8 byte)
+{
+	switch (g_state)
+	{
+		case M24C16_WORD_ADDRESS:
+			g_address = (g_address & 0x0700) | byte;
+			g_pageAddress = g_address & ~(M24C16_PAGE_SIZE - 1);
+			g_state = M24C16_RECEIVING;
+			return TRUE;
+
+		case M24C16_RECEIVING:
+			/* Store in the page buffer, the address rolls over inside the page */
+			g_pageBuffer[g_address & (M24C16_PAGE_SIZE - 1)] = byte;
+			g_pageMask |= (1 << (g_address & (M24C16_PAGE_SIZE - 1)));
+			g_address = g_pageAddress | ((g_address + 1) & (M24C16_PAGE_SIZE - 1));
+			return TRUE;
+
+		default:
+			return FALSE;
+	}
+}
+
+/*
+ * Description :
+ * Byte requested by the master in a read transfer.
+ * master_ack: TRUE if the master acknowledges the byte (more bytes follow).
+ */
+uint8 M24C16_read(boolean master_ack)
+{
+	uint8 byte;
+
+	if (g_state != M24C16_TRANSMITTING)
+	{
+		/* Nobody drives the bus, the pull-ups read as ones */
+		return 0xFF;
+	}
+
+	byte = M24C16_injectErrors(g_memory[g_address], g_config.read_bit_error_rate);
+	g_stats.bytes_read++;
+
+	/* Sequential read rolls over at the end of the memory */
+	g_address = (g_address + 1) & (M24C16_SIZE - 1);
+
+	if (!master_ack)
+	{
+		g_state = M24C16_NOT_SELECTED;
+	}
+	return byte;
+}
+
+/*
+ * Description :
+ * Copy the model statistics.
+ */
+void M24C16_getStats(M24C16_StatsType * stats_ptr)
+{
+	*stats_ptr = g_stats;
+}
+
+/* Flip the bits of a byte according to the given bit error rate */
+static uint8 M24C16_injectErrors(uint8 byte, float64 bit_error_rate)
+{
+	uint8 bit;
+
+	if (bit_error_rate <= 0.0)
+	{
+		return byte;
+	}
+
+	for (bit = 0; bit < 8; bit++)
+	{
+		/* xorshift32 random generator (uint32 may be wider than 32 bits on the host) */
+		g_random ^= (g_random << 13) & 0xFFFFFFFFUL;
+		g_random ^= g_random >> 17;
+		g_random ^= (g_random << 5) & 0xFFFFFFFFUL;
+
+		if (((float64)g_random / 4294967296.0) < bit_error_rate)
+		{
+			byte ^= (1 << bit);
+			g_stats.bit_errors++;
+		}
+	}
+	return byte;
+}
@@ -0,0 +1,112 @@
+/*
+ * m24c16_model.h
+ *	Description: Header file for the host (Linux) model of the M24C16 External EEPROM
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The memory array is an image file mapped with mmap, so its content survives between runs
+ * and can be inspected with any hex viewer. The model follows the M24C16 datasheet:
+ *  - 2048 bytes organised as 128 pages of 16 bytes.
+ *  - Written bytes go to a 16 byte page buffer, the address rolls over inside the page.
+ *  - The page buffer is programmed on the Stop condition and the device then NACKs its
+ *    address until the internal write cycle (tW) is finished.
+ *  - Sequential reads roll over at the end of the memory.
+ * Optional bit errors can be injected on reads (transient) and on writes (stored in the image).
+ */
+
+#ifndef M24C16_MODEL_H_
+#define M24C16_MODEL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define M24C16_SIZE              2048   /* Size of the memory array in bytes */
+#define M24C16_PAGE_SIZE         16     /* Size of the page buffer in bytes */
+#define M24C16_DEVICE_CODE       0x0A   /* 1010 in the upper 4 bits of the 7 bit address */
+#define M24C16_WRITE_CYCLE_US    5000   /* Maximum write time tW from the datasheet */
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Structure defining the model configuration */
+typedef struct
+{
+	const char *image_path;         /* Image file backing the memory array */
+	uint32 write_cycle_us;          /* Internal write cycle time in micro seconds */
+	float64 read_bit_error_rate;    /* Probability of flipping each bit read from the array */
+	float64 write_bit_error_rate;   /* Probability of flipping each bit programmed in the array */
+	uint32 seed;                    /* Seed of the error injection random generator */
+} M24C16_ConfigType;
+
+/* Structure holding the model statistics */
+typedef struct
+{
+	uint32 bytes_read;              /* Bytes sent by the device to the master */
+	uint32 bytes_written;           /* Bytes programmed in the memory array */
+	uint32 write_cycles;            /* Internal write cycles started */
+	uint32 busy_nacks;              /* Addresses not acknowledged during a write cycle */
+	uint32 bit_errors;              /* Injected bit errors */
+} M24C16_StatsType;
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Map the image file and reset the device state.
+ * A missing or short image file is created/extended and filled with 0xFF like a blank part.
+ * returns: TRUE if the image is mapped, FALSE otherwise.
+ */
+boolean M24C16_open(const M24C16_ConfigType * config_ptr);
+
+/*
+ * Description :
+ * Flush and unmap the image file.
+ */
+void M24C16_close(void);
+
+/*
+ * Description :
+ * Start (or repeated start) condition seen on the bus.
+ */
+void M24C16_start(void);
+
+/*
+ * Description :
+ * Stop condition seen on the bus. Programs the page buffer if data was written.
+ */
+void M24C16_stop(void);
+
+/*
+ * Description :
+ * First byte after a start condition (7 bit address + R/W bit).
+ * returns: TRUE if the device acknowledges the address.
+ */
+boolean M24C16_address(uint8 address_byte);
+
+/*
+ * Description :
+ * Byte sent by the master in a write transfer.
+ * returns: TRUE if the device acknowledges the byte.
+ */
+boolean M24C16_write(uint8 byte);
+
+/*
+ * Description :
+ * Byte requested by the master in a read transfer.
+ * master_ack: TRUE if the master acknowledges the byte (more bytes follow).
+ */
+uint8 M24C16_read(boolean master_ack);
+
+/*
+ * Description :
+ * Copy the model statistics.
+ */
+void M24C16_getStats(M24C16_StatsType * stats_ptr);
+
+#endif /* M24C16_MODEL_H_ */
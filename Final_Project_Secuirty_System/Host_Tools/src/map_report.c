@@ -0,0 +1,318 @@
+/*
+ * map_report.c
+ *	Description: Reports the flash and RAM use of each module from the .map file of an ECU
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The sizes of the input sections of the linker map are added for each object file:
+ *  - text: .text and the vectors/init/fini code (flash only)
+ *  - data: .data and .rodata, stored in flash and copied to RAM at start-up
+ *  - bss:  .bss, COMMON and .noinit (RAM only)
+ * The RAM left after the static data is the room of the stack, compare it with the high-water
+ * mark measured on the target by STACK_getHighWater().
+ * Given a second (older) map file, the change of every module is printed too, so each new feature
+ * comes with its memory cost.
+ *
+ * Build (from Host_Tools/src):
+ *   gcc -std=gnu99 -Wall -I../../Control_ECU/src -o map_report map_report.c
+ *
+ * Usage:
+ *   ./map_report ../../Control_ECU/Debug/Control_ECU.map [older .map file]
+ */
+
+#include "std_types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Memories of the ATmega32 */
+#define FLASH_SIZE          32768
+#define RAM_SIZE            2048
+
+/* Largest number of modules and length of a name or a map line */
+#define MAX_MODULES         64
+#define MAX_NAME            48
+#define MAX_LINE            512
+
+/* Line of the map file after which the sections are listed */
+#define MAP_START           "Linker script and memory map"
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum defining where an output section is stored */
+typedef enum
+{
+	AREA_NONE,              /* Debug information, not on the target */
+	AREA_TEXT,
+	AREA_DATA,
+	AREA_BSS,
+	AREA_NUM
+} Area_Type;
+
+/* Structure of the sizes of one object file, or one library for the library members */
+typedef struct
+{
+	char name[MAX_NAME];
+	uint32 size[AREA_NUM];
+} Module_Type;
+
+/* Structure of all the modules of one map file */
+typedef struct
+{
+	Module_Type modules[MAX_MODULES];
+	uint8 count;
+	uint32 total[AREA_NUM];
+} Map_Type;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+static Map_Type g_new;
+static Map_Type g_old;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+static boolean MAP_read(const char *path, Map_Type *map_ptr);
+static Area_Type MAP_area(const char *section);
+static void MAP_add(Map_Type *map_ptr, const char *file, Area_Type area, uint32 size);
+static Module_Type * MAP_find(Map_Type *map_ptr, const char *name);
+static int MAP_compare(const void *a, const void *b);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	const Module_Type *module_ptr;
+	const Module_Type *old_ptr;
+	boolean diff = (argc > 2);
+	uint32 ram, flash;
+	uint8 i;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s <file.map> [older file.map]\n", argv[0]);
+		return 1;
+	}
+	if (!MAP_read(argv[1], &g_new) || (diff && !MAP_read(argv[2], &g_old)))
+	{
+		return 1;
+	}
+
+	/* Modules using the most RAM first */
+	qsort(g_new.modules, g_new.count, sizeof(Module_Type), MAP_compare);
+
+	printf("%-32s %7s %7s %7s", "module", "text", "data", "bss");
+	printf(diff ? "   %7s %7s %7s\n" : "\n", "+text", "+data", "+bss");
+	for (i = 0; i < g_new.count; i++)
+	{
+		module_ptr = &g_new.modules[i];
+		if ((module_ptr->size[AREA_TEXT] | module_ptr->size[AREA_DATA] | module_ptr->size[AREA_BSS]) == 0)
+		{
+			continue;
+		}
+
+		printf("%-32s %7lu %7lu %7lu", module_ptr->name, module_ptr->size[AREA_TEXT],
+				module_ptr->size[AREA_DATA], module_ptr->size[AREA_BSS]);
+		if (diff)
+		{
+			old_ptr = MAP_find(&g_old, module_ptr->name);
+			printf("   %+7ld %+7ld %+7ld",
+					(long)module_ptr->size[AREA_TEXT] - (old_ptr ? (long)old_ptr->size[AREA_TEXT] : 0),
+					(long)module_ptr->size[AREA_DATA] - (old_ptr ? (long)old_ptr->size[AREA_DATA] : 0),
+					(long)module_ptr->size[AREA_BSS] - (old_ptr ? (long)old_ptr->size[AREA_BSS] : 0));
+		}
+		printf("\n");
+	}
+
+	/* Modules of the older map that are gone */
+	for (i = 0; diff && (i < g_old.count); i++)
+	{
+		old_ptr = &g_old.modules[i];
+		if ((MAP_find(&g_new, old_ptr->name) == NULL_PTR) &&
+			((old_ptr->size[AREA_TEXT] | old_ptr->size[AREA_DATA] | old_ptr->size[AREA_BSS]) != 0))
+		{
+			printf("%-32s %7s %7s %7s   %+7ld %+7ld %+7ld\n", old_ptr->name, "-", "-", "-",
+					-(long)old_ptr->size[AREA_TEXT], -(long)old_ptr->size[AREA_DATA], -(long)old_ptr->size[AREA_BSS]);
+		}
+	}
+
+	printf("%-32s %7lu %7lu %7lu", "total", g_new.total[AREA_TEXT], g_new.total[AREA_DATA], g_new.total[AREA_BSS]);
+	if (diff)
+	{
+		printf("   %+7ld %+7ld %+7ld", (long)g_new.total[AREA_TEXT] - (long)g_old.total[AREA_TEXT],
+				(long)g_new.total[AREA_DATA] - (long)g_old.total[AREA_DATA],
+				(long)g_new.total[AREA_BSS] - (long)g_old.total[AREA_BSS]);
+	}
+
+	flash = g_new.total[AREA_TEXT] + g_new.total[AREA_DATA];
+	ram = g_new.total[AREA_DATA] + g_new.total[AREA_BSS];
+	printf("\n\nflash: %5lu of %u bytes (%.1f%%)\n", flash, FLASH_SIZE, 100.0 * flash / FLASH_SIZE);
+	printf("RAM:   %5lu of %u bytes (%.1f%%) static, %ld bytes left for the stack\n",
+			ram, RAM_SIZE, 100.0 * ram / RAM_SIZE, (long)RAM_SIZE - (long)ram);
+	return 0;
+}
+
+/* Add the input sections of a map file to the modules, returns FALSE if it cannot be read */
+static boolean MAP_read(const char *path, Map_Type *map_ptr)
+{
+	char line[MAX_LINE];
+	char section[MAX_LINE] = "";
+	char first[MAX_LINE], file[MAX_LINE];
+	unsigned long address, size;
+	Area_Type area = AREA_NONE;
+	boolean started = FALSE;
+	FILE *map_file = fopen(path, "r");
+
+	if (map_file == NULL)
+	{
+		perror(path);
+		return FALSE;
+	}
+
+	while (fgets(line, sizeof(line), map_file) != NULL)
+	{
+		line[strcspn(line, "\r\n")] = '\0';
+
+		/* The discarded sections and the memory configuration come before the memory map */
+		if (!started)
+		{
+			started = (strncmp(line, MAP_START, strlen(MAP_START)) == 0);
+			continue;
+		}
+
+		/* An output section starts in the first column: ".bss            0x0080017a        0xe" */
+		if (line[0] == '.')
+		{
+			sscanf(line, "%s", first);
+			area = MAP_area(first);
+			continue;
+		}
+		if (area == AREA_NONE)
+		{
+			continue;
+		}
+
+		/*
+		 * An input section is indented by one space: " .bss  0x0080017a  0x0 ./src/buzzer.o"
+		 * A long name is alone on its line and the address, size and file follow on the next line.
+		 */
+		if ((line[0] == ' ') && ((line[1] == '.') || (strncmp(&line[1], "COMMON", 6) == 0)))
+		{
+			if (sscanf(line, "%s %lx %lx %s", section, &address, &size, file) == 4)
+			{
+				MAP_add(map_ptr, file, area, size);
+				section[0] = '\0';
+			}
+			continue;
+		}
+		if ((section[0] != '\0') && (sscanf(line, "%lx %lx %s", &address, &size, file) == 3))
+		{
+			MAP_add(map_ptr, file, area, size);
+		}
+		section[0] = '\0';
+	}
+
+	fclose(map_file);
+	return TRUE;
+}
+
+/* Return where an output section is stored */
+static Area_Type MAP_area(const char *section)
+{
+	if (strcmp(section, ".text") == 0)
+	{
+		return AREA_TEXT;
+	}
+	else if (strcmp(section, ".data") == 0)
+	{
+		return AREA_DATA;
+	}
+	else if ((strcmp(section, ".bss") == 0) || (strcmp(section, ".noinit") == 0))
+	{
+		return AREA_BSS;
+	}
+	else
+	{
+		return AREA_NONE;
+	}
+}
+
+/* Add the size of an input section to the module of its file */
+static void MAP_add(Map_Type *map_ptr, const char *file, Area_Type area, uint32 size)
+{
+	char name[MAX_NAME];
+	const char *base = file;
+	const char *ptr;
+	Module_Type *module_ptr;
+
+	/* File name without the directories, the build may come from Windows or Linux */
+	for (ptr = file; *ptr != '\0'; ptr++)
+	{
+		if ((*ptr == '/') || (*ptr == '\\'))
+		{
+			base = ptr + 1;
+		}
+	}
+
+	/* Members of a library are added to the library: "libgcc.a(_clz.o)" */
+	snprintf(name, sizeof(name), "%.*s", (int)strcspn(base, "("), base);
+
+	module_ptr = MAP_find(map_ptr, name);
+	if (module_ptr == NULL_PTR)
+	{
+		if (map_ptr->count == MAX_MODULES)
+		{
+			return;
+		}
+		module_ptr = &map_ptr->modules[map_ptr->count++];
+		strcpy(module_ptr->name, name);
+	}
+
+	module_ptr->size[area] += size;
+	map_ptr->total[area] += size;
+}
+
+/* Return the module of a name, NULL_PTR if there is none */
+static Module_Type * MAP_find(Map_Type *map_ptr, const char *name)
+{
+	uint8 i;
+
+	for (i = 0; i < map_ptr->count; i++)
+	{
+		if (strcmp(map_ptr->modules[i].name, name) == 0)
+		{
+			return &map_ptr->modules[i];
+		}
+	}
+	return NULL_PTR;
+}
+
+/* Order of the modules: most RAM first, then most flash */
+static int MAP_compare(const void *a, const void *b)
+{
+	const Module_Type *first = a;
+	const Module_Type *second = b;
+	uint32 ram_first = first->size[AREA_DATA] + first->size[AREA_BSS];
+	uint32 ram_second = second->size[AREA_DATA] + second->size[AREA_BSS];
+
+	if (ram_first != ram_second)
+	{
+		return (ram_first < ram_second) ? 1 : -1;
+	}
+	if (first->size[AREA_TEXT] != second->size[AREA_TEXT])
+	{
+		return (first->size[AREA_TEXT] < second->size[AREA_TEXT]) ? 1 : -1;
+	}
+	return strcmp(first->name, second->name);
+}
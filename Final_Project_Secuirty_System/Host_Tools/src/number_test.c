@@ -0,0 +1,123 @@
+/*
+ * number_test.c
+ *	Description: Checks the decimal numbers of the HMI LCD driver against sprintf
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * LCD_displayNumber converts without any division (double dabble), so every value it can get is
+ * checked: 0 to 65535 at the widths 0 to 7, against sprintf("%*u"). LCD_intgerToString is checked
+ * for every value of the 16-bit int of the AVR against sprintf("%d"). Each number is drawn on the
+ * first row, sent through LCD_flush and the drain of the system tick, and read back from the LCD
+ * model, so the cells the shadow framebuffer skips as unchanged are checked as well.
+ *
+ * Build (from Host_Tools/src):
+ *   gcc -std=gnu99 -O2 -Wall -DF_CPU=8000000UL -I../include -I. -I../../HMI_ECU/src \
+ *       -o number_test number_test.c lcd_model.c io_model.c timer1_model.c host_clock.c \
+ *       ../../HMI_ECU/src/lcd.c ../../HMI_ECU/src/soft_timer.c
+ *
+ * Usage:
+ *   ./number_test
+ * The exit status is not zero if a number is wrong.
+ */
+
+#include "lcd_model.h"
+#include "timer1_model.h"
+#include "lcd.h"
+#include "timer1.h"
+#include "soft_timer.h"
+#include <stdio.h>
+#include <string.h>
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Widest alignment checked, wider than the 5 digits of a 16-bit value */
+#define TEST_MAX_WIDTH      7
+
+/* Range of the 16-bit int of the AVR */
+#define TEST_INT_MIN        (-32768L)
+#define TEST_INT_MAX        32767L
+
+/* One system tick in nanoseconds */
+#define TEST_TICK_TIME      1000000ULL
+
+/* Wrong numbers printed before the others are only counted */
+#define TEST_MAX_PRINTED    10
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Number of wrong numbers */
+static uint32 g_failures = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Send the shadow to the LCD and compare its first row with the expected text */
+static void TEST_check(const char * expected)
+{
+	char shown[LCD_NUM_COLS + 1];
+	char padded[LCD_NUM_COLS + 1];
+
+	(void)LCD_flush();
+	while (!LCD_isIdle())
+	{
+		TIMER1_MODEL_run(TEST_TICK_TIME);
+		(void)SOFT_TIMER_runDeferred();
+	}
+
+	memset(padded, ' ', LCD_NUM_COLS);
+	memcpy(padded, expected, strlen(expected));
+	padded[LCD_NUM_COLS] = '\0';
+	LCD_MODEL_getRow(0, shown);
+	if (strcmp(shown, padded) != 0)
+	{
+		if (g_failures < TEST_MAX_PRINTED)
+		{
+			printf("FAIL: LCD shows \"%s\", expected \"%s\"\n", shown, padded);
+		}
+		g_failures++;
+	}
+}
+
+int main(void)
+{
+	char expected[LCD_NUM_COLS + 1];
+	uint32 value;
+	sint32 data;
+	uint8 width;
+
+	LCD_MODEL_init();
+	LCD_init();
+	TIMER1_init();
+	SOFT_TIMER_init();
+	sei();
+
+	for (width = 0; width <= TEST_MAX_WIDTH; width++)
+	{
+		for (value = 0; value <= 0xFFFF; value++)
+		{
+			LCD_clearScreen();
+			LCD_displayNumber((uint16)value, width);
+			sprintf(expected, "%*lu", width, (unsigned long)value);
+			TEST_check(expected);
+		}
+		printf("LCD_displayNumber width %u: 0 to 65535 checked\n", width);
+	}
+
+	for (data = TEST_INT_MIN; data <= TEST_INT_MAX; data++)
+	{
+		LCD_clearScreen();
+		LCD_intgerToString((int)data);
+		sprintf(expected, "%ld", (long)data);
+		TEST_check(expected);
+	}
+	printf("LCD_intgerToString: -32768 to 32767 checked\n");
+
+	printf("%lu wrong numbers\n%s\n", (unsigned long)g_failures, (g_failures == 0) ? "PASS" : "FAIL");
+	return (g_failures == 0) ? 0 : 1;
+}
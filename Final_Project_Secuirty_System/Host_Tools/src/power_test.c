@@ -0,0 +1,303 @@
+/*
+ * power_test.c
+ *	Description: Runs the idle sleep of the HMI on Linux and counts the interrupts that wake the CPU
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * power.c, keypad.c, lcd.c and soft_timer.c are built unchanged from HMI_ECU/src, on the port
+ * registers of io_model.c, the system tick of timer1_model.c, the LCD of lcd_model.c and the keypad
+ * of keypad_model.c. The test runs a main loop like the one of the HMI: the deferred timers, the
+ * keys shown on the LCD, then the sleep of POWER_idle after the check for pending work with the
+ * interrupts disabled. The sleep instruction moves the virtual clock to the next interrupt: a tick,
+ * a Timer1 overflow, or the INT2 edge of a key pressed while the scan waits for it.
+ *
+ * Three phases are run: ten idle seconds, five keys typed, ten idle seconds again. For each phase
+ * the test reports the wakes of each interrupt per second, and the line of POWER_dump. The code runs
+ * in no virtual time on the host: the awake share of POWER_dump only holds the delays of the LCD bus.
+ * The awake share and the current of the target are then estimated from the wakes, with the awake
+ * time of one wake given on the command line: the time of an ISR and one round of the main loop,
+ * which only the target measures (POWER_dump of the HMI gives it).
+ *
+ * With KEYPAD_WAKE_ENABLE the tick must stop once the scan waits for INT2 and the LCD is drained:
+ * the test fails if an idle phase has more ticks than the idle scans and the drain take. Each key
+ * typed must be shown on the LCD.
+ * The configuration tested is the one of power.h and keypad.h: POWER_SLEEP_ENABLE must be set to 1,
+ * set KEYPAD_WAKE_ENABLE to 1 to test the wake.
+ *
+ * Build (from Host_Tools/src):
+ *   gcc -std=gnu99 -Wall -DF_CPU=8000000UL -I../include -I. -I../../HMI_ECU/src \
+ *       -o power_test power_test.c lcd_model.c keypad_model.c io_model.c timer1_model.c host_clock.c \
+ *       ../../HMI_ECU/src/power.c ../../HMI_ECU/src/keypad.c ../../HMI_ECU/src/lcd.c \
+ *       ../../HMI_ECU/src/soft_timer.c
+ *
+ * Usage:
+ *   ./power_test [awake micro seconds per wake]
+ * The default is 150 us per wake. The exit status is not zero if a check fails.
+ */
+
+#include "lcd_model.h"
+#include "keypad_model.h"
+#include "timer1_model.h"
+#include "host_clock.h"
+#include "lcd.h"
+#include "keypad.h"
+#include "power.h"
+#include "timer1.h"
+#include "soft_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#if (POWER_SLEEP_ENABLE == 0)
+
+#error "power_test needs POWER_SLEEP_ENABLE set to 1 in power.h"
+
+#endif
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Nanoseconds of a millisecond */
+#define TEST_MS                 1000000ULL
+
+/* Length of an idle phase */
+#define TEST_IDLE_TIME          (10000ULL * TEST_MS)
+
+/* Keys typed in the typing phase, the time each one is held and the time between two presses */
+#define TEST_KEYS               5
+#define TEST_HOLD_TIME          (100ULL * TEST_MS)
+#define TEST_KEY_PERIOD         (400ULL * TEST_MS)
+
+/* Length of the typing phase, the last key is released and shown before its end */
+#define TEST_TYPING_TIME        (TEST_KEYS * TEST_KEY_PERIOD)
+
+/* Default awake time of a wake in micro seconds, an estimate for the -O0 build */
+#define TEST_AWAKE_US           150
+
+/*
+ * Most ticks of an idle phase with KEYPAD_WAKE_ENABLE: the idle scans before the scan waits, the
+ * drain of the last key and its stop, with one full scan to spare
+ */
+#define TEST_IDLE_TICKS         (((KEYPAD_IDLE_SCANS + 1) * KEYPAD_NUM_ROWS * KEYPAD_SCAN_PERIOD) + 10)
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Wakes of the sleep since the start of the phase: ticks, Timer1 overflows and INT2 edges */
+static uint32 g_tickWakes;
+static uint32 g_overflowWakes;
+static uint32 g_int2Wakes;
+
+/* Virtual time of the next key action and TRUE if it is a press, no action if g_keyTime is 0 */
+static uint64 g_keyTime = 0;
+static boolean g_keyPress;
+
+/* Keys typed and keys seen pressed by the main loop */
+static uint8 g_typed = 0;
+static uint8 g_seen = 0;
+
+/* Number of failed checks */
+static uint32 g_failures = 0;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/* Output of POWER_dump */
+static void TEST_sendByte(const uint8 data)
+{
+	if (data != '\r')
+	{
+		putchar(data);
+	}
+}
+
+/* Output of the POWER_dump that starts the first measure */
+static void TEST_dropByte(const uint8 data)
+{
+	(void)data;
+}
+
+/* Hold or release the key of the next action, then schedule the following action */
+static void TEST_keyAction(void)
+{
+	KEYPAD_MODEL_setKey(0, g_typed % KEYPAD_NUM_COLS, g_keyPress);
+	KEYPAD_MODEL_update();
+
+	if (g_keyPress)
+	{
+		g_keyPress = FALSE;
+		g_keyTime += TEST_HOLD_TIME;
+	}
+	else
+	{
+		g_typed++;
+		g_keyPress = TRUE;
+		g_keyTime = (g_typed < TEST_KEYS) ? (g_keyTime + TEST_KEY_PERIOD - TEST_HOLD_TIME) : 0;
+	}
+}
+
+/*
+ * Sleep instruction: move the clock to the next interrupt and run it. A key changed meanwhile only
+ * wakes the CPU when INT2 is enabled, the scan reads it at its next row step otherwise.
+ */
+void HOST_SLEEP_cpu(void)
+{
+	uint64 next;
+	boolean overflow, armed;
+
+	while (1)
+	{
+		next = TIMER1_MODEL_getNextInterrupt(&overflow);
+		if ((g_keyTime != 0) && (g_keyTime <= next))
+		{
+			HOST_CLOCK_advance(g_keyTime - HOST_CLOCK_getTime());
+			armed = ((GICR & (1 << INT2)) != 0);
+			TEST_keyAction();
+			if (armed && ((GICR & (1 << INT2)) == 0))
+			{
+				g_int2Wakes++;
+				return;
+			}
+			continue;
+		}
+
+		HOST_CLOCK_advance(next - HOST_CLOCK_getTime());
+		if (overflow)
+		{
+			g_overflowWakes++;
+		}
+		else
+		{
+			g_tickWakes++;
+			TIMER1_MODEL_run(0);
+		}
+		return;
+	}
+}
+
+/* One round of the main loop: the deferred timers, the keys shown, then the sleep */
+static void TEST_round(void)
+{
+	KEYPAD_EventType event;
+
+	(void)SOFT_TIMER_runDeferred();
+	while (KEYPAD_getEvent(&event))
+	{
+		if (event.kind == KEYPAD_PRESS)
+		{
+			LCD_displayCharacter('1' + g_seen);
+			g_seen++;
+		}
+	}
+	(void)LCD_flush();
+
+	cli();
+	if (!SOFT_TIMER_isReady() && !KEYPAD_hasEvent())
+	{
+		POWER_idle();
+	}
+	sei();
+}
+
+/* Run the main loop for a phase and report its wakes, return the ticks of the phase */
+static uint32 TEST_phase(const char * name, uint64 length, uint32 awake_us)
+{
+	uint64 start = HOST_CLOCK_getTime();
+	uint64 time;
+	uint32 wakes;
+	uint64 share;
+
+	g_tickWakes = 0;
+	g_overflowWakes = 0;
+	g_int2Wakes = 0;
+	while ((HOST_CLOCK_getTime() - start) < length)
+	{
+		TEST_round();
+	}
+	time = (HOST_CLOCK_getTime() - start) / TEST_MS;
+	wakes = g_tickWakes + g_overflowWakes + g_int2Wakes;
+
+	/* Estimated awake share of the target in hundredths of percent, and its current */
+	share = ((uint64)wakes * awake_us * 10) / time;
+	if (share > 10000)
+	{
+		share = 10000;
+	}
+
+	printf("%s, %lu ms: %lu wakes (%lu ticks, %lu overflows, %lu INT2), %lu.%02lu wakes/s\n", name,
+			(unsigned long)time, (unsigned long)wakes, (unsigned long)g_tickWakes,
+			(unsigned long)g_overflowWakes, (unsigned long)g_int2Wakes,
+			(unsigned long)((wakes * 1000ULL) / time), (unsigned long)(((wakes * 100000ULL) / time) % 100));
+	printf("  POWER_dump (bus delays only): ");
+	POWER_dump(TEST_sendByte);
+	printf("  estimate at %lu us per wake: awake %lu.%02lu%%, %lu uA\n", (unsigned long)awake_us,
+			(unsigned long)(share / 100), (unsigned long)(share % 100),
+			(unsigned long)(POWER_IDLE_CURRENT + (((POWER_ACTIVE_CURRENT - POWER_IDLE_CURRENT) * share) / 10000)));
+
+	return g_tickWakes;
+}
+
+int main(int argc, char * argv[])
+{
+	uint32 awake_us = (argc > 1) ? (uint32)strtoul(argv[1], NULL, 10) : TEST_AWAKE_US;
+	uint32 ticks[2];
+	char shown[LCD_NUM_COLS + 1];
+	char expected[LCD_NUM_COLS + 1];
+	uint8 i;
+
+	printf("KEYPAD_WAKE_ENABLE %d\n", KEYPAD_WAKE_ENABLE);
+
+	LCD_MODEL_init();
+	LCD_init();
+	KEYPAD_MODEL_init();
+	TIMER1_init();
+	SOFT_TIMER_init();
+	KEYPAD_init();
+	sei();
+	POWER_dump(TEST_dropByte);
+
+	ticks[0] = TEST_phase("idle", TEST_IDLE_TIME, awake_us);
+
+	g_keyPress = TRUE;
+	g_keyTime = HOST_CLOCK_getTime() + TEST_MS;
+	(void)TEST_phase("typing", TEST_TYPING_TIME, awake_us);
+
+	ticks[1] = TEST_phase("idle", TEST_IDLE_TIME, awake_us);
+
+	/* Each key typed is shown */
+	memset(expected, ' ', LCD_NUM_COLS);
+	for (i = 0; i < TEST_KEYS; i++)
+	{
+		expected[i] = '1' + i;
+	}
+	expected[LCD_NUM_COLS] = '\0';
+	LCD_MODEL_getRow(0, shown);
+	if ((g_seen != TEST_KEYS) || (strcmp(shown, expected) != 0))
+	{
+		printf("FAIL: %u of %u keys seen, LCD shows \"%s\"\n", g_seen, TEST_KEYS, shown);
+		g_failures++;
+	}
+
+#if (KEYPAD_WAKE_ENABLE == 1)
+	/* The tick stops once the scan waits for INT2 and the LCD is drained */
+	for (i = 0; i < 2; i++)
+	{
+		if (ticks[i] > TEST_IDLE_TICKS)
+		{
+			printf("FAIL: %lu ticks in idle phase %u, %u at most\n", (unsigned long)ticks[i], i + 1, TEST_IDLE_TICKS);
+			g_failures++;
+		}
+	}
+#else
+	(void)ticks;
+#endif
+
+	printf("%s\n", (g_failures == 0) ? "PASS" : "FAIL");
+	return (g_failures == 0) ? 0 : 1;
+}
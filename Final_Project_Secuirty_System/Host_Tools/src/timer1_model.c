@@ -0,0 +1,261 @@
+/*
+ * timer1_model.c
+ *	Description: Host (Linux) model of the Timer1 driver on the virtual clock
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The counter is the virtual time in micro seconds. The timestamp is not cut to 32 bits: uint32
+ * of std_types.h is 64-bit on the build machine, and the long runs of the host tests would
+ * otherwise wrap it where the target code expects a 32-bit wrap.
+ */
+
+#include "timer1_model.h"
+#include "timer1.h"
+#include "host_clock.h"
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Nanoseconds of one count of the counter */
+#define TIMER1_MODEL_COUNT_TIME     (1000000000ULL / TIMER1_FREQUENCY)
+
+/* Counts of one turn of the 16-bit counter */
+#define TIMER1_MODEL_TURN           0x10000ULL
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Callback of each channel and TRUE while its interrupt is enabled */
+static void (*g_callBackFunctions[TIMER1_NUM_OF_CHANNELS])(void);
+static boolean g_enabled[TIMER1_NUM_OF_CHANNELS];
+
+/* Virtual time of the next match of each channel in counts, the overflow and capture never match */
+static uint64 g_match[TIMER1_NUM_OF_CHANNELS];
+
+/* Virtual time spent inside the callbacks in nanoseconds */
+static uint64 g_isrTime = 0;
+
+/* Model of the input pins updated before each callback */
+static void (*g_inputHook)(void) = NULL_PTR;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Return the virtual time in counts */
+static uint64 TIMER1_MODEL_now(void);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description : Function to initialize the Timer1, release all channels
+ */
+void TIMER1_init(void)
+{
+	uint8 channel;
+
+	for (channel = 0; channel < TIMER1_NUM_OF_CHANNELS; channel++)
+	{
+		TIMER1_releaseChannel(channel);
+	}
+}
+
+/*
+ * Description: Function to disable & stop Timer1 and release all channels.
+ */
+void TIMER1_deinit(void)
+{
+	TIMER1_init();
+}
+
+/*
+ * Description: Function to take a channel and set its Call Back function address.
+ */
+boolean TIMER1_allocateChannel(TIMER1_Channel channel, void (*ptr_func)(void))
+{
+	if (g_callBackFunctions[channel] != NULL_PTR)
+	{
+		return FALSE;
+	}
+	g_callBackFunctions[channel] = ptr_func;
+	g_enabled[channel] = FALSE;
+	return TRUE;
+}
+
+/*
+ * Description: Function to disable a channel and make it free for another user.
+ */
+void TIMER1_releaseChannel(TIMER1_Channel channel)
+{
+	g_callBackFunctions[channel] = NULL_PTR;
+	g_enabled[channel] = FALSE;
+}
+
+/*
+ * Description: Function to enable the interrupt of a channel.
+ */
+void TIMER1_enableChannel(TIMER1_Channel channel)
+{
+	g_enabled[channel] = TRUE;
+}
+
+/*
+ * Description: Function to disable the interrupt of a channel without releasing it.
+ */
+void TIMER1_disableChannel(TIMER1_Channel channel)
+{
+	g_enabled[channel] = FALSE;
+}
+
+/*
+ * Description: Function to schedule a compare channel at an absolute counter value, the next time
+ * the 16-bit counter reaches it.
+ */
+void TIMER1_setCompare(TIMER1_Channel channel, uint16 count)
+{
+	uint64 now = TIMER1_MODEL_now();
+	uint64 counts = (uint16)(count - (uint16)now);
+
+	/* A match on the current count happens one turn later, as the counter already passed it */
+	if (counts == 0)
+	{
+		counts = TIMER1_MODEL_TURN;
+	}
+	g_match[channel] = now + counts;
+	g_enabled[channel] = TRUE;
+}
+
+/*
+ * Description: Function to move a compare channel forward by a number of counts from its last match.
+ */
+void TIMER1_advanceCompare(TIMER1_Channel channel, uint16 counts)
+{
+	g_match[channel] += counts;
+}
+
+/*
+ * Description: Function to read the free-running counter.
+ */
+uint16 TIMER1_getCount(void)
+{
+	return (uint16)TIMER1_MODEL_now();
+}
+
+/*
+ * Description: Function to read the counter value latched by the last input capture, none here.
+ */
+uint16 TIMER1_getCapture(void)
+{
+	return 0;
+}
+
+/*
+ * Description: Function to read the timestamp, one count per micro second.
+ */
+uint32 TIMER1_getTimestamp(void)
+{
+	return (uint32)TIMER1_MODEL_now();
+}
+
+/*
+ * Description :
+ * Advance the virtual clock and call the callbacks of the channels at their matches. The callbacks
+ * run with the interrupts disabled as in an ISR, and none runs while the caller disabled them.
+ */
+void TIMER1_MODEL_run(uint64 nanoseconds)
+{
+	uint64 end = HOST_CLOCK_getTime() + nanoseconds;
+	uint64 now;
+	uint8 channel, next;
+
+	while ((SREG & (1 << HOST_SREG_I)) != 0)
+	{
+		/* Earliest match of the enabled compare channels before the end */
+		next = TIMER1_NUM_OF_CHANNELS;
+		for (channel = TIMER1_CHANNEL_A; channel <= TIMER1_CHANNEL_B; channel++)
+		{
+			if (g_enabled[channel] && (g_callBackFunctions[channel] != NULL_PTR) &&
+				((g_match[channel] * TIMER1_MODEL_COUNT_TIME) <= end) &&
+				((next == TIMER1_NUM_OF_CHANNELS) || (g_match[channel] < g_match[next])))
+			{
+				next = channel;
+			}
+		}
+		if (next == TIMER1_NUM_OF_CHANNELS)
+		{
+			break;
+		}
+
+		/* An ISR longer than the period delays the next match, the hardware flag waits for it */
+		now = HOST_CLOCK_getTime();
+		if ((g_match[next] * TIMER1_MODEL_COUNT_TIME) > now)
+		{
+			HOST_CLOCK_advance((g_match[next] * TIMER1_MODEL_COUNT_TIME) - now);
+		}
+		if (g_inputHook != NULL_PTR)
+		{
+			(*g_inputHook)();
+		}
+		now = HOST_CLOCK_getTime();
+		cli();
+		(*g_callBackFunctions[next])();
+		sei();
+		g_isrTime += HOST_CLOCK_getTime() - now;
+	}
+
+	now = HOST_CLOCK_getTime();
+	if (end > now)
+	{
+		HOST_CLOCK_advance(end - now);
+	}
+}
+
+/*
+ * Description :
+ * Return the virtual time spent inside the callbacks.
+ */
+uint64 TIMER1_MODEL_getIsrTime(void)
+{
+	return g_isrTime;
+}
+
+/*
+ * Description :
+ * Set the function called before each callback.
+ */
+void TIMER1_MODEL_setInputHook(void (*ptr_func)(void))
+{
+	g_inputHook = ptr_func;
+}
+
+/*
+ * Description :
+ * Return the virtual time of the next interrupt of Timer1, a compare match or the overflow.
+ */
+uint64 TIMER1_MODEL_getNextInterrupt(boolean * overflow_ptr)
+{
+	uint64 next = ((TIMER1_MODEL_now() / TIMER1_MODEL_TURN) + 1) * TIMER1_MODEL_TURN;
+	uint8 channel;
+
+	*overflow_ptr = TRUE;
+	for (channel = TIMER1_CHANNEL_A; channel <= TIMER1_CHANNEL_B; channel++)
+	{
+		if (g_enabled[channel] && (g_callBackFunctions[channel] != NULL_PTR) && (g_match[channel] <= next))
+		{
+			next = g_match[channel];
+			*overflow_ptr = FALSE;
+		}
+	}
+	return next * TIMER1_MODEL_COUNT_TIME;
+}
+
+/* Return the virtual time in counts */
+static uint64 TIMER1_MODEL_now(void)
+{
+	return HOST_CLOCK_getTime() / TIMER1_MODEL_COUNT_TIME;
+}
@@ -0,0 +1,54 @@
+/*
+ * timer1_model.h
+ *	Description: Header file for the host (Linux) model of the Timer1 driver
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * timer1_model.c replaces timer1.c: the functions of timer1.h count on the virtual clock of
+ * host_clock.c, one count per micro second as TIMER1_FREQUENCY gives on the target. The compare
+ * and overflow callbacks are called by TIMER1_MODEL_run when the clock reaches their matches, so
+ * the system tick and the software timers of soft_timer.c run unchanged. An ISR advancing the
+ * clock (the delays of the LCD bus) delays the next matches as on the target, never the ones
+ * after it.
+ */
+
+#ifndef TIMER1_MODEL_H_
+#define TIMER1_MODEL_H_
+
+#include "std_types.h"
+
+/*******************************************************************************
+ *                      Functions Prototypes                                   *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Advance the virtual clock by the given number of nanoseconds, and call the callbacks of the
+ * enabled channels at their matches on the way, in the order of the matches.
+ */
+void TIMER1_MODEL_run(uint64 nanoseconds);
+
+/*
+ * Description :
+ * Return the virtual time spent inside the callbacks since the start, in nanoseconds: the time
+ * the ISRs advanced the clock by their delays.
+ */
+uint64 TIMER1_MODEL_getIsrTime(void);
+
+/*
+ * Description :
+ * Set a function called before each callback, for the models of the input pins the ISRs read:
+ * the levels they set are the ones the pins settled to since the previous interrupt.
+ */
+void TIMER1_MODEL_setInputHook(void (*ptr_func)(void));
+
+/*
+ * Description :
+ * Return the virtual time of the next interrupt of Timer1 in nanoseconds: the next match of an
+ * enabled compare channel, or the next overflow of the counter, whose interrupt always runs for the
+ * timestamp. The overflow has no callback here, it only wakes the CPU.
+ * overflow_ptr is set to TRUE if the next interrupt is the overflow.
+ */
+uint64 TIMER1_MODEL_getNextInterrupt(boolean * overflow_ptr);
+
+#endif /* TIMER1_MODEL_H_ */
@@ -0,0 +1,582 @@
+/*
+ * trace_decode.c
+ *	Description: Rebuilds the text of the trace records sent by an ECU
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * The format strings are read from the .trace_fmt section of the ELF file the ECU runs, the
+ * n-th string is the format of message id n (see trace.h). The capture is the raw debug output,
+ * from the software UART (PD7, 8N1) or from the link: the "~HHHH..." lines are decoded, the other
+ * text lines (profiler, RAM use) are printed as they are and the bytes of the link protocol are dropped.
+ * Every record is printed with its time in seconds and the time since the previous record.
+ *
+ * With -m the captures of both ECUs are merged on the time line of the HMI. The HMI must be built
+ * with CLOCK_SYNC_ENABLE: its CLOCK_OFFSET records give the offset of the Control clock at their
+ * time, the offset between them is interpolated, so the drift between the two records is followed.
+ *
+ * Build (from Host_Tools/src):
+ *   gcc -std=gnu99 -Wall -I../../Control_ECU/src -o trace_decode trace_decode.c
+ *
+ * Usage:
+ *   ./trace_decode ../../Control_ECU/Debug/Control_ECU.elf [capture file, default stdin]
+ *   ./trace_decode -m HMI_ECU.elf hmi.txt Control_ECU.elf control.txt
+ *   stty -F /dev/ttyUSB0 4800 cs8 -parenb raw && ./trace_decode HMI_ECU.elf /dev/ttyUSB0
+ *   stty -F /dev/ttyUSB0 9600 cs8 parenb -parodd raw && ./trace_decode Control_ECU.elf /dev/ttyUSB0
+ */
+
+#include "std_types.h"
+#include <elf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Name of the section of the format strings */
+#define FORMAT_SECTION      ".trace_fmt"
+
+/* Header byte of a record: id in the low 6 bits, number of arguments in the high 2 bits */
+#define RECORD_ID(header)   ((header) & 0x3F)
+#define RECORD_ARGS(header) ((header) >> 6)
+#define LOST_ID             0x3F
+
+/* Format of the HMI record with the offset of the Control clock, high 16 bits first */
+#define CLOCK_OFFSET_FORMAT "clock offset 0x%04X%04X"
+
+/* Largest record, number of messages and length of a line */
+#define MAX_RECORD          9
+#define MAX_MESSAGES        64
+#define MAX_LINE            256
+
+/* The extended timestamps start here, so a record older than the first one stays positive */
+#define TIME_BASE           0x100000000ULL
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/*
+ * The timestamps of the ECUs are 32-bit counters that wrap, the differences are taken with the
+ * fixed-width types because uint32 of std_types.h is 64-bit on the build machine.
+ */
+
+/* Structure of the format strings of one ELF file */
+typedef struct
+{
+	char *strings;                      /* Contents of the format section */
+	const char *format[MAX_MESSAGES];   /* Format of each id */
+	uint8 count;
+} Formats_Type;
+
+/* Structure of one decoded record */
+typedef struct
+{
+	uint32_t timestamp;
+	uint8 id;
+	uint8 args_num;
+	uint16 args[2];
+	char text[MAX_LINE];
+} Record_Type;
+
+/* Structure of the state of the reader of one capture */
+typedef struct
+{
+	FILE *file;
+	boolean record;                     /* TRUE if the line being read started with '~' */
+} Reader_Type;
+
+/* Structure of one line of a capture kept for the merge */
+typedef struct
+{
+	uint64_t time;                      /* Extended timestamp, on the time line of the HMI once merged */
+	uint32_t timestamp;                 /* Timestamp of the ECU */
+	boolean timed;                      /* FALSE for a text line or a bad record */
+	char text[MAX_LINE];
+} Line_Type;
+
+/* Structure of all the lines of one capture */
+typedef struct
+{
+	Line_Type *lines;
+	uint32_t count;
+} Capture_Type;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* Time of the previous record printed */
+static uint64_t g_lastTime;
+static boolean g_first = TRUE;
+
+/* Offsets of the Control clock (Control - HMI) measured by the HMI, at the HMI time of their record */
+static uint64_t *g_syncTime;
+static uint32_t *g_syncOffset;
+static uint32_t g_syncCount;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+static boolean TRACE_readFormats(const char *path, Formats_Type *formats_ptr);
+static boolean TRACE_readLine(Reader_Type *reader_ptr, char *line, boolean *record_ptr);
+static boolean TRACE_decodeRecord(const Formats_Type *formats_ptr, const char *hex, Record_Type *record_ptr);
+static void TRACE_format(char *text, const char *format, const uint16 *args, uint8 args_num);
+static void TRACE_printLine(uint64_t time, boolean timed, const char *source, const char *text);
+static boolean TRACE_readCapture(const char *elf_path, const char *path, Capture_Type *capture_ptr, boolean hmi);
+static uint32_t TRACE_offsetAt(uint64_t hmi_time);
+static uint64_t TRACE_unwrap(uint32_t timestamp, uint64_t reference);
+static int TRACE_merge(char *argv[]);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+int main(int argc, char *argv[])
+{
+	Formats_Type formats = {0};
+	Record_Type record;
+	Reader_Type reader = {stdin, FALSE};
+	char line[MAX_LINE];
+	boolean is_record;
+	uint64_t time = TIME_BASE;
+
+	if ((argc == 6) && (strcmp(argv[1], "-m") == 0))
+	{
+		return TRACE_merge(argv);
+	}
+	if ((argc < 2) || (argv[1][0] == '-'))
+	{
+		fprintf(stderr, "usage: %s <file.elf> [capture file]\n", argv[0]);
+		fprintf(stderr, "       %s -m <HMI file.elf> <HMI capture> <Control file.elf> <Control capture>\n", argv[0]);
+		return 1;
+	}
+	if (!TRACE_readFormats(argv[1], &formats))
+	{
+		return 1;
+	}
+	if ((argc > 2) && ((reader.file = fopen(argv[2], "rb")) == NULL))
+	{
+		perror(argv[2]);
+		return 1;
+	}
+
+	/* The lines are printed as they come, so a serial port can be read directly */
+	while (TRACE_readLine(&reader, line, &is_record))
+	{
+		if (!is_record)
+		{
+			printf("%s\n", line);
+		}
+		else if (TRACE_decodeRecord(&formats, line, &record))
+		{
+			time = g_first ? (TIME_BASE + record.timestamp) : TRACE_unwrap(record.timestamp, time);
+			TRACE_printLine(time, TRUE, NULL, record.text);
+		}
+		else
+		{
+			printf("%s\n", record.text);
+		}
+		fflush(stdout);
+	}
+	return 0;
+}
+
+/* Read the format strings from the ELF file, returns FALSE if there are none */
+static boolean TRACE_readFormats(const char *path, Formats_Type *formats_ptr)
+{
+	unsigned char ident[EI_NIDENT];
+	uint64 section_offset = 0, section_size = 0;
+	uint64 headers, names_offset = 0;
+	uint16 header_size, headers_num, names_index, i;
+	char name[sizeof(FORMAT_SECTION)];
+	char *ptr;
+	FILE *elf = fopen(path, "rb");
+
+	if (elf == NULL)
+	{
+		perror(path);
+		return FALSE;
+	}
+
+	/* The AVR files are ELF32, ELF64 is read too to check the tool on the build machine */
+	if ((fread(ident, 1, EI_NIDENT, elf) != EI_NIDENT) || (memcmp(ident, ELFMAG, SELFMAG) != 0))
+	{
+		fprintf(stderr, "%s: not an ELF file\n", path);
+		fclose(elf);
+		return FALSE;
+	}
+	rewind(elf);
+	if (ident[EI_CLASS] == ELFCLASS32)
+	{
+		Elf32_Ehdr header;
+		Elf32_Shdr names;
+		fread(&header, sizeof(header), 1, elf);
+		headers = header.e_shoff;
+		header_size = header.e_shentsize;
+		headers_num = header.e_shnum;
+		names_index = header.e_shstrndx;
+		fseek(elf, headers + (uint64)names_index * header_size, SEEK_SET);
+		fread(&names, sizeof(names), 1, elf);
+		names_offset = names.sh_offset;
+	}
+	else
+	{
+		Elf64_Ehdr header;
+		Elf64_Shdr names;
+		fread(&header, sizeof(header), 1, elf);
+		headers = header.e_shoff;
+		header_size = header.e_shentsize;
+		headers_num = header.e_shnum;
+		names_index = header.e_shstrndx;
+		fseek(elf, headers + (uint64)names_index * header_size, SEEK_SET);
+		fread(&names, sizeof(names), 1, elf);
+		names_offset = names.sh_offset;
+	}
+
+	/* Find the section by its name */
+	for (i = 0; (i < headers_num) && (section_size == 0); i++)
+	{
+		uint64 name_offset, offset, size;
+
+		fseek(elf, headers + (uint64)i * header_size, SEEK_SET);
+		if (ident[EI_CLASS] == ELFCLASS32)
+		{
+			Elf32_Shdr section;
+			fread(&section, sizeof(section), 1, elf);
+			name_offset = section.sh_name;
+			offset = section.sh_offset;
+			size = section.sh_size;
+		}
+		else
+		{
+			Elf64_Shdr section;
+			fread(&section, sizeof(section), 1, elf);
+			name_offset = section.sh_name;
+			offset = section.sh_offset;
+			size = section.sh_size;
+		}
+
+		fseek(elf, names_offset + name_offset, SEEK_SET);
+		if ((fread(name, 1, sizeof(name), elf) == sizeof(name)) && (memcmp(name, FORMAT_SECTION, sizeof(name)) == 0))
+		{
+			section_offset = offset;
+			section_size = size;
+		}
+	}
+
+	if (section_size == 0)
+	{
+		fprintf(stderr, "%s: no %s section, build with TRACE_ENABLE = 1\n", path, FORMAT_SECTION);
+		fclose(elf);
+		return FALSE;
+	}
+
+	/* One string after the other, in the order of the ids */
+	formats_ptr->strings = calloc(section_size + 1, 1);
+	fseek(elf, section_offset, SEEK_SET);
+	fread(formats_ptr->strings, 1, section_size, elf);
+	fclose(elf);
+
+	for (ptr = formats_ptr->strings; (ptr < formats_ptr->strings + section_size) && (formats_ptr->count < MAX_MESSAGES); ptr += strlen(ptr) + 1)
+	{
+		formats_ptr->format[formats_ptr->count++] = ptr;
+	}
+	return TRUE;
+}
+
+/* Read the next line of a capture, returns FALSE at the end. *record_ptr is TRUE for a "~" line */
+static boolean TRACE_readLine(Reader_Type *reader_ptr, char *line, boolean *record_ptr)
+{
+	uint16 length = 0;
+	int data;
+
+	/* The link bytes (READY, results) are not printable and are dropped */
+	while ((data = fgetc(reader_ptr->file)) != EOF)
+	{
+		if ((data == '\n') || (data == '\r') || (data == '~') || (length == (MAX_LINE - 1)))
+		{
+			line[length] = '\0';
+			*record_ptr = reader_ptr->record;
+			reader_ptr->record = (data == '~');
+			if (*record_ptr || (length > 0))
+			{
+				return TRUE;
+			}
+		}
+		else if (isprint(data))
+		{
+			line[length++] = (char)data;
+		}
+	}
+
+	/* The last line of a capture cut in the middle */
+	line[length] = '\0';
+	*record_ptr = reader_ptr->record;
+	reader_ptr->record = FALSE;
+	return (length > 0);
+}
+
+/* Decode one record line, the hex digits after '~', returns FALSE if it is not a valid record */
+static boolean TRACE_decodeRecord(const Formats_Type *formats_ptr, const char *hex, Record_Type *record_ptr)
+{
+	uint8 record[MAX_RECORD] = {0};
+	const char *line = hex;
+	uint8 length = 0;
+	unsigned int value;
+
+	while ((length < MAX_RECORD) && (sscanf(hex, "%2x", &value) == 1) && isxdigit(hex[1]))
+	{
+		record[length++] = (uint8)value;
+		hex += 2;
+	}
+
+	record_ptr->id = RECORD_ID(record[0]);
+	record_ptr->args_num = RECORD_ARGS(record[0]);
+	if ((length != (5 + 2 * record_ptr->args_num)) || (*hex != '\0'))
+	{
+		snprintf(record_ptr->text, MAX_LINE, "bad record ~%s", line);
+		return FALSE;
+	}
+
+	record_ptr->timestamp = record[1] | ((uint32_t)record[2] << 8) | ((uint32_t)record[3] << 16) | ((uint32_t)record[4] << 24);
+	record_ptr->args[0] = record[5] | (record[6] << 8);
+	record_ptr->args[1] = record[7] | (record[8] << 8);
+
+	if (record_ptr->id == LOST_ID)
+	{
+		snprintf(record_ptr->text, MAX_LINE, "*** %u trace records lost ***", record_ptr->args[0]);
+	}
+	else if (record_ptr->id >= formats_ptr->count)
+	{
+		snprintf(record_ptr->text, MAX_LINE, "unknown message %u", record_ptr->id);
+	}
+	else
+	{
+		TRACE_format(record_ptr->text, formats_ptr->format[record_ptr->id], record_ptr->args, record_ptr->args_num);
+	}
+	return TRUE;
+}
+
+/* Write the text of a format with the 16-bit arguments of its record */
+static void TRACE_format(char *text, const char *format, const uint16 *args, uint8 args_num)
+{
+	char spec[16];
+	uint8 length, next = 0;
+	size_t used = 0;
+
+	while ((*format != '\0') && (used < MAX_LINE - 1))
+	{
+		if (*format != '%')
+		{
+			text[used++] = *format++;
+			continue;
+		}
+		if (format[1] == '%')
+		{
+			text[used++] = '%';
+			format += 2;
+			continue;
+		}
+
+		/* Copy the conversion "%[flags][width]c" and print one argument with it */
+		length = 0;
+		do
+		{
+			spec[length++] = *format++;
+		} while ((*format != '\0') && (strchr("udxXc", *format) == NULL) && (length < sizeof(spec) - 2));
+		if (*format == '\0')
+		{
+			break;
+		}
+		spec[length++] = *format;
+		spec[length] = '\0';
+
+		if (next >= args_num)
+		{
+			used += snprintf(&text[used], MAX_LINE - used, "<missing>");
+		}
+		else if (*format == 'd')
+		{
+			used += snprintf(&text[used], MAX_LINE - used, spec, (int)(sint16)args[next++]);
+		}
+		else
+		{
+			used += snprintf(&text[used], MAX_LINE - used, spec, (unsigned int)args[next++]);
+		}
+		if (used > MAX_LINE - 1)
+		{
+			used = MAX_LINE - 1;
+		}
+		format++;
+	}
+	text[used] = '\0';
+}
+
+/* Print a line with its time and the time since the previous record, the source in merge mode */
+static void TRACE_printLine(uint64_t time, boolean timed, const char *source, const char *text)
+{
+	if (timed)
+	{
+		/* A lost records line carries the time it was sent, so it may be older than the next record */
+		printf("%12.6f %+10.3f ms  ", (time - TIME_BASE) / 1e6, g_first ? 0.0 : ((double)time - (double)g_lastTime) / 1e3);
+		g_lastTime = time;
+		g_first = FALSE;
+	}
+	else if (source != NULL)
+	{
+		printf("%12s %13s  ", "", "");
+	}
+
+	if (source != NULL)
+	{
+		printf("%-8s", source);
+	}
+	printf("%s\n", text);
+}
+
+/*
+ * Read a whole capture for the merge. The timestamps are extended to 64 bits, the lines between
+ * records take the time of the record before them. The offsets measured by the HMI are kept.
+ */
+static boolean TRACE_readCapture(const char *elf_path, const char *path, Capture_Type *capture_ptr, boolean hmi)
+{
+	Formats_Type formats = {0};
+	Record_Type record;
+	Reader_Type reader = {NULL, FALSE};
+	char line[MAX_LINE];
+	boolean is_record;
+	uint64_t time = TIME_BASE;
+	boolean first = TRUE;
+	uint32_t size = 0;
+	Line_Type *line_ptr;
+
+	if (!TRACE_readFormats(elf_path, &formats))
+	{
+		return FALSE;
+	}
+	if ((reader.file = fopen(path, "rb")) == NULL)
+	{
+		perror(path);
+		return FALSE;
+	}
+
+	while (TRACE_readLine(&reader, line, &is_record))
+	{
+		if (capture_ptr->count == size)
+		{
+			size = (size == 0) ? 256 : (2 * size);
+			capture_ptr->lines = realloc(capture_ptr->lines, size * sizeof(Line_Type));
+		}
+		line_ptr = &capture_ptr->lines[capture_ptr->count++];
+		line_ptr->timed = is_record && TRACE_decodeRecord(&formats, line, &record);
+
+		if (!line_ptr->timed)
+		{
+			line_ptr->time = time;
+			strcpy(line_ptr->text, is_record ? record.text : line);
+			continue;
+		}
+
+		time = first ? (TIME_BASE + record.timestamp) : TRACE_unwrap(record.timestamp, time);
+		first = FALSE;
+		line_ptr->time = time;
+		line_ptr->timestamp = record.timestamp;
+		strcpy(line_ptr->text, record.text);
+
+		if (hmi && (record.id < formats.count) && (strcmp(formats.format[record.id], CLOCK_OFFSET_FORMAT) == 0))
+		{
+			g_syncTime = realloc(g_syncTime, (g_syncCount + 1) * sizeof(uint64_t));
+			g_syncOffset = realloc(g_syncOffset, (g_syncCount + 1) * sizeof(uint32_t));
+			g_syncTime[g_syncCount] = time;
+			g_syncOffset[g_syncCount] = ((uint32_t)record.args[0] << 16) | record.args[1];
+			g_syncCount++;
+		}
+	}
+
+	fclose(reader.file);
+	free(formats.strings);
+	return TRUE;
+}
+
+/* Return the offset of the Control clock at a time of the HMI, interpolated between the measures */
+static uint32_t TRACE_offsetAt(uint64_t hmi_time)
+{
+	uint32_t i = 0;
+	double slope;
+
+	if (g_syncCount == 1)
+	{
+		return g_syncOffset[0];
+	}
+
+	/* The segment around the time, the first or the last one is extended outside the measures */
+	while ((i < (g_syncCount - 2)) && (hmi_time >= g_syncTime[i + 1]))
+	{
+		i++;
+	}
+	slope = (double)(int32_t)(g_syncOffset[i + 1] - g_syncOffset[i]) / (double)(g_syncTime[i + 1] - g_syncTime[i]);
+	return g_syncOffset[i] + (uint32_t)(int32_t)(slope * ((double)hmi_time - (double)g_syncTime[i]));
+}
+
+/* Extend a 32-bit timestamp to the 64-bit time nearest to the reference */
+static uint64_t TRACE_unwrap(uint32_t timestamp, uint64_t reference)
+{
+	return reference + (int64_t)(int32_t)(timestamp - (uint32_t)reference);
+}
+
+/* Merge the captures of both ECUs on the time line of the HMI */
+static int TRACE_merge(char *argv[])
+{
+	Capture_Type hmi = {NULL, 0};
+	Capture_Type control = {NULL, 0};
+	uint64_t time;
+	uint32_t i = 0, j = 0;
+
+	if (!TRACE_readCapture(argv[2], argv[3], &hmi, TRUE) || !TRACE_readCapture(argv[4], argv[5], &control, FALSE))
+	{
+		return 1;
+	}
+	if (g_syncCount == 0)
+	{
+		fprintf(stderr, "%s: no clock offset records, build the HMI with CLOCK_SYNC_ENABLE = 1\n", argv[3]);
+		return 1;
+	}
+
+	/*
+	 * Control time = HMI time + offset: the HMI time is found from the offset at a first guess of
+	 * it, then again from the offset at the time found. Each record is near the one before it.
+	 */
+	time = g_syncTime[0];
+	for (j = 0; j < control.count; j++)
+	{
+		if (control.lines[j].timed)
+		{
+			time = TRACE_unwrap(control.lines[j].timestamp - TRACE_offsetAt(time), time);
+			time = TRACE_unwrap(control.lines[j].timestamp - TRACE_offsetAt(time), time);
+		}
+		control.lines[j].time = time;
+	}
+
+	/* Both captures are in time order, each keeps the order of its own lines */
+	j = 0;
+	while ((i < hmi.count) || (j < control.count))
+	{
+		if ((j == control.count) || ((i < hmi.count) && (hmi.lines[i].time <= control.lines[j].time)))
+		{
+			TRACE_printLine(hmi.lines[i].time, hmi.lines[i].timed, "HMI", hmi.lines[i].text);
+			i++;
+		}
+		else
+		{
+			TRACE_printLine(control.lines[j].time, control.lines[j].timed, "CONTROL", control.lines[j].text);
+			j++;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * twi_model.c
+ *	Description: Host (Linux) model of the ATmega32 TWI peripheral in master mode
+ *  Created on: Oct 18, 2026
+ *      Author: abdalla
+ *
+ * Backs the TWBR, TWSR, TWDR, TWAR and TWCR registers declared in the host avr/io.h so that
+ * i2c.c runs unchanged. Every command written to TWCR is executed against the M24C16 model,
+ * TWSR gets the same status code the real peripheral reports, and the virtual clock is
+ * advanced by the bus time computed from TWBR and the TWSR prescaler bits.
+ *
+ * A write to TWCR is detected through a marker bit above the 8 register bits: the model
+ * always leaves the marker set, a plain assignment from the driver clears it. The command is
+ * executed on the next access of TWCR or of the virtual clock.
+ */
+
+#include <avr/io.h>
+#include "m24c16_model.h"
+#include "host_clock.h"
+#include "i2c.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* Marker bit showing the TWCR content was written by the model and not by the driver */
+#define TWCR_MODEL_MARKER   0x0100
+
+/* Status reported in TWSR when no relevant state is available */
+#define TWI_NO_INFO         0xF8
+
+/* Bit times of each bus operation (8 data bits + ACK bit for a byte) */
+#define TWI_BYTE_BITS       9
+#define TWI_START_BITS      1
+#define TWI_STOP_BITS       1
+
+/*******************************************************************************
+ *                               Types Declaration                             *
+ *******************************************************************************/
+
+/* Enum defining the master state of the peripheral */
+typedef enum
+{
+	TWI_MODEL_IDLE,         /* Bus not owned */
+	TWI_MODEL_ADDRESS,      /* Start sent, next byte is the slave address */
+	TWI_MODEL_TRANSMIT,     /* Master transmitter after SLA+W */
+	TWI_MODEL_RECEIVE       /* Master receiver after SLA+R */
+} TWI_ModelState;
+
+/*******************************************************************************
+ *                           Global Variables                                  *
+ *******************************************************************************/
+
+/* TWI registers declared in the host avr/io.h */
+volatile uint8 TWBR = 0;
+volatile uint8 TWSR = TWI_NO_INFO;
+volatile uint8 TWDR = 0xFF;
+volatile uint8 TWAR = 0xFE;
+static volatile uint16 g_TWCR = TWCR_MODEL_MARKER;
+
+static TWI_ModelState g_state = TWI_MODEL_IDLE;
+
+/*******************************************************************************
+ *                      Functions Prototypes(For this file only)               *
+ *******************************************************************************/
+
+/* Execute the command written to TWCR, if any */
+static void TWI_MODEL_sync(void);
+
+/* Advance the virtual clock by the given number of SCL periods */
+static void TWI_MODEL_busTime(uint8 bits);
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * Access to the TWCR register, used by the TWCR macro of the host avr/io.h.
+ */
+volatile uint16 * TWI_MODEL_accessTWCR(void)
+{
+	/* Make sure the model follows every command on the virtual clock */
+	HOST_CLOCK_setSyncHook(TWI_MODEL_sync);
+
+	TWI_MODEL_sync();
+	return &g_TWCR;
+}
+
+/* Execute the command written to TWCR, if any */
+static void TWI_MODEL_sync(void)
+{
+	uint8 control;
+	boolean ack;
+
+	if (g_TWCR & TWCR_MODEL_MARKER)
+	{
+		/* Nothing written since the last access */
+		return;
+	}
+
+	/* Take the command and mark it as seen before advancing the clock */
+	control = (uint8)g_TWCR;
+	g_TWCR = TWCR_MODEL_MARKER | (control & ~(1 << TWINT));
+
+	/* Writing one to TWINT clears the flag and starts the operation */
+	if (!(control & (1 << TWINT)) || !(control & (1 << TWEN)))
+	{
+		return;
+	}
+
+	if (control & (1 << TWSTO))
+	{
+		TWI_MODEL_busTime(TWI_STOP_BITS);
+		M24C16_stop();
+		g_state = TWI_MODEL_IDLE;
+		TWSR = (TWSR & 0x03) | TWI_NO_INFO;
+
+		/* TWSTO is cleared by hardware and TWINT is not set after a stop */
+		g_TWCR = TWCR_MODEL_MARKER | (control & ~((1 << TWINT) | (1 << TWSTO)));
+		return;
+	}
+
+	if (control & (1 << TWSTA))
+	{
+		TWI_MODEL_busTime(TWI_START_BITS);
+		TWSR = (TWSR & 0x03) | ((g_state == TWI_MODEL_IDLE) ? TWI_START : TWI_REP_START);
+		M24C16_start();
+		g_state = TWI_MODEL_ADDRESS;
+	}
+	else if (g_state == TWI_MODEL_ADDRESS)
+	{
+		TWI_MODEL_busTime(TWI_BYTE_BITS);
+		ack = M24C16_address(TWDR);
+		if (TWDR & 0x01)
+		{
+			TWSR = (TWSR & 0x03) | (ack ? TWI_MT_SLA_R_ACK : TWI_MT_SLA_R_NACK);
+			g_state = TWI_MODEL_RECEIVE;
+		}
+		else
+		{
+			TWSR = (TWSR & 0x03) | (ack ? TWI_MT_SLA_W_ACK : TWI_MT_SLA_W_NACK);
+			g_state = TWI_MODEL_TRANSMIT;
+		}
+	}
+	else if (g_state == TWI_MODEL_TRANSMIT)
+	{
+		TWI_MODEL_busTime(TWI_BYTE_BITS);
+		ack = M24C16_write(TWDR);
+		TWSR = (TWSR & 0x03) | (ack ? TWI_MT_DATA_ACK : TWI_MT_DATA_NACK);
+	}
+	else if (g_state == TWI_MODEL_RECEIVE)
+	{
+		TWI_MODEL_busTime(TWI_BYTE_BITS);
+		ack = (control & (1 << TWEA)) ? TRUE : FALSE;
+		TWDR = M24C16_read(ack);
+		TWSR = (TWSR & 0x03) | (ack ? TWI_MR_DATA_ACK : TWI_MR_DATA_NACK);
+	}
+	else
+	{
+		TWSR = (TWSR & 0x03) | TWI_NO_INFO;
+	}
+
+	/* The operation is complete, TWSTA must be cleared by the driver but TWINT is set */
+	g_TWCR = TWCR_MODEL_MARKER | control;
+}
+
+/* Advance the virtual clock by the given number of SCL periods */
+static void TWI_MODEL_busTime(uint8 bits)
+{
+	/* SCL frequency = F_CPU / (16 + 2 * TWBR * 4^TWPS) */
+	uint64 cycles_per_bit = 16 + 2 * (uint64)TWBR * (1 << (2 * (TWSR & 0x03)));
+
+	HOST_CLOCK_advance(bits * cycles_per_bit * 1000000000ULL / F_CPU);
+}